@@ -0,0 +1,201 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2014 Stefan Seefeld
+# All rights reserved.
+#
+# This file is part of OpenVSIP. It is made available under the
+# license contained in the accompanying LICENSE.BSD file.
+
+"""Compare two benchmark reports and flag performance regressions.
+
+Usage: compare.py [options] baseline current
+
+Both reports are produced by running a benchmark with `-json` or `-csv`
+(optionally together with `-o <file>`). For each problem size present in
+both, the time per iteration is compared. A change is reported as a
+regression (or an improvement) if it exceeds the threshold and is
+statistically significant according to a one-sided Welch's t-test.
+This requires at least two samples in both runs; changes that can't be
+tested are reported as warnings only. Run benchmarks with `-samples 5`
+or more to obtain meaningful statistics.
+
+The exit status is 1 if any (significant) regression was found, 0
+otherwise, so this may be used to gate library upgrades."""
+
+from __future__ import print_function
+import sys
+import csv
+import json
+import math
+import optparse
+
+
+class Sample(object):
+    """Per-iteration time statistics for a single problem size."""
+
+    def __init__(self, size, loop, n, mean, stddev, median):
+
+        self.size = size
+        # Convert from seconds per `loop` iterations to seconds per iteration.
+        self.n = n
+        self.mean = mean / loop
+        self.stddev = stddev / loop
+        self.median = median / loop
+
+
+def _stats(times):
+
+    n = len(times)
+    mean = sum(times) / n
+    var = sum((t - mean)**2 for t in times) / (n - 1) if n > 1 else 0.
+    s = sorted(times)
+    median = s[n//2] if n % 2 else 0.5 * (s[n//2 - 1] + s[n//2])
+    return n, mean, math.sqrt(var), median
+
+
+def load(filename):
+    """Load a report, returning its metadata and a dict of samples by size."""
+
+    with open(filename) as f:
+        text = f.read()
+    if text.lstrip().startswith('{'):
+        report = json.loads(text)
+        samples = {}
+        for r in report['results']:
+            n, mean, stddev, median = _stats(r['times'])
+            samples[r['size']] = Sample(r['size'], r['loop'], n, mean, stddev, median)
+        return report, samples
+    # CSV: "# key,value" metadata lines, followed by a table.
+    meta, samples, columns = {}, {}, None
+    for row in csv.reader(text.splitlines()):
+        if not row:
+            continue
+        if row[0].startswith('#'):
+            key, value = row[0][1:].strip(), ','.join(row[1:])
+            if key in meta:
+                meta[key] += '\n' + value
+            else:
+                meta[key] = value
+        elif columns is None:
+            columns = row
+        else:
+            r = dict(zip(columns, row))
+            size = int(r['size'])
+            samples[size] = Sample(size, int(r['loop']), int(r['samples']),
+                                   float(r['mean']), float(r['stddev']),
+                                   float(r['median']))
+    if 'backend' in meta:
+        meta['backends'] = meta.pop('backend')
+    return meta, samples
+
+
+def _betacf(a, b, x):
+    """Continued fraction for the incomplete beta function."""
+
+    tiny = 1e-300
+    c, d = 1., 1. - (a + b) * x / (a + 1.)
+    d = 1. / (d if abs(d) > tiny else tiny)
+    h = d
+    for m in range(1, 200):
+        m2 = 2 * m
+        for aa in (m * (b - m) * x / ((a + m2 - 1.) * (a + m2)),
+                   -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.))):
+            d = 1. + aa * d
+            d = 1. / (d if abs(d) > tiny else tiny)
+            c = 1. + aa / c
+            if abs(c) < tiny: c = tiny
+            h *= d * c
+        if abs(d * c - 1.) < 1e-12:
+            break
+    return h
+
+
+def _ibeta(a, b, x):
+    """Regularized incomplete beta function I_x(a, b)."""
+
+    if x <= 0.: return 0.
+    if x >= 1.: return 1.
+    lbeta = math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b)
+    front = math.exp(lbeta + a * math.log(x) + b * math.log(1. - x))
+    if x < (a + 1.) / (a + b + 2.):
+        return front * _betacf(a, b, x) / a
+    return 1. - front * _betacf(b, a, 1. - x) / b
+
+
+def welch(base, cur):
+    """Return the one-sided p-value for `cur` being slower than `base`,
+    or None if there are too few samples to tell."""
+
+    if base.n < 2 or cur.n < 2:
+        return None
+    vb, vc = base.stddev**2 / base.n, cur.stddev**2 / cur.n
+    if vb + vc == 0.:
+        return 0. if cur.mean > base.mean else 1.
+    t = (cur.mean - base.mean) / math.sqrt(vb + vc)
+    df = (vb + vc)**2 / (vb**2 / (base.n - 1) + vc**2 / (cur.n - 1))
+    # P(T > t) for Student's t distribution with df degrees of freedom.
+    tail = 0.5 * _ibeta(df / 2., 0.5, df / (df + t * t))
+    return tail if t > 0 else 1. - tail
+
+
+def compare(baseline, current, threshold, alpha, out=sys.stdout):
+    """Compare two reports, and return the number of significant regressions."""
+
+    base_meta, base = load(baseline)
+    cur_meta, cur = load(current)
+    for key in ('what', 'cpu', 'compiler', 'cxxflags', 'nproc', 'backends'):
+        b, c = base_meta.get(key), cur_meta.get(key)
+        if b is not None and c is not None and str(b).strip() != str(c).strip():
+            print('note: %s differs:\n  baseline: %s\n  current : %s'
+                  %(key, str(b).replace('\n', '\n            '),
+                    str(c).replace('\n', '\n            ')), file=out)
+    print('%10s %14s %14s %9s %8s  %s'
+          %('size', 'base (s/it)', 'cur (s/it)', 'change', 'p', 'verdict'), file=out)
+    regressions, untested = 0, 0
+    for size in sorted(set(base) & set(cur)):
+        b, c = base[size], cur[size]
+        change = c.median / b.median - 1. if b.median > 0. else 0.
+        p_slower = welch(b, c)
+        p_faster = welch(c, b)
+        p = p_slower if change >= 0. else p_faster
+        verdict = ''
+        if change > threshold and p is None:
+            verdict = 'warning: slower (untested: too few samples)'
+            untested += 1
+        elif change > threshold and p < alpha:
+            verdict = 'REGRESSION'
+            regressions += 1
+        elif change < -threshold and (p is None or p < alpha):
+            verdict = 'improvement'
+            if p is None:
+                verdict += ' (untested: too few samples)'
+        print('%10d %14.6g %14.6g %+8.1f%% %8s  %s'
+              %(size, b.median, c.median, 100. * change,
+                '-' if p is None else '%.3f'%p, verdict), file=out)
+    missing = sorted(set(base) ^ set(cur))
+    if missing:
+        print('note: sizes only present in one report: %s'
+              %', '.join(str(m) for m in missing), file=out)
+    if untested:
+        print('warning: %d change(s) could not be tested for significance;'
+              ' rerun both benchmarks with -samples 2 or more'%untested, file=out)
+    return regressions
+
+
+def main(argv):
+
+    parser = optparse.OptionParser(usage='%prog [options] baseline current',
+                                   description=__doc__.split('\n')[0])
+    parser.add_option('-t', '--threshold', type='float', default=5.,
+                      help='minimum relative change to report, in percent (default: 5)')
+    parser.add_option('-a', '--alpha', type='float', default=0.05,
+                      help='significance level (default: 0.05)')
+    options, args = parser.parse_args(argv)
+    if len(args) != 2:
+        parser.error('expected two reports')
+    regressions = compare(args[0], args[1], options.threshold / 100., options.alpha)
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+/// Description
+///   Hardware performance counters (Linux perf_event_open).
+///
+///   Counters are opened per event (rather than as a group), so
+///   whichever subset the kernel and the hardware support can be
+///   used.  Counts are scaled to compensate for multiplexing.  Only
+///   user-space events of the calling thread (and threads it creates
+///   afterwards) are counted.  On other platforms, no counters are
+///   available.
+
+#ifndef counters_hpp_
+#define counters_hpp_
+
+#include <ovxx/detail/noncopyable.hpp>
+#include <cstring>
+#if defined(__linux__)
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+# define OVXX_HAVE_PERF_EVENT 1
+#endif
+
+namespace perf
+{
+
+enum event
+{
+  cycles,
+  instructions,
+  cache_references,  // last-level cache references
+  cache_misses,      // last-level cache misses
+  branch_misses,
+  num_events
+};
+
+inline char const *name(event e)
+{
+  switch (e)
+  {
+    case cycles: return "cycles";
+    case instructions: return "instructions";
+    case cache_references: return "cache_references";
+    case cache_misses: return "cache_misses";
+    case branch_misses: return "branch_misses";
+    default: return "unknown";
+  }
+}
+
+/// The size of a cache line, used to convert cache misses to bytes.
+inline unsigned cache_line_size()
+{
+#if defined(_SC_LEVEL1_DCACHE_LINESIZE)
+  long size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+  if (size > 0) return size;
+#endif
+  return 64;
+}
+
+/// A set of counters accumulating events between `start()`
+/// and `stop()` calls.
+class counters : ovxx::detail::noncopyable
+{
+public:
+  counters()
+  {
+    for (int e = 0; e != num_events; ++e)
+    {
+      fd_[e] = -1;
+      total_[e] = 0.;
+    }
+#if OVXX_HAVE_PERF_EVENT
+    static unsigned long const config[num_events] =
+    {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_REFERENCES,
+      PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (int e = 0; e != num_events; ++e)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = config[e];
+      attr.disabled = 1;
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format =
+	PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      fd_[e] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+  }
+  ~counters()
+  {
+#if OVXX_HAVE_PERF_EVENT
+    for (int e = 0; e != num_events; ++e)
+      if (fd_[e] >= 0) close(fd_[e]);
+#endif
+  }
+
+  /// Is any counter available ?
+  bool available() const
+  {
+    for (int e = 0; e != num_events; ++e)
+      if (fd_[e] >= 0) return true;
+    return false;
+  }
+  bool available(event e) const { return fd_[e] >= 0;}
+
+  void start()
+  {
+#if OVXX_HAVE_PERF_EVENT
+    for (int e = 0; e != num_events; ++e)
+      if (fd_[e] >= 0)
+      {
+	ioctl(fd_[e], PERF_EVENT_IOC_RESET, 0);
+	ioctl(fd_[e], PERF_EVENT_IOC_ENABLE, 0);
+      }
+#endif
+  }
+
+  void stop()
+  {
+#if OVXX_HAVE_PERF_EVENT
+    for (int e = 0; e != num_events; ++e)
+      if (fd_[e] >= 0)
+      {
+	ioctl(fd_[e], PERF_EVENT_IOC_DISABLE, 0);
+	// value, time enabled, time running
+	unsigned long long data[3];
+	if (read(fd_[e], data, sizeof(data)) != sizeof(data))
+	  continue;
+	if (data[2])
+	  total_[e] += static_cast<double>(data[0]) * data[1] / data[2];
+      }
+#endif
+  }
+
+  /// Clear the accumulated counts.
+  void reset()
+  {
+    for (int e = 0; e != num_events; ++e) total_[e] = 0.;
+  }
+
+  /// Return the accumulated count of `e`, or -1 if it isn't available.
+  double value(event e) const { return fd_[e] >= 0 ? total_[e] : -1.;}
+
+private:
+  int fd_[num_events];
+  double total_[num_events];
+};
+
+} // namespace perf
+
+#endif
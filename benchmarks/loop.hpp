@@ -18,6 +18,9 @@
 
 #include <vsip/vector.hpp>
 #include <vsip/math.hpp>
+#include "report.hpp"
+#include "counters.hpp"
+#include <memory>
 #if OVXX_PARALLEL_API == 1
 # include <vsip/parallel.hpp>
 #endif
@@ -102,7 +105,11 @@ public:
     mode_        (sweep_mode),
     m_array_     (),
     param_       (),
-    allocator_   (0)
+    allocator_   (0),
+    format_      (text_output),
+    output_      (),
+    cxxflags_    (),
+    counters_    (false)
   {}
 
   template <typename Functor>
@@ -127,6 +134,22 @@ public:
   unsigned
   m_value(unsigned i);
 
+  char const *metric_name() const;
+
+  template <typename Functor>
+  report::info make_info(Functor& fcn);
+
+  template <typename Functor>
+  report::record make_record(Functor& fcn, std::size_t M, std::size_t loop,
+			     std::vector<float> const &times,
+			     perf::counters const *counters = 0);
+
+  /// Write the events being counted to the text report header.
+  static void write_counters_header(std::ostream &os, perf::counters const &counters);
+  /// Write the metrics derived from counters to a text report line,
+  /// omitting unavailable ones.
+  static void write_counters(std::ostream &os, report::record const &record);
+
   // Member data.
 public:
   unsigned	start_;		// loop start "i-value"
@@ -152,6 +175,10 @@ public:
   std::vector<unsigned> m_array_;
   std::map<std::string, std::string> param_;
   ovxx::allocator *allocator_;
+  output_format format_;	// text, csv, or json output
+  std::string   output_;	// output file name (default: stdout)
+  std::string   cxxflags_;	// flags the benchmark was compiled with
+  bool          counters_;	// measure hardware events
 };
 
 
@@ -238,6 +265,98 @@ Loop1P::m_value(unsigned i)
   }
 }
 
+inline char const *
+Loop1P::metric_name() const
+{
+  return metric_ == pts_per_sec  ? "pts_per_sec" :
+    metric_ == ops_per_sec  ? "ops_per_sec" :
+    metric_ == iob_per_sec  ? "iob_per_sec" :
+    metric_ == riob_per_sec ? "riob_per_sec" :
+    metric_ == wiob_per_sec ? "wiob_per_sec" :
+    metric_ == all_per_sec  ? "all_per_sec" :
+    metric_ == data_per_sec ? "data_per_sec" :
+    metric_ == secs_per_pt  ? "usecs_per_pt" :
+    "*unknown*";
+}
+
+// Collect the metadata of a machine-readable report.
+// As this runs the functor's diagnostics, it needs to
+// be called on all processors.
+template <typename Functor>
+report::info
+Loop1P::make_info(Functor& fcn)
+{
+  report::info info;
+  info.what = fcn.what();
+  info.id = what_;
+  info.nproc = vsip::num_processors();
+  info.metric = metric_name();
+  if (note_) info.note = note_;
+  info.cxxflags = cxxflags_;
+  info.backends = report::backends<Functor>::get(fcn);
+  info.ops_per_point = fcn.ops_per_point(1);
+  info.riob_per_point = fcn.riob_per_point(1);
+  info.wiob_per_point = fcn.wiob_per_point(1);
+  info.mem_per_point = fcn.mem_per_point(1);
+  info.counters = counters_;
+  info.params = param_;
+  return info;
+}
+
+template <typename Functor>
+report::record
+Loop1P::make_record(Functor& fcn, std::size_t M, std::size_t loop,
+		    std::vector<float> const &times,
+		    perf::counters const *counters)
+{
+  report::record record;
+  record.size = M;
+  record.x = lhs_ == lhs_mem ? M * fcn.mem_per_point(M) : M;
+  record.loop = loop;
+  record.times = times;
+  float median = report::statistics(times).median;
+  record.mpts_per_sec = metric(fcn, M, loop, median, pts_per_sec);
+  record.mops_per_sec = metric(fcn, M, loop, median, ops_per_sec);
+  record.miob_per_sec = metric(fcn, M, loop, median, iob_per_sec);
+  record.has_counters = counters;
+  record.ipc = record.bytes_per_flop = -1.;
+  if (counters)
+  {
+    // Events per iteration.
+    double iterations = static_cast<double>(times.size()) * loop;
+    for (int e = 0; e != perf::num_events; ++e)
+    {
+      double value = counters->value(perf::event(e));
+      record.events[e] = value < 0. ? -1. : value / iterations;
+    }
+    if (record.events[perf::cycles] > 0. && record.events[perf::instructions] >= 0.)
+      record.ipc = record.events[perf::instructions] / record.events[perf::cycles];
+    double ops = static_cast<double>(M) * fcn.ops_per_point(M);
+    if (ops > 0. && record.events[perf::cache_misses] >= 0.)
+      record.bytes_per_flop =
+	record.events[perf::cache_misses] * perf::cache_line_size() / ops;
+  }
+  return record;
+}
+
+inline void
+Loop1P::write_counters_header(std::ostream &os, perf::counters const &counters)
+{
+  os << "# counters         :";
+  for (int e = 0; e != perf::num_events; ++e)
+    if (counters.available(perf::event(e)))
+      os << ' ' << perf::name(perf::event(e));
+  if (!counters.available()) os << " (unavailable)";
+  os << '\n';
+}
+
+inline void
+Loop1P::write_counters(std::ostream &os, report::record const &record)
+{
+  if (record.ipc >= 0.) os << "  ipc: " << record.ipc;
+  if (record.bytes_per_flop >= 0.) os << "  B/flop: " << record.bytes_per_flop;
+}
+
 
 template <typename Functor>
 inline void
@@ -254,6 +373,7 @@ Loop1P::sweep(Functor fcn)
   length_type nproc = num_processors();
 
   std::vector<float> mtime(n_time);
+  std::auto_ptr<perf::counters> counters(counters_ ? new perf::counters : 0);
 
 #if OVXX_PARALLEL_API == 1
   Vector<float, Dense<1, float, row1_type, Map<> > >
@@ -302,7 +422,18 @@ Loop1P::sweep(Functor fcn)
     } while (factor >= factor_thresh && loop > old_loop);
   }
 
-  if (proc == 0)
+  report::info info;
+  std::vector<report::record> records;
+  std::ofstream file;
+  if (format_ != text_output)
+    info = make_info(fcn);
+  if (proc == 0 && !output_.empty())
+    file.open(output_.c_str());
+  std::ostream &os = output_.empty() ? std::cout : file;
+
+  if (proc == 0 && format_ == csv_output)
+    report::write_csv_header(os, info);
+  else if (proc == 0 && format_ == text_output)
   {
     if (metric_ == data_per_sec)
     {
@@ -318,17 +449,11 @@ Loop1P::sweep(Functor fcn)
     std::cout << "# ops_per_point(1) : " << fcn.ops_per_point(1) << '\n';
     std::cout << "# riob_per_point(1): " << fcn.riob_per_point(1) << '\n';
     std::cout << "# wiob_per_point(1): " << fcn.wiob_per_point(1) << '\n';
-    std::cout << "# metric           : " <<
-      (metric_ == pts_per_sec  ? "pts_per_sec" :
-       metric_ == ops_per_sec  ? "ops_per_sec" :
-       metric_ == iob_per_sec  ? "iob_per_sec" :
-       metric_ == riob_per_sec ? "riob_per_sec" :
-       metric_ == wiob_per_sec ? "wiob_per_sec" :
-       metric_ == data_per_sec ? "data_per_sec" :
-       metric_ == secs_per_pt  ? "usecs_per_pt" :
-       "*unknown*") << '\n';
+    std::cout << "# metric           : " << metric_name() << '\n';
     if (this->note_)
       std::cout << "# note: " << this->note_ << '\n';
+    if (counters.get())
+      write_counters_header(std::cout, *counters);
     std::cout << "# start_loop       : " << static_cast<unsigned long>(loop) << '\n';
     }
   }
@@ -337,6 +462,7 @@ Loop1P::sweep(Functor fcn)
   for (unsigned i=start_; i<=stop_; i++)
   {
     M = this->m_value(i);
+    if (counters.get()) counters->reset();
 
     for (unsigned j=0; j<n_time; ++j)
     {
@@ -344,7 +470,9 @@ Loop1P::sweep(Functor fcn)
       {
 	ovxx::allocator *cur_allocator = ovxx::allocator::get_default();
 	if (allocator_) ovxx::allocator::set_default(allocator_);
+	if (counters.get()) counters->start();
 	fcn(M, loop, time);
+	if (counters.get()) counters->stop();
 	ovxx::allocator::set_default(cur_allocator);
       }
       barrier();
@@ -357,10 +485,17 @@ Loop1P::sweep(Functor fcn)
       mtime[j] = maxval(glob_time.local(), idx);
     }
 
+    if (proc == 0 && format_ != text_output)
+    {
+      report::record record = make_record(fcn, M, loop, mtime, counters.get());
+      if (format_ == csv_output) report::write_csv(os, record);
+      else records.push_back(record);
+    }
+
     std::sort(mtime.begin(), mtime.end());
 
 
-    if (proc == 0)
+    if (proc == 0 && format_ == text_output)
     {
       std::size_t L;
       
@@ -398,6 +533,8 @@ Loop1P::sweep(Functor fcn)
 	std::cout << "  " << loop;
       if (this->show_time_)
 	std::cout << "  " << mtime[(n_time-1)/2];
+      if (counters.get())
+	write_counters(std::cout, make_record(fcn, M, loop, mtime, counters.get()));
       std::cout << std::endl;
     }
 
@@ -415,6 +552,8 @@ Loop1P::sweep(Functor fcn)
       if (loop < 1) loop = 1;
     }
   }
+  if (proc == 0 && format_ == json_output)
+    report::write_json(os, info, records);
 }
 
 
@@ -440,26 +579,30 @@ Loop1P::steady(Functor fcn)
   Vector<float> glob_time(1);
 #endif
   loop = loop_start_;
-
-  if (proc == 0)
+  std::auto_ptr<perf::counters> counters(counters_ ? new perf::counters : 0);
+
+  // A steady run doesn't end, so its report is streamed (as text or
+  // CSV) rather than written as a single JSON document.
+  std::ofstream file;
+  if (proc == 0 && !output_.empty())
+    file.open(output_.c_str());
+  std::ostream &os = output_.empty() ? std::cout : file;
+
+  if (proc == 0 && format_ == csv_output)
+    report::write_csv_header(os, make_info(fcn));
+  else if (proc == 0)
   {
-    std::cout << "# what             : " << fcn.what() << " (" << what_ << ")\n";
-    std::cout << "# nproc            : " << nproc << "\n";
-    std::cout << "# ops_per_point(1) : " << fcn.ops_per_point(1) << '\n';
-    std::cout << "# riob_per_point(1): " << fcn.riob_per_point(1) << '\n';
-    std::cout << "# wiob_per_point(1): " << fcn.wiob_per_point(1) << '\n';
-    std::cout << "# metric           : " <<
-      (metric_ == pts_per_sec  ? "pts_per_sec" :
-       metric_ == ops_per_sec  ? "ops_per_sec" :
-       metric_ == iob_per_sec  ? "iob_per_sec" :
-       metric_ == riob_per_sec ? "riob_per_sec" :
-       metric_ == wiob_per_sec ? "wiob_per_sec" :
-       metric_ == data_per_sec ? "data_per_sec" :
-       metric_ == secs_per_pt  ? "usecs_per_pt" :
-       "*unknown*") << '\n';
+    os << "# what             : " << fcn.what() << " (" << what_ << ")\n";
+    os << "# nproc            : " << nproc << "\n";
+    os << "# ops_per_point(1) : " << fcn.ops_per_point(1) << '\n';
+    os << "# riob_per_point(1): " << fcn.riob_per_point(1) << '\n';
+    os << "# wiob_per_point(1): " << fcn.wiob_per_point(1) << '\n';
+    os << "# metric           : " << metric_name() << '\n';
     if (this->note_)
-      std::cout << "# note: " << this->note_ << '\n';
-    std::cout << "# start_loop       : " << static_cast<unsigned long>(loop) << '\n';
+      os << "# note: " << this->note_ << '\n';
+    if (counters.get())
+      write_counters_header(os, *counters);
+    os << "# start_loop       : " << static_cast<unsigned long>(loop) << '\n';
   }
 
   // for real ---------------------------------------------------------
@@ -471,7 +614,9 @@ Loop1P::steady(Functor fcn)
     {
       allocator *cur_allocator = ovxx::allocator::get_default();
       if (allocator_) ovxx::allocator::set_default(allocator_);
+      if (counters.get()) { counters->reset(); counters->start();}
       fcn(M, loop, time);
+      if (counters.get()) counters->stop();
       ovxx::allocator::set_default(cur_allocator);
     }
     barrier();
@@ -483,21 +628,30 @@ Loop1P::steady(Functor fcn)
 
     time = maxval(glob_time.local(), idx);
 
-    if (proc == 0)
+    if (proc == 0 && format_ == csv_output)
+    {
+      report::write_csv(os, make_record(fcn, M, loop, std::vector<float>(1, time),
+					counters.get()));
+      os.flush();
+    }
+    else if (proc == 0)
     {
       if (this->metric_ == all_per_sec)
-	std::cout << M << ' '
-		  << this->metric(fcn, M, loop, time, pts_per_sec) << ' '
-		  << this->metric(fcn, M, loop, time, ops_per_sec) << ' '
-		  << this->metric(fcn, M, loop, time, iob_per_sec);
+	os << M << ' '
+	   << this->metric(fcn, M, loop, time, pts_per_sec) << ' '
+	   << this->metric(fcn, M, loop, time, ops_per_sec) << ' '
+	   << this->metric(fcn, M, loop, time, iob_per_sec);
       else
-	std::cout << M << ' '
-		  << this->metric(fcn, M, loop, time, metric_);
+	os << M << ' '
+	   << this->metric(fcn, M, loop, time, metric_);
       if (this->show_loop_)
-	std::cout << "  " << loop;
+	os << "  " << loop;
       if (this->show_time_)
-	std::cout << "  " << time;
-      std::cout << std::endl;
+	os << "  " << time;
+      if (counters.get())
+	write_counters(os, make_record(fcn, M, loop, std::vector<float>(1, time),
+				       counters.get()));
+      os << std::endl;
     }
 
     float factor = goal_sec_ / time;
@@ -532,6 +686,8 @@ Loop1P::single(Functor fcn)
   Vector<float> glob_time(1);
 #endif
 
+  std::auto_ptr<perf::counters> counters(counters_ ? new perf::counters : 0);
+
   // calibrate
   if (do_cal_ && !fix_loop_)
   {
@@ -568,7 +724,9 @@ Loop1P::single(Functor fcn)
   barrier();
   ovxx::allocator *cur_allocator = ovxx::allocator::get_default();
   if (allocator_) ovxx::allocator::set_default(allocator_);
+  if (counters.get()) counters->start();
   fcn(M, loop, time);
+  if (counters.get()) counters->stop();
   ovxx::allocator::set_default(cur_allocator);
   barrier();
 
@@ -579,12 +737,29 @@ Loop1P::single(Functor fcn)
 
   time = maxval(glob_time.local(), idx);
 
-  if (proc == 0)
+  if (proc != 0) return;
+
+  std::ofstream file;
+  if (!output_.empty()) file.open(output_.c_str());
+  std::ostream &os = output_.empty() ? std::cout : file;
+  std::vector<report::record> records
+    (1, make_record(fcn, M, loop, std::vector<float>(1, time), counters.get()));
+  if (format_ == csv_output)
+  {
+    report::write_csv_header(os, make_info(fcn));
+    report::write_csv(os, records[0]);
+  }
+  else if (format_ == json_output)
+    report::write_json(os, make_info(fcn), records);
+  else
   {
-    std::cout << M << ", " 
-	      << this->metric(fcn, M, loop, time, ops_per_sec) << ", "
-	      << loop << ", "
-	      << time * 1e6 / loop << std::endl;
+    os << M << ", " 
+       << this->metric(fcn, M, loop, time, ops_per_sec) << ", "
+       << loop << ", "
+       << time * 1e6 / loop;
+    if (counters.get())
+      write_counters(os, records[0]);
+    os << std::endl;
   }
 }
 
@@ -41,6 +41,9 @@ main(int argc, char** argv)
   bool   pause   = false;
 
   loop.goal_sec_ = 0.25;
+#ifdef OVXX_BENCHMARK_CXXFLAGS
+  loop.cxxflags_ = OVXX_BENCHMARK_CXXFLAGS;
+#endif
   defaults(loop);
 
   int what = 0;
@@ -94,6 +97,22 @@ main(int argc, char** argv)
       loop.metric_ = data_per_sec;
     else if (!strcmp(argv[i], "-lat"))
       loop.metric_ = secs_per_pt;
+    else if (!strcmp(argv[i], "-csv"))
+      loop.format_ = csv_output;
+    else if (!strcmp(argv[i], "-json"))
+      loop.format_ = json_output;
+    else if (!strcmp(argv[i], "-o"))
+    {
+      if (i + 1 == argc)
+      {
+	std::cerr << "ERROR: -o requires a file name\n"
+		  << "usage: " << argv[0] << " [-o <report file>] ..." << std::endl;
+	exit(-1);
+      }
+      loop.output_ = argv[++i];
+    }
+    else if (!strcmp(argv[i], "-counters"))
+      loop.counters_ = true;
     else if (!strcmp(argv[i], "-geom"))
       loop.progression_ = geometric;
     else if (!strcmp(argv[i], "-linear"))
@@ -165,6 +184,12 @@ main(int argc, char** argv)
       std::cerr << "ERROR: Unknown argument: " << argv[i] << std::endl;
   }
 
+  if (loop.mode_ == steady_mode && loop.format_ == json_output)
+  {
+    std::cerr << "ERROR: -json can't be used with -steady (use -csv)" << std::endl;
+    exit(-1);
+  }
+
   if (loop.metric_ == data_per_sec && loop.samples_ < 3)
   {
     std::cerr << "ERROR: -samples must be >= 3 when using -data" << std::endl;
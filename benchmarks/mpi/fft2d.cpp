@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+/// Description
+///   Benchmark for distributed 2D FFTs.
+///   Compares the built-in corner turn of a distributed Fft<2>
+///   with a row Fftm, a parallel assignment (corner turn) and a
+///   column Fftm.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/math.hpp>
+#include <vsip/signal.hpp>
+#include <vsip/map.hpp>
+#include "benchmark.hpp"
+#include <iostream>
+
+using namespace ovxx;
+
+float
+fft_ops(length_type len)
+{
+  return 5.0 * len * std::log((double)len) / std::log(2.0);
+}
+
+template <typename T, typename ImplTag>
+struct t_fft2d;
+
+struct Impl_fft;	// distributed Fft<2>
+struct Impl_fftm;	// Fftm + corner turn + Fftm
+
+template <typename T, typename ImplTag>
+struct t_fft2d_base : Benchmark_base
+{
+  typedef Map<Block_dist, Block_dist>      map_type;
+  typedef Dense<2, T, row2_type, map_type> block_type;
+  typedef Matrix<T, block_type>            view_type;
+
+  float ops_per_point(length_type cols)
+  { return (rows_ * fft_ops(cols) + cols * fft_ops(rows_)) / cols;}
+  int riob_per_point(length_type) { return rows_*sizeof(T);}
+  int wiob_per_point(length_type) { return rows_*sizeof(T);}
+  int mem_per_point (length_type) { return 2*rows_*sizeof(T);}
+
+  void check(char const *name, view_type Z, length_type cols)
+  {
+    // The FFT of a constant matrix has a single non-zero element.
+    T expected = T(rows_ * cols);
+    if (!equal(Z.get(0, 0), expected))
+    {
+      std::cout << name << ": ERROR" << std::endl;
+      std::cout << "   got     : " << Z.get(0, 0) << std::endl;
+      std::cout << "   expected: " << expected << std::endl;
+      abort();
+    }
+  }
+
+  t_fft2d_base(length_type rows) : rows_(rows) {}
+
+  length_type rows_;
+};
+
+template <typename T>
+struct t_fft2d<T, Impl_fft> : t_fft2d_base<T, Impl_fft>
+{
+  typedef t_fft2d_base<T, Impl_fft> base_type;
+  typedef typename base_type::map_type map_type;
+  typedef typename base_type::view_type view_type;
+
+  char const* what() { return "t_fft2d<T, Impl_fft>";}
+
+  void operator()(length_type cols, length_type loop, float& time)
+  {
+    length_type rows = this->rows_;
+    processor_type np = num_processors();
+
+    view_type A(rows, cols, T(1), map_type(np, 1));
+    view_type Z(rows, cols, map_type(1, np));
+
+    Fft<const_Matrix, T, T, fft_fwd, by_reference, 1, alg_time>
+      fft(Domain<2>(rows, cols), 1.f);
+
+    // Warm up, to set up the corner turn.
+    fft(A, Z);
+
+    timer t1;
+    for (index_type l=0; l<loop; ++l)
+      fft(A, Z);
+    time = t1.elapsed();
+
+    this->check(what(), Z, cols);
+  }
+
+  t_fft2d(length_type rows) : base_type(rows) {}
+};
+
+template <typename T>
+struct t_fft2d<T, Impl_fftm> : t_fft2d_base<T, Impl_fftm>
+{
+  typedef t_fft2d_base<T, Impl_fftm> base_type;
+  typedef typename base_type::map_type map_type;
+  typedef typename base_type::view_type view_type;
+
+  char const* what() { return "t_fft2d<T, Impl_fftm>";}
+
+  void operator()(length_type cols, length_type loop, float& time)
+  {
+    length_type rows = this->rows_;
+    processor_type np = num_processors();
+
+    view_type A(rows, cols, T(1), map_type(np, 1));
+    view_type B(rows, cols, map_type(np, 1));
+    view_type C(rows, cols, map_type(1, np));
+    view_type Z(rows, cols, map_type(1, np));
+
+    Fftm<T, T, row, fft_fwd, by_reference, 1, alg_time>
+      row_fftm(Domain<2>(rows, cols), 1.f);
+    Fftm<T, T, col, fft_fwd, by_reference, 1, alg_time>
+      col_fftm(Domain<2>(rows, cols), 1.f);
+
+    row_fftm(A, B);
+    C = B;
+    col_fftm(C, Z);
+
+    timer t1;
+    for (index_type l=0; l<loop; ++l)
+    {
+      row_fftm(A, B);
+      C = B;
+      col_fftm(C, Z);
+    }
+    time = t1.elapsed();
+
+    this->check(what(), Z, cols);
+  }
+
+  t_fft2d(length_type rows) : base_type(rows) {}
+};
+
+
+
+void
+defaults(Loop1P& loop)
+{
+  loop.start_      = 4;
+  loop.stop_       = 12;
+  loop.loop_start_ = 10;
+
+  loop.param_["rows"] = "256";
+}
+
+int
+benchmark(Loop1P& loop, int what)
+{
+  length_type rows = atoi(loop.param_["rows"].c_str());
+
+  typedef complex<float>  Cf;
+  typedef complex<double> Cd;
+
+  switch (what)
+  {
+  case  1: loop(t_fft2d<Cf, Impl_fft>(rows)); break;
+  case  2: loop(t_fft2d<Cf, Impl_fftm>(rows)); break;
+
+  case 11: loop(t_fft2d<Cd, Impl_fft>(rows)); break;
+  case 12: loop(t_fft2d<Cd, Impl_fftm>(rows)); break;
+
+  case 0:
+    std::cout
+      << "fft2d -- distributed 2D FFT\n"
+      << "   -1 -- distributed Fft<2>, built-in corner turn (float)\n"
+      << "   -2 -- row Fftm, corner turn, column Fftm         (float)\n"
+      << "  -11 -- distributed Fft<2>, built-in corner turn (double)\n"
+      << "  -12 -- row Fftm, corner turn, column Fftm         (double)\n"
+      << "\n"
+      << " Parameters (sweeping number of columns)\n"
+      << "  -p:rows ROWS -- set number of rows (default 256)\n"
+      ;
+  default: return 0;
+  }
+  return 1;
+}
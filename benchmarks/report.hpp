@@ -0,0 +1,403 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+/// Description
+///   Machine-readable (JSON / CSV) benchmark reports.
+///
+///   A report describes a single benchmark run: what was measured,
+///   the environment it was measured in (CPU, compiler, flags,
+///   library configuration, the backends chosen by the dispatcher),
+///   and for each problem size the full set of timing samples
+///   together with summary statistics.  Reports are meant to be
+///   consumed by tools such as benchmarks/compare.py.
+
+#ifndef report_hpp_
+#define report_hpp_
+
+#include <ovxx/check_config.hpp>
+#include <ovxx/detail/util.hpp>
+#include "counters.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <string>
+#include <cmath>
+#include <ctime>
+#include <cstdio>
+#if !_WIN32
+# include <unistd.h>
+#endif
+
+enum output_format
+{
+  text_output,
+  csv_output,
+  json_output
+};
+
+namespace report
+{
+
+/// Summary statistics of a set of timing samples.
+struct statistics
+{
+  statistics(std::vector<float> const &samples)
+    : min(0), max(0), median(0), mean(0), stddev(0)
+  {
+    if (samples.empty()) return;
+    std::vector<float> s(samples);
+    std::sort(s.begin(), s.end());
+    std::size_t n = s.size();
+    min = s.front();
+    max = s.back();
+    median = n % 2 ? s[n/2] : 0.5 * (s[n/2 - 1] + s[n/2]);
+    double sum = 0.;
+    for (std::size_t i = 0; i != n; ++i) sum += s[i];
+    mean = sum / n;
+    if (n > 1)
+    {
+      double var = 0.;
+      for (std::size_t i = 0; i != n; ++i)
+	var += (s[i] - mean) * (s[i] - mean);
+      stddev = std::sqrt(var / (n - 1));
+    }
+  }
+
+  double min;
+  double max;
+  double median;
+  double mean;
+  double stddev;
+};
+
+/// The measurement for a single problem size.
+struct record
+{
+  std::size_t size;          // problem size (M)
+  std::size_t x;             // reported size (points or memory)
+  std::size_t loop;          // iterations per sample
+  std::vector<float> times;  // seconds per sample (of `loop` iterations)
+  double mpts_per_sec;       // at the median time
+  double mops_per_sec;
+  double miob_per_sec;
+  // Hardware events per iteration (-1 if unavailable), if requested.
+  bool has_counters;
+  double events[perf::num_events];
+  double ipc;                // instructions per cycle
+  double bytes_per_flop;     // bytes transferred due to cache misses, per op
+};
+
+/// Quote `s` as a JSON string.
+inline std::string quote(std::string const &s)
+{
+  std::ostringstream oss;
+  oss << '"';
+  for (std::string::const_iterator i = s.begin(); i != s.end(); ++i)
+  {
+    switch (*i)
+    {
+      case '"': oss << "\\\""; break;
+      case '\\': oss << "\\\\"; break;
+      case '\n': oss << "\\n"; break;
+      case '\t': oss << "\\t"; break;
+      case '\r': oss << "\\r"; break;
+      default:
+	if (static_cast<unsigned char>(*i) < 0x20)
+	{
+	  char buf[8];
+	  sprintf(buf, "\\u%04x", static_cast<unsigned char>(*i));
+	  oss << buf;
+	}
+	else oss << *i;
+    }
+  }
+  oss << '"';
+  return oss.str();
+}
+
+/// Write a number, or null if it isn't finite (which JSON can't express).
+struct number
+{
+  number(double v) : value(v) {}
+  double value;
+};
+
+inline std::ostream &operator<<(std::ostream &os, number n)
+{
+  if (n.value == n.value && n.value - n.value == 0.) os << n.value;
+  else os << "null";
+  return os;
+}
+
+/// Write a non-negative value, or null if it is negative (i.e., unavailable).
+struct count
+{
+  count(double v) : value(v) {}
+  double value;
+};
+
+inline std::ostream &operator<<(std::ostream &os, count c)
+{
+  if (c.value >= 0.) os << number(c.value);
+  else os << "null";
+  return os;
+}
+
+/// Quote `s` as a CSV field.
+inline std::string csv_quote(std::string const &s)
+{
+  if (s.find_first_of(",\"\n") == std::string::npos) return s;
+  std::string r = "\"";
+  for (std::string::const_iterator i = s.begin(); i != s.end(); ++i)
+  {
+    if (*i == '"') r += '"';
+    r += *i;
+  }
+  return r + '"';
+}
+
+/// Return a description of the host CPU.
+inline std::string cpu()
+{
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line))
+    if (line.compare(0, 10, "model name") == 0)
+    {
+      std::string::size_type i = line.find(':');
+      if (i != std::string::npos)
+      {
+	i = line.find_first_not_of(" \t", i + 1);
+	if (i != std::string::npos) return line.substr(i);
+      }
+    }
+  return "unknown";
+}
+
+inline std::string host()
+{
+#if !_WIN32
+  char name[256];
+  if (gethostname(name, sizeof(name)) == 0)
+  {
+    name[sizeof(name) - 1] = '\0';
+    return name;
+  }
+#endif
+  return "unknown";
+}
+
+inline std::string compiler()
+{
+#if defined(__clang__) || defined(__INTEL_COMPILER)
+  return __VERSION__;
+#elif defined(__GNUC__)
+  return "GCC " __VERSION__;
+#else
+  return "unknown";
+#endif
+}
+
+inline std::string timestamp()
+{
+  char buf[32];
+  std::time_t now = std::time(0);
+  std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+  return buf;
+}
+
+namespace detail
+{
+using ovxx::detail::yes_tag;
+using ovxx::detail::no_tag;
+
+template <typename T, void (T::*)()> struct diag_helper;
+
+template <typename T>
+no_tag has_diag_helper(...);
+
+template <typename T>
+yes_tag has_diag_helper(int, diag_helper<T, &T::diag> * = 0);
+} // namespace report::detail
+
+/// Does F provide its own (dispatcher diagnostics) `diag()` ?
+template <typename F>
+struct has_diag
+{
+  static bool const value =
+    sizeof(detail::has_diag_helper<F>(0)) == sizeof(ovxx::detail::yes_tag);
+};
+
+template <typename F, bool = has_diag<F>::value>
+struct backends
+{
+  static std::string get(F &) { return std::string();}
+};
+
+/// Capture the output of `F::diag()`, which reports the
+/// backends chosen to evaluate the benchmarked operation.
+template <typename F>
+struct backends<F, true>
+{
+  static std::string get(F &fcn)
+  {
+    std::ostringstream oss;
+    std::streambuf *buf = std::cout.rdbuf(oss.rdbuf());
+    fcn.diag();
+    std::cout.rdbuf(buf);
+    return oss.str();
+  }
+};
+
+/// Everything known about a benchmark run, other than its measurements.
+struct info
+{
+  std::string what;
+  int id;
+  std::size_t nproc;
+  std::string metric;
+  std::string note;
+  std::string cxxflags;
+  std::string backends;      // dispatcher diagnostics, if available
+  int ops_per_point;
+  int riob_per_point;
+  int wiob_per_point;
+  int mem_per_point;
+  bool counters;             // whether records contain hardware events
+  std::map<std::string, std::string> params;
+};
+
+inline void
+write_json(std::ostream &os, info const &i, std::vector<record> const &records)
+{
+  std::streamsize precision = os.precision(8);
+  os << "{\n"
+     << "  \"format\": \"ovxx-benchmark-1\",\n"
+     << "  \"what\": " << quote(i.what) << ",\n"
+     << "  \"id\": " << i.id << ",\n"
+     << "  \"nproc\": " << i.nproc << ",\n"
+     << "  \"metric\": " << quote(i.metric) << ",\n"
+     << "  \"timestamp\": " << quote(timestamp()) << ",\n"
+     << "  \"host\": " << quote(host()) << ",\n"
+     << "  \"cpu\": " << quote(cpu()) << ",\n"
+     << "  \"compiler\": " << quote(compiler()) << ",\n"
+     << "  \"cxxflags\": " << quote(i.cxxflags) << ",\n"
+     << "  \"library_config\": " << quote(ovxx::library_config()) << ",\n"
+     << "  \"backends\": " << quote(i.backends) << ",\n";
+  if (!i.note.empty())
+    os << "  \"note\": " << quote(i.note) << ",\n";
+  os << "  \"ops_per_point\": " << i.ops_per_point << ",\n"
+     << "  \"riob_per_point\": " << i.riob_per_point << ",\n"
+     << "  \"wiob_per_point\": " << i.wiob_per_point << ",\n"
+     << "  \"mem_per_point\": " << i.mem_per_point << ",\n"
+     << "  \"params\": {";
+  for (std::map<std::string, std::string>::const_iterator p = i.params.begin();
+       p != i.params.end(); ++p)
+    os << (p == i.params.begin() ? "" : ", ")
+       << quote(p->first) << ": " << quote(p->second);
+  os << "},\n"
+     << "  \"results\": [";
+  for (std::size_t r = 0; r != records.size(); ++r)
+  {
+    record const &rec = records[r];
+    statistics s(rec.times);
+    os << (r ? "," : "") << "\n    {\"size\": " << rec.size
+       << ", \"x\": " << rec.x
+       << ", \"loop\": " << rec.loop
+       << ", \"times\": [";
+    for (std::size_t t = 0; t != rec.times.size(); ++t)
+      os << (t ? ", " : "") << rec.times[t];
+    os << "],\n     \"min\": " << s.min
+       << ", \"median\": " << s.median
+       << ", \"mean\": " << s.mean
+       << ", \"max\": " << s.max
+       << ", \"stddev\": " << s.stddev
+       << ",\n     \"mpts_per_sec\": " << number(rec.mpts_per_sec)
+       << ", \"mops_per_sec\": " << number(rec.mops_per_sec)
+       << ", \"miob_per_sec\": " << number(rec.miob_per_sec);
+    if (rec.has_counters)
+    {
+      os << ",\n     \"counters\": {";
+      for (int e = 0; e != perf::num_events; ++e)
+	os << (e ? ", " : "") << quote(perf::name(perf::event(e))) << ": "
+	   << count(rec.events[e]);
+      os << "}, \"ipc\": " << count(rec.ipc)
+	 << ", \"bytes_per_flop\": " << count(rec.bytes_per_flop);
+    }
+    os << "}";
+  }
+  os << "\n  ]\n}" << std::endl;
+  os.precision(precision);
+}
+
+/// Write the header of a CSV report. Metadata is written as
+/// "# key,value" comment lines, followed by the column names.
+inline void
+write_csv_header(std::ostream &os, info const &i)
+{
+  os << "# what," << csv_quote(i.what) << '\n'
+     << "# id," << i.id << '\n'
+     << "# nproc," << i.nproc << '\n'
+     << "# metric," << i.metric << '\n'
+     << "# timestamp," << timestamp() << '\n'
+     << "# host," << csv_quote(host()) << '\n'
+     << "# cpu," << csv_quote(cpu()) << '\n'
+     << "# compiler," << csv_quote(compiler()) << '\n'
+     << "# cxxflags," << csv_quote(i.cxxflags) << '\n';
+  // Multi-line values are folded into one line per entry.
+  std::istringstream backends(i.backends);
+  std::string line;
+  while (std::getline(backends, line))
+    if (!line.empty()) os << "# backend," << csv_quote(line) << '\n';
+  for (std::map<std::string, std::string>::const_iterator p = i.params.begin();
+       p != i.params.end(); ++p)
+    os << "# param," << csv_quote(p->first) << ',' << csv_quote(p->second) << '\n';
+  os << "size,x,loop,samples,min,median,mean,max,stddev,"
+     << "mpts_per_sec,mops_per_sec,miob_per_sec";
+  if (i.counters)
+  {
+    for (int e = 0; e != perf::num_events; ++e)
+      os << ',' << perf::name(perf::event(e));
+    os << ",ipc,bytes_per_flop";
+  }
+  os << std::endl;
+}
+
+inline void
+write_csv(std::ostream &os, record const &rec)
+{
+  statistics s(rec.times);
+  std::streamsize precision = os.precision(8);
+  os << rec.size << ',' << rec.x << ',' << rec.loop << ','
+     << rec.times.size() << ','
+     << s.min << ',' << s.median << ',' << s.mean << ','
+     << s.max << ',' << s.stddev << ','
+     << rec.mpts_per_sec << ',' << rec.mops_per_sec << ','
+     << rec.miob_per_sec;
+  if (rec.has_counters)
+  {
+    // Unavailable values are left empty.
+    for (int e = 0; e != perf::num_events; ++e)
+    {
+      os << ',';
+      if (rec.events[e] >= 0.) os << rec.events[e];
+    }
+    os << ',';
+    if (rec.ipc >= 0.) os << rec.ipc;
+    os << ',';
+    if (rec.bytes_per_flop >= 0.) os << rec.bytes_per_flop;
+  }
+  os << std::endl;
+  os.precision(precision);
+}
+
+} // namespace report
+
+#endif
@@ -0,0 +1,206 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+/// Description
+///   Autotuner for cost-based dispatch.
+///
+///   For a set of operations, measure every backend that is available
+///   for it over a range of problem sizes (2^start ... 2^stop elements),
+///   and write the results as a tuning table, to the file given with
+///   `-o`, or to stdout.  Setting OVXX_TUNING to the name of that file
+///   then makes the dispatcher use the fastest backend for each size.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/math.hpp>
+#include <ovxx/dispatch.hpp>
+#include <ovxx/dispatcher/tuning.hpp>
+#include "benchmark.hpp"
+#include <fstream>
+#include <cmath>
+
+using namespace ovxx;
+namespace tuning = ovxx::dispatcher::tuning;
+
+/// Measure E::exec for the arguments held by `c`, if E is valid for them.
+template <typename O, typename B, typename E, bool V = E::ct_valid>
+struct measure
+{
+  template <typename C> static void exec(C &, double) {}
+};
+
+template <typename O, typename B, typename E>
+struct measure<O, B, E, true>
+{
+  template <typename C>
+  static void exec(C &c, double goal)
+  {
+    if (!c.template valid<E>()) return;
+    c.template run<E>(); // warm up
+    length_type loop = 1;
+    double time;
+    while (true)
+    {
+      timer t;
+      for (index_type l = 0; l != loop; ++l) c.template run<E>();
+      time = t.elapsed();
+      if (time >= goal || loop >= (1u << 24)) break;
+      loop *= time > 0. ? std::min(16., std::max(2., 1.5 * goal / time)) : 16;
+    }
+    // Take the best of three samples.
+    double best = time / loop;
+    for (int s = 0; s != 2; ++s)
+    {
+      timer t;
+      for (index_type l = 0; l != loop; ++l) c.template run<E>();
+      best = std::min(best, t.elapsed() / loop);
+    }
+    tuning::add(profile::name<O>(), profile::name<B>(), c.size(), best);
+    std::cerr << std::setw(12) << profile::name<B>()
+	      << std::setw(10) << c.size()
+	      << std::setw(14) << best << "  " << profile::name<O>() << std::endl;
+  }
+};
+
+/// Measure all backends in L.
+template <typename O, typename C,
+	  typename L = typename dispatcher::List<O>::type>
+struct backends
+{
+  typedef typename L::head B;
+  typedef dispatcher::Evaluator<O, B, typename C::signature_type> E;
+  static void exec(C &c, double goal)
+  {
+    measure<O, B, E>::exec(c, goal);
+    backends<O, C, typename L::tail>::exec(c, goal);
+  }
+};
+
+template <typename O, typename C>
+struct backends<O, C, dispatcher::null_type>
+{
+  static void exec(C &, double) {}
+};
+
+/// Arguments for a binary operation.
+template <typename R, typename A1>
+struct args2
+{
+  typedef void signature_type(R &, A1 const &);
+  args2(R &r, A1 const &a1) : r_(r), a1_(a1) {}
+  length_type size() const { return tuning::size(r_, a1_);}
+  template <typename E> bool valid() { return E::rt_valid(r_, a1_);}
+  template <typename E> void run() { E::exec(r_, a1_);}
+  R &r_;
+  A1 const &a1_;
+};
+
+/// Arguments for a ternary operation.
+template <typename R, typename A1, typename A2>
+struct args3
+{
+  typedef void signature_type(R &, A1 const &, A2 const &);
+  args3(R &r, A1 const &a1, A2 const &a2) : r_(r), a1_(a1), a2_(a2) {}
+  length_type size() const { return tuning::size(r_, a1_, a2_);}
+  template <typename E> bool valid() { return E::rt_valid(r_, a1_, a2_);}
+  template <typename E> void run() { E::exec(r_, a1_, a2_);}
+  R &r_;
+  A1 const &a1_;
+  A2 const &a2_;
+};
+
+template <typename O, typename LHS, typename RHS>
+void tune_assign(LHS &lhs, RHS const &rhs, double goal)
+{
+  args2<LHS, RHS> args(lhs, rhs);
+  backends<O, args2<LHS, RHS> >::exec(args, goal);
+}
+
+template <typename O, typename R, typename A1, typename A2>
+void tune_op(R &r, A1 const &a1, A2 const &a2, double goal)
+{
+  args3<R, A1, A2> args(r, a1, a2);
+  backends<O, args3<R, A1, A2> >::exec(args, goal);
+}
+
+// Tuning tables are kept per operation, not per argument type, so
+// each operation is measured with a single representative case.
+
+// Element-wise vector operations, represented by a vector multiply.
+template <typename T>
+void vector_ops(length_type size, double goal)
+{
+  Vector<T> a(size, T(1));
+  Vector<T> b(size, T(2));
+  Vector<T> c(size);
+  tune_assign<dispatcher::op::assign<1> >(c.block(), (a * b).block(), goal);
+}
+
+// Matrix products, represented by square matrix-matrix products
+// (for sizes that are perfect squares).
+template <typename T>
+void matrix_ops(length_type size, double goal)
+{
+  length_type n = static_cast<length_type>(std::sqrt(static_cast<double>(size)));
+  if (n < 2 || n > 512 || n * n != size) return;
+  Matrix<T> a(n, n, T(1));
+  Matrix<T> b(n, n, T(2));
+  Matrix<T> c(n, n);
+  tune_op<dispatcher::op::prod>(c.block(), a.block(), b.block(), goal);
+}
+
+template <typename T>
+void tune(Loop1P &loop)
+{
+  // Spend a fraction of the usual measurement goal on each point.
+  double goal = loop.goal_sec_ / 25;
+  for (unsigned i = loop.start_; i <= loop.stop_; ++i)
+  {
+    length_type size = length_type(1) << i;
+    vector_ops<T>(size, goal);
+    matrix_ops<T>(size, goal);
+  }
+  if (loop.output_.empty())
+    tuning::save(std::cout);
+  else
+  {
+    std::ofstream ofs(loop.output_.c_str());
+    tuning::save(ofs);
+  }
+}
+
+void
+defaults(Loop1P &loop)
+{
+  loop.start_ = 2;
+  loop.stop_ = 20;
+}
+
+int
+benchmark(Loop1P &loop, int what)
+{
+  switch (what)
+  {
+  case 1: tune<float>(loop); break;
+  case 2: tune<double>(loop); break;
+  case 3: tune<complex<float> >(loop); break;
+
+  case 0:
+    std::cout
+      << "tune -- measure backends and write a tuning table\n"
+      << "  -1 -- float\n"
+      << "  -2 -- double\n"
+      << "  -3 -- complex<float>\n"
+      << "  -start N, -stop N: problem sizes 2^N to measure\n"
+      << "  -o file: the tuning table to write (default: stdout)\n"
+      ;
+  default: return 0;
+  }
+  return 1;
+}
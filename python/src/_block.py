@@ -6,8 +6,17 @@
 # license contained in the accompanying LICENSE.BSD file.
 
 from vsip import import_module
+import support
 import numpy
 
+# Map DLPack (type code, bits) pairs to value types.
+_dlpack_types = {(0, 32): numpy.int32,
+                 (2, 32): numpy.float32,
+                 (2, 64): numpy.float64,
+                 (5, 64): numpy.complex64,
+                 (5, 128): numpy.complex128,
+                 (6, 8): bool}
+
 def block(*args, **kwargs):
     """Create a block.
 
@@ -16,6 +25,10 @@ def block(*args, **kwargs):
       block(dtype, shape): create a block of the given type and shape
       block(dtype, shape, value): create a block of the given type and shape and initialize it to value
       block(array=A): create a block from an existing array-like container
+      block(buffer=B): create a block referring to the memory exported by B
+                       through the buffer protocol (no copy)
+      block(dlpack=T): create a block referring to the DLPack tensor T
+                       (or an object providing __dlpack__) (no copy)
     """
 
     # First figure out the data type so we know which
@@ -29,11 +42,24 @@ def block(*args, **kwargs):
         # make sure we have all the required metadata
         array = numpy.array(kwargs['array'], copy=False)
         dtype = array.dtype
+    elif 'buffer' in kwargs:
+        # This only inspects the buffer, it doesn't copy it.
+        buffer = numpy.asarray(kwargs['buffer'])
+        dtype = buffer.dtype
+    elif 'dlpack' in kwargs:
+        tensor = kwargs['dlpack']
+        if hasattr(tensor, '__dlpack__'):
+            tensor = tensor.__dlpack__()
+        dtype = _dlpack_types.get(support.dlpack_type(tensor))
 
     mod = import_module('vsip.block', dtype)
 
     if 'array' in kwargs:
         return mod.block(array)
+    elif 'buffer' in kwargs:
+        return mod.wrap(buffer)
+    elif 'dlpack' in kwargs:
+        return mod.from_dlpack(tensor)
         
     # Create a new block
     if len(shape) == 1:
@@ -9,11 +9,14 @@
 #define block_api_hpp_
 
 #include <ovxx/python/block.hpp>
+#include <ovxx/python/dlpack.hpp>
+#include <ovxx/detail/endian.hpp>
 #include <ovxx/view/fns_elementwise.hpp>
 #include <vsip/vector.hpp>
 #include <vsip/matrix.hpp>
 #include <vsip/parallel.hpp>
 #include <iostream>
+#include <cstring>
 #include <ovxx/output.hpp>
 
 namespace pyvsip
@@ -263,6 +266,229 @@ bpl::object make_array(bpl::object o)
   return bpl::object(bpl::handle<>(a));
 }
 
+// Check whether a buffer's format (as defined by the struct module)
+// describes a single value of type T.
+template <typename T>
+struct buffer_format
+{
+  static bool match(char const *f)
+  {
+    char const *codes = is_signed<T>::value ? "bhilqn" : "BHILQN";
+    return f[0] && !f[1] && std::strchr(codes, f[0]);
+  }
+};
+template <>
+struct buffer_format<bool>
+{
+  static bool match(char const *f) { return f[0] == '?' && !f[1];}
+};
+template <>
+struct buffer_format<float>
+{
+  static bool match(char const *f) { return f[0] == 'f' && !f[1];}
+};
+template <>
+struct buffer_format<double>
+{
+  static bool match(char const *f) { return f[0] == 'd' && !f[1];}
+};
+template <typename T>
+struct buffer_format<complex<T> >
+{
+  static bool match(char const *f)
+  { return f[0] == 'Z' && buffer_format<T>::match(f + 1);}
+};
+
+template <typename T>
+bool is_format_compatible(Py_buffer const &b)
+{
+  if (b.itemsize != sizeof(T)) return false;
+  char const *f = b.format ? b.format : "B";
+  // Accept native byte order only.
+  if (*f == '@' || *f == '=' ||
+      (*f == '<' && !is_big_endian) ||
+      ((*f == '>' || *f == '!') && is_big_endian))
+    ++f;
+  return buffer_format<T>::match(f);
+}
+
+// Wrap external memory in a block of the appropriate dimension.
+template <typename T, typename S>
+bpl::object make_external(int ndim, S const *shape, stride_type const *strides,
+			  T *data, boost::shared_ptr<void> owner)
+{
+  switch (ndim)
+  {
+    case 1:
+      return bpl::object(boost::shared_ptr<Block<1, T> >
+        (new Block<1, T>(Domain<1>(shape[0]), strides, data, owner)));
+    case 2:
+      return bpl::object(boost::shared_ptr<Block<2, T> >
+	(new Block<2, T>(Domain<2>(shape[0], shape[1]), strides, data, owner)));
+    default:
+      PYVSIP_THROW(ValueError, "unsupported shape");
+  }
+}
+
+struct buffer_release
+{
+  void operator()(Py_buffer *b)
+  {
+    gil_acquire gil;
+    PyBuffer_Release(b);
+    delete b;
+  }
+};
+
+// Construct a block referring to the memory `o` exports through the
+// buffer protocol, without copying.  Non-contiguous buffers result in
+// strided blocks.  The buffer is released once the block (and all its
+// subblocks) are gone.
+template <typename T>
+bpl::object wrap(bpl::object o)
+{
+  Py_buffer *b = new Py_buffer;
+  if (PyObject_GetBuffer(o.ptr(), b, PyBUF_RECORDS) < 0)
+  {
+    delete b;
+    bpl::throw_error_already_set();
+  }
+  boost::shared_ptr<void> owner(b, buffer_release());
+  if (!is_format_compatible<T>(*b))
+    PYVSIP_THROW(TypeError, "buffer holds values of the wrong type");
+  if (b->ndim < 1 || b->ndim > 2)
+    PYVSIP_THROW(ValueError, "unsupported shape");
+  stride_type strides[2];
+  for (int d = 0; d != b->ndim; ++d)
+  {
+    if (b->strides[d] % b->itemsize)
+      PYVSIP_THROW(ValueError, "buffer strides are not a multiple of its item size");
+    strides[d] = b->strides[d] / b->itemsize;
+  }
+  return make_external(b->ndim, b->shape, strides, static_cast<T*>(b->buf), owner);
+}
+
+// Export a block through the buffer protocol, by way of
+// the array referring to its data.
+template <dimension_type D, typename T>
+int get_buffer(PyObject *self, Py_buffer *view, int flags)
+{
+  try
+  {
+    bpl::object array =
+      make_array<D, T>(bpl::object(bpl::handle<>(bpl::borrowed(self))));
+    return PyObject_GetBuffer(array.ptr(), view, flags);
+  }
+  catch (bpl::error_already_set const &) { return -1;}
+}
+
+struct dlpack_release
+{
+  void operator()(dlpack::ManagedTensor *t)
+  {
+    gil_acquire gil;
+    if (t->deleter) t->deleter(t);
+  }
+};
+
+// Construct a block referring to a DLPack tensor (or an object
+// providing `__dlpack__`), without copying.
+template <typename T>
+bpl::object from_dlpack(bpl::object o)
+{
+  bpl::object capsule = o;
+  if (PyObject_HasAttrString(o.ptr(), "__dlpack__"))
+    capsule = o.attr("__dlpack__")();
+  if (!PyCapsule_IsValid(capsule.ptr(), "dltensor"))
+    PYVSIP_THROW(TypeError, "argument is not a DLPack tensor");
+  dlpack::ManagedTensor *m = static_cast<dlpack::ManagedTensor*>
+    (PyCapsule_GetPointer(capsule.ptr(), "dltensor"));
+  dlpack::Tensor const &t = m->dl_tensor;
+  if (t.device.device_type != dlpack::cpu)
+    PYVSIP_THROW(ValueError, "tensor is not in host memory");
+  if (!dlpack::is_compatible<T>(t.dtype))
+    PYVSIP_THROW(TypeError, "tensor holds values of the wrong type");
+  if (t.ndim < 1 || t.ndim > 2)
+    PYVSIP_THROW(ValueError, "unsupported shape");
+  stride_type strides[2];
+  for (int d = 0; d != t.ndim; ++d)
+    strides[d] = t.strides ? t.strides[d] : d == t.ndim - 1 ? 1 : t.shape[d + 1];
+  T *data = reinterpret_cast<T*>(static_cast<char*>(t.data) + t.byte_offset);
+  // Take ownership of the tensor.
+  PyCapsule_SetName(capsule.ptr(), "used_dltensor");
+  boost::shared_ptr<void> owner(m, dlpack_release());
+  return make_external(t.ndim, t.shape, strides, data, owner);
+}
+
+// A tensor exported through DLPack, holding a reference
+// to the block it refers to.
+template <dimension_type D>
+struct dlpack_export
+{
+  static void release(dlpack::ManagedTensor *t)
+  {
+    dlpack_export *e = static_cast<dlpack_export*>(t->manager_ctx);
+    gil_acquire gil;
+    Py_DECREF(e->block);
+    delete e;
+  }
+
+  dlpack::ManagedTensor tensor;
+  int64_type shape[D];
+  int64_type strides[D];
+  PyObject *block;
+};
+
+// Release tensors no consumer has taken ownership of.
+inline void dlpack_capsule_destructor(PyObject *capsule)
+{
+  if (PyCapsule_IsValid(capsule, "dltensor"))
+  {
+    dlpack::ManagedTensor *t = static_cast<dlpack::ManagedTensor*>
+      (PyCapsule_GetPointer(capsule, "dltensor"));
+    if (t->deleter) t->deleter(t);
+  }
+}
+
+template <dimension_type D, typename T>
+bpl::object to_dlpack(bpl::object o, bpl::object /*stream*/)
+{
+  Block<D, T> &b = bpl::extract<Block<D, T> &>(o);
+  dlpack_export<D> *e = new dlpack_export<D>;
+  dlpack::Tensor &t = e->tensor.dl_tensor;
+  t.data = b.ptr();
+  t.device.device_type = dlpack::cpu;
+  t.device.device_id = 0;
+  t.ndim = D;
+  t.dtype.code = dlpack::type_info<T>::code;
+  t.dtype.bits = dlpack::type_info<T>::bits;
+  t.dtype.lanes = 1;
+  for (dimension_type d = 0; d != D; ++d)
+  {
+    e->shape[d] = b.size(D, d);
+    e->strides[d] = b.stride(D, d);
+  }
+  t.shape = e->shape;
+  t.strides = e->strides;
+  t.byte_offset = 0;
+  e->tensor.manager_ctx = e;
+  e->tensor.deleter = dlpack_export<D>::release;
+  e->block = bpl::incref(o.ptr());
+  PyObject *capsule = PyCapsule_New(&e->tensor, "dltensor",
+				    dlpack_capsule_destructor);
+  if (!capsule)
+  {
+    dlpack_export<D>::release(&e->tensor);
+    bpl::throw_error_already_set();
+  }
+  return bpl::object(bpl::handle<>(capsule));
+}
+
+inline bpl::tuple dlpack_device(bpl::object)
+{
+  return bpl::make_tuple(int(dlpack::cpu), 0);
+}
+
 // Calculate a domain corresponding to the given slice, assuming the given length.
 // To be able to generate a domain we also need the parent block's lay
 // The stride parameter is needed to account for non-unit-stride access (i.e. when
@@ -331,6 +557,7 @@ bpl::object imag(Block<D, complex<T>, M> &b)
 template <dimension_type D, typename T, typename M>
 void assign(Block<D, T, M> &b, Block<D, T, M> const &other)
 {
+  gil_release nogil;
   ovxx::assign<D>(b, other);
 }
 
@@ -338,6 +565,7 @@ template <dimension_type D, typename T, typename M>
 void assign_scalar(Block<D, T, M> &b, T val)
 {
   ovxx::expr::Scalar<D, T> scalar(val);
+  gil_release nogil;
   ovxx::assign<D>(b, scalar);
 }
 
@@ -346,7 +574,10 @@ boost::shared_ptr<Block<D, T, M> > copy(Block<D, T, M> const &b)
 {
   Domain<D> dom = block_domain<D>(b);
   boost::shared_ptr<Block<D, T, M> > other(new Block<D, T, M>(dom));
-  ovxx::assign<D>(*other, b);
+  {
+    gil_release nogil;
+    ovxx::assign<D>(*other, b);
+  }
   return other;
 }
 
@@ -415,6 +646,15 @@ void define_block(char const *type_name)
   block.setattr("dtype", get_dtype<T>());
   /// Conversion to array.
   block.def("__array__", make_array<D, T>);
+  /// Export through DLPack and the buffer protocol.
+  block.def("__dlpack__", to_dlpack<D, T>,
+	    (bpl::arg("self"), bpl::arg("stream") = bpl::object()));
+  block.def("__dlpack_device__", dlpack_device);
+  PyTypeObject *type = reinterpret_cast<PyTypeObject*>(block.ptr());
+  type->tp_as_buffer->bf_getbuffer = get_buffer<D, T>;
+#if PY_MAJOR_VERSION < 3
+  type->tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
   block.def("assign", assign<D, T, M>);
   block.def("assign", assign_scalar<D, T, M>);
 
@@ -438,6 +678,9 @@ void define_block(char const *type_name)
   bpl::def("block", traits<D, T>::construct_init);
   /// Conversion from array.
   bpl::def("block", construct<T>);
+  /// Wrap external memory.
+  bpl::def("wrap", wrap<T>);
+  bpl::def("from_dlpack", from_dlpack<T>);
   /// Construct subblock
   bpl::def("subblock", subblock1<T>);
   if (D == 2)
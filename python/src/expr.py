@@ -0,0 +1,137 @@
+#
+# Copyright (c) 2014 Stefan Seefeld
+# All rights reserved.
+#
+# This file is part of OpenVSIP. It is made available under the
+# license contained in the accompanying LICENSE.BSD file.
+
+"""Deferred element-wise expressions.
+
+Operators on vectors and matrices evaluate eagerly, so `a*b + c` makes
+two passes over memory and allocates a temporary block per operator.
+Wrapping an operand with `lazy` instead builds an expression tree that
+is only evaluated when it is assigned to a view, or forced with
+`evaluate`, in a single fused pass:
+
+  >>> r[:] = lazy(a)*b + c          # one pass, no temporaries
+  >>> v = evaluate(elementwise.sqrt(lazy(a)*a + b*b))"""
+
+import numpy
+import _block
+from vsip import import_module
+
+# Opcodes. These need to be kept in sync with math/fused.hpp.
+_opcodes = {'view':0, 'scalar':1,
+            'add':2, 'sub':3, 'mul':4, 'div':5,
+            'neg':6, 'sq':7, 'sqrt':8, 'exp':9, 'log':10, 'sin':11, 'cos':12}
+
+#: element-wise functions that may be part of a fused expression
+unary = ('neg', 'sq', 'sqrt', 'exp', 'log', 'sin', 'cos')
+binary = ('add', 'sub', 'mul', 'div')
+
+def _wrap(x):
+
+    if isinstance(x, expr): return x
+    elif hasattr(x, 'block'): return expr('view', x)
+    # numpy arrays have a dtype, too, but aren't scalars.
+    elif type(x) in (int, float, complex) or isinstance(x, numpy.generic):
+        return expr('scalar', x)
+    else:
+        raise TypeError, 'Unsupported operand %s'%type(x)
+
+class expr(object):
+    """An element-wise expression over views and scalars, evaluated on demand."""
+
+    def __init__(self, op, *args):
+
+        self.op = op
+        self.args = args
+
+    def apply(self, func, *args):
+        """Return an expression applying `func` to `self` (and `args`)."""
+
+        return expr(func, self, *[_wrap(a) for a in args])
+
+    def views(self):
+        """Return the views this expression refers to."""
+
+        if self.op == 'view': return [self.args[0]]
+        elif self.op == 'scalar': return []
+        else: return sum([a.views() for a in self.args], [])
+
+    def _compile(self, code, blocks, scalars):
+
+        if self.op == 'view':
+            b = self.args[0].block
+            # Refer to each block only once.
+            for i, o in enumerate(blocks):
+                if o is b: break
+            else:
+                i = len(blocks)
+                blocks.append(b)
+            code += [_opcodes['view'], i]
+        elif self.op == 'scalar':
+            code += [_opcodes['scalar'], len(scalars)]
+            scalars.append(self.args[0])
+        else:
+            for a in self.args:
+                a._compile(code, blocks, scalars)
+            code.append(_opcodes[self.op])
+
+    def evaluate(self, block=None):
+        """Evaluate this expression in a single pass. If `block` is given,
+        assign the result to it. Otherwise return a new view holding the result."""
+
+        views = self.views()
+        if not views:
+            raise ValueError, 'Expression does not refer to any view'
+        v = views[0]
+        for o in views[1:]:
+            if o.block.dtype != v.block.dtype:
+                raise ValueError, 'Unsupported combination of dtypes (%s, %s)'%(v.block.dtype, o.block.dtype)
+        result = block
+        if result is None:
+            result = _block.block(v.block.dtype, v.shape)
+        code, blocks, scalars = [], [], []
+        self._compile(code, blocks, scalars)
+        m = import_module('vsip.math.fused', v.block.dtype)
+        m.evaluate(code, blocks, scalars, result)
+        if block is None:
+            return v.__class__(block=result)
+
+    def __array__(self):
+        """Evaluate this expression and convert the result to a NumPy array."""
+
+        return self.evaluate().__array__()
+
+    def __neg__(self): return expr('neg', self)
+    def __add__(self, other): return expr('add', self, _wrap(other))
+    def __radd__(self, other): return expr('add', _wrap(other), self)
+    def __sub__(self, other): return expr('sub', self, _wrap(other))
+    def __rsub__(self, other): return expr('sub', _wrap(other), self)
+    def __mul__(self, other): return expr('mul', self, _wrap(other))
+    def __rmul__(self, other): return expr('mul', _wrap(other), self)
+    def __div__(self, other): return expr('div', self, _wrap(other))
+    def __rdiv__(self, other): return expr('div', _wrap(other), self)
+    __truediv__ = __div__
+    __rtruediv__ = __rdiv__
+
+def lazy(v):
+    """Return a deferred expression referring to view `v`."""
+
+    return _wrap(v)
+
+def evaluate(e):
+    """Evaluate `e` if it is an expression, and return the resulting view."""
+
+    if isinstance(e, expr):
+        return e.evaluate()
+    return e
+
+def assign(block, value):
+    """Assign `value` (a block, scalar, or expression) to `block`."""
+
+    if isinstance(value, expr):
+        value.evaluate(block)
+    else:
+        block.assign(value)
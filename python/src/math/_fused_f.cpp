@@ -0,0 +1,15 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#include "fused.hpp"
+
+BOOST_PYTHON_MODULE(_fused_f)
+{
+  using namespace pyvsip;
+  import_array();
+  define_fused<float>();
+}
@@ -26,7 +26,7 @@ inline bpl::object F(Block<D, T> const &b)		\
   Domain<D> dom = ovxx::block_domain<D>(b);		\
   B *result = new B(dom);				\
   typename view_of<B>::type r(*result);			\
-  r = vsip::F(v);					\
+  { gil_release nogil; r = vsip::F(v);}			\
   return bpl::object(boost::shared_ptr<B>(result));	\
 }
 
@@ -39,7 +39,7 @@ inline bpl::object F(Block<D, T> const &b)			\
   Domain<D> dom = ovxx::block_domain<D>(b);			\
   Block<D, R> *result = new Block<D, R>(dom);			\
   typename view_of<Block<D, R> >::type r(*result);		\
-  r = ovxx::F(v);						\
+  { gil_release nogil; r = ovxx::F(v);}				\
   return bpl::object(boost::shared_ptr<Block<D, R> >(result));	\
 }
 
@@ -53,7 +53,7 @@ inline bpl::object F(Block<D, T> const &b1, Block<D, T> const &b2)	\
   Domain<D> dom = ovxx::block_domain<D>(b1);				\
   B *result = new B(dom);						\
   typename view_of<B>::type r(*result);					\
-  r = ovxx::F(v1, v2);							\
+  { gil_release nogil; r = ovxx::F(v1, v2);}				\
   return bpl::object(boost::shared_ptr<B>(result));			\
 }
 
@@ -67,7 +67,7 @@ inline bpl::object F(Block<D, T> const &b1, Block<D, T> const &b2)	\
   Domain<D> dom = ovxx::block_domain<D>(b1);				\
   Block<D, R> *result = new Block<D, R>(dom);				\
   typename view_of<Block<D, R> >::type r(*result);			\
-  r = ovxx::F(v1, v2);							\
+  { gil_release nogil; r = ovxx::F(v1, v2);}				\
   return bpl::object(boost::shared_ptr<Block<D, R> >(result));		\
 }
 
@@ -82,7 +82,7 @@ inline bpl::object F(Block<D, T> const &b1, Block<D, T> const &b2, Block<D, T> c
   Domain<D> dom = ovxx::block_domain<D>(b1);				                  \
   B *result = new B(dom);						                  \
   typename view_of<B>::type r(*result);					                  \
-  r = ovxx::F(v1, v2, v3);							          \
+  { gil_release nogil; r = ovxx::F(v1, v2, v3);} \
   return bpl::object(boost::shared_ptr<B>(result));			                  \
 }
 
@@ -8,9 +8,14 @@
 from vsip import import_module
 import numpy
 from vsip import vector, matrix
+from vsip import expr
 
 def unary(func, a):
 
+    if isinstance(a, expr.expr):
+        if func in expr.unary:
+            return a.apply(func)
+        a = a.evaluate()
     b = a.block
     m = import_module('vsip.math.elementwise', b.dtype)
     f = getattr(m, func)
@@ -19,6 +24,10 @@ def unary(func, a):
 
 def binary(func, a1, a2):
 
+    if isinstance(a1, expr.expr) or isinstance(a2, expr.expr):
+        if func in expr.binary:
+            return expr.lazy(a1).apply(func, a2)
+        a1, a2 = expr.evaluate(a1), expr.evaluate(a2)
     b1 = a1.block
     b2 = a2.block
     if b1.dtype == b2.dtype:
@@ -31,6 +40,7 @@ def binary(func, a1, a2):
 
 def ternary(func, a1, a2, a3):
 
+    a1, a2, a3 = expr.evaluate(a1), expr.evaluate(a2), expr.evaluate(a3)
     b1 = a1.block
     b2 = a2.block
     b3 = a3.block
@@ -64,3 +74,5 @@ def magsq(a): return unary('magsq', a)
 def mul(a1, a2): return binary('mul', a1, a2)
 def neg(a): return unary('neg', a)
 def sin(a): return unary('sin', a)
+def sq(a): return unary('sq', a)
+def sqrt(a): return unary('sqrt', a)
@@ -0,0 +1,278 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef fused_hpp_
+#define fused_hpp_
+
+#include <ovxx/python/block.hpp>
+#include <ovxx/dda.hpp>
+#include <ovxx/aligned_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+#include <cmath>
+#include <complex>
+
+namespace pyvsip
+{
+using namespace ovxx;
+using namespace ovxx::python;
+
+// Evaluate element-wise expressions built by vsip.expr in a single pass.
+//
+// An expression arrives as a program in postfix form.  Rather than
+// evaluating each operation over the full extent of its operands
+// (requiring a temporary per operation), the program is run over
+// strips short enough for all intermediate results to stay in cache.
+namespace fused
+{
+
+// Opcodes. These need to be kept in sync with vsip/expr.py.
+enum opcode
+{
+  op_view = 0, // push operand <index>
+  op_scalar,   // push scalar <index>
+  op_add,
+  op_sub,
+  op_mul,
+  op_div,
+  op_neg,
+  op_sq,
+  op_sqrt,
+  op_exp,
+  op_log,
+  op_sin,
+  op_cos
+};
+
+length_type const strip = 256;
+length_type const max_depth = 32;
+
+#define PYVSIP_FUSED_OP(NAME, EXPR)				\
+struct NAME##_op						\
+{								\
+  template <typename T>						\
+  static T apply(T a) { using namespace std; return EXPR;}	\
+};
+
+PYVSIP_FUSED_OP(neg, -a)
+PYVSIP_FUSED_OP(sq, a * a)
+PYVSIP_FUSED_OP(sqrt, sqrt(a))
+PYVSIP_FUSED_OP(exp, exp(a))
+PYVSIP_FUSED_OP(log, log(a))
+PYVSIP_FUSED_OP(sin, sin(a))
+PYVSIP_FUSED_OP(cos, cos(a))
+
+#undef PYVSIP_FUSED_OP
+
+#define PYVSIP_FUSED_OP(NAME, OP)				\
+struct NAME##_op						\
+{								\
+  template <typename T>						\
+  static T apply(T a, T b) { return a OP b;}			\
+};
+
+PYVSIP_FUSED_OP(add, +)
+PYVSIP_FUSED_OP(sub, -)
+PYVSIP_FUSED_OP(mul, *)
+PYVSIP_FUSED_OP(div, /)
+
+#undef PYVSIP_FUSED_OP
+
+/// A stack entry: either `size` values, or a single (scalar) value.
+template <typename T>
+struct operand
+{
+  T const *ptr;
+  bool scalar;
+};
+
+template <typename O, typename T>
+void apply(operand<T> &a, T *r, length_type size)
+{
+  if (a.scalar)
+    size = 1;
+  for (index_type i = 0; i != size; ++i)
+    r[i] = O::apply(a.ptr[i]);
+  a.ptr = r;
+}
+
+template <typename O, typename T>
+void apply(operand<T> &a, operand<T> const &b, T *r, length_type size)
+{
+  if (a.scalar && b.scalar)
+    r[0] = O::apply(a.ptr[0], b.ptr[0]);
+  else if (a.scalar)
+  {
+    T s = a.ptr[0];
+    for (index_type i = 0; i != size; ++i)
+      r[i] = O::apply(s, b.ptr[i]);
+  }
+  else if (b.scalar)
+  {
+    T s = b.ptr[0];
+    for (index_type i = 0; i != size; ++i)
+      r[i] = O::apply(a.ptr[i], s);
+  }
+  else
+    for (index_type i = 0; i != size; ++i)
+      r[i] = O::apply(a.ptr[i], b.ptr[i]);
+  a.ptr = r;
+  a.scalar = a.scalar && b.scalar;
+}
+
+/// Check that `code` is a well-formed program referring to
+/// `views` operands and `scalars` scalars, and return the
+/// stack depth it requires.
+inline length_type
+validate(std::vector<int> const &code, length_type views, length_type scalars)
+{
+  length_type depth = 0, max = 0;
+  for (index_type pc = 0; pc != code.size(); ++pc)
+  {
+    switch (code[pc])
+    {
+      case op_view:
+      case op_scalar:
+	if (++pc == code.size() || code[pc] < 0 ||
+	    code[pc] >= static_cast<int>(code[pc - 1] == op_view ? views : scalars))
+	  PYVSIP_THROW(ValueError, "invalid operand");
+	if (++depth > max) max = depth;
+	break;
+      case op_add: case op_sub: case op_mul: case op_div:
+	if (depth-- < 2)
+	  PYVSIP_THROW(ValueError, "stack underflow");
+	break;
+      case op_neg: case op_sq: case op_sqrt:
+      case op_exp: case op_log: case op_sin: case op_cos:
+	if (depth < 1)
+	  PYVSIP_THROW(ValueError, "stack underflow");
+	break;
+      default:
+	PYVSIP_THROW(ValueError, "invalid opcode");
+    }
+  }
+  if (depth != 1)
+    PYVSIP_THROW(ValueError, "invalid program");
+  if (max > max_depth)
+    PYVSIP_THROW(ValueError, "expression too deep");
+  return max;
+}
+
+/// Run `code` over `size` elements, writing the result to `out`.
+template <typename T>
+void run(std::vector<int> const &code,
+	 std::vector<T const *> const &views, std::vector<T> const &scalars,
+	 length_type depth, T *out, length_type size)
+{
+  // One strip of storage per stack slot.
+  aligned_array<T> buffer(depth * strip);
+  operand<T> stack[max_depth];
+  for (index_type offset = 0; offset < size; offset += strip)
+  {
+    length_type const n = std::min(strip, size - offset);
+    index_type sp = 0;
+    for (index_type pc = 0; pc != code.size(); ++pc)
+    {
+      int op = code[pc];
+      if (op == op_view || op == op_scalar)
+      {
+	stack[sp].ptr = op == op_view ?
+	  views[code[++pc]] + offset : &scalars[code[++pc]];
+	stack[sp++].scalar = op == op_scalar;
+	continue;
+      }
+      if (op <= op_div) --sp;
+      T *r = buffer.get() + (sp - 1) * strip;
+      switch (op)
+      {
+	case op_add: apply<add_op>(stack[sp - 1], stack[sp], r, n); break;
+	case op_sub: apply<sub_op>(stack[sp - 1], stack[sp], r, n); break;
+	case op_mul: apply<mul_op>(stack[sp - 1], stack[sp], r, n); break;
+	case op_div: apply<div_op>(stack[sp - 1], stack[sp], r, n); break;
+	case op_neg: apply<neg_op>(stack[sp - 1], r, n); break;
+	case op_sq: apply<sq_op>(stack[sp - 1], r, n); break;
+	case op_sqrt: apply<sqrt_op>(stack[sp - 1], r, n); break;
+	case op_exp: apply<exp_op>(stack[sp - 1], r, n); break;
+	case op_log: apply<log_op>(stack[sp - 1], r, n); break;
+	case op_sin: apply<sin_op>(stack[sp - 1], r, n); break;
+	case op_cos: apply<cos_op>(stack[sp - 1], r, n); break;
+      }
+    }
+    if (stack[0].scalar)
+      std::fill(out + offset, out + offset + n, stack[0].ptr[0]);
+    else
+      std::copy(stack[0].ptr, stack[0].ptr + n, out + offset);
+  }
+}
+
+} // namespace pyvsip::fused
+
+/// Evaluate `program` (a list of opcodes and operand indices) for the
+/// blocks in `operands` and the values in `scalars`, and assign the
+/// result to `result`.
+template <dimension_type D, typename T>
+void evaluate(bpl::list program, bpl::list operands, bpl::list scalars,
+	      Block<D, T> &result)
+{
+  typedef Block<D, T> B;
+  typedef Layout<D, tuple<0,1,2>, dense, array> layout_type;
+  typedef vsip::dda::Data<B, vsip::dda::in, layout_type> in_type;
+  typedef vsip::dda::Data<B, vsip::dda::out, layout_type> out_type;
+
+  std::vector<int> code(bpl::len(program));
+  for (index_type i = 0; i != code.size(); ++i)
+    code[i] = bpl::extract<int>(program[i]);
+  std::vector<T> values(bpl::len(scalars));
+  for (index_type i = 0; i != values.size(); ++i)
+    values[i] = bpl::extract<T>(scalars[i]);
+  std::vector<B*> blocks(bpl::len(operands));
+  for (index_type i = 0; i != blocks.size(); ++i)
+  {
+    blocks[i] = &bpl::extract<B&>(operands[i])();
+    for (dimension_type d = 0; d != D; ++d)
+      if (blocks[i]->size(D, d) != result.size(D, d))
+	PYVSIP_THROW(ValueError, "shape mismatch");
+  }
+  length_type depth = fused::validate(code, blocks.size(), values.size());
+
+  gil_release nogil;
+  std::vector<boost::shared_ptr<in_type> > in(blocks.size());
+  std::vector<T const *> views(blocks.size());
+  for (index_type i = 0; i != blocks.size(); ++i)
+  {
+    in[i].reset(new in_type(*blocks[i]));
+    views[i] = in[i]->ptr();
+  }
+  out_type out(result);
+  length_type size = result.size();
+  // As the program is run strip by strip, an operand may only share
+  // storage with the result if it is the result.
+  bool overlap = false;
+  for (index_type i = 0; i != views.size(); ++i)
+    if (views[i] != out.ptr() &&
+	views[i] < out.ptr() + size && out.ptr() < views[i] + size)
+      overlap = true;
+  if (overlap)
+  {
+    aligned_array<T> tmp(size);
+    fused::run(code, views, values, depth, tmp.get(), size);
+    std::copy(tmp.get(), tmp.get() + size, out.ptr());
+  }
+  else
+    fused::run(code, views, values, depth, out.ptr(), size);
+}
+
+template <typename T>
+void define_fused()
+{
+  bpl::def("evaluate", evaluate<1, T>);
+  bpl::def("evaluate", evaluate<2, T>);
+}
+
+} // namespace pyvsip
+
+#endif
@@ -25,6 +25,7 @@ inline T F(Block<D, T> const &b)			\
   typedef Block<D, T> B;				\
   typename view_of<B>::const_type v(const_cast<B&>(b)); \
   Domain<D> dom = ovxx::block_domain<D>(b);		\
+  gil_release nogil;					\
   return vsip::F(v);					\
 }
 
@@ -36,7 +37,11 @@ inline bpl::object F(Block<D, T> const &b)		\
   typename view_of<B>::const_type v(const_cast<B&>(b)); \
   vsip::Index<D> i;					\
   Domain<D> dom = ovxx::block_domain<D>(b);		\
-  T r = vsip::F(v, i);					\
+  T r;							\
+  {							\
+    gil_release nogil;					\
+    r = vsip::F(v, i);					\
+  }							\
   return bpl::make_tuple(r, i);				\
 }
 
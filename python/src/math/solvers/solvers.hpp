@@ -24,6 +24,7 @@ void covsol(ovxx::python::Block<2, T> &a,
 {
   typedef ovxx::python::Block<2, T> B;
   typedef vsip::Matrix<T, B> M;
+  ovxx::python::gil_release nogil;
   vsip::covsol(M(a), M(const_cast<B&>(b)), M(x));
 }
 
@@ -34,6 +35,7 @@ void llsqsol(ovxx::python::Block<2, T> &a,
 {
   typedef ovxx::python::Block<2, T> B;
   typedef vsip::Matrix<T, B> M;
+  ovxx::python::gil_release nogil;
   vsip::llsqsol(M(a), M(const_cast<B&>(b)), M(x));
 }
 
@@ -45,6 +47,7 @@ void toepsol(ovxx::python::Block<1, T> const &t,
 {
   typedef ovxx::python::Block<1, T> B;
   typedef vsip::Vector<T, B> V;
+  ovxx::python::gil_release nogil;
   vsip::toepsol(V(const_cast<B&>(t)), V(const_cast<B&>(b)), V(y), V(x));
 }
 
@@ -56,9 +59,10 @@ class lud
 public:
   lud(vsip::length_type l) : impl_(l) {}
   vsip::length_type length() const { return impl_.length();}
-  bool decompose(B &b) { return impl_.decompose(M(b));}
+  bool decompose(B &b) { ovxx::python::gil_release nogil; return impl_.decompose(M(b));}
   bool solve(vsip::mat_op_type op, B const &b, B &x)
   {
+    ovxx::python::gil_release nogil;
     using namespace vsip;
     switch (op)
     {
@@ -91,8 +95,8 @@ public:
   chold(vsip::mat_uplo uplo, vsip::length_type l) : impl_(uplo, l) {}
   vsip::length_type length() const { return impl_.length();}
   vsip::mat_uplo uplo() const { return impl_.uplo();}
-  bool decompose(B &b) { return impl_.decompose(M(b));}
-  bool solve(B const &b, B &x) { return impl_.solve(M(const_cast<B&>(b)), M(x));}
+  bool decompose(B &b) { ovxx::python::gil_release nogil; return impl_.decompose(M(b));}
+  bool solve(B const &b, B &x) { ovxx::python::gil_release nogil; return impl_.solve(M(const_cast<B&>(b)), M(x));}
 private:
   vsip::chold<T, vsip::by_reference> impl_;
 };
@@ -117,9 +121,10 @@ public:
   vsip::length_type rows() const { return impl_.rows();}
   vsip::length_type columns() const { return impl_.columns();}
   vsip::storage_type qstorage() const { return impl_.qstorage();}
-  bool decompose(B &b) { return impl_.decompose(M(b));}
+  bool decompose(B &b) { ovxx::python::gil_release nogil; return impl_.decompose(M(b));}
   bool prodq(vsip::mat_op_type op, vsip::product_side_type side, B const &b, B &x)
   {
+    ovxx::python::gil_release nogil;
     using namespace vsip;
     switch (op)
     {
@@ -131,6 +136,7 @@ public:
   }
   bool rsol(vsip::mat_op_type op, B const &b, T alpha, B &x)
   {
+    ovxx::python::gil_release nogil;
     using namespace vsip;
     switch (op)
     {
@@ -140,8 +146,8 @@ public:
       case mat_conj: return impl_.template rsol<mat_conj>(M(const_cast<B&>(b)), alpha, M(x));
     }
   }
-  bool covsol(B const &b, B &x) { return impl_.covsol(M(const_cast<B&>(b)), M(x));}
-  bool lsqsol(B const &b, B &x) { return impl_.lsqsol(M(const_cast<B&>(b)), M(x));}
+  bool covsol(B const &b, B &x) { ovxx::python::gil_release nogil; return impl_.covsol(M(const_cast<B&>(b)), M(x));}
+  bool lsqsol(B const &b, B &x) { ovxx::python::gil_release nogil; return impl_.lsqsol(M(const_cast<B&>(b)), M(x));}
 private:
   template <vsip::mat_op_type tr>
   bool prodq_(vsip::product_side_type side, B const &b, B &x)
@@ -187,17 +193,19 @@ public:
   vsip::length_type columns() const { return impl_.columns();}
   vsip::storage_type ustorage() const { return impl_.ustorage();}
   vsip::storage_type vstorage() const { return impl_.vstorage();}
-  bool decompose(B2 &b, B1 &dest) { return impl_.decompose(M(b), V(dest));}
+  bool decompose(B2 &b, B1 &dest) { ovxx::python::gil_release nogil; return impl_.decompose(M(b), V(dest));}
   bool produ(vsip::mat_op_type op, vsip::product_side_type side, B2 const &b, B2 &x)
   {
+    ovxx::python::gil_release nogil;
     return svd_call_traits<T>::produ(*this, op, side, b, x);
   }
   bool prodv(vsip::mat_op_type op, vsip::product_side_type side, B2 const &b, B2 &x)
   {
+    ovxx::python::gil_release nogil;
     return svd_call_traits<T>::prodv(*this, op, side, b, x);
   }
-  bool u(vsip::index_type low, vsip::index_type high, B2 &dest) { return impl_.u(low, high, M(dest));}
-  bool v(vsip::index_type low, vsip::index_type high, B2 &dest) { return impl_.v(low, high, M(dest));}
+  bool u(vsip::index_type low, vsip::index_type high, B2 &dest) { ovxx::python::gil_release nogil; return impl_.u(low, high, M(dest));}
+  bool v(vsip::index_type low, vsip::index_type high, B2 &dest) { ovxx::python::gil_release nogil; return impl_.v(low, high, M(dest));}
 
   template <vsip::mat_op_type tr>
   bool produ_(vsip::product_side_type side, B2 const &b, B2 &x)
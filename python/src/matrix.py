@@ -7,6 +7,7 @@
 
 import _block
 from vsip import import_module
+import expr
 from vector import vector
 
 class matrix:
@@ -27,7 +28,15 @@ class matrix:
 
            `matrix(block=B)`
               will construct a matrix from an existing block `B`. data type and length
-              will be inferred from `B`."""
+              will be inferred from `B`.
+
+           `matrix(buffer=B)`
+              will construct a matrix referring to the memory exported by `B` through
+              the buffer protocol, without copying. `B` may be non-contiguous.
+
+           `matrix(dlpack=T)`
+              will construct a matrix referring to the DLPack tensor `T` (or an object
+              providing `__dlpack__`), without copying."""
 
         self.block = None #: the block object
         self.dtype = None #: the data type
@@ -44,12 +53,23 @@ class matrix:
             self.block = kwargs['block']
         elif 'array' in kwargs:
             self.block = _block.block(array=kwargs['array'])
+        elif 'buffer' in kwargs:
+            self.block = _block.block(buffer=kwargs['buffer'])
+        elif 'dlpack' in kwargs:
+            self.block = _block.block(dlpack=kwargs['dlpack'])
         else:
             raise ValueError, 'Invalid arguments'
         self.dtype = self.block.dtype
 
     def __array__(self): return self.block.__array__()
 
+    def __dlpack__(self, stream=None):
+        """Export this matrix as a DLPack tensor, without copying."""
+
+        return self.block.__dlpack__(stream)
+
+    def __dlpack_device__(self): return self.block.__dlpack_device__()
+
     def rows(self):
         """Return the number of rows of the matrix."""
 
@@ -138,6 +158,9 @@ class matrix:
              [6.0, 8.0]])
         """
 
+        if isinstance(other, expr.expr):
+            expr.assign(self.block, expr.lazy(self) + other)
+            return self
         if not isinstance(other, matrix):
             self.block += other
         else:
@@ -156,6 +179,9 @@ class matrix:
              [0.0, 0.0]])
         """
 
+        if isinstance(other, expr.expr):
+            expr.assign(self.block, expr.lazy(self) - other)
+            return self
         if not isinstance(other, matrix):
             self.block -= other
         else:
@@ -174,6 +200,9 @@ class matrix:
              [9.0, 16.0]])
         """
 
+        if isinstance(other, expr.expr):
+            expr.assign(self.block, expr.lazy(self) * other)
+            return self
         if isinstance(other, matrix):
             self.block *= other.block
         else:
@@ -192,6 +221,9 @@ class matrix:
              [1.0, 1.0]])
         """
 
+        if isinstance(other, expr.expr):
+            expr.assign(self.block, expr.lazy(self) / other)
+            return self
         if isinstance(other, matrix):
             self.block /= other.block
         else:
@@ -222,6 +254,8 @@ class matrix:
              [6.0, 8.0]])
         """
 
+        if isinstance(other, expr.expr):
+            return expr.lazy(self) + other
         m = matrix(block=self.block.copy())
         m+= other
         return m
@@ -237,6 +271,8 @@ class matrix:
              [0.0, 0.0]])
         """
 
+        if isinstance(other, expr.expr):
+            return expr.lazy(self) - other
         m = matrix(block=self.block.copy())
         m-= other
         return m
@@ -252,6 +288,8 @@ class matrix:
              [9.0, 16.0]])
         """
 
+        if isinstance(other, expr.expr):
+            return expr.lazy(self) * other
         m = matrix(block=self.block.copy())
         m*= other
         return m
@@ -277,6 +315,8 @@ class matrix:
              [1.0, 1.0]])
         """
 
+        if isinstance(other, expr.expr):
+            return expr.lazy(self) / other
         m = matrix(block=self.block.copy())
         m/= other
         return m
@@ -346,20 +386,20 @@ class matrix:
         if type(i) != tuple:
             # must be a row accessor
             if isinstance(i, slice):
-                _block.subblock(self.block, (i,slice(0,None))).assign(value)
+                expr.assign(_block.subblock(self.block, (i,slice(0,None))), value)
             else:
-                self.block.row(i).assign(value)
+                expr.assign(self.block.row(i), value)
             return
         assert len(i) == 2
         if isinstance(i[0], slice) and isinstance(i[1], slice):
             if i[0] == slice(None) and i[1] == slice(None):
-                self.block.assign(value)
+                expr.assign(self.block, value)
             else:
-                _block.subblock(self.block, i).assign(value)
+                expr.assign(_block.subblock(self.block, i), value)
         elif isinstance(i[0], slice):
-            _block.subblock(self.block.col(i[1]), (i[0],)).assign(value)
+            expr.assign(_block.subblock(self.block.col(i[1]), (i[0],)), value)
         elif isinstance(i[1], slice):
-            _block.subblock(self.block.row(i[0]), (i[1],)).assign(value)
+            expr.assign(_block.subblock(self.block.row(i[0]), (i[1],)), value)
         else:
             self.block.put(i[0], i[1], value)
 
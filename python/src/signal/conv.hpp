@@ -50,7 +50,7 @@ public:
   virtual vsip::support_region_type support() const { return conv_.support();}
   virtual vsip::length_type output_size() const { return conv_.output_size().size();}
   virtual vsip::length_type decimation() const { return conv_.decimation();}
-  virtual void op(B const &i, B &o) { conv_(V(const_cast<B&>(i)), V(o));}
+  virtual void op(B const &i, B &o) { ovxx::python::gil_release nogil; conv_(V(const_cast<B&>(i)), V(o));}
 
 private:
   vsip::Convolution<vsip::const_Vector, S, R, T> conv_;
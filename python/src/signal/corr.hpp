@@ -45,7 +45,10 @@ public:
   virtual vsip::support_region_type support() const { return corr_.support();}
   virtual vsip::length_type output_size() const { return corr_.output_size().size();}
   virtual void op(vsip::bias_type b, B const &r, B const &i, B &o)
-  { corr_(b, V(const_cast<B&>(r)), V(const_cast<B&>(i)), V(o));}
+  {
+    ovxx::python::gil_release nogil;
+    corr_(b, V(const_cast<B&>(r)), V(const_cast<B&>(i)), V(o));
+  }
 
 private:
   vsip::Correlation<vsip::const_Vector, R, T> corr_;
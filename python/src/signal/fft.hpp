@@ -85,8 +85,8 @@ public:
   virtual vsip::length_type output_size() const { return fft_.output_size().size();}
   virtual T scale() const { return fft_.scale();}
   virtual bool forward() const { return fft_.forward();}
-  virtual void op(block_type const &i, block_type &o) { fft_(V(const_cast<block_type&>(i)), V(o));}
-  virtual void ip(block_type &io) { fft_(V(io));}
+  virtual void op(block_type const &i, block_type &o) { ovxx::python::gil_release nogil; fft_(V(const_cast<block_type&>(i)), V(o));}
+  virtual void ip(block_type &io) { ovxx::python::gil_release nogil; fft_(V(io));}
 private:
   vsip::Fft<vsip::Vector, vsip::complex<T>, vsip::complex<T>,
             D, vsip::by_reference, N, H> fft_;
@@ -108,7 +108,7 @@ public:
   virtual vsip::length_type output_size() const { return fft_.output_size().size();}
   virtual T scale() const { return fft_.scale();}
   virtual bool forward() const { return fft_.forward();}
-  virtual void op(input_block_type const &i, output_block_type &o) { fft_(IV(const_cast<input_block_type&>(i)), OV(o));}
+  virtual void op(input_block_type const &i, output_block_type &o) { ovxx::python::gil_release nogil; fft_(IV(const_cast<input_block_type&>(i)), OV(o));}
 private:
   vsip::Fft<vsip::Vector, T, vsip::complex<T>, 0, vsip::by_reference, N, H> fft_;
 };
@@ -129,7 +129,7 @@ public:
   virtual vsip::length_type output_size() const { return fft_.output_size().size();}
   virtual T scale() const { return fft_.scale();}
   virtual bool forward() const { return fft_.forward();}
-  virtual void op(input_block_type const &i, output_block_type &o) {fft_(IV(const_cast<input_block_type&>(i)), OV(o));}
+  virtual void op(input_block_type const &i, output_block_type &o) { ovxx::python::gil_release nogil; fft_(IV(const_cast<input_block_type&>(i)), OV(o));}
 private:
   vsip::Fft<vsip::Vector, vsip::complex<T>, T, 0, vsip::by_reference, N, H> fft_;
 };
@@ -92,8 +92,8 @@ public:
   virtual T scale() const { return fftm_.scale();}
   virtual bool forward() const { return fftm_.forward();}
   virtual int axis() const { return A;}
-  virtual void op(B const &i, B &o) { fftm_(V(const_cast<B &>(i)), V(o));}
-      virtual void ip(B &io) { fftm_(V(io));}
+  virtual void op(B const &i, B &o) { ovxx::python::gil_release nogil; fftm_(V(const_cast<B &>(i)), V(o));}
+      virtual void ip(B &io) { ovxx::python::gil_release nogil; fftm_(V(io));}
 private:
   vsip::Fftm<vsip::complex<T>, vsip::complex<T>,
 	     A, D, vsip::by_reference, N, H> fftm_;
@@ -117,7 +117,7 @@ public:
   virtual T scale() const { return fftm_.scale();}
   virtual bool forward() const { return fftm_.forward();}
   virtual int axis() const { return A;}
-  virtual void op(IB const &i, OB &o) { fftm_(IV(const_cast<IB&>(i)), OV(o));}
+  virtual void op(IB const &i, OB &o) { ovxx::python::gil_release nogil; fftm_(IV(const_cast<IB&>(i)), OV(o));}
 private:
   vsip::Fftm<T, vsip::complex<T>, A, vsip::fft_fwd, vsip::by_reference, N, H> fftm_;
 };
@@ -140,7 +140,7 @@ public:
   virtual T scale() const { return fftm_.scale();}
   virtual int axis() const { return A;}
   virtual bool forward() const { return fftm_.forward();}
-  virtual void op(IB const &i, OB &o) {fftm_(IV(const_cast<IB&>(i)), OV(o));}
+  virtual void op(IB const &i, OB &o) { ovxx::python::gil_release nogil; fftm_(IV(const_cast<IB&>(i)), OV(o));}
 private:
   vsip::Fftm<vsip::complex<T>, T, A, vsip::fft_inv, vsip::by_reference, N, H> fftm_;
 };
@@ -51,7 +51,7 @@ public:
   virtual vsip::length_type decimation() const { return fir_.decimation();}
   virtual vsip::obj_state state() const { return C;}
   virtual void reset() { fir_.reset();}
-  virtual void op(B const &i, B &o) { fir_(V(const_cast<B&>(i)), V(o));}
+  virtual void op(B const &i, B &o) { ovxx::python::gil_release nogil; fir_(V(const_cast<B&>(i)), V(o));}
 
 private:
   vsip::Fir<T, S, C> fir_;
@@ -46,7 +46,7 @@ public:
   virtual vsip::length_type input_size() const { return iir_.input_size();}
   virtual vsip::obj_state state() const { return S;}
   virtual void reset() { iir_.reset();}
-  virtual void op(B const &i, B &o) { iir_(V(const_cast<B&>(i)), V(o));}
+  virtual void op(B const &i, B &o) { ovxx::python::gil_release nogil; iir_(V(const_cast<B&>(i)), V(o));}
 
 private:
   vsip::Iir<T, S> iir_;
@@ -6,6 +6,7 @@
 // license contained in the accompanying LICENSE.BSD file.
 
 #include <ovxx/python/block.hpp>
+#include <ovxx/python/dlpack.hpp>
 #include <boost/python.hpp>
 #include <vsip/initfin.hpp>
 #include <vsip/support.hpp>
@@ -23,6 +24,19 @@ void convert(std::runtime_error const &e)
   PyErr_SetString(PyExc_RuntimeError, e.what());
 }
 
+// Report the value type of a DLPack tensor as (code, bits),
+// so the matching block module can be selected.
+bpl::tuple dlpack_type(bpl::object capsule)
+{
+  using ovxx::python::dlpack::ManagedTensor;
+  if (!PyCapsule_IsValid(capsule.ptr(), "dltensor"))
+    PYVSIP_THROW(TypeError, "argument is not a DLPack tensor");
+  ManagedTensor *t = static_cast<ManagedTensor*>
+    (PyCapsule_GetPointer(capsule.ptr(), "dltensor"));
+  return bpl::make_tuple(int(t->dl_tensor.dtype.code),
+			 int(t->dl_tensor.dtype.bits));
+}
+
 }
 
 BOOST_PYTHON_MODULE(support)
@@ -35,4 +49,6 @@ BOOST_PYTHON_MODULE(support)
   dom.add_property("length", &Domain<1>::length);
 
   bpl::implicitly_convertible<int, Domain<1> >();
+
+  bpl::def("dlpack_type", dlpack_type);
 }
@@ -7,6 +7,7 @@
 
 import _block
 from vsip import import_module
+import expr
 
 class vector:
     """A vector contains a one-dimensional data-set of a specific type."""
@@ -26,7 +27,15 @@ class vector:
 
            `vector(block=B)`
               will construct a vector from an existing block ``B``. data type and length
-              will be inferred from ``B``."""
+              will be inferred from ``B``.
+
+           `vector(buffer=B)`
+              will construct a vector referring to the memory exported by ``B`` through
+              the buffer protocol, without copying. ``B`` may be non-contiguous.
+
+           `vector(dlpack=T)`
+              will construct a vector referring to the DLPack tensor ``T`` (or an object
+              providing ``__dlpack__``), without copying."""
 
         self.block = None #: the block object
         self.dtype = None #: the vector's data type
@@ -43,6 +52,10 @@ class vector:
             self.block = kwargs['block']
         elif 'array' in kwargs:
             self.block = _block.block(array=kwargs['array'])
+        elif 'buffer' in kwargs:
+            self.block = _block.block(buffer=kwargs['buffer'])
+        elif 'dlpack' in kwargs:
+            self.block = _block.block(dlpack=kwargs['dlpack'])
         else:
             raise ValueError, 'Invalid arguments'
         self.dtype = self.block.dtype
@@ -52,6 +65,15 @@ class vector:
 
         return self.block.__array__()
 
+    def __dlpack__(self, stream=None):
+        """Export this vector as a DLPack tensor, without copying."""
+
+        return self.block.__dlpack__(stream)
+
+    def __dlpack_device__(self):
+
+        return self.block.__dlpack_device__()
+
     def length(self):
         """Return the length of the vector."""
 
@@ -109,6 +131,9 @@ class vector:
           vector(dtype=float64, shape=(4) data=[2.0, 2.0, 6.0, 8.0])
         """
 
+        if isinstance(other, expr.expr):
+            expr.assign(self.block, expr.lazy(self) + other)
+            return self
         if isinstance(other, vector):
             self.block += other.block
         else:
@@ -125,6 +150,9 @@ class vector:
           vector(dtype=float64, shape=(4) data=[0.0, 2.0, 0.0, 0.0])
         """
 
+        if isinstance(other, expr.expr):
+            expr.assign(self.block, expr.lazy(self) - other)
+            return self
         if isinstance(other, vector):
             self.block -= other.block
         else:
@@ -141,6 +169,9 @@ class vector:
           vector(dtype=float64, shape=(4) data=[1.0, 0.0, 9.0, 16.0])
         """
 
+        if isinstance(other, expr.expr):
+            expr.assign(self.block, expr.lazy(self) * other)
+            return self
         if isinstance(other, vector):
             self.block *= other.block
         else:
@@ -157,6 +188,9 @@ class vector:
           vector(dtype=float64, shape=(4) data=[1.0, nan, 1.0, 1.0])
         """
 
+        if isinstance(other, expr.expr):
+            expr.assign(self.block, expr.lazy(self) / other)
+            return self
         if isinstance(other, vector):
             self.block /= other.block
         else:
@@ -183,6 +217,8 @@ class vector:
           vector(dtype=float64, shape=(4) data=[2.0, 2.0, 6.0, 8.0])
         """
 
+        if isinstance(other, expr.expr):
+            return expr.lazy(self) + other
         v = vector(block=self.block.copy())
         v+= other
         return v
@@ -196,6 +232,8 @@ class vector:
           vector(dtype=float64, shape=(4) data=[0.0, 2.0, 0.0, 0.0])
         """
 
+        if isinstance(other, expr.expr):
+            return expr.lazy(self) - other
         v = vector(block=self.block.copy())
         v-= other
         return v
@@ -209,6 +247,8 @@ class vector:
           vector(dtype=float64, shape=(4) data=[1.0, 0.0, 9.0, 16.0])
         """
 
+        if isinstance(other, expr.expr):
+            return expr.lazy(self) * other
         v = vector(block=self.block.copy())
         v*= other
         return v
@@ -232,6 +272,8 @@ class vector:
           vector(dtype=float64, shape=(4) data=[1.0, nan, 1.0, 1.0])
         """
 
+        if isinstance(other, expr.expr):
+            return expr.lazy(self) / other
         v = vector(block=self.block.copy())
         v/= other
         return v
@@ -267,9 +309,9 @@ class vector:
             value = value.block
         if isinstance(i, slice):
             if i == slice(None):
-                self.block.assign(value)
+                expr.assign(self.block, value)
             else:
-                _block.subblock(self.block, (i,)).assign(value)
+                expr.assign(_block.subblock(self.block, (i,)), value)
         else:
             self.block.put(i, value)
 
@@ -0,0 +1,64 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+// Record frames from a processing loop without blocking on I/O,
+// using a background writer thread, both into a raw file and an HDF5
+// dataset.
+
+#include <vsip/initfin.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/math.hpp>
+#include <vsip/selgen.hpp>
+#include <ovxx/io/async_writer.hpp>
+#include <ovxx/io/raw.hpp>
+#include <ovxx/io/hdf5.hpp>
+#include <iostream>
+
+using namespace ovxx;
+
+int main (int argc, char **argv)
+{
+  length_type const FRAMES=64;
+  length_type const SAMPLES=4096;
+
+  vsipl init(argc, argv);
+
+  Vector<complex<float> > frame(SAMPLES);
+  try
+  {
+    raw::writer raw_file("frames.raw");
+    hdf5::file file("frames.hdf5", 'w');
+    hdf5::dataset ds = file.create_dataset<complex<float> >
+      ("iq", Length<2>(0, SAMPLES), Length<2>(1, SAMPLES));
+    {
+      // Triple-buffer frames for each sink.
+      io::async_writer<complex<float> > raw_out(raw_file, SAMPLES);
+      io::async_writer<complex<float> > hdf5_out(ds, SAMPLES, 3);
+      for (index_type f = 0; f != FRAMES; ++f)
+      {
+	// Produce the frame directly in a buffer of the first writer...
+	Vector<complex<float> > out = raw_out.acquire();
+	out = ramp<float>(f * SAMPLES, 1, SAMPLES);
+	out *= complex<float>(0.f, 1.f);
+	frame = out;
+	raw_out.commit();
+	// ...and hand a copy to the second, unless it is falling behind.
+	if (!hdf5_out.try_write(frame))
+	  hdf5_out.write(frame);
+      }
+      std::cout << hdf5_out.overruns() << " frames had to wait for the HDF5 writer."
+		<< std::endl;
+      // Both writers write all pending frames before they are destroyed.
+    }
+    assert(ds.query_extent<2>()[0].size() == FRAMES);
+  }
+  catch (std::exception &e)
+  {
+    std::cerr << "Error : " << e.what() << std::endl;
+    return 1;
+  }
+}
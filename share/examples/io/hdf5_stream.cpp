@@ -0,0 +1,73 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+// Stream data to and from an HDF5 file frame by frame, using a
+// chunked, extensible dataset.
+
+#include <vsip/initfin.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/math.hpp>
+#include <vsip/selgen.hpp>
+#include <ovxx/equal.hpp>
+#include <ovxx/io/hdf5.hpp>
+#include <iostream>
+
+using namespace ovxx;
+
+int main (int argc, char **argv)
+{
+  length_type const FRAMES=16;
+  length_type const SAMPLES=1024;
+
+  vsipl init(argc, argv);
+
+  Vector<complex<float> > frame(SAMPLES);
+  try
+  {
+    {
+      hdf5::file file("stream.hdf5", 'w');
+      // Start with an empty dataset, one frame per chunk, and a
+      // cache big enough for a few frames.
+      hdf5::dataset ds = file.create_dataset<complex<float> >
+	("iq", Length<2>(0, SAMPLES), Length<2>(1, SAMPLES), true,
+	 hdf5::chunk_cache(4 * SAMPLES * sizeof(complex<float>)));
+      // Record frames as they are produced...
+      for (index_type f = 0; f != FRAMES; ++f)
+      {
+	frame = ramp<float>(f * SAMPLES, 1, SAMPLES);
+	ds.append(frame);
+      }
+      // ...and finally append a block of two more.
+      Matrix<complex<float> > frames(2, SAMPLES);
+      frames.row(0) = ramp<float>(FRAMES * SAMPLES, 1, SAMPLES);
+      frames.row(1) = ramp<float>((FRAMES + 1) * SAMPLES, 1, SAMPLES);
+      ds.append(frames);
+    }
+    {
+      hdf5::file file("stream.hdf5", 'r');
+      hdf5::dataset ds = file.open_dataset("iq");
+      Domain<2> extent = ds.query_extent<2>();
+      assert(extent[0].size() == FRAMES + 2);
+      // Play the recording back, one frame at a time...
+      for (index_type f = 0; f != extent[0].size(); ++f)
+      {
+	ds.read(frame, Domain<2>(Domain<1>(f, 1, 1), SAMPLES));
+	assert(equal(frame.real(), ramp<float>(f * SAMPLES, 1, SAMPLES)));
+      }
+      // ...or read every other sample of the first four frames.
+      Matrix<complex<float> > m(4, SAMPLES / 2);
+      ds.read(m, Domain<2>(4, Domain<1>(0, 2, SAMPLES / 2)));
+      assert(equal(m.get(3, 5).real(), float(3 * SAMPLES + 10)));
+    }
+  }
+  catch (std::exception &e)
+  {
+    std::cerr << "Error : " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+// Store views in a raw file, and access them again by mapping
+// the file into memory, without reading or copying any data.
+
+#include <vsip/initfin.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/math.hpp>
+#include <vsip/selgen.hpp>
+#include <ovxx/equal.hpp>
+#include <ovxx/io/raw.hpp>
+#include <iostream>
+
+using namespace ovxx;
+
+int main (int argc, char **argv)
+{
+  length_type const BEAMS=64;
+  length_type const SAMPLES=1024;
+
+  vsipl init(argc, argv);
+
+  try
+  {
+    {
+      // Store a calibration table and a replica.
+      Matrix<complex<float> > calibration(BEAMS, SAMPLES);
+      for (index_type b = 0; b != BEAMS; ++b)
+	calibration.row(b) = ramp<float>(b * SAMPLES, 1, SAMPLES);
+      Vector<float> replica = ramp<float>(0, 0.5, SAMPLES);
+      raw::writer file("tables.raw");
+      file.append(calibration);
+      file.append(replica);
+    }
+    {
+      raw::reader file("tables.raw");
+      assert(file.size() == 2);
+      // These views refer to the mapped file directly.
+      const_Matrix<complex<float> > calibration = file.matrix<complex<float> >(0);
+      const_Vector<float> replica = file.vector<float>(1);
+      assert(calibration.size(0) == BEAMS && calibration.size(1) == SAMPLES);
+      assert(equal(calibration.get(3, 5).real(), float(3 * SAMPLES + 5)));
+      assert(equal(replica.get(10), 5.f));
+      // Asking for the wrong type is an error.
+      try
+      {
+	file.vector<double>(1);
+	assert(0);
+      }
+      catch (raw::exception const &) {}
+      std::cout << "mapped " << file.size() << " records from tables.raw"
+		<< std::endl;
+    }
+  }
+  catch (std::exception &e)
+  {
+    std::cerr << "Error : " << e.what() << std::endl;
+    return 1;
+  }
+}
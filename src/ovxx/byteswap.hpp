@@ -8,9 +8,12 @@
 #ifndef ovxx_byteswap_hpp_
 #define ovxx_byteswap_hpp_
 
+#include <ovxx/support.hpp>
 #include <vsip/complex.hpp>
 #include <ovxx/detail/endian.hpp>
+#include <ovxx/inttypes.hpp>
 #include <byteswap.h>
+#include <cstring>
 
 namespace ovxx
 {
@@ -25,22 +28,36 @@ struct bswap
   static void apply(T *) {}
 };
 
+// Swap the bytes of the (possibly unaligned) value at `d` in place.
+template <typename U>
+inline void swap_in_place(void *d, U (*swap)(U))
+{
+  U u;
+  std::memcpy(&u, d, sizeof(U));
+  u = swap(u);
+  std::memcpy(d, &u, sizeof(U));
+}
+
+inline uint16_type swap16(uint16_type u) { return bswap_16(u);}
+inline uint32_type swap32(uint32_type u) { return bswap_32(u);}
+inline uint64_type swap64(uint64_type u) { return bswap_64(u);}
+
 template <typename T>
 struct bswap<T, true, 2, false>
 {
-  static void apply(T *d) { bswap_16(reinterpret_cast<char*>(d));}
+  static void apply(T *d) { swap_in_place(d, swap16);}
 };
 
 template <typename T>
 struct bswap<T, true, 4, false>
 {
-  static void apply(T *d) { bswap_32(reinterpret_cast<char*>(d));}
+  static void apply(T *d) { swap_in_place(d, swap32);}
 };
 
 template <typename T>
 struct bswap<T, true, 8, false>
 {
-  static void apply(T *d) { bswap_64(reinterpret_cast<char*>(d));}
+  static void apply(T *d) { swap_in_place(d, swap64);}
 };
 
 template <typename T>
@@ -48,8 +65,8 @@ struct bswap<T, true, 8, true>   // complex
 {
   static void apply(T *d) 
   {
-    bswap_32(reinterpret_cast<char*>(d));
-    bswap_32(reinterpret_cast<char*>(d)+4);
+    swap_in_place(d, swap32);
+    swap_in_place(reinterpret_cast<char*>(d)+4, swap32);
   }
 };
 
@@ -58,8 +75,8 @@ struct bswap<T, true, 16, true>  // complex
 {
   static void apply(T *d) 
   {
-    bswap_64(reinterpret_cast<char*>(d));
-    bswap_64(reinterpret_cast<char*>(d)+8);
+    swap_in_place(d, swap64);
+    swap_in_place(reinterpret_cast<char*>(d)+8, swap64);
   }
 };
 
@@ -86,6 +103,13 @@ void byteswap(T &data)
   detail::bswap<T, true>::apply(&data);
 }
 
+// swap bytes of `size` consecutive values
+template <typename T>
+void byteswap_n(T *data, length_type size)
+{
+  for (index_type i = 0; i != size; ++i)
+    detail::bswap<T, true>::apply(data + i);
+}
 
 } // namespace ovxx
 
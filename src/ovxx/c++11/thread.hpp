@@ -27,8 +27,9 @@ public:
   }
   ~mutex() { pthread_mutex_destroy(&mutex_);}
   void lock() { pthread_mutex_lock(&mutex_);}
+  bool try_lock() { return !pthread_mutex_trylock(&mutex_);}
   void unlock() { pthread_mutex_unlock(&mutex_);}
-
+  pthread_mutex_t *native_handle() { return &mutex_;}
 
 private:
   pthread_mutex_t mutex_;
@@ -48,6 +49,48 @@ private:
   L &l_;
 };
 
+template <typename L>
+class unique_lock
+{
+public:
+  unique_lock(L &l) : l_(l), owns_(true) { l_.lock();}
+  ~unique_lock() { if (owns_) l_.unlock();}
+  void lock() { l_.lock(); owns_ = true;}
+  void unlock() { l_.unlock(); owns_ = false;}
+  bool owns_lock() const { return owns_;}
+  L *mutex() const { return &l_;}
+
+private:
+  unique_lock(unique_lock const &);
+  unique_lock& operator=(unique_lock const &);
+
+  L &l_;
+  bool owns_;
+};
+
+class condition_variable
+{
+public:
+  condition_variable()
+  {
+    if (pthread_cond_init(&cond_, 0))
+      throw std::bad_alloc();
+  }
+  ~condition_variable() { pthread_cond_destroy(&cond_);}
+  void notify_one() { pthread_cond_signal(&cond_);}
+  void notify_all() { pthread_cond_broadcast(&cond_);}
+  void wait(unique_lock<mutex> &l)
+  { pthread_cond_wait(&cond_, l.mutex()->native_handle());}
+  template <typename P>
+  void wait(unique_lock<mutex> &l, P pred) { while (!pred()) wait(l);}
+
+private:
+  condition_variable(condition_variable const &);
+  condition_variable &operator=(condition_variable const &);
+
+  pthread_cond_t cond_;
+};
+
 class thread
 {
   struct callable_base
@@ -88,19 +131,22 @@ public:
 
 
   template <typename Callable>
-  thread(Callable c) : callable_(new callable_wrapper<Callable>(c))
+  thread(Callable c)
+    : callable_(new callable_wrapper<Callable>(c)), joinable_(true)
   {
     if (pthread_create(&id_.thread_, 0, &thread::start, this) != 0)
       throw std::bad_alloc();
   }
   ~thread()
   {
-    detach();
+    if (joinable_) detach();
   }
+  bool joinable() const { return joinable_;}
   void join(void **status = 0)
   {
     void *s;
     pthread_join(id_.thread_, &s);
+    joinable_ = false;
     if (status) *status = s;    
   }
   id get_id() const { return id_;}
@@ -120,6 +166,7 @@ private:
 
   std::auto_ptr<callable_base> callable_;
   id id_;
+  bool joinable_;
 };
 
 namespace this_thread
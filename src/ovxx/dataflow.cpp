@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#include <ovxx/dataflow.hpp>
+#include <ovxx/thread_pool.hpp>
+#if defined(OVXX_ENABLE_THREADING)
+# include <ovxx/c++11/thread.hpp>
+#endif
+#include <map>
+
+namespace ovxx
+{
+namespace dataflow
+{
+namespace
+{
+typedef refcounted_ptr<detail::stage> stage_ptr;
+
+/// The stages accessing a resource that haven't necessarily completed.
+struct resource
+{
+  stage_ptr writer;
+  std::vector<stage_ptr> readers;
+};
+
+/// Execute a stage on the thread pool.
+class stage_task : public thread_pool::task
+{
+public:
+  stage_task(graph *g, stage_ptr const &s) : graph_(g), stage_(s) {}
+  virtual void run()
+  {
+    if (!stage_->failed)
+    {
+      try { stage_->run();}
+      catch (...)
+      {
+	stage_->failed = true;
+	graph_->complete(*stage_);
+	throw;
+      }
+    }
+    graph_->complete(*stage_);
+  }
+private:
+  graph *graph_;
+  stage_ptr stage_;
+};
+} // namespace <unnamed>
+
+struct graph::impl
+{
+  impl(length_type m) : pending(0), max_pending(m) {}
+
+  /// Whether another stage may be submitted.
+  static bool has_room(void *self)
+  {
+    impl *i = static_cast<impl *>(self);
+#if defined(OVXX_ENABLE_THREADING)
+    lock_guard<mutex> lock(i->guard);
+#endif
+    return i->pending < i->max_pending;
+  }
+
+  /// Make `s` depend on `p`, unless `p` has already completed.
+  void depend(detail::stage *s, stage_ptr const &p)
+  {
+    if (!p.get() || p.get() == s) return;
+    if (p->done)
+    {
+      if (p->failed) s->failed = true;
+      return;
+    }
+    p->successors.push_back(stage_ptr(s));
+    ++s->waiting;
+  }
+
+  /// Forget about completed stages.
+  void clear()
+  {
+#if defined(OVXX_ENABLE_THREADING)
+    lock_guard<mutex> lock(guard);
+#endif
+    resources.clear();
+  }
+
+#if defined(OVXX_ENABLE_THREADING)
+  mutable mutex guard;
+#endif
+  std::map<void const *, resource> resources;
+  thread_pool::task_group group;
+  length_type pending;
+  length_type max_pending;
+};
+
+graph::graph(length_type max_pending) : impl_(new impl(max_pending)) {}
+
+graph::~graph()
+{
+  try { wait();}
+  catch (...) {}
+  delete impl_;
+}
+
+void graph::submit(detail::stage *s, access const &a)
+{
+  stage_ptr ptr(s, false);
+  // Help executing stages until there is room for this one.
+  if (impl_->max_pending)
+    thread_pool::run_until(&impl::has_room, impl_);
+  bool ready;
+  {
+#if defined(OVXX_ENABLE_THREADING)
+    lock_guard<mutex> lock(impl_->guard);
+#endif
+    // Hold the stage back while its dependencies are being recorded.
+    s->waiting = 1;
+    access::entries_type const &entries = a.entries();
+    for (access::entries_type::const_iterator i = entries.begin();
+	 i != entries.end(); ++i)
+    {
+      resource &r = impl_->resources[i->resource];
+      impl_->depend(s, r.writer);
+      if (i->write)
+      {
+	// Write after read.
+	for (std::size_t j = 0; j != r.readers.size(); ++j)
+	  impl_->depend(s, r.readers[j]);
+	r.readers.clear();
+	r.writer = ptr;
+      }
+      else
+      {
+	// Drop completed readers, so resources that are only ever
+	// read don't accumulate stages.
+	std::size_t n = 0;
+	for (std::size_t j = 0; j != r.readers.size(); ++j)
+	  if (!r.readers[j]->done) r.readers[n++] = r.readers[j];
+	r.readers.resize(n, ptr);
+	r.readers.push_back(ptr);
+      }
+    }
+    ++impl_->pending;
+    ready = !--s->waiting;
+  }
+  if (ready) schedule(ptr);
+}
+
+void graph::schedule(stage_ptr const &s)
+{
+  impl_->group.run(new stage_task(this, s));
+}
+
+void graph::complete(detail::stage &s)
+{
+  std::vector<stage_ptr> ready;
+  {
+#if defined(OVXX_ENABLE_THREADING)
+    lock_guard<mutex> lock(impl_->guard);
+#endif
+    s.done = true;
+    --impl_->pending;
+    for (std::size_t i = 0; i != s.successors.size(); ++i)
+    {
+      stage_ptr const &next = s.successors[i];
+      if (s.failed) next->failed = true;
+      if (!--next->waiting) ready.push_back(next);
+    }
+    s.successors.clear();
+  }
+  for (std::size_t i = 0; i != ready.size(); ++i)
+    schedule(ready[i]);
+}
+
+void graph::wait()
+{
+  try { impl_->group.wait();}
+  catch (...)
+  {
+    impl_->clear();
+    throw;
+  }
+  impl_->clear();
+}
+
+length_type graph::pending() const
+{
+#if defined(OVXX_ENABLE_THREADING)
+  lock_guard<mutex> lock(impl_->guard);
+#endif
+  return impl_->pending;
+}
+
+} // namespace ovxx::dataflow
+} // namespace ovxx
@@ -0,0 +1,218 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_dataflow_hpp_
+#define ovxx_dataflow_hpp_
+
+#include <ovxx/support.hpp>
+#include <ovxx/refcounted.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#include <vector>
+
+namespace ovxx
+{
+/// Asynchronous execution of processing chains.
+///
+/// A graph executes stages (library operations such as `Fftm`,
+/// `Convolution`, or `Fir`, assignments, or arbitrary function objects)
+/// on the library thread pool.  Each stage declares which views it reads
+/// and writes, and the graph derives the dependencies between stages
+/// from these declarations, in submission order: a stage runs once all
+/// earlier stages writing the views it accesses, or reading the views
+/// it writes, have completed.  Independent stages run concurrently.
+///
+/// Stages hold copies of their views, which share the views' blocks by
+/// reference-counting, so data is passed between stages without being
+/// copied, and blocks stay alive until the stages using them complete.
+///
+/// Successive frames of a processing chain are pipelined by rotating
+/// over a set of buffers: the stages of one frame only wait for the
+/// stages of earlier frames that used the same buffers, so the number
+/// of buffers bounds the number of frames in flight.  The number of
+/// pending stages may be bounded, too, in which case submission
+/// blocks (executing pending tasks) until earlier stages complete.
+///
+/// Dependencies are tracked per block: views of the same block are
+/// recognized as aliases, but subviews are blocks of their own, and
+/// expressions are not looked through.  Stages accessing overlapping
+/// data through distinct blocks need to declare the underlying views.
+namespace dataflow
+{
+namespace detail
+{
+class stage : public refcounted<stage>
+{
+public:
+  stage() : waiting(0), done(false), failed(false) {}
+  virtual ~stage() {}
+  virtual void run() = 0;
+
+  // Bookkeeping, managed by the graph.
+  length_type waiting;
+  bool done;
+  bool failed;
+  std::vector<refcounted_ptr<stage> > successors;
+};
+
+template <typename F>
+class function_stage : public stage
+{
+public:
+  function_stage(F const &f) : f_(f) {}
+  virtual void run() { f_();}
+private:
+  F f_;
+};
+
+template <typename O, typename I, typename R>
+class call_stage : public stage
+{
+public:
+  call_stage(O &op, I const &in, R const &out) : op_(&op), in_(in), out_(out) {}
+  virtual void run() { (*op_)(in_, out_);}
+private:
+  O *op_;
+  I in_;
+  R out_;
+};
+
+template <typename O, typename V>
+class inplace_stage : public stage
+{
+public:
+  inplace_stage(O &op, V const &inout) : op_(&op), inout_(inout) {}
+  virtual void run() { (*op_)(inout_);}
+private:
+  O *op_;
+  V inout_;
+};
+
+template <typename L, typename R>
+class assign_stage : public stage
+{
+public:
+  assign_stage(L const &lhs, R const &rhs) : lhs_(lhs), rhs_(rhs) {}
+  virtual void run() { lhs_ = rhs_;}
+private:
+  L lhs_;
+  R rhs_;
+};
+} // namespace ovxx::dataflow::detail
+
+/// The resources a stage accesses.
+class access
+{
+public:
+  struct entry
+  {
+    entry(void const *r, bool w) : resource(r), write(w) {}
+    void const *resource;
+    bool write;
+  };
+  typedef std::vector<entry> entries_type;
+
+  /// The stage reads `view`.
+  template <typename V>
+  access &reads(V const &view)
+  {
+    entries_.push_back(entry(&view.block(), false));
+    return *this;
+  }
+  /// The stage writes `view`.
+  template <typename V>
+  access &writes(V const &view)
+  {
+    entries_.push_back(entry(&view.block(), true));
+    return *this;
+  }
+  /// The stage modifies `object`, such as a stateful operation
+  /// (e.g. a `Fir` object), so it must not run concurrently with,
+  /// nor be reordered relative to, other stages using it.
+  template <typename T>
+  access &exclusive(T const &object)
+  {
+    entries_.push_back(entry(&object, true));
+    return *this;
+  }
+
+  entries_type const &entries() const { return entries_;}
+
+private:
+  entries_type entries_;
+};
+
+class graph : ovxx::detail::noncopyable
+{
+public:
+  /// Create a graph. If `max_pending` is non-zero, at most that many
+  /// stages may be pending (submitted but not yet completed).
+  explicit graph(length_type max_pending = 0);
+  /// Wait for all stages, ignoring errors.
+  ~graph();
+
+  /// Submit the function object `f`, accessing `a`.
+  template <typename F>
+  void submit(F const &f, access const &a)
+  { submit(new detail::function_stage<F>(f), a);}
+
+  /// Submit the operation `op(in, out)`.
+  /// `op` is held by reference, and needs to remain valid until the
+  /// stage completes. Stages using the same operation are executed
+  /// in submission order.
+  template <typename O, typename I, typename R>
+  void call(O &op, I const &in, R const &out)
+  {
+    access a;
+    a.reads(in).writes(out).exclusive(op);
+    submit(new detail::call_stage<O, I, R>(op, in, out), a);
+  }
+  /// Submit the in-place operation `op(inout)`.
+  template <typename O, typename V>
+  void call(O &op, V const &inout)
+  {
+    access a;
+    a.writes(inout).exclusive(op);
+    submit(new detail::inplace_stage<O, V>(op, inout), a);
+  }
+  /// Submit the assignment `lhs = rhs`.
+  /// `rhs` needs to be a view, not an expression.
+  template <typename L, typename R>
+  void assign(L const &lhs, R const &rhs)
+  {
+    access a;
+    a.reads(rhs).writes(lhs);
+    submit(new detail::assign_stage<L, R>(lhs, rhs), a);
+  }
+
+  /// Submit the stage `s`, accessing `a`. The graph takes ownership of `s`.
+  void submit(detail::stage *s, access const &a);
+  template <typename S>
+  void submit(S *s, access const &a)
+  { submit(static_cast<detail::stage *>(s), a);}
+
+  /// Wait for all stages submitted so far to complete, executing
+  /// pending tasks while waiting.  If any stage terminated with an
+  /// exception, throw a std::runtime_error reporting it.  (Stages
+  /// depending on a failed stage are skipped.)
+  void wait();
+
+  /// Return the number of stages submitted but not yet completed.
+  length_type pending() const;
+
+  // Implementation details.
+  void schedule(refcounted_ptr<detail::stage> const &);
+  void complete(detail::stage &);
+
+private:
+  struct impl;
+  impl *impl_;
+};
+
+} // namespace ovxx::dataflow
+} // namespace ovxx
+
+#endif
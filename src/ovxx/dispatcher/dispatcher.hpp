@@ -10,6 +10,8 @@
 
 #include <ovxx/support.hpp>
 #include <ovxx/c++11.hpp>
+#include <ovxx/profile.hpp>
+#include <ovxx/dispatcher/tuning.hpp>
 
 namespace ovxx
 {
@@ -137,10 +139,37 @@ template <typename O,
 struct Dispatcher<O, R(A...), L, B, N, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A...);
+  /// Execute the operation with this backend.
+  static R exec(A... args)
+  {
+    profile::scope<O, B> scope(args...);
+    return E::exec(args...);
+  }
+  /// Select the cheapest backend from this and the remaining ones,
+  /// for cost-based dispatch (see tuning.hpp).
+  static void select(length_type size, function_type &f, double &cost,
+                     A... args)
+  {
+    if (E::rt_valid(args...)) tuning::select<O, B>(size, &exec, f, cost);
+    Dispatcher<O, R(A...), N>::select(size, f, cost, args...);
+  }
+  /// Call `f`, as chosen by select().
+  static R call(function_type f, A... args)
+  {
+    if (f == &exec) return exec(args...);
+    else return Dispatcher<O, R(A...), N>::call(f, args...);
+  }
   static R dispatch(A... args)
   {
-    if (E::rt_valid(args...))
-      return E::exec(args...);
+    if (tuning::enabled())
+    {
+      function_type f = 0;
+      double cost = 0.;
+      select(tuning::size(args...), f, cost, args...);
+      if (f) return call(f, args...);
+    }
+    if (E::rt_valid(args...)) return exec(args...);
     else return Dispatcher<O, R(A...), N>::dispatch(args...);
   }
 };
@@ -150,9 +179,24 @@ template <typename O, typename L, typename B, typename E, typename R, typename .
 struct Dispatcher<O, R(A...), L, B, null_type, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A...);
+  static R exec(A... args)
+  {
+    profile::scope<O, B> scope(args...);
+    return E::exec(args...);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A... args)
+  {
+    if (E::rt_valid(args...)) tuning::select<O, B>(size, &exec, f, cost);
+  }
+  static R call(function_type, A... args)
+  {
+    return exec(args...);
+  }
   static R dispatch(A... args)
   {
-    if (E::rt_valid(args...)) return E::exec(args...);
+    if (E::rt_valid(args...)) return exec(args...);
     else throw std::runtime_error("No backend");
   }
 };
@@ -161,6 +205,12 @@ struct Dispatcher<O, R(A...), L, B, null_type, E, true>
 template <typename O, typename L, typename B, typename E, typename R, typename ...A>
 struct Dispatcher<O, R(A... args), L, B, null_type, E, false>
 {
+  typedef R (*function_type)(A...);
+  static void select(length_type, function_type &, double &, A...) {}
+  static R call(function_type, A... args)
+  {
+    throw std::runtime_error("No backend");
+  }
   static R dispatch(A... args)
   {
     throw std::runtime_error("No backend");
@@ -176,9 +226,34 @@ template <typename O,
 struct Dispatcher<O, R(A), L, B, N, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A);
+  static R exec(A a)
+  {
+    profile::scope<O, B> scope(a);
+    return E::exec(a);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A a)
+  {
+    if (E::rt_valid(a)) tuning::select<O, B>(size, &exec, f, cost);
+    Dispatcher<O, R(A), N>::select(size, f, cost, a);
+  }
+  /// Call `f`, as chosen by select().
+  static R call(function_type f, A a)
+  {
+    if (f == &exec) return exec(a);
+    else return Dispatcher<O, R(A), N>::call(f, a);
+  }
   static R dispatch(A a)
   {
-    if (E::rt_valid(a)) return E::exec(a);
+    if (tuning::enabled())
+    {
+      function_type f = 0;
+      double cost = 0.;
+      select(tuning::size(a), f, cost, a);
+      if (f) return call(f, a);
+    }
+    if (E::rt_valid(a)) return exec(a);
     else return Dispatcher<O, R(A), N>::dispatch(a);
   }
 };
@@ -188,10 +263,24 @@ template <typename O, typename R, typename A, typename L, typename B, typename E
 struct Dispatcher<O, R(A), L, B, null_type, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A);
+  static R exec(A a)
+  {
+    profile::scope<O, B> scope(a);
+    return E::exec(a);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A a)
+  {
+    if (E::rt_valid(a)) tuning::select<O, B>(size, &exec, f, cost);
+  }
+  static R call(function_type, A a)
+  {
+    return exec(a);
+  }
   static R dispatch(A a)
   {
-    if (E::rt_valid(a))
-      return E::exec(a);
+    if (E::rt_valid(a)) return exec(a);
     else OVXX_DO_THROW(unimplemented("No backend"));
   }
 };
@@ -200,6 +289,12 @@ struct Dispatcher<O, R(A), L, B, null_type, E, true>
 template <typename O, typename R, typename A, typename L, typename B, typename E>
 struct Dispatcher<O, R(A), L, B, null_type, E, false>
 {
+  typedef R (*function_type)(A);
+  static void select(length_type, function_type &, double &, A) {}
+  static R call(function_type, A)
+  {
+    OVXX_DO_THROW(unimplemented("No backend"));
+  }
   static R dispatch(A)
   {
     OVXX_DO_THROW(unimplemented("No backend"));
@@ -213,9 +308,34 @@ template <typename O,
 struct Dispatcher<O, R(A1, A2), L, B, N, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A1, A2);
+  static R exec(A1 a1, A2 a2)
+  {
+    profile::scope<O, B> scope(a1, a2);
+    return E::exec(a1, a2);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A1 a1, A2 a2)
+  {
+    if (E::rt_valid(a1, a2)) tuning::select<O, B>(size, &exec, f, cost);
+    Dispatcher<O, R(A1, A2), N>::select(size, f, cost, a1, a2);
+  }
+  /// Call `f`, as chosen by select().
+  static R call(function_type f, A1 a1, A2 a2)
+  {
+    if (f == &exec) return exec(a1, a2);
+    else return Dispatcher<O, R(A1, A2), N>::call(f, a1, a2);
+  }
   static R dispatch(A1 a1, A2 a2)
   {
-    if (E::rt_valid(a1, a2)) return E::exec(a1, a2);
+    if (tuning::enabled())
+    {
+      function_type f = 0;
+      double cost = 0.;
+      select(tuning::size(a1, a2), f, cost, a1, a2);
+      if (f) return call(f, a1, a2);
+    }
+    if (E::rt_valid(a1, a2)) return exec(a1, a2);
     else return Dispatcher<O, R(A1, A2), N>::dispatch(a1, a2);
   }
 };
@@ -227,9 +347,24 @@ template <typename O,
 struct Dispatcher<O, R(A1, A2), L, B, null_type, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A1, A2);
+  static R exec(A1 a1, A2 a2)
+  {
+    profile::scope<O, B> scope(a1, a2);
+    return E::exec(a1, a2);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A1 a1, A2 a2)
+  {
+    if (E::rt_valid(a1, a2)) tuning::select<O, B>(size, &exec, f, cost);
+  }
+  static R call(function_type, A1 a1, A2 a2)
+  {
+    return exec(a1, a2);
+  }
   static R dispatch(A1 a1, A2 a2)
   {
-    if (E::rt_valid(a1, a2)) return E::exec(a1, a2);
+    if (E::rt_valid(a1, a2)) return exec(a1, a2);
     else OVXX_DO_THROW(unimplemented("No backend"));
   }
 };
@@ -240,6 +375,12 @@ template <typename O,
           typename L, typename B, typename E>
 struct Dispatcher<O, R(A1, A2), L, B, null_type, E, false>
 {
+  typedef R (*function_type)(A1, A2);
+  static void select(length_type, function_type &, double &, A1, A2) {}
+  static R call(function_type, A1, A2)
+  {
+    OVXX_DO_THROW(unimplemented("No backend"));
+  }
   static R dispatch(A1, A2)
   {
     OVXX_DO_THROW(unimplemented("No backend"));
@@ -253,9 +394,34 @@ template <typename O,
 struct Dispatcher<O, R(A1, A2, A3), L, B, N, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A1, A2, A3);
+  static R exec(A1 a1, A2 a2, A3 a3)
+  {
+    profile::scope<O, B> scope(a1, a2, a3);
+    return E::exec(a1, a2, a3);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A1 a1, A2 a2, A3 a3)
+  {
+    if (E::rt_valid(a1, a2, a3)) tuning::select<O, B>(size, &exec, f, cost);
+    Dispatcher<O, R(A1, A2, A3), N>::select(size, f, cost, a1, a2, a3);
+  }
+  /// Call `f`, as chosen by select().
+  static R call(function_type f, A1 a1, A2 a2, A3 a3)
+  {
+    if (f == &exec) return exec(a1, a2, a3);
+    else return Dispatcher<O, R(A1, A2, A3), N>::call(f, a1, a2, a3);
+  }
   static R dispatch(A1 a1, A2 a2, A3 a3)
   {
-    if (E::rt_valid(a1, a2, a3)) return E::exec(a1, a2, a3);
+    if (tuning::enabled())
+    {
+      function_type f = 0;
+      double cost = 0.;
+      select(tuning::size(a1, a2, a3), f, cost, a1, a2, a3);
+      if (f) return call(f, a1, a2, a3);
+    }
+    if (E::rt_valid(a1, a2, a3)) return exec(a1, a2, a3);
     else return Dispatcher<O, R(A1, A2, A3), N>::dispatch(a1, a2, a3);
   }
 };
@@ -267,9 +433,24 @@ template <typename O,
 struct Dispatcher<O, R(A1, A2, A3), L, B, null_type, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A1, A2, A3);
+  static R exec(A1 a1, A2 a2, A3 a3)
+  {
+    profile::scope<O, B> scope(a1, a2, a3);
+    return E::exec(a1, a2, a3);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A1 a1, A2 a2, A3 a3)
+  {
+    if (E::rt_valid(a1, a2, a3)) tuning::select<O, B>(size, &exec, f, cost);
+  }
+  static R call(function_type, A1 a1, A2 a2, A3 a3)
+  {
+    return exec(a1, a2, a3);
+  }
   static R dispatch(A1 a1, A2 a2, A3 a3)
   {
-    if (E::rt_valid(a1, a2, a3)) return E::exec(a1, a2, a3);
+    if (E::rt_valid(a1, a2, a3)) return exec(a1, a2, a3);
     else OVXX_DO_THROW(unimplemented("No backend"));
   }
 };
@@ -280,6 +461,12 @@ template <typename O,
           typename L, typename B, typename E>
 struct Dispatcher<O, R(A1, A2, A3), L, B, null_type, E, false>
 {
+  typedef R (*function_type)(A1, A2, A3);
+  static void select(length_type, function_type &, double &, A1, A2, A3) {}
+  static R call(function_type, A1, A2, A3)
+  {
+    OVXX_DO_THROW(unimplemented("No backend"));
+  }
   static R dispatch(A1, A2, A3)
   {
     OVXX_DO_THROW(unimplemented("No backend"));
@@ -293,9 +480,34 @@ template <typename O,
 struct Dispatcher<O, R(A1, A2, A3, A4), L, B, N, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A1, A2, A3, A4);
+  static R exec(A1 a1, A2 a2, A3 a3, A4 a4)
+  {
+    profile::scope<O, B> scope(a1, a2, a3, a4);
+    return E::exec(a1, a2, a3, a4);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A1 a1, A2 a2, A3 a3, A4 a4)
+  {
+    if (E::rt_valid(a1, a2, a3, a4)) tuning::select<O, B>(size, &exec, f, cost);
+    Dispatcher<O, R(A1, A2, A3, A4), N>::select(size, f, cost, a1, a2, a3, a4);
+  }
+  /// Call `f`, as chosen by select().
+  static R call(function_type f, A1 a1, A2 a2, A3 a3, A4 a4)
+  {
+    if (f == &exec) return exec(a1, a2, a3, a4);
+    else return Dispatcher<O, R(A1, A2, A3, A4), N>::call(f, a1, a2, a3, a4);
+  }
   static R dispatch(A1 a1, A2 a2, A3 a3, A4 a4)
   {
-    if (E::rt_valid(a1, a2, a3, a4)) return E::exec(a1, a2, a3, a4);
+    if (tuning::enabled())
+    {
+      function_type f = 0;
+      double cost = 0.;
+      select(tuning::size(a1, a2, a3, a4), f, cost, a1, a2, a3, a4);
+      if (f) return call(f, a1, a2, a3, a4);
+    }
+    if (E::rt_valid(a1, a2, a3, a4)) return exec(a1, a2, a3, a4);
     else return Dispatcher<O, R(A1, A2, A3, A4), N>::dispatch(a1, a2, a3, a4);
   }
 };
@@ -307,9 +519,24 @@ template <typename O,
 struct Dispatcher<O, R(A1, A2, A3, A4), L, B, null_type, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A1, A2, A3, A4);
+  static R exec(A1 a1, A2 a2, A3 a3, A4 a4)
+  {
+    profile::scope<O, B> scope(a1, a2, a3, a4);
+    return E::exec(a1, a2, a3, a4);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A1 a1, A2 a2, A3 a3, A4 a4)
+  {
+    if (E::rt_valid(a1, a2, a3, a4)) tuning::select<O, B>(size, &exec, f, cost);
+  }
+  static R call(function_type, A1 a1, A2 a2, A3 a3, A4 a4)
+  {
+    return exec(a1, a2, a3, a4);
+  }
   static R dispatch(A1 a1, A2 a2, A3 a3, A4 a4)
   {
-    if (E::rt_valid(a1, a2, a3, a4)) return E::exec(a1, a2, a3, a4);
+    if (E::rt_valid(a1, a2, a3, a4)) return exec(a1, a2, a3, a4);
     else OVXX_DO_THROW(unimplemented("No backend"));
   }
 };
@@ -320,6 +547,12 @@ template <typename O,
           typename L, typename B, typename E>
 struct Dispatcher<O, R(A1, A2, A3, A4), L, B, null_type, E, false>
 {
+  typedef R (*function_type)(A1, A2, A3, A4);
+  static void select(length_type, function_type &, double &, A1, A2, A3, A4) {}
+  static R call(function_type, A1, A2, A3, A4)
+  {
+    OVXX_DO_THROW(unimplemented("No backend"));
+  }
   static R dispatch(A1, A2, A3, A4)
   {
     OVXX_DO_THROW(unimplemented("No backend"));
@@ -334,9 +567,34 @@ template <typename O,
 struct Dispatcher<O, R(A1, A2, A3, A4, A5), L, B, N, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A1, A2, A3, A4, A5);
+  static R exec(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5)
+  {
+    profile::scope<O, B> scope(a1, a2, a3, a4, a5);
+    return E::exec(a1, a2, a3, a4, a5);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A1 a1, A2 a2, A3 a3, A4 a4, A5 a5)
+  {
+    if (E::rt_valid(a1, a2, a3, a4, a5)) tuning::select<O, B>(size, &exec, f, cost);
+    Dispatcher<O, R(A1, A2, A3, A4, A5), N>::select(size, f, cost, a1, a2, a3, a4, a5);
+  }
+  /// Call `f`, as chosen by select().
+  static R call(function_type f, A1 a1, A2 a2, A3 a3, A4 a4, A5 a5)
+  {
+    if (f == &exec) return exec(a1, a2, a3, a4, a5);
+    else return Dispatcher<O, R(A1, A2, A3, A4, A5), N>::call(f, a1, a2, a3, a4, a5);
+  }
   static R dispatch(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5)
   {
-    if (E::rt_valid(a1, a2, a3, a4, a5)) return E::exec(a1, a2, a3, a4, a5);
+    if (tuning::enabled())
+    {
+      function_type f = 0;
+      double cost = 0.;
+      select(tuning::size(a1, a2, a3, a4, a5), f, cost, a1, a2, a3, a4, a5);
+      if (f) return call(f, a1, a2, a3, a4, a5);
+    }
+    if (E::rt_valid(a1, a2, a3, a4, a5)) return exec(a1, a2, a3, a4, a5);
     else return Dispatcher<O, R(A1, A2, A3, A4, A5), N>::dispatch
       (a1, a2, a3, a4, a5);
   }
@@ -350,9 +608,24 @@ template <typename O,
 struct Dispatcher<O, R(A1, A2, A3, A4, A5), L, B, null_type, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A1, A2, A3, A4, A5);
+  static R exec(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5)
+  {
+    profile::scope<O, B> scope(a1, a2, a3, a4, a5);
+    return E::exec(a1, a2, a3, a4, a5);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A1 a1, A2 a2, A3 a3, A4 a4, A5 a5)
+  {
+    if (E::rt_valid(a1, a2, a3, a4, a5)) tuning::select<O, B>(size, &exec, f, cost);
+  }
+  static R call(function_type, A1 a1, A2 a2, A3 a3, A4 a4, A5 a5)
+  {
+    return exec(a1, a2, a3, a4, a5);
+  }
   static R dispatch(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5)
   {
-    if (E::rt_valid(a1, a2, a3, a4, a5)) return E::exec(a1, a2, a3, a4, a5);
+    if (E::rt_valid(a1, a2, a3, a4, a5)) return exec(a1, a2, a3, a4, a5);
     else OVXX_DO_THROW(unimplemented("No backend"));
   }
 };
@@ -364,6 +637,12 @@ template <typename O,
           typename L, typename B, typename E>
 struct Dispatcher<O, R(A1, A2, A3, A4, A5), L, B, null_type, E, false>
 {
+  typedef R (*function_type)(A1, A2, A3, A4, A5);
+  static void select(length_type, function_type &, double &, A1, A2, A3, A4, A5) {}
+  static R call(function_type, A1, A2, A3, A4, A5)
+  {
+    OVXX_DO_THROW(unimplemented("No backend"));
+  }
   static R dispatch(A1, A2, A3, A4, A5)
   {
     OVXX_DO_THROW(unimplemented("No backend"));
@@ -378,9 +657,34 @@ template <typename O,
 struct Dispatcher<O, R(A1, A2, A3, A4, A5, A6), L, B, N, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A1, A2, A3, A4, A5, A6);
+  static R exec(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6)
+  {
+    profile::scope<O, B> scope(a1, a2, a3, a4, a5, a6);
+    return E::exec(a1, a2, a3, a4, a5, a6);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6)
+  {
+    if (E::rt_valid(a1, a2, a3, a4, a5, a6)) tuning::select<O, B>(size, &exec, f, cost);
+    Dispatcher<O, R(A1, A2, A3, A4, A5, A6), N>::select(size, f, cost, a1, a2, a3, a4, a5, a6);
+  }
+  /// Call `f`, as chosen by select().
+  static R call(function_type f, A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6)
+  {
+    if (f == &exec) return exec(a1, a2, a3, a4, a5, a6);
+    else return Dispatcher<O, R(A1, A2, A3, A4, A5, A6), N>::call(f, a1, a2, a3, a4, a5, a6);
+  }
   static R dispatch(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6)
   {
-    if (E::rt_valid(a1, a2, a3, a4, a5, a6)) return E::exec(a1, a2, a3, a4, a5, a6);
+    if (tuning::enabled())
+    {
+      function_type f = 0;
+      double cost = 0.;
+      select(tuning::size(a1, a2, a3, a4, a5, a6), f, cost, a1, a2, a3, a4, a5, a6);
+      if (f) return call(f, a1, a2, a3, a4, a5, a6);
+    }
+    if (E::rt_valid(a1, a2, a3, a4, a5, a6)) return exec(a1, a2, a3, a4, a5, a6);
     else return Dispatcher<O, R(A1, A2, A3, A4, A5, A6), N>::dispatch
       (a1, a2, a3, a4, a5, a6);
   }
@@ -394,9 +698,24 @@ template <typename O,
 struct Dispatcher<O, R(A1, A2, A3, A4, A5, A6), L, B, null_type, E, true>
 {
   typedef B backend;
+  typedef R (*function_type)(A1, A2, A3, A4, A5, A6);
+  static R exec(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6)
+  {
+    profile::scope<O, B> scope(a1, a2, a3, a4, a5, a6);
+    return E::exec(a1, a2, a3, a4, a5, a6);
+  }
+  static void select(length_type size, function_type &f, double &cost,
+                     A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6)
+  {
+    if (E::rt_valid(a1, a2, a3, a4, a5, a6)) tuning::select<O, B>(size, &exec, f, cost);
+  }
+  static R call(function_type, A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6)
+  {
+    return exec(a1, a2, a3, a4, a5, a6);
+  }
   static R dispatch(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6)
   {
-    if (E::rt_valid(a1, a2, a3, a4, a5, a6)) return E::exec(a1, a2, a3, a4, a5, a6);
+    if (E::rt_valid(a1, a2, a3, a4, a5, a6)) return exec(a1, a2, a3, a4, a5, a6);
     else OVXX_DO_THROW(unimplemented("No backend"));
   }
 };
@@ -408,6 +727,12 @@ template <typename O,
           typename L, typename B, typename E>
 struct Dispatcher<O, R(A1, A2, A3, A4, A5, A6), L, B, null_type, E, false>
 {
+  typedef R (*function_type)(A1, A2, A3, A4, A5, A6);
+  static void select(length_type, function_type &, double &, A1, A2, A3, A4, A5, A6) {}
+  static R call(function_type, A1, A2, A3, A4, A5, A6)
+  {
+    OVXX_DO_THROW(unimplemented("No backend"));
+  }
   static R dispatch(A1, A2, A3, A4, A5, A6)
   {
     OVXX_DO_THROW(unimplemented("No backend"));
@@ -0,0 +1,182 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#include <ovxx/dispatcher/tuning.hpp>
+#include <ovxx/c++11.hpp>
+#if defined(OVXX_ENABLE_THREADING)
+# include <ovxx/c++11/thread.hpp>
+#endif
+#include <map>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include <cmath>
+
+namespace ovxx
+{
+namespace dispatcher
+{
+namespace tuning
+{
+namespace detail
+{
+bool enabled = false;
+} // namespace ovxx::dispatcher::tuning::detail
+
+namespace
+{
+typedef std::pair<std::string, std::string> key_type;
+// Map nodes are never erased, so references to models remain valid.
+typedef std::map<key_type, model> table_type;
+
+table_type &table()
+{
+  static table_type t;
+  return t;
+}
+
+#if defined(OVXX_ENABLE_THREADING)
+mutex table_guard;
+#endif
+
+struct less_size
+{
+  bool operator()(std::pair<double, double> const &a,
+		  std::pair<double, double> const &b) const
+  { return a.first < b.first;}
+};
+
+/// Interpolate linearly between (x0, y0) and (x1, y1) in the
+/// log-log domain.
+double interpolate(std::pair<double, double> const &p0,
+		   std::pair<double, double> const &p1,
+		   double x)
+{
+  double lx0 = std::log(p0.first), lx1 = std::log(p1.first);
+  double ly0 = std::log(p0.second), ly1 = std::log(p1.second);
+  double slope = (ly1 - ly0) / (lx1 - lx0);
+  return std::exp(ly0 + slope * (std::log(x) - lx0));
+}
+} // namespace <unnamed>
+
+void model::add(length_type size, double seconds)
+{
+  // Sizes and times need to be positive for the log-log interpolation.
+  if (!size || !(seconds > 0.)) return;
+  std::pair<double, double> p(static_cast<double>(size), seconds);
+  points_type::iterator i =
+    std::lower_bound(points_.begin(), points_.end(), p, less_size());
+  if (i != points_.end() && i->first == p.first)
+    i->second = seconds;
+  else
+    points_.insert(i, p);
+  valid_ = true;
+}
+
+double model::operator()(length_type size) const
+{
+  if (points_.empty()) return 0.;
+  if (points_.size() == 1)
+    // Assume linear complexity.
+    return points_[0].second * std::max(size, length_type(1)) / points_[0].first;
+  double x = std::max(static_cast<double>(size), 1.);
+  std::pair<double, double> p(x, 0.);
+  points_type::const_iterator i =
+    std::lower_bound(points_.begin(), points_.end(), p, less_size());
+  if (i != points_.end() && i->first == x) return i->second;
+  // Extrapolate beyond either end using the nearest segment.
+  if (i == points_.begin()) ++i;
+  else if (i == points_.end()) --i;
+  return interpolate(*(i - 1), *i, x);
+}
+
+model &find(char const *op, char const *backend)
+{
+#if defined(OVXX_ENABLE_THREADING)
+  lock_guard<mutex> lock(table_guard);
+#endif
+  return table()[key_type(op, backend)];
+}
+
+void add(char const *op, char const *backend, length_type size, double seconds)
+{
+  find(op, backend).add(size, seconds);
+  detail::enabled = true;
+}
+
+void load(char const *filename)
+{
+  std::ifstream ifs(filename);
+  if (!ifs)
+    OVXX_DO_THROW(std::runtime_error(std::string("Unable to open tuning file ")
+				     + filename));
+  std::string line;
+  for (unsigned lineno = 1; std::getline(ifs, line); ++lineno)
+  {
+    std::string::size_type start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line[start] == '#') continue;
+    // Each line holds "<backend> <size> <seconds> <operation>",
+    // with the operation name taking the rest of the line.
+    std::istringstream iss(line);
+    std::string backend, op;
+    length_type size;
+    double seconds;
+    if (!(iss >> backend >> size >> seconds) || !std::getline(iss >> std::ws, op))
+    {
+      std::ostringstream msg;
+      msg << filename << ':' << lineno << ": invalid tuning entry";
+      OVXX_DO_THROW(std::runtime_error(msg.str()));
+    }
+    add(op.c_str(), backend.c_str(), size, seconds);
+  }
+}
+
+void save(std::ostream &os)
+{
+#if defined(OVXX_ENABLE_THREADING)
+  lock_guard<mutex> lock(table_guard);
+#endif
+  os << "# backend size seconds operation\n";
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision(6);
+  os << std::scientific;
+  for (table_type::const_iterator i = table().begin(); i != table().end(); ++i)
+  {
+    model::points_type const &points = i->second.points();
+    for (std::size_t p = 0; p != points.size(); ++p)
+      os << i->first.second << ' '
+	 << static_cast<length_type>(points[p].first) << ' '
+	 << points[p].second << ' '
+	 << i->first.first << '\n';
+  }
+  os.precision(precision);
+  os.flags(flags);
+}
+
+void clear()
+{
+#if defined(OVXX_ENABLE_THREADING)
+  lock_guard<mutex> lock(table_guard);
+#endif
+  detail::enabled = false;
+  for (table_type::iterator i = table().begin(); i != table().end(); ++i)
+    i->second.clear();
+}
+
+void initialize()
+{
+  if (char const *filename = std::getenv("OVXX_TUNING"))
+    if (*filename) load(filename);
+}
+
+} // namespace ovxx::dispatcher::tuning
+} // namespace ovxx::dispatcher
+} // namespace ovxx
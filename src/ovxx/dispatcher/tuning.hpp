@@ -0,0 +1,200 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_dispatcher_tuning_hpp_
+#define ovxx_dispatcher_tuning_hpp_
+
+#include <ovxx/support.hpp>
+#include <ovxx/profile.hpp>
+#include <iosfwd>
+#include <limits>
+#include <vector>
+#include <utility>
+
+namespace ovxx
+{
+namespace dispatcher
+{
+/// Cost-based backend selection.
+///
+/// By default, the dispatcher uses the first backend in an operation's
+/// list whose runtime check passes.  If a tuning table is loaded, it
+/// instead estimates the cost of every valid backend for which the
+/// table holds measurements, and uses the cheapest one.  (Backends
+/// without measurements are only used if no measured backend is valid,
+/// in list order.)
+///
+/// A tuning table holds, for each (operation, backend) pair, the time
+/// measured for a set of problem sizes, as produced by the `tune`
+/// benchmark.  Costs for other sizes are interpolated (linearly in the
+/// log-log domain).  The problem size is the size of the largest block
+/// argument.
+///
+/// Tables are read from the file named by the OVXX_TUNING environment
+/// variable during library initialization, or may be loaded or built
+/// explicitly.  They must not be modified while operations are being
+/// dispatched.
+namespace tuning
+{
+
+/// The measured cost of an operation performed by a single backend.
+class model
+{
+public:
+  model() : valid_(false) {}
+  bool valid() const { return valid_;}
+  /// Add a measurement of `seconds` for problem size `size`.
+  void add(length_type size, double seconds);
+  void clear() { points_.clear(); valid_ = false;}
+  /// Return the estimated time (in seconds) for problem size `size`.
+  double operator()(length_type size) const;
+
+  typedef std::vector<std::pair<double, double> > points_type;
+  points_type const &points() const { return points_;}
+
+private:
+  points_type points_;
+  bool valid_;
+};
+
+namespace detail
+{
+extern bool enabled;
+} // namespace ovxx::dispatcher::tuning::detail
+
+/// Is cost-based selection enabled ?
+inline bool enabled() { return detail::enabled;}
+
+/// Return the model for `op` performed by `backend`.
+/// The returned reference remains valid (and reflects later changes
+/// to the table) for the lifetime of the program.
+model &find(char const *op, char const *backend);
+
+/// Add a measurement to the table.
+void add(char const *op, char const *backend, length_type size, double seconds);
+
+/// Load measurements from `filename`, adding them to the table.
+void load(char const *filename);
+/// Write the table to `os`, in the format understood by `load()`.
+void save(std::ostream &os);
+
+/// Remove all measurements, disabling cost-based selection.
+void clear();
+
+void initialize();
+
+/// Return the model for operation O performed by backend B.
+template <typename O, typename B>
+model const &lookup()
+{
+  static model const &m = find(profile::name<O>(), profile::name<B>());
+  return m;
+}
+
+/// Consider backend B's function `fn` for operation O on a problem of
+/// size `size`: choose it if no function was chosen yet or if it is
+/// cheaper than the chosen one.
+template <typename O, typename B, typename F>
+void select(length_type size, F fn, F &f, double &cost)
+{
+  model const &m = lookup<O, B>();
+  if (!m.valid())
+  {
+    // Unmeasured backends are only used as a fallback, and are
+    // replaced by any measured one.
+    if (!f)
+    {
+      f = fn;
+      cost = std::numeric_limits<double>::infinity();
+    }
+    return;
+  }
+  double c = m(size);
+  if (!f || c < cost)
+  {
+    f = fn;
+    cost = c;
+  }
+}
+
+/// Return the problem size of an operation.
+template <typename A1>
+length_type size(A1 const &a1)
+{
+  profile::cost c;
+  profile::add_cost(a1, c);
+  return c.size;
+}
+template <typename A1, typename A2>
+length_type size(A1 const &a1, A2 const &a2)
+{
+  profile::cost c;
+  profile::add_cost(a1, c); profile::add_cost(a2, c);
+  return c.size;
+}
+template <typename A1, typename A2, typename A3>
+length_type size(A1 const &a1, A2 const &a2, A3 const &a3)
+{
+  profile::cost c;
+  profile::add_cost(a1, c); profile::add_cost(a2, c); profile::add_cost(a3, c);
+  return c.size;
+}
+template <typename A1, typename A2, typename A3, typename A4>
+length_type size(A1 const &a1, A2 const &a2, A3 const &a3, A4 const &a4)
+{
+  profile::cost c;
+  profile::add_cost(a1, c); profile::add_cost(a2, c); profile::add_cost(a3, c);
+  profile::add_cost(a4, c);
+  return c.size;
+}
+template <typename A1, typename A2, typename A3, typename A4, typename A5>
+length_type size(A1 const &a1, A2 const &a2, A3 const &a3, A4 const &a4,
+		 A5 const &a5)
+{
+  profile::cost c;
+  profile::add_cost(a1, c); profile::add_cost(a2, c); profile::add_cost(a3, c);
+  profile::add_cost(a4, c); profile::add_cost(a5, c);
+  return c.size;
+}
+template <typename A1, typename A2, typename A3, typename A4, typename A5,
+	  typename A6>
+length_type size(A1 const &a1, A2 const &a2, A3 const &a3, A4 const &a4,
+		 A5 const &a5, A6 const &a6)
+{
+  profile::cost c;
+  profile::add_cost(a1, c); profile::add_cost(a2, c); profile::add_cost(a3, c);
+  profile::add_cost(a4, c); profile::add_cost(a5, c); profile::add_cost(a6, c);
+  return c.size;
+}
+template <typename A1, typename A2, typename A3, typename A4, typename A5,
+	  typename A6, typename A7>
+length_type size(A1 const &a1, A2 const &a2, A3 const &a3, A4 const &a4,
+		 A5 const &a5, A6 const &a6, A7 const &a7)
+{
+  profile::cost c;
+  profile::add_cost(a1, c); profile::add_cost(a2, c); profile::add_cost(a3, c);
+  profile::add_cost(a4, c); profile::add_cost(a5, c); profile::add_cost(a6, c);
+  profile::add_cost(a7, c);
+  return c.size;
+}
+template <typename A1, typename A2, typename A3, typename A4, typename A5,
+	  typename A6, typename A7, typename A8>
+length_type size(A1 const &a1, A2 const &a2, A3 const &a3, A4 const &a4,
+		 A5 const &a5, A6 const &a6, A7 const &a7, A8 const &a8)
+{
+  profile::cost c;
+  profile::add_cost(a1, c); profile::add_cost(a2, c); profile::add_cost(a3, c);
+  profile::add_cost(a4, c); profile::add_cost(a5, c); profile::add_cost(a6, c);
+  profile::add_cost(a7, c); profile::add_cost(a8, c);
+  return c.size;
+}
+
+} // namespace ovxx::dispatcher::tuning
+} // namespace ovxx::dispatcher
+} // namespace ovxx
+
+#endif
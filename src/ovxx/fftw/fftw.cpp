@@ -295,6 +295,7 @@ public:
     : planner<1, ctype, ctype>
       (dom, exponent<ctype, ctype, S>::value, make_flags<ctype>(dom, number))
   {}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<1> &inout)
   {
     inout.packing = this->aligned_ ? aligned : dense;
@@ -366,6 +367,7 @@ public:
   fft(Domain<1> const &dom, unsigned number)
     : planner<1, rtype, ctype>(dom, 0, make_flags<rtype>(dom, number))
   {}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<1> &in, Rt_layout<1> &out)
   {
     in.packing = this->aligned_ ? aligned : dense;
@@ -408,6 +410,7 @@ public:
   fft(Domain<1> const &dom, unsigned number)
     : planner<1, ctype, rtype>(dom, 0, make_flags<rtype>(dom, number))
   {}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<1> &in, Rt_layout<1> &out)
   {
     in.packing = this->aligned_ ? aligned : dense;
@@ -449,6 +452,7 @@ public:
     : planner<2, ctype, ctype>
       (dom, exponent<ctype, ctype, S>::value, make_flags(number))
   {}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &inout)
   {
     inout.packing = this->aligned_ ? aligned : dense;
@@ -525,6 +529,7 @@ public:
   fft(Domain<2> const &dom, unsigned number)
     : planner<2, rtype, ctype>(dom, A, make_flags(number))
   {}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &in, Rt_layout<2> &out)
   {
     in.packing = this->aligned_ ? aligned : dense;
@@ -570,6 +575,7 @@ public:
   fft(Domain<2> const &dom, unsigned number)
     : planner<2, ctype, rtype>(dom, A, make_flags(number, false))
   {}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &in, Rt_layout<2> &out)
   {
     in.packing = this->aligned_ ? aligned : dense;
@@ -614,6 +620,7 @@ public:
   fft(Domain<3> const &dom, unsigned number)
     : planner<3, ctype, ctype>(dom, exponent<ctype, ctype, S>::value, make_flags(number))
   {}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<3> &inout)
   {
     inout.packing = this->aligned_ ? aligned : dense;
@@ -691,6 +698,7 @@ public:
   fft(Domain<3> const &dom, unsigned number)
     : planner<3, rtype, ctype>(dom, A, make_flags(number))
   {}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<3> &in, Rt_layout<3> &out)
   {
     in.packing = this->aligned_ ? aligned : dense;
@@ -738,6 +746,7 @@ public:
   fft(Domain<3> const &dom, unsigned number)
     : planner<3, ctype, rtype>(dom, A, make_flags(number, false))
   {}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<3> &in, Rt_layout<3> &out)
   {
     in.packing = this->aligned_ ? aligned : dense;
@@ -791,6 +800,7 @@ public:
 			       dom[1 - axis].length())
   {
   }
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &in, Rt_layout<2> &out)
   {
     in.packing = this->aligned_ ? aligned : dense;
@@ -857,6 +867,7 @@ public:
     : planner<1, ctype, rtype>(dom[axis], 0, make_flags<rtype>(dom[axis], number), dom[1-axis].length())
   {
   }
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &in, Rt_layout<2> &out)
   {
     in.packing = this->aligned_ ? aligned : dense;
@@ -917,6 +928,7 @@ public:
     : planner<1, ctype, ctype>
       (dom[axis], exponent<ctype, ctype, D>::value, make_flags<ctype>(dom[axis], number), dom[1-axis].size())
   {}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &inout)
   {
     inout.packing = this->aligned_ ? aligned : dense;
@@ -0,0 +1,251 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_io_async_writer_hpp_
+#define ovxx_io_async_writer_hpp_
+
+#include <ovxx/support.hpp>
+#include <ovxx/view.hpp>
+#include <ovxx/aligned_array.hpp>
+#include <ovxx/c++11/thread.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/tensor.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+
+namespace ovxx
+{
+namespace io
+{
+
+/// Write frames to a sink from a dedicated thread, so that a
+/// processing loop doesn't block on I/O.
+///
+/// The writer owns a fixed number of pre-allocated frame buffers
+/// (three by default, for triple-buffering).  A frame is either
+/// produced directly into a buffer obtained from acquire() and
+/// handed over with commit(), or copied into one by write().
+/// The sink may be any object providing `append(V)` for views of the
+/// frame type, such as hdf5::dataset or raw::writer. It is called
+/// from the writer thread only, and needs to outlive the writer.
+///
+/// If the sink can't keep up, all buffers eventually fill up:
+/// acquire() and write() then block, while try_write() drops the
+/// frame and counts an overrun.  An exception thrown by the sink
+/// is reported to the producer by the next call to any of these
+/// functions, or by flush().
+template <typename T, dimension_type D = 1>
+class async_writer : ovxx::detail::noncopyable
+{
+  typedef Dense<D, T> block_type;
+
+public:
+  typedef typename view_of<block_type>::type view_type;
+  typedef typename view_of<block_type>::const_type const_view_type;
+
+  template <typename S>
+  async_writer(S &sink, Domain<D> const &frame, length_type buffers = 3)
+    : sink_(new sink_wrapper<S>(sink)),
+      acquired_(-1),
+      overruns_(0),
+      done_(false)
+  {
+    OVXX_PRECONDITION(buffers > 0);
+    for (index_type i = 0; i != buffers; ++i)
+    {
+      slot s;
+      s.data = alloc_align<T>(OVXX_ALLOC_ALIGNMENT, frame.size());
+      // The producer and the writer thread use separate blocks, so
+      // their reference counts are never touched concurrently.
+      s.in = new block_type(frame, s.data);
+      s.out = new block_type(frame, s.data);
+      slots_.push_back(s);
+      free_.push_back(i);
+    }
+    thread_.reset(new thread(runner(this)));
+  }
+  /// Write all pending frames, then stop the writer thread.
+  ~async_writer()
+  {
+    {
+      lock_guard<mutex> lock(mutex_);
+      done_ = true;
+    }
+    pending_cond_.notify_one();
+    thread_->join();
+    for (index_type i = 0; i != slots_.size(); ++i)
+    {
+      slots_[i].in->decrement_count();
+      slots_[i].out->decrement_count();
+      free_align(slots_[i].data);
+    }
+  }
+
+  /// Return an unused frame buffer to produce the next frame in,
+  /// waiting for one to become available if necessary.
+  view_type acquire()
+  {
+    OVXX_PRECONDITION(acquired_ < 0);
+    unique_lock<mutex> lock(mutex_);
+    while (free_.empty() && error_.empty()) free_cond_.wait(lock);
+    check_error();
+    acquired_ = free_.front();
+    free_.pop_front();
+    lock.unlock();
+    block_type *block = slots_[acquired_].in;
+    block->admit(false);
+    return view_type(*block);
+  }
+  /// Queue the frame buffer returned by the last call to acquire()
+  /// for writing.  The buffer must not be used any more afterwards.
+  void commit()
+  {
+    OVXX_PRECONDITION(acquired_ >= 0);
+    slots_[acquired_].in->release(true);
+    {
+      lock_guard<mutex> lock(mutex_);
+      pending_.push_back(acquired_);
+    }
+    acquired_ = -1;
+    pending_cond_.notify_one();
+  }
+  /// Queue a copy of `frame` for writing, waiting for a buffer to
+  /// become available if necessary.
+  template <typename V>
+  void write(V frame)
+  {
+    acquire() = frame;
+    commit();
+  }
+  /// Queue a copy of `frame` for writing if a buffer is available.
+  /// Otherwise, drop the frame and return false.
+  template <typename V>
+  bool try_write(V frame)
+  {
+    {
+      lock_guard<mutex> lock(mutex_);
+      check_error();
+      if (free_.empty())
+      {
+	++overruns_;
+	return false;
+      }
+    }
+    // Only the producer takes buffers, so this won't block.
+    write(frame);
+    return true;
+  }
+  /// Wait until all queued frames have been written.
+  void flush()
+  {
+    unique_lock<mutex> lock(mutex_);
+    while (!pending_.empty() && error_.empty()) free_cond_.wait(lock);
+    check_error();
+  }
+
+  /// Return the number of frames waiting to be written.
+  length_type pending() const
+  {
+    lock_guard<mutex> lock(mutex_);
+    return pending_.size();
+  }
+  /// Return the number of frames dropped by try_write().
+  length_type overruns() const
+  {
+    lock_guard<mutex> lock(mutex_);
+    return overruns_;
+  }
+
+private:
+  struct sink_base
+  {
+    virtual ~sink_base() {}
+    virtual void append(const_view_type) = 0;
+  };
+  template <typename S>
+  struct sink_wrapper : sink_base
+  {
+    sink_wrapper(S &s) : sink(s) {}
+    virtual void append(const_view_type v) { sink.append(v);}
+    S &sink;
+  };
+  struct runner
+  {
+    runner(async_writer *w) : writer(w) {}
+    void operator()() { writer->run();}
+    async_writer *writer;
+  };
+  struct slot
+  {
+    T *data;
+    block_type *in;
+    block_type *out;
+  };
+
+  // Must be called with the mutex locked.
+  void check_error()
+  {
+    if (!error_.empty())
+    {
+      std::string error = error_;
+      error_.clear();
+      OVXX_DO_THROW(std::runtime_error(error));
+    }
+  }
+
+  void run()
+  {
+    unique_lock<mutex> lock(mutex_);
+    while (true)
+    {
+      while (pending_.empty() && !done_) pending_cond_.wait(lock);
+      if (pending_.empty()) return;
+      block_type *block = slots_[pending_.front()].out;
+      lock.unlock();
+      block->admit(true);
+#if OVXX_HAS_EXCEPTIONS
+      try { sink_->append(const_view_type(*block));}
+      catch (std::exception &e)
+      {
+	lock.lock();
+	error_ = e.what();
+	lock.unlock();
+      }
+#else
+      sink_->append(const_view_type(*block));
+#endif
+      block->release(false);
+      lock.lock();
+      free_.push_back(pending_.front());
+      pending_.pop_front();
+      free_cond_.notify_all();
+    }
+  }
+
+  std::auto_ptr<sink_base> sink_;
+  std::vector<slot> slots_;
+  std::deque<index_type> free_;
+  std::deque<index_type> pending_;
+  stride_type acquired_;
+  length_type overruns_;
+  std::string error_;
+  bool done_;
+  mutable mutex mutex_;
+  condition_variable free_cond_;
+  condition_variable pending_cond_;
+  std::auto_ptr<thread> thread_;
+};
+
+} // namespace ovxx::io
+} // namespace ovxx
+
+#endif
@@ -18,6 +18,8 @@
 
 #include <ovxx/dda.hpp>
 #include <ovxx/view.hpp>
+#include <ovxx/length.hpp>
+#include <ovxx/detail/noncopyable.hpp>
 #include <stdexcept>
 #include <hdf5.h>
 
@@ -88,13 +90,69 @@ class exception : public std::runtime_error
   exception(std::string const &error) : std::runtime_error(error) {}
 };
 
+/// Parameters of the chunk cache used to access a chunked dataset
+/// (see H5Pset_chunk_cache).  The cache should be large enough to hold
+/// all chunks touched by a single read or write.
+struct chunk_cache
+{
+  chunk_cache(size_t b = 1024*1024, size_t s = 521, double p = 0.75)
+    : bytes(b), slots(s), w0(p) {}
+
+  /// The total size of the cache, in bytes.
+  size_t bytes;
+  /// The number of hash table slots; ideally a prime, much
+  /// larger than the number of chunks that fit into the cache.
+  size_t slots;
+  /// The preemption policy: 0 evicts least recently used chunks first,
+  /// 1 evicts chunks that have been fully read or written first.
+  double w0;
+};
+
+namespace detail
+{
+inline hid_t access_plist(chunk_cache const &cache)
+{
+  hid_t plist = H5Pcreate(H5P_DATASET_ACCESS);
+  H5Pset_chunk_cache(plist, cache.slots, cache.bytes, cache.w0);
+  return plist;
+}
+
+/// Close a property list when going out of scope.
+class plist_guard : ovxx::detail::noncopyable
+{
+public:
+  explicit plist_guard(hid_t plist) : plist_(plist) {}
+  ~plist_guard() { H5Pclose(plist_);}
+  hid_t get() const { return plist_;}
+private:
+  hid_t plist_;
+};
+} // namespace ovxx::hdf5::detail
+
 class file;
 
 class dataset
 {
   friend class file;
 public:
-  ~dataset() { if (impl_) H5Dclose (impl_);}
+  /// Copies refer to the same dataset, which is closed with the last one.
+  dataset(dataset const &other)
+    : create_(other.create_), impl_(other.impl_),
+      file_(other.file_), name_(other.name_)
+  {
+    if (impl_ > 0) H5Iinc_ref(impl_);
+  }
+  dataset &operator=(dataset const &other)
+  {
+    if (other.impl_ > 0) H5Iinc_ref(other.impl_);
+    if (impl_ > 0) H5Dclose(impl_);
+    create_ = other.create_;
+    impl_ = other.impl_;
+    file_ = other.file_;
+    name_ = other.name_;
+    return *this;
+  }
+  ~dataset() { if (impl_ > 0) H5Dclose (impl_);}
 
   dimension_type query_dimensionality()
   {
@@ -138,6 +196,64 @@ public:
 			    H5S_ALL, H5S_ALL, H5P_DEFAULT, data.ptr());
   }
 
+  /// Read the subdomain `sub` of this dataset into `v`. `v` needs
+  /// to have as many elements as `sub`, but not necessarily the same
+  /// dimensionality, so for example a single row of a two-dimensional
+  /// dataset may be read into a vector.
+  template <dimension_type D,
+	    template <typename, typename> class V, typename T, typename B>
+  void read(V<T, B> v, Domain<D> const &sub)
+  {
+    OVXX_PRECONDITION(impl_);
+    hsize_t start[D], stride[D], count[D];
+    slab(sub, start, stride, count);
+    transfer(v, D, start, stride, count, false);
+  }
+
+  /// Write `v` into the subdomain `sub` of this (existing) dataset.
+  template <dimension_type D,
+	    template <typename, typename> class V, typename T, typename B>
+  void write(V<T, B> v, Domain<D> const &sub)
+  {
+    OVXX_PRECONDITION(impl_);
+    hsize_t start[D], stride[D], count[D];
+    slab(sub, start, stride, count);
+    transfer(v, D, start, stride, count, true);
+  }
+
+  /// Append `v` to this (extensible) dataset, growing it along its
+  /// first dimension.  `v` either has the same dimensionality as the
+  /// dataset, or one less, in which case it is appended as a single
+  /// frame (such as a row to a two-dimensional dataset).
+  template <template <typename, typename> class V, typename T, typename B>
+  void append(V<T, B> v)
+  {
+    OVXX_PRECONDITION(impl_);
+    dimension_type const dim = V<T, B>::dim;
+    hsize_t dims[3];
+    hid_t space = H5Dget_space(impl_);
+    int rank = H5Sget_simple_extent_dims(space, dims, 0);
+    H5Sclose(space);
+    if (rank != static_cast<int>(dim) && rank != static_cast<int>(dim) + 1)
+      OVXX_DO_THROW(exception("incompatible dimensionality"));
+
+    int offset = rank - dim;
+    hsize_t start[3] = { dims[0], 0, 0};
+    hsize_t stride[3] = { 1, 1, 1};
+    hsize_t count[3];
+    count[0] = offset ? 1 : v.size(0);
+    for (int d = 1; d < rank; ++d)
+    {
+      count[d] = v.size(d - offset);
+      if (count[d] != dims[d])
+	OVXX_DO_THROW(exception("incompatible dimensions"));
+    }
+    dims[0] += count[0];
+    if (H5Dset_extent(impl_, dims) < 0)
+      OVXX_DO_THROW(exception("unable to extend dataset '" + name_ + "'"));
+    transfer(v, rank, start, stride, count, true);
+  }
+
   template <template <typename, typename> class V, typename T, typename B>
   void write(V<T, B> v)
   {
@@ -160,16 +276,83 @@ public:
   }
 
 private:
-  dataset(hid_t file, std::string const &name, bool create = false)
+  dataset(hid_t file, std::string const &name, bool create = false,
+	  hid_t access = H5P_DEFAULT)
     : create_(create), impl_(0), file_(file), name_(name)
   {
     if (!create)
     {
-      impl_ = H5Dopen(file, name.c_str(), H5P_DEFAULT);
+      impl_ = H5Dopen(file, name.c_str(), access);
       if (impl_ < 0)
 	OVXX_DO_THROW(exception("No dataset '" + name + "'"));
     }
   }
+  dataset(hid_t file, std::string const &name, hid_t impl)
+    : create_(true), impl_(impl), file_(file), name_(name)
+  {
+    if (impl_ < 0)
+      OVXX_DO_THROW(exception("Unable to create dataset '" + name + "'"));
+  }
+
+  template <dimension_type D>
+  static void slab(Domain<D> const &sub,
+		   hsize_t *start, hsize_t *stride, hsize_t *count)
+  {
+    for (dimension_type d = 0; d != D; ++d)
+    {
+      OVXX_PRECONDITION(sub[d].stride() > 0);
+      start[d] = sub[d].first();
+      stride[d] = sub[d].stride();
+      count[d] = sub[d].length();
+    }
+  }
+
+  // Transfer the data of `v` to (or from) the given hyperslab of
+  // the dataset, without any intermediate copies if `v` is dense.
+  template <template <typename, typename> class V, typename T, typename B>
+  void transfer(V<T, B> v, int rank, hsize_t const *start,
+		hsize_t const *stride, hsize_t const *count, bool write)
+  {
+    dimension_type const dim = V<T, B>::dim;
+    hid_t fspace = H5Dget_space(impl_);
+    if (H5Sget_simple_extent_ndims(fspace) != rank)
+    {
+      H5Sclose(fspace);
+      OVXX_DO_THROW(exception("incompatible dimensionality"));
+    }
+    hsize_t size = 1;
+    for (int d = 0; d != rank; ++d) size *= count[d];
+    if (size != v.size())
+    {
+      H5Sclose(fspace);
+      OVXX_DO_THROW(exception("incompatible dimensions"));
+    }
+    H5Sselect_hyperslab(fspace, H5S_SELECT_SET, start, stride, count, 0);
+    hsize_t dims[dim];
+    for (dimension_type d = 0; d != dim; ++d) dims[d] = v.size(d);
+    hid_t mspace = H5Screate_simple(dim, dims, 0);
+
+    typedef Layout<dim, tuple<0,1,2>, dense> layout_type;
+    herr_t status;
+    if (write)
+    {
+      vsip::dda::Data<B, vsip::dda::in, layout_type> data(v.block());
+      status = H5Dwrite(impl_, traits<T>::type(), mspace, fspace,
+			H5P_DEFAULT, data.ptr());
+    }
+    else
+    {
+      ovxx::dda::Data<B, ovxx::dda::out, layout_type> data(v.block());
+      status = H5Dread(impl_, traits<T>::type(), mspace, fspace,
+		       H5P_DEFAULT, data.ptr());
+    }
+    H5Sclose(mspace);
+    H5Sclose(fspace);
+    if (status < 0)
+      OVXX_DO_THROW(exception(std::string(write ? "writing" : "reading") +
+			      " dataset '" + name_ + "' failed"));
+  }
+
   bool create_;
   hid_t impl_; // Note: HDF5 takes care of reference counting these...
   hid_t file_; // remember only for post-poned creation during write.
@@ -179,10 +362,14 @@ private:
 class file : ovxx::detail::noncopyable
 {
 public:
+  /// Open file `name` for reading ('r'), for reading and
+  /// writing ('a'), or create it, truncating any existing file ('w').
   file(std::string const &name, char mode)
   {
     if (mode == 'r')
       impl_ = H5Fopen(name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    else if (mode == 'a')
+      impl_ = H5Fopen(name.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
     else
       impl_ = H5Fcreate(name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
     if (impl_ < 0)
@@ -193,8 +380,44 @@ public:
   { return H5Fis_hdf5(name.c_str()) > 0;}
   dataset open_dataset(std::string const &name)
   { return dataset(impl_, name);}
+  /// Open a (chunked) dataset, using the given chunk cache.
+  dataset open_dataset(std::string const &name, chunk_cache const &cache)
+  {
+    detail::plist_guard access(detail::access_plist(cache));
+    return dataset(impl_, name, false, access.get());
+  }
   dataset create_dataset(std::string const &name)
   { return dataset(impl_, name, true);}
+
+  /// Create a chunked dataset of value-type `T`, with the given
+  /// initial extent, stored in chunks of extent `chunk`.
+  /// If `extensible` is true, the dataset may grow without bounds
+  /// along its first dimension, for example using dataset::append().
+  template <typename T, dimension_type D>
+  dataset create_dataset(std::string const &name,
+			 Length<D> const &extent, Length<D> const &chunk,
+			 bool extensible = true,
+			 chunk_cache const &cache = chunk_cache())
+  {
+    hsize_t dims[D], max_dims[D], chunk_dims[D];
+    for (dimension_type d = 0; d != D; ++d)
+    {
+      OVXX_PRECONDITION(chunk[d] > 0);
+      dims[d] = max_dims[d] = extent[d];
+      chunk_dims[d] = chunk[d];
+    }
+    if (extensible) max_dims[0] = H5S_UNLIMITED;
+    hid_t space = H5Screate_simple(D, dims, max_dims);
+    hid_t create = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(create, D, chunk_dims);
+    hid_t access = detail::access_plist(cache);
+    hid_t impl = H5Dcreate(impl_, name.c_str(), traits<T>::type(), space,
+			   H5P_DEFAULT, create, access);
+    H5Pclose(access);
+    H5Pclose(create);
+    H5Sclose(space);
+    return dataset(impl_, name, impl);
+  }
   
 private:
   hid_t impl_;
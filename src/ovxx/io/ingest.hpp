@@ -0,0 +1,229 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+// Convert raw integer sample data (as delivered by sensors, in
+// either byte order) to floating-point views in a single pass:
+// swap bytes, convert, scale, and (for IQ data) de-interleave into
+// the storage format of the target block.
+
+#ifndef ovxx_io_ingest_hpp_
+#define ovxx_io_ingest_hpp_
+
+#include <ovxx/support.hpp>
+#include <ovxx/dda.hpp>
+#include <ovxx/byteswap.hpp>
+#include <ovxx/inttypes.hpp>
+#include <vsip/vector.hpp>
+#include <utility>
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+namespace ovxx
+{
+namespace io
+{
+namespace detail
+{
+
+template <typename I>
+inline float value(I v, bool swap)
+{
+  byteswap(v, swap);
+  return static_cast<float>(v);
+}
+
+/// Generic conversion kernels.
+/// `interleaved` converts `size` values to `out`.
+/// `split` converts `size` IQ pairs to `real` and `imag`.
+template <typename I>
+struct generic_kernel
+{
+  static void interleaved(I const *in, length_type size, float scale,
+			  bool swap, float *out)
+  {
+    for (index_type i = 0; i != size; ++i)
+      out[i] = scale * value(in[i], swap);
+  }
+  static void split(I const *in, length_type size, float scale, bool swap,
+		    float *real, float *imag)
+  {
+    for (index_type i = 0; i != size; ++i)
+    {
+      real[i] = scale * value(in[2*i], swap);
+      imag[i] = scale * value(in[2*i+1], swap);
+    }
+  }
+};
+
+template <typename I>
+struct ingest_kernel : generic_kernel<I> {};
+
+#if defined(__SSE2__)
+inline __m128i swap_epi16(__m128i x)
+{ return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));}
+
+inline __m128i swap_epi32(__m128i x)
+{
+  x = swap_epi16(x);
+  return _mm_or_si128(_mm_slli_epi32(x, 16), _mm_srli_epi32(x, 16));
+}
+
+template <>
+struct ingest_kernel<int16_type>
+{
+  static void interleaved(int16_type const *in, length_type size, float scale,
+			  bool swap, float *out)
+  {
+    __m128 s = _mm_set1_ps(scale);
+    index_type i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+      if (swap) x = swap_epi16(x);
+      // Sign-extend to 32 bits.
+      __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+      __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+      _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), s));
+      _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), s));
+    }
+    generic_kernel<int16_type>::interleaved(in + i, size - i, scale, swap,
+					    out + i);
+  }
+  static void split(int16_type const *in, length_type size, float scale,
+		    bool swap, float *real, float *imag)
+  {
+    __m128 s = _mm_set1_ps(scale);
+    index_type i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + 2*i));
+      if (swap) x = swap_epi16(x);
+      // Each 32-bit lane holds an IQ pair, I in the lower half.
+      __m128i r = _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+      __m128i q = _mm_srai_epi32(x, 16);
+      _mm_storeu_ps(real + i, _mm_mul_ps(_mm_cvtepi32_ps(r), s));
+      _mm_storeu_ps(imag + i, _mm_mul_ps(_mm_cvtepi32_ps(q), s));
+    }
+    generic_kernel<int16_type>::split(in + 2*i, size - i, scale, swap,
+				      real + i, imag + i);
+  }
+};
+
+template <>
+struct ingest_kernel<int32_type>
+{
+  static void interleaved(int32_type const *in, length_type size, float scale,
+			  bool swap, float *out)
+  {
+    __m128 s = _mm_set1_ps(scale);
+    index_type i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+      if (swap) x = swap_epi32(x);
+      _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(x), s));
+    }
+    generic_kernel<int32_type>::interleaved(in + i, size - i, scale, swap,
+					    out + i);
+  }
+  static void split(int32_type const *in, length_type size, float scale,
+		    bool swap, float *real, float *imag)
+  {
+    __m128 s = _mm_set1_ps(scale);
+    index_type i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + 2*i));
+      __m128i y = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + 2*i + 4));
+      if (swap)
+      {
+	x = swap_epi32(x);
+	y = swap_epi32(y);
+      }
+      __m128 a = _mm_cvtepi32_ps(x);
+      __m128 b = _mm_cvtepi32_ps(y);
+      __m128 r = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+      __m128 q = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+      _mm_storeu_ps(real + i, _mm_mul_ps(r, s));
+      _mm_storeu_ps(imag + i, _mm_mul_ps(q, s));
+    }
+    generic_kernel<int32_type>::split(in + 2*i, size - i, scale, swap,
+				      real + i, imag + i);
+  }
+};
+#endif
+
+// Dispatch on the pointer type of the target storage.
+template <typename I>
+void ingest_iq(I const *in, length_type size, float scale, bool swap,
+	       complex<float> *out)
+{
+  ingest_kernel<I>::interleaved(in, 2 * size, scale, swap,
+				reinterpret_cast<float*>(out));
+}
+
+template <typename I>
+void ingest_iq(I const *in, length_type size, float scale, bool swap,
+	       float *out)
+{
+  ingest_kernel<I>::interleaved(in, 2 * size, scale, swap, out);
+}
+
+template <typename I>
+void ingest_iq(I const *in, length_type size, float scale, bool swap,
+	       std::pair<float*, float*> const &out)
+{
+  ingest_kernel<I>::split(in, size, scale, swap, out.first, out.second);
+}
+
+template <typename B>
+struct ingest_layout
+{
+  static storage_format_type const format =
+    get_block_layout<B>::storage_format == split_complex ? split_complex :
+    get_block_layout<B>::storage_format == interleaved_complex ?
+    interleaved_complex : array;
+  typedef Layout<1, row1_type, unit_stride, format> type;
+};
+
+} // namespace ovxx::io::detail
+
+/// Convert `out.size()` samples of integral type `I` (such as
+/// int16_type or int32_type), starting at `in`, to float, and
+/// multiply them by `scale`.  `big_endian` is the byte order of the
+/// input.
+template <typename I, typename B>
+void ingest(I const *in, Vector<float, B> out, float scale = 1.f,
+	    bool big_endian = is_big_endian)
+{
+  typedef typename detail::ingest_layout<B>::type layout_type;
+  vsip::dda::Data<B, vsip::dda::out, layout_type> data(out.block());
+  detail::ingest_kernel<I>::interleaved(in, out.size(), scale,
+					big_endian != is_big_endian,
+					data.ptr());
+}
+
+/// Convert `out.size()` interleaved IQ pairs of integral type `I`,
+/// starting at `in`, to complex<float>, and multiply them by
+/// `scale`.  `big_endian` is the byte order of the input.
+/// Data are written directly in the storage format of `out`,
+/// so split-complex blocks don't need a separate de-interleave pass.
+template <typename I, typename B>
+void ingest(I const *in, Vector<complex<float>, B> out, float scale = 1.f,
+	    bool big_endian = is_big_endian)
+{
+  typedef typename detail::ingest_layout<B>::type layout_type;
+  vsip::dda::Data<B, vsip::dda::out, layout_type> data(out.block());
+  detail::ingest_iq(in, out.size(), scale, big_endian != is_big_endian,
+		    data.ptr());
+}
+
+} // namespace ovxx::io
+} // namespace ovxx
+
+#endif
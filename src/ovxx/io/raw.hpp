@@ -0,0 +1,281 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+// A minimal self-describing binary container.  A file starts with a
+// header identifying the format and the byte order it was written
+// in, followed by a sequence of records.  Each record consists of a
+// vsip::serialization::Descriptor, followed by the data it describes,
+// stored densely in row-major order, starting at the next multiple
+// of `raw::alignment` bytes from the start of the file.
+
+#ifndef ovxx_io_raw_hpp_
+#define ovxx_io_raw_hpp_
+
+#include <ovxx/dda.hpp>
+#include <ovxx/view.hpp>
+#include <ovxx/byteswap.hpp>
+#include <ovxx/domain_utils.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#include <vsip/serialization.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/tensor.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ovxx
+{
+namespace raw
+{
+
+/// The alignment of data in a file, in bytes.
+length_type const alignment = 64;
+
+class exception : public std::runtime_error
+{
+ public:
+  exception(std::string const &error) : std::runtime_error(error) {}
+};
+
+namespace detail
+{
+struct header
+{
+  char magic[4];
+  uint32_type byte_order;
+  uint32_type version;
+  uint32_type reserved;
+};
+
+inline header make_header()
+{
+  header h;
+  std::memcpy(h.magic, "OVXX", 4);
+  h.byte_order = 0x01020304;
+  h.version = 1;
+  h.reserved = 0;
+  return h;
+}
+
+inline length_type align(length_type offset)
+{ return (offset + alignment - 1) / alignment * alignment;}
+
+/// Return the size in bytes of a value of the given type.
+inline length_type value_size(uint64_type value_type)
+{
+  using namespace vsip::serialization;
+  if (serialization::impl::is_integral(value_type))
+    return serialization::impl::size(value_type);
+  switch (value_type)
+  {
+    case type_info<bool>::value: return sizeof(bool);
+    case type_info<char>::value: return sizeof(char);
+    case type_info<float>::value: return sizeof(float);
+    case type_info<complex<float> >::value: return sizeof(complex<float>);
+    case type_info<double>::value: return sizeof(double);
+    case type_info<complex<double> >::value: return sizeof(complex<double>);
+    default: return 0;
+  }
+}
+
+inline void byteswap(serialization::Descriptor &info)
+{
+  ovxx::byteswap<true>(info.value_type);
+  for (int i = 0; i != 3; ++i)
+  {
+    ovxx::byteswap<true>(info.size[i]);
+    ovxx::byteswap<true>(info.stride[i]);
+  }
+  ovxx::byteswap<true>(info.storage_size);
+}
+} // namespace ovxx::raw::detail
+
+/// Write views to a file, one record per view.
+class writer : ovxx::detail::noncopyable
+{
+public:
+  /// Create file `name`, or append to it if `append` is true.
+  writer(std::string const &name, bool append = false)
+    : name_(name), file_(std::fopen(name.c_str(), append ? "ab" : "wb"))
+  {
+    if (!file_)
+      OVXX_DO_THROW(exception("Unable to open file '" + name + "'"));
+    std::fseek(file_, 0, SEEK_END);
+    offset_ = std::ftell(file_);
+    if (offset_ == 0)
+    {
+      detail::header h = detail::make_header();
+      put(&h, sizeof(h));
+    }
+  }
+  ~writer() { std::fclose(file_);}
+
+  /// Append `v` as a new record.
+  template <template <typename, typename> class V, typename T, typename B>
+  void append(V<T, B> v)
+  {
+    dimension_type const dim = V<T, B>::dim;
+    typedef Layout<dim, tuple<0,1,2>, dense, array> layout_type;
+    vsip::dda::Data<B, vsip::dda::in, layout_type> data(v.block());
+    serialization::Descriptor info;
+    std::memset(&info, 0, sizeof(info));
+    serialization::describe_data(data, info);
+    put(&info, sizeof(info));
+    char const padding[alignment] = {};
+    put(padding, detail::align(offset_) - offset_);
+    put(data.ptr(), v.size() * sizeof(T));
+  }
+
+  void flush() { std::fflush(file_);}
+
+private:
+  void put(void const *data, length_type size)
+  {
+    if (std::fwrite(data, 1, size, file_) != size)
+      OVXX_DO_THROW(exception("writing to '" + name_ + "' failed"));
+    offset_ += size;
+  }
+
+  std::string name_;
+  std::FILE *file_;
+  length_type offset_;
+};
+
+/// Provide access to the records of a file by mapping it into memory.
+///
+/// Views returned by the reader refer to the mapped data directly,
+/// so opening even a large file is cheap, and data are only paged in
+/// once they are accessed.  If the file was written on a machine of
+/// different byte order, each record's data is swapped the first time
+/// a view of it is requested.  (This only affects the private mapping,
+/// not the file.)  The reader needs to outlive the views it returns.
+class reader : ovxx::detail::noncopyable
+{
+public:
+  reader(std::string const &name)
+    : name_(name), data_(0), size_(0), swap_(false)
+  {
+    int fd = open(name.c_str(), O_RDONLY);
+    if (fd < 0)
+      OVXX_DO_THROW(exception("Unable to open file '" + name + "'"));
+    struct stat st;
+    if (fstat(fd, &st) == 0) size_ = st.st_size;
+    if (size_ < sizeof(detail::header))
+    {
+      close(fd);
+      OVXX_DO_THROW(exception("'" + name + "' is not a raw file"));
+    }
+    detail::header h;
+    if (::read(fd, &h, sizeof(h)) != sizeof(h) ||
+	std::memcmp(h.magic, "OVXX", 4) != 0 ||
+	(h.byte_order != 0x01020304 && h.byte_order != 0x04030201))
+    {
+      close(fd);
+      OVXX_DO_THROW(exception("'" + name + "' is not a raw file"));
+    }
+    swap_ = h.byte_order != 0x01020304;
+    // Foreign data are swapped in place, so the mapping needs to be
+    // writable.  As it is private, the file is never modified.
+    int prot = swap_ ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *data = mmap(0, size_, prot, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+      OVXX_DO_THROW(exception("Unable to map file '" + name + "'"));
+    data_ = static_cast<char*>(data);
+    scan();
+  }
+  ~reader() { munmap(data_, size_);}
+
+  /// Return the number of records in the file.
+  length_type size() const { return records_.size();}
+  /// Return the descriptor of the `i`th record, in native byte order.
+  serialization::Descriptor const &descriptor(index_type i) const
+  { return records_.at(i).info;}
+  /// Report whether the file was written in foreign byte order.
+  bool swapped() const { return swap_;}
+
+  /// Return a view of the `i`th record.  Throw an exception if
+  /// the record doesn't hold a vector (matrix, tensor) of `T`.
+  template <typename T>
+  const_Vector<T> vector(index_type i) { return view<T, 1>(i);}
+  template <typename T>
+  const_Matrix<T> matrix(index_type i) { return view<T, 2>(i);}
+  template <typename T>
+  const_Tensor<T> tensor(index_type i) { return view<T, 3>(i);}
+
+private:
+  struct record
+  {
+    serialization::Descriptor info;
+    length_type offset;
+    bool native; // whether the data are in native byte order
+  };
+
+  void scan()
+  {
+    length_type offset = sizeof(detail::header);
+    while (offset < size_)
+    {
+      record r;
+      if (offset + sizeof(r.info) > size_) corrupt();
+      std::memcpy(&r.info, data_ + offset, sizeof(r.info));
+      if (swap_) detail::byteswap(r.info);
+      length_type value_size = detail::value_size(r.info.value_type);
+      if (!value_size || r.info.dimensions < 1 || r.info.dimensions > 3)
+	corrupt();
+      r.offset = detail::align(offset + sizeof(r.info));
+      r.native = !swap_;
+      offset = r.offset + r.info.storage_size * value_size;
+      if (offset > size_) corrupt();
+      records_.push_back(r);
+    }
+  }
+
+  void corrupt() const
+  { OVXX_DO_THROW(exception("'" + name_ + "' is corrupt"));}
+
+  template <typename T, dimension_type D>
+  typename view_of<Dense<D, T> >::const_type view(index_type i)
+  {
+    typedef Dense<D, T> block_type;
+    record &r = records_.at(i);
+    if (!serialization::is_compatible<block_type>(r.info))
+      OVXX_DO_THROW(exception("incompatible record"));
+    T *data = reinterpret_cast<T*>(data_ + r.offset);
+    if (!r.native)
+    {
+      byteswap_n(data, r.info.storage_size);
+      r.native = true;
+    }
+    Domain<1> dom[D];
+    for (dimension_type d = 0; d != D; ++d) dom[d] = Domain<1>(r.info.size[d]);
+    block_type *block = new block_type(construct_domain<D>(dom), data);
+    block->admit(true);
+    typename view_of<block_type>::const_type v(*block);
+    block->decrement_count();
+    return v;
+  }
+
+  std::string name_;
+  char *data_;
+  length_type size_;
+  bool swap_;
+  std::vector<record> records_;
+};
+
+} // namespace ovxx::raw
+} // namespace ovxx
+
+#endif
@@ -9,6 +9,9 @@
 #include <ovxx/library.hpp>
 #include <ovxx/allocator.hpp>
 #include <ovxx/c++11/chrono.hpp>
+#include <ovxx/profile.hpp>
+#include <ovxx/dispatcher/tuning.hpp>
+#include <ovxx/thread_pool.hpp>
 #if defined(OVXX_ENABLE_THREADING)
 # include <ovxx/c++11/thread.hpp>
 #endif
@@ -65,6 +68,9 @@ void initialize(int &argc, char **&argv)
 #ifndef OVXX_TIMER_SYSTEM
     cxx11::chrono::high_resolution_clock::init();
 #endif
+    profile::initialize();
+    dispatcher::tuning::initialize();
+    thread_pool::initialize();
 #if defined(OVXX_HAVE_OPENCL)
     ovxx::opencl::initialize();
 #endif
@@ -138,6 +144,9 @@ void finalize()
   }
   if (!global_count)
   {
+    thread_pool::finalize();
+    profile::finalize();
+    dispatcher::tuning::clear();
 #if (OVXX_HAVE_CVSIP)
     vsip_finalize(0);
 #endif
@@ -146,6 +146,14 @@ free_chain(MPI_Datatype chain)
   MPI_Type_free(&chain);
 }
 
+inline MPI_Datatype
+dup_chain(MPI_Datatype chain)
+{
+  MPI_Datatype copy;
+  OVXX_MPI_CHECK_RESULT(MPI_Type_dup, (chain, &copy));
+  return copy;
+}
+
 } // namespace ovxx::mpi
 } // namespace ovxx
 
@@ -8,11 +8,23 @@
 
 #include <ovxx/mpi/communicator.hpp>
 
+#ifndef OVXX_REPRODUCIBLE_REDUCTIONS
+# define OVXX_REPRODUCIBLE_REDUCTIONS 0
+#endif
+
+namespace
+{
+bool reproducible = OVXX_REPRODUCIBLE_REDUCTIONS;
+}
+
 namespace ovxx
 {
 namespace mpi
 {
 
+void set_reproducible_reductions(bool r) { reproducible = r;}
+bool reproducible_reductions() { return reproducible;}
+
 struct comm_free
 {
   void operator()(MPI_Comm* comm) const
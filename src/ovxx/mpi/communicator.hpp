@@ -13,6 +13,7 @@
 #include <ovxx/reductions/types.hpp>
 #include <ovxx/mpi/exception.hpp>
 #include <ovxx/mpi/datatype.hpp>
+#include <ovxx/mpi/reduction.hpp>
 #include <ovxx/mpi/group.hpp>
 #include <ovxx/c++11.hpp>
 #include <mpi.h>
@@ -22,6 +23,16 @@ namespace ovxx
 namespace mpi
 {
 
+/// Select how values are reduced across processors.
+/// By default, reductions use MPI_Allreduce, whose order of
+/// evaluation is up to the MPI implementation, so floating-point
+/// results may differ in the last bits from one run to another.
+/// Reproducible reductions combine values along a fixed binary tree
+/// instead, which yields bit-identical results for a given number
+/// of processors, at the cost of some performance.
+void set_reproducible_reductions(bool);
+bool reproducible_reductions();
+
 /// A communicator permits communication and
 /// synchronization among a set of processes.
 class Communicator
@@ -92,9 +103,37 @@ public:
   template <typename T>
   void recv(processor_type src_proc, T* data, length_type size);
 
+  template <typename T>
+  void recv(processor_type src_proc, T* data, length_type size,
+	    request_type& req);
+
   void recv(processor_type src_proc, chain_type& chain);
 
+  void send_init(processor_type dest_proc, chain_type& chain, request_type& req);
+  void recv_init(processor_type src_proc, chain_type& chain, request_type& req);
+
+  template <typename T>
+  void send_init(processor_type dest_proc, T* data, length_type size, int tag,
+		 request_type& req);
+  template <typename T>
+  void recv_init(processor_type src_proc, T* data, length_type size, int tag,
+		 request_type& req);
+
+  void start(request_type& req);
+  void start(std::vector<request_type>& reqs);
+
+  bool test(request_type& req);
+  bool test(std::vector<request_type>& reqs);
+
   void wait(request_type& req);
+  void wait(std::vector<request_type>& reqs);
+
+  void free(request_type& req);
+
+  template <typename T>
+  void alltoallv(T const *send, int const *send_counts, int const *send_displs,
+		 T *recv, int const *recv_counts, int const *recv_displs,
+		 request_type &req);
 
   template <typename T>
   void broadcast(processor_type root_proc, T* data, length_type size);
@@ -102,6 +141,12 @@ public:
   template <typename T>
   T allreduce(reduction_type rdx, T value);
 
+  /// Reduce a value and its (linearized) index from all processors
+  /// to all processors. `rdx` is either `reduce_max` or `reduce_min`.
+  /// Processors not holding a value pass `Value_index<T>::npos` as `pos`.
+  template <typename T>
+  void allreduce(reduction_type rdx, T &value, index_type &pos);
+
   int impl_ll_pset() const VSIP_NOTHROW { return 0;}
   // { return ll_pset_type(); }
 
@@ -109,6 +154,9 @@ public:
   friend bool operator==(Communicator const&, Communicator const&);
 
 private:
+  template <typename T>
+  T do_allreduce(MPI_Op op, T value);
+
   ovxx::shared_ptr<MPI_Comm> impl_;
   pvec_type pvec_;
 };
@@ -162,6 +210,17 @@ Communicator::recv(processor_type src_proc, T *data, length_type size)
     (data, size, Datatype<T>::value(), src_proc, 0, *this, &status));
 }
 
+template <typename T>
+inline void
+Communicator::recv(processor_type src_proc,
+		   T *data,
+		   length_type size,
+		   request_type &req)
+{
+  OVXX_MPI_CHECK_RESULT(MPI_Irecv,
+    (data, size, Datatype<T>::value(), src_proc, 0, *this, &req));
+}
+
 inline void
 Communicator::recv(processor_type src_proc, chain_type &chain)
 {
@@ -170,6 +229,83 @@ Communicator::recv(processor_type src_proc, chain_type &chain)
     (MPI_BOTTOM, 1, chain, src_proc, 0, *this, &status));
 }
 
+/// Create a persistent send request. The request is inactive until
+/// it is started, and may be started any number of times.
+inline void
+Communicator::send_init(processor_type dest_proc, chain_type &chain,
+			request_type &req)
+{
+  OVXX_MPI_CHECK_RESULT(MPI_Send_init,
+    (MPI_BOTTOM, 1, chain, dest_proc, 0, *this, &req));
+}
+
+/// Create a persistent receive request.
+inline void
+Communicator::recv_init(processor_type src_proc, chain_type &chain,
+			request_type &req)
+{
+  OVXX_MPI_CHECK_RESULT(MPI_Recv_init,
+    (MPI_BOTTOM, 1, chain, src_proc, 0, *this, &req));
+}
+
+/// Create a persistent send request for `size` values of type `T`,
+/// using message tag `tag`.
+template <typename T>
+inline void
+Communicator::send_init(processor_type dest_proc, T *data, length_type size,
+			int tag, request_type &req)
+{
+  OVXX_MPI_CHECK_RESULT(MPI_Send_init,
+    (data, size, Datatype<T>::value(), dest_proc, tag, *this, &req));
+}
+
+/// Create a persistent receive request for `size` values of type `T`,
+/// using message tag `tag`.
+template <typename T>
+inline void
+Communicator::recv_init(processor_type src_proc, T *data, length_type size,
+			int tag, request_type &req)
+{
+  OVXX_MPI_CHECK_RESULT(MPI_Recv_init,
+    (data, size, Datatype<T>::value(), src_proc, tag, *this, &req));
+}
+
+/// (Re-)activate a persistent request.
+inline void
+Communicator::start(request_type &req)
+{
+  OVXX_MPI_CHECK_RESULT(MPI_Start, (&req));
+}
+
+/// (Re-)activate a set of persistent requests.
+inline void
+Communicator::start(std::vector<request_type> &reqs)
+{
+  if (reqs.size())
+    OVXX_MPI_CHECK_RESULT(MPI_Startall, (reqs.size(), &reqs[0]));
+}
+
+/// Test whether a communication has completed, without blocking.
+inline bool
+Communicator::test(request_type &req)
+{
+  int flag;
+  OVXX_MPI_CHECK_RESULT(MPI_Test, (&req, &flag, MPI_STATUS_IGNORE));
+  return flag;
+}
+
+/// Test whether a set of communications has completed, without blocking.
+/// This also lets the MPI library make progress on them.
+inline bool
+Communicator::test(std::vector<request_type> &reqs)
+{
+  int flag = 1;
+  if (reqs.size())
+    OVXX_MPI_CHECK_RESULT(MPI_Testall,
+      (reqs.size(), &reqs[0], &flag, MPI_STATUSES_IGNORE));
+  return flag;
+}
+
 /// Wait for a previous communication (send or receive) to complete.
 inline void
 Communicator::wait(request_type& req)
@@ -178,6 +314,49 @@ Communicator::wait(request_type& req)
   MPI_Wait(&req, &status);
 }
 
+/// Wait for a set of communications to complete.
+/// Persistent requests remain allocated, and may be started again.
+inline void
+Communicator::wait(std::vector<request_type> &reqs)
+{
+  if (reqs.size())
+    OVXX_MPI_CHECK_RESULT(MPI_Waitall,
+      (reqs.size(), &reqs[0], MPI_STATUSES_IGNORE));
+}
+
+/// Release a (persistent) request.
+inline void
+Communicator::free(request_type &req)
+{
+  if (req != MPI_REQUEST_NULL)
+    MPI_Request_free(&req);
+}
+
+/// Exchange (variable-sized) messages between all processors.
+/// If supported by the MPI library the exchange is non-blocking,
+/// and has to be completed with wait(req). Otherwise it completes
+/// immediately, and req is set to MPI_REQUEST_NULL.
+template <typename T>
+inline void
+Communicator::alltoallv(T const *send, int const *send_counts,
+			int const *send_displs,
+			T *recv, int const *recv_counts, int const *recv_displs,
+			request_type &req)
+{
+#if MPI_VERSION >= 3
+  OVXX_MPI_CHECK_RESULT(MPI_Ialltoallv,
+    (send, send_counts, send_displs, Datatype<T>::value(),
+     recv, recv_counts, recv_displs, Datatype<T>::value(), *this, &req));
+#else
+  OVXX_MPI_CHECK_RESULT(MPI_Alltoallv,
+    (const_cast<T*>(send), const_cast<int*>(send_counts),
+     const_cast<int*>(send_displs), Datatype<T>::value(),
+     recv, const_cast<int*>(recv_counts), const_cast<int*>(recv_displs),
+     Datatype<T>::value(), *this));
+  req = MPI_REQUEST_NULL;
+#endif
+}
+
 /// Broadcast a value from root processor to other processors.
 template <typename T>
 inline void
@@ -192,25 +371,59 @@ template <typename T>
 inline T
 Communicator::allreduce(reduction_type rtype, T value)
 {
-  T result;
+  return do_allreduce(Operation<T>::value(rtype), value);
+}
 
-  MPI_Op op;
+template <typename T>
+inline void
+Communicator::allreduce(reduction_type rtype, T &value, index_type &pos)
+{
+  Value_index<T> vi(value, pos);
+  vi = do_allreduce(Operation<Value_index<T> >::value(rtype), vi);
+  value = vi.value;
+  pos = vi.pos;
+}
 
-  switch (rtype)
+template <typename T>
+inline T
+Communicator::do_allreduce(MPI_Op op, T value)
+{
+  if (!reproducible_reductions())
   {
-  case reduce_all_true:		op = MPI_LAND; break;
-  case reduce_all_true_bool:	op = MPI_BAND; break;
-  case reduce_any_true:		op = MPI_LOR; break;
-  case reduce_any_true_bool:	op = MPI_BOR; break;
-  case reduce_sum:		op = MPI_SUM; break;
-  case reduce_min:		op = MPI_MIN; break;
-  case reduce_max:		op = MPI_MAX; break;
-  default: OVXX_UNREACHABLE("invalid reduction type");
+    T result;
+    OVXX_MPI_CHECK_RESULT(MPI_Allreduce, 
+      (&value, &result, 1, Datatype<T>::value(), op, *this));
+    return result;
   }
-
-  OVXX_MPI_CHECK_RESULT(MPI_Allreduce, 
-    (&value, &result, 1, Datatype<T>::value(), op, *this));
-  return result;
+  // Combine values along a binomial tree rooted at rank 0, always
+  // in order of increasing rank, then broadcast the result.
+  // (A separate tag keeps these messages apart from any point-to-point
+  // transfers that may be in flight.)
+  int const tag = 1;
+  int r = rank();
+  int s = size();
+  for (int mask = 1; mask < s; mask <<= 1)
+  {
+    if (r & mask)
+    {
+      OVXX_MPI_CHECK_RESULT(MPI_Send,
+        (&value, 1, Datatype<T>::value(), r - mask, tag, *this));
+      break;
+    }
+    else if (r + mask < s)
+    {
+      T other;
+      OVXX_MPI_CHECK_RESULT(MPI_Recv,
+        (&other, 1, Datatype<T>::value(), r + mask, tag, *this,
+	 MPI_STATUS_IGNORE));
+      // other = value op other
+      OVXX_MPI_CHECK_RESULT(MPI_Reduce_local,
+        (&value, &other, 1, Datatype<T>::value(), op));
+      value = other;
+    }
+  }
+  broadcast(0, &value, 1);
+  return value;
 }
 
 } // namespace ovxx::mpi
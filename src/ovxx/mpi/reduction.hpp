@@ -0,0 +1,183 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_mpi_reduction_hpp_
+#define ovxx_mpi_reduction_hpp_
+
+#include <ovxx/support.hpp>
+#include <ovxx/reductions/types.hpp>
+#include <ovxx/mpi/datatype.hpp>
+#include <ovxx/mpi/exception.hpp>
+#include <mpi.h>
+#include <complex>
+
+namespace ovxx
+{
+namespace mpi
+{
+
+/// A value together with the position at which it was found,
+/// used to combine reductions that return an index (such as maxval).
+/// The position refers to the traversal order of the reduced view.
+/// A processor that doesn't hold any value sets it to `npos`.
+template <typename T>
+struct Value_index
+{
+  static index_type const npos = static_cast<index_type>(-1);
+
+  Value_index() : value(), pos(npos) {}
+  Value_index(T v, index_type p) : value(v), pos(p) {}
+
+  T value;
+  index_type pos;
+};
+
+template <typename T>
+struct Datatype<Value_index<T> >
+{
+  static MPI_Datatype value()
+  {
+    static bool first = true;
+    static MPI_Datatype datatype;
+
+    if (first)
+    {
+      first = false;
+      Value_index<T> vi;
+      int lengths[2] = { 1, 1};
+      MPI_Aint base, displs[2];
+      MPI_Datatype types[2] = { Datatype<T>::value(), Datatype<index_type>::value()};
+      MPI_Get_address(&vi, &base);
+      MPI_Get_address(&vi.value, &displs[0]);
+      MPI_Get_address(&vi.pos, &displs[1]);
+      displs[0] -= base;
+      displs[1] -= base;
+      MPI_Datatype tmp;
+      MPI_Type_create_struct(2, lengths, displs, types, &tmp);
+      MPI_Type_create_resized(tmp, 0, sizeof(Value_index<T>), &datatype);
+      MPI_Type_free(&tmp);
+      MPI_Type_commit(&datatype);
+    }
+
+    return datatype;
+  }
+};
+
+namespace detail
+{
+template <typename T>
+void complex_sum(void *in, void *inout, int *len, MPI_Datatype *)
+{
+  std::complex<T> const *a = static_cast<std::complex<T> const *>(in);
+  std::complex<T> *b = static_cast<std::complex<T> *>(inout);
+  for (int i = 0; i != *len; ++i)
+    b[i] = a[i] + b[i];
+}
+
+// Keep the greater (Max) or smaller (!Max) value. Ties are
+// resolved in favor of the lower position, so the result doesn't
+// depend on the order in which values are combined.
+template <typename T, bool Max>
+void value_index(void *in, void *inout, int *len, MPI_Datatype *)
+{
+  typedef Value_index<T> vi_type;
+  vi_type const *a = static_cast<vi_type const *>(in);
+  vi_type *b = static_cast<vi_type *>(inout);
+  for (int i = 0; i != *len; ++i)
+  {
+    if (a[i].pos == vi_type::npos) continue;
+    else if (b[i].pos == vi_type::npos) b[i] = a[i];
+    else if (Max ? a[i].value > b[i].value : a[i].value < b[i].value) b[i] = a[i];
+    else if (a[i].value == b[i].value && a[i].pos < b[i].pos) b[i] = a[i];
+  }
+}
+
+inline MPI_Op
+create_operation(MPI_User_function *f)
+{
+  MPI_Op op;
+  OVXX_MPI_CHECK_RESULT(MPI_Op_create, (f, 1, &op));
+  return op;
+}
+} // namespace ovxx::mpi::detail
+
+/// Provide a mapping from reduction types to MPI operations.
+template <typename T>
+struct Operation
+{
+  static MPI_Op value(reduction_type rtype)
+  {
+    switch (rtype)
+    {
+      // All_true and Any_true are bitwise operations for
+      // non-bool types. For bool (transferred as bytes) the bitwise
+      // operations are equivalent to the logical ones.
+      case reduce_all_true:
+      case reduce_all_true_bool: return MPI_BAND;
+      case reduce_any_true:
+      case reduce_any_true_bool: return MPI_BOR;
+      case reduce_sum: return MPI_SUM;
+      case reduce_min: return MPI_MIN;
+      case reduce_max: return MPI_MAX;
+      default: OVXX_UNREACHABLE("invalid reduction type");
+    }
+  }
+};
+
+/// MPI's predefined operations don't apply to complex values
+/// (in terms of our derived datatype), so provide our own.
+template <typename T>
+struct Operation<std::complex<T> >
+{
+  static MPI_Op value(reduction_type rtype)
+  {
+    static bool first = true;
+    static MPI_Op sum;
+
+    if (first)
+    {
+      first = false;
+      sum = detail::create_operation(&detail::complex_sum<T>);
+    }
+    switch (rtype)
+    {
+      case reduce_sum: return sum;
+      default: OVXX_UNREACHABLE("invalid reduction type for complex values");
+    }
+  }
+};
+
+/// Operations on value-index pairs: `reduce_max` and `reduce_min`
+/// keep the greatest / smallest value, and the lowest position
+/// it was found at.
+template <typename T>
+struct Operation<Value_index<T> >
+{
+  static MPI_Op value(reduction_type rtype)
+  {
+    static bool first = true;
+    static MPI_Op max, min;
+
+    if (first)
+    {
+      first = false;
+      max = detail::create_operation(&detail::value_index<T, true>);
+      min = detail::create_operation(&detail::value_index<T, false>);
+    }
+    switch (rtype)
+    {
+      case reduce_max: return max;
+      case reduce_min: return min;
+      default: OVXX_UNREACHABLE("invalid reduction type for value-index pairs");
+    }
+  }
+};
+
+} // namespace ovxx::mpi
+} // namespace ovxx
+
+#endif
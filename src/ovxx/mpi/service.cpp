@@ -7,15 +7,29 @@
 // license contained in the accompanying LICENSE.BSD file.
 
 #include "service.hpp"
+#include <ovxx/mpi/shared_memory.hpp>
+#if OVXX_ENABLE_THREADING
+# include <ovxx/c++11/thread.hpp>
+#endif
 #include <cstring>
+#include <cstdlib>
 #include <iostream>
+#include <vector>
+#include <algorithm>
 
 namespace
 {
+typedef std::vector<void (*)()> finalizer_list;
 #if OVXX_ENABLE_THREADING
 thread_local ovxx::mpi::Communicator *communicator;
+thread_local finalizer_list *finalizers = 0;
 #else
 ovxx::mpi::Communicator *communicator;
+finalizer_list *finalizers = 0;
+#endif
+finalizer_list mpi_finalizers;
+#if OVXX_ENABLE_THREADING
+ovxx::mutex mpi_finalizers_guard;
 #endif
 vsip::length_type const BUFSIZE = 2*256*256*4;
 char *buffer = 0;
@@ -45,9 +59,16 @@ void initialize(int &argc, char **&argv)
     }
     MPI_Buffer_attach(buffer, BUFSIZE);
     MPI_Comm_set_errhandler(MPI_COMM_WORLD, MPI_ERRORS_RETURN);
-    // Initialize complex datatypes.
+    // Initialize complex datatypes and operations.
     Datatype<complex<float> >::value();
     Datatype<complex<double> >::value();
+    Operation<complex<float> >::value(reduce_sum);
+    Operation<complex<double> >::value(reduce_sum);
+    // OVXX_SHARED_MEMORY holds the size (in MiB) of the
+    // shared-memory segment each process allocates.
+    if (char const *size = std::getenv("OVXX_SHARED_MEMORY"))
+      if (length_type mib = std::atol(size))
+	initialize_shared_memory(mib << 20);
   }
   communicator = new Communicator(MPI_COMM_WORLD, Communicator::comm_attach);
 }
@@ -55,16 +76,51 @@ void initialize(int &argc, char **&argv)
 // On its final call (presumably from the main thread) finalize the MPI library.
 void finalize(bool final)
 {
+  if (finalizers)
+  {
+    // Run in reverse order of registration.
+    for (finalizer_list::reverse_iterator i = finalizers->rbegin();
+	 i != finalizers->rend(); ++i)
+      (*i)();
+    delete finalizers;
+    finalizers = 0;
+  }
   delete communicator;
   communicator = 0;
   if (final)
   {
+    {
+#if OVXX_ENABLE_THREADING
+      lock_guard<mutex> lock(mpi_finalizers_guard);
+#endif
+      for (finalizer_list::reverse_iterator i = mpi_finalizers.rbegin();
+	   i != mpi_finalizers.rend(); ++i)
+	(*i)();
+      mpi_finalizers.clear();
+    }
+    finalize_shared_memory();
     if (finalize_mpi)
       MPI_Finalize();
     delete[] buffer;
   }
 }
 
+void at_finalize(void (*f)())
+{
+  if (!finalizers) finalizers = new finalizer_list;
+  finalizers->push_back(f);
+}
+
+void at_mpi_finalize(void (*f)())
+{
+#if OVXX_ENABLE_THREADING
+  lock_guard<mutex> lock(mpi_finalizers_guard);
+#endif
+  if (std::find(mpi_finalizers.begin(), mpi_finalizers.end(), f) ==
+      mpi_finalizers.end())
+    mpi_finalizers.push_back(f);
+}
+
 } // namespace ovxx::mpi
 
 namespace parallel
@@ -30,6 +30,19 @@ namespace mpi
 void initialize(int &, char **&);
 void finalize(bool);
 
+/// Register a function to be called when MPI is finalized for the
+/// calling thread. This allows objects caching MPI resources
+/// (persistent requests, datatypes) across calls to release them
+/// while the communicators are still valid.
+void at_finalize(void (*)());
+
+/// Register a function to be called once, when MPI itself is
+/// finalized (whichever thread that happens on). This allows
+/// resources cached by any thread to be released, including those
+/// of threads that never finalize the library. Registering the same
+/// function again has no effect.
+void at_mpi_finalize(void (*)());
+
 } // namespace mpi
 
 namespace parallel
@@ -38,6 +51,7 @@ using mpi::Communicator;
 using mpi::Group;
 using mpi::Chain_builder;
 using mpi::free_chain;
+using mpi::dup_chain;
 
 typedef int ll_pbuf_type;
 typedef int ll_pset_type;
@@ -53,24 +67,52 @@ inline void
 destroy_ll_pset(ll_pset_type&) {}
 
 
+using mpi::set_reproducible_reductions;
+using mpi::reproducible_reductions;
+
 // supported reductions
 
 template <reduction_type rtype, typename T>
 struct reduction_supported
 { static bool const value = false;};
 
-template <> struct reduction_supported<reduce_sum, int>
-{ static bool const value = true;};
-template <> struct reduction_supported<reduce_sum, float>
-{ static bool const value = true;};
-template <> struct reduction_supported<reduce_all_true, int>
-{ static bool const value = true;};
-template <> struct reduction_supported<reduce_all_true_bool, bool>
-{ static bool const value = true;};
-template <> struct reduction_supported<reduce_any_true, int>
-{ static bool const value = true;};
-template <> struct reduction_supported<reduce_any_true_bool, bool>
+#define OVXX_REDUCTION_SUPPORTED(R, T)		\
+template <> struct reduction_supported<R, T>	\
 { static bool const value = true;};
+
+OVXX_REDUCTION_SUPPORTED(reduce_sum, int)
+OVXX_REDUCTION_SUPPORTED(reduce_sum, unsigned int)
+OVXX_REDUCTION_SUPPORTED(reduce_sum, long)
+OVXX_REDUCTION_SUPPORTED(reduce_sum, unsigned long)
+OVXX_REDUCTION_SUPPORTED(reduce_sum, float)
+OVXX_REDUCTION_SUPPORTED(reduce_sum, double)
+OVXX_REDUCTION_SUPPORTED(reduce_sum, complex<float>)
+OVXX_REDUCTION_SUPPORTED(reduce_sum, complex<double>)
+OVXX_REDUCTION_SUPPORTED(reduce_all_true, int)
+OVXX_REDUCTION_SUPPORTED(reduce_all_true, unsigned int)
+OVXX_REDUCTION_SUPPORTED(reduce_all_true, long)
+OVXX_REDUCTION_SUPPORTED(reduce_all_true, unsigned long)
+OVXX_REDUCTION_SUPPORTED(reduce_all_true_bool, bool)
+OVXX_REDUCTION_SUPPORTED(reduce_any_true, int)
+OVXX_REDUCTION_SUPPORTED(reduce_any_true, unsigned int)
+OVXX_REDUCTION_SUPPORTED(reduce_any_true, long)
+OVXX_REDUCTION_SUPPORTED(reduce_any_true, unsigned long)
+OVXX_REDUCTION_SUPPORTED(reduce_any_true_bool, bool)
+OVXX_REDUCTION_SUPPORTED(reduce_max, int)
+OVXX_REDUCTION_SUPPORTED(reduce_max, unsigned int)
+OVXX_REDUCTION_SUPPORTED(reduce_max, long)
+OVXX_REDUCTION_SUPPORTED(reduce_max, unsigned long)
+OVXX_REDUCTION_SUPPORTED(reduce_max, float)
+OVXX_REDUCTION_SUPPORTED(reduce_max, double)
+OVXX_REDUCTION_SUPPORTED(reduce_min, int)
+OVXX_REDUCTION_SUPPORTED(reduce_min, unsigned int)
+OVXX_REDUCTION_SUPPORTED(reduce_min, long)
+OVXX_REDUCTION_SUPPORTED(reduce_min, unsigned long)
+OVXX_REDUCTION_SUPPORTED(reduce_min, float)
+OVXX_REDUCTION_SUPPORTED(reduce_min, double)
+
+#undef OVXX_REDUCTION_SUPPORTED
+
 } // namespace ovxx::parallel
 } // namespace ovxx
 
@@ -0,0 +1,257 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#include <ovxx/mpi/shared_memory.hpp>
+#include <ovxx/mpi/exception.hpp>
+#include <ovxx/allocator.hpp>
+#include <ovxx/aligned_allocator.hpp>
+#if defined(OVXX_ENABLE_THREADING)
+# include <ovxx/c++11/thread.hpp>
+#endif
+#include <map>
+#include <vector>
+#include <iostream>
+
+namespace ovxx
+{
+namespace mpi
+{
+namespace
+{
+
+/// Allocate from the local shared-memory segment, using a first-fit
+/// free list.  Requests that can't be satisfied from the segment are
+/// passed on to the allocator that was the default before.
+///
+/// Blocks remember their allocator, so they may be released on
+/// whichever thread drops the last reference (e.g. a thread-pool
+/// worker), while other threads allocate: the free list is guarded.
+/// For the same reason, an allocator whose segment is freed while
+/// blocks still refer to it is only deleted once the last of them
+/// is released.
+class shared_allocator : public allocator
+{
+public:
+  static size_t const align = aligned_allocator::align;
+
+  shared_allocator(char *segment, size_t size, allocator *fallback)
+    : segment_(segment), size_(size), fallback_(fallback),
+      blocks_(0), detached_(false)
+  {
+    if (size_) free_[0] = size_;
+  }
+
+  bool contains(void const *ptr) const
+  {
+    char const *p = static_cast<char const *>(ptr);
+    return p >= segment_ && p < segment_ + size_;
+  }
+
+  allocator *fallback() const { return fallback_;}
+
+  /// Give up the segment, which is about to be freed. Return the
+  /// number of blocks still allocated from it. If there are none,
+  /// the caller deletes the allocator, otherwise it deletes itself
+  /// once the last block is released.
+  size_t detach()
+  {
+#if defined(OVXX_ENABLE_THREADING)
+    lock_guard<mutex> lock(guard_);
+#endif
+    detached_ = true;
+    return blocks_;
+  }
+
+private:
+  static size_t round(size_t size)
+  {
+    if (size == 0) size = 1;
+    return (size + align - 1) / align * align;
+  }
+
+  void *allocate(size_t size)
+  {
+    size = round(size);
+    {
+#if defined(OVXX_ENABLE_THREADING)
+      lock_guard<mutex> lock(guard_);
+#endif
+      if (!detached_)
+	for (free_list::iterator i = free_.begin(); i != free_.end(); ++i)
+	  if (i->second >= size)
+	  {
+	    size_t offset = i->first;
+	    size_t avail = i->second;
+	    free_.erase(i);
+	    if (avail > size) free_[offset + size] = avail - size;
+	    ++blocks_;
+	    return segment_ + offset;
+	  }
+    }
+    return fallback_->allocate<char>(size);
+  }
+
+  void deallocate(void *ptr, size_t size)
+  {
+    size = round(size);
+    if (!contains(ptr))
+    {
+      fallback_->deallocate(static_cast<char*>(ptr), size);
+      return;
+    }
+    if (release(static_cast<char*>(ptr) - segment_, size))
+      delete this;
+  }
+
+  /// Return the chunk at `offset` to the free list. Return true
+  /// if this was the last block of a detached allocator.
+  bool release(size_t offset, size_t size)
+  {
+#if defined(OVXX_ENABLE_THREADING)
+    lock_guard<mutex> lock(guard_);
+#endif
+    --blocks_;
+    if (detached_) return !blocks_;
+    free_list::iterator next = free_.lower_bound(offset);
+    // Merge with the following free chunk...
+    if (next != free_.end() && offset + size == next->first)
+    {
+      size += next->second;
+      free_.erase(next++);
+    }
+    // ...and with the preceding one.
+    if (next != free_.begin())
+    {
+      free_list::iterator prev = next;
+      --prev;
+      if (prev->first + prev->second == offset)
+      {
+	prev->second += size;
+	return false;
+      }
+    }
+    free_[offset] = size;
+    return false;
+  }
+
+  typedef std::map<size_t, size_t> free_list;
+
+  char *segment_;
+  size_t size_;
+  allocator *fallback_;
+#if defined(OVXX_ENABLE_THREADING)
+  mutex guard_;
+#endif
+  free_list free_;
+  size_t blocks_;
+  bool detached_;
+};
+
+#if MPI_VERSION >= 3
+MPI_Win window = MPI_WIN_NULL;
+MPI_Group node_group = MPI_GROUP_NULL;
+std::vector<char *> segments;
+#endif
+shared_allocator *pool = 0;
+
+} // namespace <unnamed>
+
+void initialize_shared_memory(length_type size)
+{
+#if MPI_VERSION >= 3
+  MPI_Comm node;
+  OVXX_MPI_CHECK_RESULT(MPI_Comm_split_type,
+    (MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node));
+  // Let the implementation place each segment on a page boundary
+  // close to its owner, rather than packing them contiguously.
+  MPI_Info info;
+  MPI_Info_create(&info);
+  MPI_Info_set(info, const_cast<char*>("alloc_shared_noncontig"),
+	       const_cast<char*>("true"));
+  char *base;
+  OVXX_MPI_CHECK_RESULT(MPI_Win_allocate_shared,
+    (size, 1, info, node, &base, &window));
+  MPI_Info_free(&info);
+  // Keep a passive-target epoch open for the lifetime of the window,
+  // so MPI_Win_sync may be used to synchronize memory.
+  OVXX_MPI_CHECK_RESULT(MPI_Win_lock_all, (MPI_MODE_NOCHECK, window));
+
+  int node_size;
+  MPI_Comm_size(node, &node_size);
+  segments.resize(node_size);
+  for (int i = 0; i != node_size; ++i)
+  {
+    MPI_Aint s;
+    int disp;
+    OVXX_MPI_CHECK_RESULT(MPI_Win_shared_query,
+      (window, i, &s, &disp, &segments[i]));
+  }
+  MPI_Comm_group(node, &node_group);
+  MPI_Comm_free(&node);
+
+  pool = new shared_allocator(base, size, allocator::get_default());
+  allocator::set_default(pool);
+#endif
+}
+
+void finalize_shared_memory()
+{
+  if (!pool) return;
+  allocator::set_default(pool->fallback());
+  if (size_t blocks = pool->detach())
+    // The views using these blocks outlive the library, and must
+    // not be accessed anymore.
+    std::cerr << "WARNING: " << blocks << " block(s) still allocated in "
+	      << "shared memory at finalization" << std::endl;
+  else
+    delete pool;
+  pool = 0;
+#if MPI_VERSION >= 3
+  MPI_Group_free(&node_group);
+  segments.clear();
+  MPI_Win_unlock_all(window);
+  MPI_Win_free(&window);
+#endif
+}
+
+stride_type shared_offset(void const *ptr)
+{
+  if (!pool || !pool->contains(ptr)) return -1;
+#if MPI_VERSION >= 3
+  int rank;
+  MPI_Group_rank(node_group, &rank);
+  return static_cast<char const *>(ptr) - segments[rank];
+#else
+  return -1;
+#endif
+}
+
+char *shared_segment(MPI_Comm comm, processor_type proc)
+{
+  if (!pool) return 0;
+#if MPI_VERSION >= 3
+  MPI_Group group;
+  MPI_Comm_group(comm, &group);
+  int rank = proc;
+  int node_rank;
+  MPI_Group_translate_ranks(group, 1, &rank, node_group, &node_rank);
+  MPI_Group_free(&group);
+  return node_rank == MPI_UNDEFINED ? 0 : segments[node_rank];
+#else
+  return 0;
+#endif
+}
+
+void sync_shared_memory()
+{
+#if MPI_VERSION >= 3
+  if (pool) MPI_Win_sync(window);
+#endif
+}
+
+} // namespace ovxx::mpi
+} // namespace ovxx
@@ -0,0 +1,49 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_mpi_shared_memory_hpp_
+#define ovxx_mpi_shared_memory_hpp_
+
+#include <ovxx/support.hpp>
+#include <mpi.h>
+
+namespace ovxx
+{
+namespace mpi
+{
+
+/// Intra-node shared memory.
+///
+/// If enabled (by setting the OVXX_SHARED_MEMORY environment variable
+/// to a size in MiB), each process allocates a segment of that size
+/// in an MPI-3 shared-memory window spanning all processes on the
+/// same node, and uses it as its default allocator, falling back to
+/// ordinary memory once the segment is exhausted.  Blocks allocated
+/// from the segment can be read directly by the other processes on
+/// the node, which lets parallel assignments bypass message passing
+/// for intra-node transfers.
+void initialize_shared_memory(length_type size);
+void finalize_shared_memory();
+
+/// Return the offset of `ptr` in the local segment, or -1 if
+/// it doesn't point into it.
+stride_type shared_offset(void const *ptr);
+
+/// Return the segment of processor `proc` of communicator `comm`,
+/// or 0 if that processor doesn't share memory with the local one.
+char *shared_segment(MPI_Comm comm, processor_type proc);
+
+/// Synchronize the local view of the shared memory with other
+/// processes.  This needs to be called after writing to shared memory
+/// before notifying other processes, and after being notified before
+/// reading.
+void sync_shared_memory();
+
+} // namespace ovxx::mpi
+} // namespace ovxx
+
+#endif
@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_parallel_assign_async_hpp_
+#define ovxx_parallel_assign_async_hpp_
+
+#include <ovxx/support.hpp>
+#include <ovxx/assign.hpp>
+#include <ovxx/view/traits.hpp>
+#include <memory>
+
+namespace ovxx
+{
+namespace parallel
+{
+namespace detail
+{
+
+/// Fallback for assignments that don't involve communication
+/// (or can't be split): perform the whole assignment in start().
+template <typename LHS, typename RHS, typename Tag>
+class Async_assignment
+{
+  static dimension_type const dim = LHS::dim;
+
+public:
+  Async_assignment(typename view_of<LHS>::type lhs,
+		   typename view_of<RHS>::const_type rhs)
+    : lhs_(lhs), rhs_(rhs) {}
+
+  void start() { ovxx::assign<dim>(lhs_.block(), rhs_.block());}
+  bool test() { return true;}
+  void finish() {}
+
+private:
+  typename view_of<LHS>::type       lhs_;
+  typename view_of<RHS>::const_type rhs_;
+};
+
+#ifdef OVXX_PARALLEL
+template <typename LHS, typename RHS, typename Impl>
+class Async_assignment<LHS, RHS, assignment::par_assign<Impl> >
+{
+  static dimension_type const dim = LHS::dim;
+
+public:
+  Async_assignment(typename view_of<LHS>::type lhs,
+		   typename view_of<RHS>::const_type rhs)
+    : same_map_(has_same_map<dim>(lhs.block().map(), rhs.block())),
+      sync_(lhs, rhs),
+      assign_(same_map_ ? 0 : new Assignment<dim, LHS, RHS, Impl>(lhs, rhs))
+  {}
+
+  void start() { if (same_map_) sync_.start(); else assign_->start();}
+  bool test() { return same_map_ || assign_->test();}
+  void finish() { if (!same_map_) assign_->finish();}
+
+private:
+  bool same_map_;
+  Async_assignment<LHS, RHS, void> sync_;
+  std::auto_ptr<Assignment<dim, LHS, RHS, Impl> > assign_;
+};
+#endif
+
+} // namespace ovxx::parallel::detail
+
+/// Split-phase assignment of one (distributed) view to another.
+///
+/// start() initiates the data transfer and performs all copies that
+/// don't require communication, finish() waits for the remaining
+/// data to arrive. In between, the caller may do other work, such
+/// as computing on unrelated data, to hide the communication latency.
+///
+/// Requirements:
+///   Between start() and finish(), LHS must not be accessed, and RHS
+///   must not be modified.
+///   As with other collective operations, split-phase assignments
+///   must be started in the same order on all processors.
+///
+/// Assignments that don't require communication (as well as those
+/// with an expression as RHS) complete entirely in start().
+/// Setting up the assignment is done in the constructor, so it is
+/// best to construct the object once, and start() and finish() it
+/// repeatedly.
+template <typename LHS, typename RHS>
+class Async_assignment : ovxx::detail::noncopyable
+{
+  typedef typename LHS::block_type lhs_block_type;
+  typedef typename RHS::block_type rhs_block_type;
+  static dimension_type const dim = LHS::dim;
+
+#ifdef OVXX_PARALLEL
+  typedef typename
+  assignment::trait<dim, lhs_block_type, rhs_block_type, false>::type tag_type;
+#else
+  typedef void tag_type;
+#endif
+
+public:
+  Async_assignment(LHS lhs, RHS rhs) : impl_(lhs, rhs) {}
+
+  /// Start the assignment.
+  void start() { impl_.start();}
+  /// Return true if all communication has completed.
+  /// (finish() still needs to be called.)
+  bool test() { return impl_.test();}
+  /// Wait for the assignment to complete.
+  void finish() { impl_.finish();}
+
+private:
+  detail::Async_assignment<lhs_block_type, rhs_block_type, tag_type> impl_;
+};
+
+} // namespace ovxx::parallel
+} // namespace ovxx
+
+#endif
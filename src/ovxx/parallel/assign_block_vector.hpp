@@ -168,17 +168,30 @@ public:
     // This would be non-empty if:
     //  - Par_assign did not to clear the lists after
     //    processing it (library design error), or
-    //  - User executed send() without a corresponding wait().
+    //  - User executed start() without a corresponding finish().
     OVXX_PRECONDITION(req_list.size() == 0);
   }
 
-  void operator()()
+  void operator()() { start(); finish();}
+
+  /// Initiate the assignment: post all messages, then perform
+  /// the local copies while the messages are in flight.
+  void start()
   {
+    if (recv_list.size() > 0) exec_recv_list();
     if (send_list.size() > 0) exec_send_list();
     if (copy_list.size() > 0) exec_copy_list();
-    if (recv_list.size() > 0) exec_recv_list();
+  }
+
+  /// Return true if all messages have completed.
+  /// finish() still needs to be called to complete the assignment.
+  bool test() { return comm_.test(req_list);}
 
-    if (req_list.size() > 0)  wait_send_list();
+  /// Complete the assignment, waiting for all outstanding messages.
+  void finish()
+  {
+    if (req_list.size() > 0)  wait_req_list();
+    if (recv_list.size() > 0) dst_dda_.sync_out();
 
     cleanup();
   }
@@ -195,7 +208,7 @@ private:
   void exec_recv_list();
   void exec_copy_list();
 
-  void wait_send_list();
+  void wait_req_list();
 
   void cleanup() {}	// Cleanup send_list buffers.
 
@@ -254,25 +267,33 @@ send(Communicator&                            comm,
 // split- complex.
 template <typename T>
 inline void
-recv(Communicator &comm,
-     processor_type proc,
-     T*             data,
-     length_type    size)
+recv(Communicator&                            comm,
+     processor_type                           proc,
+     T*                                       data,
+     length_type                              size,
+     std::vector<Communicator::request_type>& req_list)
 {
-  comm.recv(proc, data, size);
+  Communicator::request_type   req;
+  comm.recv(proc, data, size, req);
+  req_list.push_back(req);
 }
 
 
 
 template <typename T>
 inline void
-recv(Communicator&      comm,
-     processor_type           proc,
-     std::pair<T*, T*> const& data,
-     length_type              size)
+recv(Communicator&                            comm,
+     processor_type                           proc,
+     std::pair<T*, T*> const&                 data,
+     length_type                              size,
+     std::vector<Communicator::request_type>& req_list)
 {
-  comm.recv(proc, data.first, size);
-  comm.recv(proc, data.second, size);
+  Communicator::request_type   req1;
+  Communicator::request_type   req2;
+  comm.recv(proc, data.first,  size, req1);
+  comm.recv(proc, data.second, size, req2);
+  req_list.push_back(req1);
+  req_list.push_back(req2);
 }
 
 
@@ -566,8 +587,7 @@ Assignment<D, LHS, RHS, Blkvec_assign>::exec_recv_list()
     dst_dda_.sync_in();
     recv(comm_, proc,
 	 storage::offset(dst_dda_.ptr(), (*rl_cur).offset_),
-	 (*rl_cur).size_);
-    dst_dda_.sync_out();
+	 (*rl_cur).size_, req_list);
   }
 }
 
@@ -612,11 +632,11 @@ Assignment<D, LHS, RHS, Blkvec_assign>::exec_copy_list()
 
 
 
-// Wait for the send_list instructions to be completed.
+// Wait for the posted sends and receives to be completed.
 
 template <dimension_type D, typename LHS, typename RHS>
 void
-Assignment<D, LHS, RHS, Blkvec_assign>::wait_send_list()
+Assignment<D, LHS, RHS, Blkvec_assign>::wait_req_list()
 {
   typename std::vector<request_type>::iterator
 		cur = req_list.begin(),
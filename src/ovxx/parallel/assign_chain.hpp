@@ -15,13 +15,24 @@
 #include <vsip/support.hpp>
 #include <vsip/domain.hpp>
 #include <ovxx/view/traits.hpp>
+#include <ovxx/length.hpp>
 #include <ovxx/dda/persistent.hpp>
 #include <ovxx/parallel/service.hpp>
 #include <ovxx/parallel/assign.hpp>
 #include <ovxx/parallel/get_local_view.hpp>
+#include <ovxx/mpi/shared_memory.hpp>
+#if defined(OVXX_ENABLE_THREADING)
+# include <ovxx/c++11/thread.hpp>
+#endif
 
 #define OVXX_PCA_ROTATE  0
 #define OVXX_PCA_VERBOSE 0
+// The maximum number of plans cached (per thread) for each
+// type of assignment.
+#define OVXX_PCA_CACHE_SIZE 8
+// The maximum number of request sets kept by each plan, one per
+// pair of local subblock locations.
+#define OVXX_PCA_BINDINGS 4
 
 #if OVXX_PCA_VERBOSE
 //#  include <ovxx/output.hpp>
@@ -104,6 +115,54 @@ chain_add(Chain_builder &builder, Data &data, Domain<3> const &dom)
   }
 }
 
+// Copy the elements of `src_dom` to `dst_dom`, where both are local
+// domains of subblocks with the given strides, and `src` and `dst`
+// are the subblocks' base addresses.  The domains are traversed in
+// the order `O`.
+template <typename O, typename T, dimension_type D>
+inline void
+local_copy(T *dst, stride_type const *dst_stride, Domain<D> const &dst_dom,
+	   T const *src, stride_type const *src_stride, Domain<D> const &src_dom)
+{
+  dimension_type const order[3] = { O::impl_dim0, O::impl_dim1, O::impl_dim2};
+  length_type len[3] = { 1, 1, 1};
+  stride_type dst_step[3] = { 0, 0, 0};
+  stride_type src_step[3] = { 0, 0, 0};
+
+  // Unused outer loops have a single iteration.
+  dimension_type l = 3 - D;
+  for (dimension_type i = 0; i != 3; ++i)
+  {
+    dimension_type d = order[i];
+    if (d >= D) continue;
+    dst += dst_dom[d].first() * dst_stride[d];
+    src += src_dom[d].first() * src_stride[d];
+    len[l] = dst_dom[d].length();
+    dst_step[l] = dst_dom[d].stride() * dst_stride[d];
+    src_step[l] = src_dom[d].stride() * src_stride[d];
+    ++l;
+  }
+  for (index_type i = 0; i != len[0]; ++i)
+    for (index_type j = 0; j != len[1]; ++j)
+    {
+      T *d = dst + i * dst_step[0] + j * dst_step[1];
+      T const *s = src + i * src_step[0] + j * src_step[1];
+      for (index_type k = 0; k != len[2]; ++k)
+	d[k * dst_step[2]] = s[k * src_step[2]];
+    }
+}
+
+// Return the offset of the data at `ptr` in the local shared-memory
+// segment, or -1.  (Only plain arrays are transferred through shared
+// memory.)
+template <typename P>
+inline stride_type
+shared_offset(P) { return -1;}
+
+template <typename T>
+inline stride_type
+shared_offset(T *ptr) { return mpi::shared_offset(ptr);}
+
 template <dimension_type D,
 	  typename       Block,
 	  typename       AppMapT,
@@ -149,6 +208,31 @@ cleanup_dda_array(length_type num_subblocks,
 
 
 // Chained parallel assignment.
+//
+// The message and copy records only depend on the maps, extents and
+// local layouts of LHS and RHS, not on the particular blocks. They are
+// therefore kept in a Plan that is cached per thread and shared by all
+// Assignment objects with the same key, so repeated assignments
+// between identically distributed views (such as a corner-turn inside
+// a processing loop) pay the setup cost only once.  Messages are sent
+// and received through persistent requests, which remain valid as
+// long as the local subblocks don't move.  A plan keeps a set of
+// requests for each of the most recently used pairs of subblock
+// locations, so assignments alternating between buffers (as in
+// double-buffering) merely restart them.
+//
+// The assignment may be executed in two phases: start() posts all
+// messages and performs the local copies, finish() waits for the
+// messages to complete. Other work may be done in between.
+//
+// If shared memory is enabled (see <ovxx/mpi/shared_memory.hpp>),
+// transfers between processors on the same node bypass message
+// passing: the sender only notifies the receiver where its subblock
+// is located, and the receiver copies the data directly out of it,
+// acknowledging when done so the sender knows it may modify the
+// subblock again.  If the sender's subblock isn't in shared memory
+// (because it uses user storage, or the segment was exhausted), the
+// notice says so, and the data is sent as a regular message instead.
 template <dimension_type D, typename LHS, typename RHS>
 class Assignment<D, LHS, RHS, Chained_assign>
   : ct_assert<is_split_block<LHS>::value == is_split_block<RHS>::value>
@@ -170,6 +254,9 @@ class Assignment<D, LHS, RHS, Chained_assign>
   typedef ovxx::dda::Persistent_data<rhs_local_block> rhs_dda_type;
   typedef ovxx::dda::Persistent_data<lhs_local_block> lhs_dda_type;
 
+  typedef typename rhs_dda_type::non_const_ptr_type rhs_ptr_type;
+  typedef typename lhs_dda_type::non_const_ptr_type lhs_ptr_type;
+
   typedef typename LHS::map_type lhs_appmap_t;
   typedef typename RHS::map_type rhs_appmap_t;
 
@@ -178,23 +265,29 @@ class Assignment<D, LHS, RHS, Chained_assign>
   typedef Communicator::request_type request_type;
   typedef Communicator::chain_type   chain_type;
 
+  typedef typename LHS::value_type lhs_value_type;
+  typedef typename RHS::value_type rhs_value_type;
+
+  // Intra-node transfers are done by direct copies if both subblocks
+  // are accessed as plain arrays of the same type.
+  static bool const shm_capable =
+    is_same<lhs_value_type, rhs_value_type>::value &&
+    is_same<lhs_ptr_type, lhs_value_type*>::value &&
+    is_same<rhs_ptr_type, rhs_value_type*>::value;
+
+  // Message tags for the notices and acknowledgements of
+  // intra-node transfers.
+  static int const notice_tag = 2;
+  static int const ack_tag = 3;
+
   /// A Msg_record holds a piece of a data transfer that together
   /// describe a complete communication.
   ///
   /// Members:
   ///   PROC_ is the remote processor (to send to or receive from),
   ///   SUBBLOCK_ is the local subblock to,
-  ///   DATA_ is the raw data pointer of the local subblock,
   ///   CHAIN_ is the DMA chain representing the data from subblock_
-  ///      to send.
-  ///
-  /// Notes:
-  ///   [1] CHAIN_ completely describes the data to send/receive,
-  ///       but it is dependent on the distributed blocks storage
-  ///       location remaining unchanged from when the list is built
-  ///       to when it is executed.  SUBBLOCK_ and DATA_ are stored
-  ///       to check consistentcy and potentially update CHAIN_ if
-  ///       the storage location changes.
+  ///      to send, relative to the subblock's base address.
 
   struct Msg_record
   {
@@ -240,6 +333,175 @@ class Assignment<D, LHS, RHS, Chained_assign>
     Domain<D>    lhs_dom_;
   };
 
+  /// A Shm_record holds part of an intra-node transfer, to be copied
+  /// directly from the sender's subblock.
+  ///
+  /// Members:
+  ///   MSG_ is the index of the corresponding record in the plan's
+  ///      LOCAL_RECV_LIST_,
+  ///   RHS_DOM_ is the local domain within the sender's subblock,
+  ///   LHS_DOM_ is the local domain within the destination subblock.
+
+  struct Shm_record
+  {
+    Shm_record(index_type msg, Domain<D> rhs_dom, Domain<D> lhs_dom)
+      : msg_(msg), rhs_dom_(rhs_dom), lhs_dom_(lhs_dom) {}
+
+    index_type     msg_;
+    Domain<D>      rhs_dom_;
+    Domain<D>      lhs_dom_;
+  };
+
+  /// A Binding holds the persistent requests of a plan's messages
+  /// for one pair of local subblock locations.
+  ///
+  /// Members:
+  ///   SEND_BASE_ and RECV_BASE_ are the subblock addresses,
+  ///   REQUESTS_ are the persistent requests for all messages, with
+  ///      receives preceding sends,
+  ///   CHAINS_ are the chains the requests were created from, i.e.
+  ///      the plan's message chains stitched to SEND_BASE_ and
+  ///      RECV_BASE_,
+  ///   NOTICES_ hold the notices of intra-node transfers, sent and
+  ///      received,
+  ///   NOTICE_REQUESTS_, LOCAL_REQUESTS_ and ACK_REQUESTS_ are the
+  ///      persistent requests to receive notices, to receive data from
+  ///      senders whose subblock isn't in shared memory, and to
+  ///      acknowledge direct copies, for each of the plan's
+  ///      LOCAL_RECV_LIST_.  (The corresponding requests of the
+  ///      senders are part of REQUESTS_.)
+
+  struct Binding : ovxx::detail::noncopyable
+  {
+    Binding(rhs_ptr_type send_base, lhs_ptr_type recv_base)
+      : send_base_(send_base), recv_base_(recv_base) {}
+
+    rhs_ptr_type               send_base_;
+    lhs_ptr_type               recv_base_;
+    std::vector<request_type>  requests_;
+    std::vector<chain_type>    chains_;
+    std::vector<stride_type>   notices_;
+    std::vector<request_type>  notice_requests_;
+    std::vector<request_type>  local_requests_;
+    std::vector<request_type>  ack_requests_;
+  };
+
+  /// A Plan holds the send, receive, and copy lists for an assignment,
+  /// together with the key identifying it in the plan cache.
+  ///
+  /// Members:
+  ///   LHS_AM_, RHS_AM_, EXTENT_ and the local strides form the key,
+  ///   BINDINGS_ are the request sets for the most recently used
+  ///      subblock locations, the one in use first,
+  ///   ACTIVE_ is set between start() and finish() of the assignment
+  ///      using the plan.
+  ///   LOCAL_SEND_LIST_ and LOCAL_RECV_LIST_ hold the messages to and
+  ///      from processors on the same node, SHM_LIST_ the domains to
+  ///      copy for the latter, and SEGMENTS_ the senders' shared-memory
+  ///      segments.
+  ///   NOTICED_ records which notices have been processed.
+  ///
+  /// Notes:
+  ///   [1] The persistent requests depend on the local subblocks'
+  ///       storage location remaining unchanged from when they are
+  ///       bound to when they are executed.  A Binding is therefore
+  ///       only reused for the same SEND_BASE_ and RECV_BASE_.
+
+  struct Plan : ovxx::detail::noncopyable
+  {
+    Plan(lhs_appmap_t const &lhs_am, rhs_appmap_t const &rhs_am,
+	 Length<D> const &extent)
+      : lhs_am_(lhs_am), rhs_am_(rhs_am), extent_(extent), active_(false)
+    {
+      for (dimension_type d = 0; d != D; ++d)
+	lhs_stride_[d] = rhs_stride_[d] = 0;
+    }
+    ~Plan()
+    {
+      OVXX_PRECONDITION(!active_);
+      for (index_type i = 0; i != bindings_.size(); ++i)
+	release(bindings_[i]);
+      for (index_type i = 0; i != send_list_.size(); ++i)
+	free_chain(send_list_[i].chain_);
+      for (index_type i = 0; i != recv_list_.size(); ++i)
+	free_chain(recv_list_[i].chain_);
+      for (index_type i = 0; i != local_send_list_.size(); ++i)
+	free_chain(local_send_list_[i].chain_);
+      for (index_type i = 0; i != local_recv_list_.size(); ++i)
+	free_chain(local_recv_list_[i].chain_);
+    }
+
+    void release(Binding *b)
+    {
+      Communicator &comm = lhs_am_.impl_comm();
+      for (index_type i = 0; i != b->requests_.size(); ++i)
+	comm.free(b->requests_[i]);
+      for (index_type i = 0; i != b->notice_requests_.size(); ++i)
+      {
+	comm.free(b->notice_requests_[i]);
+	comm.free(b->local_requests_[i]);
+	comm.free(b->ack_requests_[i]);
+      }
+      for (index_type i = 0; i != b->chains_.size(); ++i)
+	free_chain(b->chains_[i]);
+      delete b;
+    }
+
+    /// Return the binding in use.
+    Binding &binding() { return *bindings_.front();}
+
+    /// Return an unbound copy of this plan.
+    Plan *clone() const
+    {
+      Plan *plan = new Plan(lhs_am_, rhs_am_, extent_);
+      std::copy(lhs_stride_, lhs_stride_ + D, plan->lhs_stride_);
+      std::copy(rhs_stride_, rhs_stride_ + D, plan->rhs_stride_);
+      for (index_type i = 0; i != send_list_.size(); ++i)
+	plan->send_list_.push_back(Msg_record(send_list_[i].proc_,
+					      send_list_[i].subblock_,
+					      dup_chain(send_list_[i].chain_)));
+      for (index_type i = 0; i != recv_list_.size(); ++i)
+	plan->recv_list_.push_back(Msg_record(recv_list_[i].proc_,
+					      recv_list_[i].subblock_,
+					      dup_chain(recv_list_[i].chain_)));
+      plan->copy_list_ = copy_list_;
+      for (index_type i = 0; i != local_send_list_.size(); ++i)
+	plan->local_send_list_.push_back(
+	  Msg_record(local_send_list_[i].proc_,
+		     local_send_list_[i].subblock_,
+		     dup_chain(local_send_list_[i].chain_)));
+      for (index_type i = 0; i != local_recv_list_.size(); ++i)
+	plan->local_recv_list_.push_back(
+	  Msg_record(local_recv_list_[i].proc_,
+		     local_recv_list_[i].subblock_,
+		     dup_chain(local_recv_list_[i].chain_)));
+      plan->shm_list_ = shm_list_;
+      plan->segments_ = segments_;
+      return plan;
+    }
+
+    lhs_appmap_t     lhs_am_;
+    rhs_appmap_t     rhs_am_;
+    Length<D>        extent_;
+    stride_type      lhs_stride_[D];
+    stride_type      rhs_stride_[D];
+
+    std::vector<Msg_record>    send_list_;
+    std::vector<Msg_record>    recv_list_;
+    std::vector<Copy_record>   copy_list_;
+    std::vector<Msg_record>    local_send_list_;
+    std::vector<Msg_record>    local_recv_list_;
+    std::vector<Shm_record>    shm_list_;
+    std::vector<char*>         segments_;
+
+    std::vector<Binding*>      bindings_;
+    bool                       active_;
+    std::vector<char>          noticed_;
+  };
+
+  typedef shared_ptr<Plan> plan_ptr;
+  // Most recently used plans first.
+  typedef std::vector<plan_ptr> plan_cache_type;
 
   // Constructor.
 public:
@@ -250,11 +512,6 @@ public:
       lhs_am_   (lhs_.block().map()),
       rhs_am_   (rhs_.block().map()),
       comm_     (lhs_am_.impl_comm()),
-      send_list (),
-      recv_list (),
-      copy_list (),
-      req_list  (),
-      msg_count (0),
       rhs_dda_ (new rhs_dda_type*[rhs_.block().map().num_subblocks()]),
       lhs_dda_ (new lhs_dda_type*[lhs_.block().map().num_subblocks()])
   {
@@ -263,43 +520,21 @@ public:
     chain_assign::build_dda_array<D, RHS>(rhs_, rhs_am_, rhs_dda_, dda::in);
     chain_assign::build_dda_array<D, LHS>(lhs_, lhs_am_, lhs_dda_, dda::out);
 
-    build_send_list();
-    if (!disable_copy)
-      build_copy_list();
-    build_recv_list();
+    plan_ = lookup_plan();
+    if (!plan_.get())
+    {
+      plan_.reset(new Plan(lhs_am_, rhs_am_, extent<D>(lhs_.block())));
+      local_strides(plan_->lhs_stride_, plan_->rhs_stride_);
+      build_send_list();
+      if (!disable_copy)
+	build_copy_list();
+      build_recv_list();
+      cache_plan(plan_);
+    }
   }
 
   ~Assignment()
   {
-    // At destruction, the list of outstanding sends should be empty.
-    // This would be non-empty if:
-    //  - Par_assign did not to clear the lists after
-    //    processing it (library design error), or
-    //  - User executed send() without a corresponding wait().
-    OVXX_PRECONDITION(req_list.size() == 0);
-
-    if (send_list.size() > 0)
-    {
-      typedef typename std::vector<Msg_record>::iterator sl_iterator;
-      sl_iterator sl_cur = send_list.begin();
-      sl_iterator sl_end = send_list.end();
-      for (; sl_cur != sl_end; ++sl_cur)
-      {
-	free_chain((*sl_cur).chain_);
-      }
-    }
-
-    if (recv_list.size() > 0)
-    {
-      typedef typename std::vector<Msg_record>::iterator rl_iterator;
-      rl_iterator rl_cur = recv_list.begin();
-      rl_iterator rl_end = recv_list.end();
-      for (; rl_cur != rl_end; ++rl_cur)
-      {
-	free_chain((*rl_cur).chain_);
-      }
-    }
-
     chain_assign::cleanup_dda_array(lhs_am_.num_subblocks(), lhs_dda_);
     chain_assign::cleanup_dda_array(rhs_am_.num_subblocks(), rhs_dda_);
 
@@ -307,49 +542,154 @@ public:
     delete[] rhs_dda_;
   }
 
-  void operator()()
+  void operator()() { start(); finish();}
+
+  /// Initiate the assignment: start all messages, then perform
+  /// the local copies while the messages are in flight.
+  void start()
   {
-    if (send_list.size() > 0) exec_send_list();
-    if (copy_list.size() > 0) exec_copy_list();
-    if (recv_list.size() > 0) exec_recv_list();
+    // The plan may be shared with another assignment that is in
+    // progress, in which case we need our own.
+    if (plan_->active_)
+      plan_.reset(plan_->clone());
+
+    Plan &plan = *plan_;
+    if (plan.send_list_.size() > 0)
+      rhs_dda_[plan.send_list_[0].subblock_]->sync_in();
+    else if (plan.local_send_list_.size() > 0)
+      rhs_dda_[plan.local_send_list_[0].subblock_]->sync_in();
+
+    bind_requests();
+    Binding &b = plan.binding();
+    // Make the sent subblock visible to the receivers of notices.
+    if (plan.local_send_list_.size() > 0)
+      mpi::sync_shared_memory();
+    comm_.start(b.notice_requests_);
+    plan.noticed_.assign(b.notice_requests_.size(), false);
+    comm_.start(b.requests_);
+    plan.active_ = true;
+    if (plan.copy_list_.size() > 0) exec_copy_list();
+  }
 
-    if (req_list.size() > 0)  wait_send_list();
+  /// Return true if all messages have completed.
+  /// finish() still needs to be called to complete the assignment.
+  bool test()
+  {
+    Plan &plan = *plan_;
+    OVXX_PRECONDITION(plan.active_);
+    Binding &b = plan.binding();
+    bool done = true;
+    for (index_type i = 0; i != b.notice_requests_.size(); ++i)
+      if (!plan.noticed_[i])
+      {
+	if (comm_.test(b.notice_requests_[i])) receive_notice(i);
+	else done = false;
+      }
+    // Test all requests, so they all make progress.
+    done = comm_.test(b.local_requests_) && done;
+    done = comm_.test(b.ack_requests_) && done;
+    return comm_.test(b.requests_) && done;
+  }
+
+  /// Complete the assignment, waiting for all outstanding messages.
+  void finish()
+  {
+    Plan &plan = *plan_;
+    OVXX_PRECONDITION(plan.active_);
+    Binding &b = plan.binding();
 
-    cleanup();
+    for (index_type i = 0; i != b.notice_requests_.size(); ++i)
+      if (!plan.noticed_[i])
+      {
+	comm_.wait(b.notice_requests_[i]);
+	receive_notice(i);
+      }
+    comm_.wait(b.local_requests_);
+    comm_.wait(b.ack_requests_);
+    comm_.wait(b.requests_);
+    plan.active_ = false;
+
+    if (plan.recv_list_.size() > 0)
+      lhs_dda_[plan.recv_list_[0].subblock_]->sync_out();
+    else if (plan.local_recv_list_.size() > 0)
+      lhs_dda_[plan.local_recv_list_[0].subblock_]->sync_out();
   }
 
 private:
   typename view_of<LHS>::type lhs_;
   typename view_of<RHS>::const_type rhs_;
 
+  void local_strides(stride_type *lhs_stride, stride_type *rhs_stride) const;
+
+  plan_ptr lookup_plan() const;
+  static void cache_plan(plan_ptr plan);
+  static plan_cache_type *thread_plans();
+  static void release_plans();
+  static void release_all_plans();
+
   void build_send_list();
   void build_recv_list();
   void build_copy_list();
 
-  void exec_send_list();
-  void exec_recv_list();
+  void bind_requests();
   void exec_copy_list();
+  void receive_notice(index_type i);
+  void copy_shared(index_type i, stride_type const *notice, true_type);
+  // Intra-node transfers of other than plain arrays are done with
+  // messages, so this is never called.
+  void copy_shared(index_type, stride_type const *, false_type) {}
 
-  void wait_send_list();
-
-  void cleanup() {}	// Cleanup send_list buffers.
+  // Whether transfers to and from `proc` can bypass message passing.
+  bool shares_memory(processor_type proc) const
+  { return shm_capable && mpi::shared_segment(comm_, proc) != 0;}
 
   lhs_appmap_t const& lhs_am_;
   rhs_appmap_t const& rhs_am_;
   Communicator& comm_;
 
-  std::vector<Msg_record>    send_list;
-  std::vector<Msg_record>    recv_list;
-  std::vector<Copy_record>   copy_list;
-
-  std::vector<request_type> req_list;
-
-  int                       msg_count;
+  plan_ptr                  plan_;
 
   rhs_dda_type**            rhs_dda_;
   lhs_dda_type**            lhs_dda_;
+
+  // Each thread has its own plan cache. All of them are listed in
+  // caches_, so they can be released when MPI is finalized, even
+  // for threads that never finalize the library.
+  static thread_local plan_cache_type *plans_;
+  static thread_local unsigned plans_generation_;
+  static std::vector<plan_cache_type *> caches_;
+  // Incremented whenever all caches are released, so stale
+  // thread-local cache pointers can be detected. It only changes
+  // while no other thread is running assignments.
+  static unsigned generation_;
+#if defined(OVXX_ENABLE_THREADING)
+  static mutex caches_guard_;
+#endif
 };
 
+template <dimension_type D, typename LHS, typename RHS>
+thread_local
+typename Assignment<D, LHS, RHS, Chained_assign>::plan_cache_type *
+Assignment<D, LHS, RHS, Chained_assign>::plans_ = 0;
+
+template <dimension_type D, typename LHS, typename RHS>
+thread_local unsigned
+Assignment<D, LHS, RHS, Chained_assign>::plans_generation_ = 0;
+
+template <dimension_type D, typename LHS, typename RHS>
+std::vector<typename Assignment<D, LHS, RHS, Chained_assign>::plan_cache_type *>
+Assignment<D, LHS, RHS, Chained_assign>::caches_;
+
+template <dimension_type D, typename LHS, typename RHS>
+unsigned
+Assignment<D, LHS, RHS, Chained_assign>::generation_ = 0;
+
+#if defined(OVXX_ENABLE_THREADING)
+template <dimension_type D, typename LHS, typename RHS>
+mutex
+Assignment<D, LHS, RHS, Chained_assign>::caches_guard_;
+#endif
+
 
 
 /***********************************************************************
@@ -446,7 +786,13 @@ Assignment<D, LHS, RHS, Chained_assign>::build_send_list()
 	  }
 	}
 	if (!builder.is_empty())
-	  send_list.push_back(Msg_record(proc, rhs_sb, builder.get_chain()));
+	{
+	  Msg_record msg(proc, rhs_sb, builder.get_chain());
+	  if (shares_memory(proc))
+	    plan_->local_send_list_.push_back(msg);
+	  else
+	    plan_->send_list_.push_back(msg);
+	}
 	dda->sync_out();
       }
     }
@@ -495,6 +841,7 @@ Assignment<D, LHS, RHS, Chained_assign>::build_recv_list()
       if (!disable_copy && proc == rank)
 	continue;
       Chain_builder builder;
+      bool local = shares_memory(proc);
       
       index_type rhs_sb = rhs_am_.subblock(proc);
 
@@ -524,6 +871,13 @@ Assignment<D, LHS, RHS, Chained_assign>::build_recv_list()
 	      Domain<dim> recv_dom = apply_intr(lhs_ldom, lhs_dom, intr);
 	      
 	      chain_assign::chain_add<lhs_order_t>(builder, *dda, recv_dom);
+	      if (local)
+	      {
+		Domain<dim> rhs_ldom = local_domain(rhs_, rhs_sb, sp);
+		Domain<dim> send_dom = apply_intr(rhs_ldom, rhs_dom, intr);
+		plan_->shm_list_.push_back(
+		  Shm_record(plan_->local_recv_list_.size(), send_dom, recv_dom));
+	      }
 	      
 #if OVXX_PCA_VERBOSE >= 1
 	      std::cout << "(" << rank << ") recv "
@@ -541,8 +895,16 @@ Assignment<D, LHS, RHS, Chained_assign>::build_recv_list()
 	  }
 	}
       }
-      if (!builder.is_empty())
-	recv_list.push_back(Msg_record(proc, lhs_sb, builder.get_chain()));
+      if (builder.is_empty())
+	continue;
+      Msg_record msg(proc, lhs_sb, builder.get_chain());
+      if (local)
+      {
+	plan_->local_recv_list_.push_back(msg);
+	plan_->segments_.push_back(mpi::shared_segment(comm_, proc));
+      }
+      else
+	plan_->recv_list_.push_back(msg);
     }
     dda->sync_out();
   }
@@ -591,7 +953,7 @@ Assignment<D, LHS, RHS, Chained_assign>::build_copy_list()
 	    Domain<dim> send_dom = apply_intr(rhs_ldom, rhs_dom, intr);
 	    Domain<dim> recv_dom = apply_intr(lhs_ldom, lhs_dom, intr);
 
-	    copy_list.push_back(Copy_record(rhs_sb, lhs_sb,
+	    plan_->copy_list_.push_back(Copy_record(rhs_sb, lhs_sb,
 					    send_dom, recv_dom));
 
 #if OVXX_PCA_VERBOSE >= 2
@@ -622,76 +984,134 @@ Assignment<D, LHS, RHS, Chained_assign>::build_copy_list()
 
 
 
-// Execute the send_list.
+// Bind the plan's messages to the local subblocks, creating
+// persistent requests for them.  This is only done if the plan has
+// no binding for the subblocks' current locations yet.
 
 template <dimension_type D, typename LHS, typename RHS>
 void
-Assignment<D, LHS, RHS, Chained_assign>::exec_send_list()
+Assignment<D, LHS, RHS, Chained_assign>::bind_requests()
 {
+  Plan &plan = *plan_;
+
+  rhs_ptr_type send_base = rhs_ptr_type();
+  lhs_ptr_type recv_base = lhs_ptr_type();
+  if (plan.send_list_.size() > 0)
+    // FIXME: Does this have to be non-const ?
+    send_base = rhs_dda_[plan.send_list_[0].subblock_]->non_const_ptr();
+  else if (plan.local_send_list_.size() > 0)
+    send_base = rhs_dda_[plan.local_send_list_[0].subblock_]->non_const_ptr();
+  if (plan.recv_list_.size() > 0)
+    recv_base = lhs_dda_[plan.recv_list_[0].subblock_]->non_const_ptr();
+  else if (plan.local_recv_list_.size() > 0)
+    recv_base = lhs_dda_[plan.local_recv_list_[0].subblock_]->non_const_ptr();
+
+  typedef typename std::vector<Binding*>::iterator bl_iterator;
+  for (bl_iterator i = plan.bindings_.begin(); i != plan.bindings_.end(); ++i)
+    if ((*i)->send_base_ == send_base && (*i)->recv_base_ == recv_base)
+    {
+      Binding *found = *i;
+      plan.bindings_.erase(i);
+      plan.bindings_.insert(plan.bindings_.begin(), found);
+      return;
+    }
+
 #if OVXX_PCA_VERBOSE >= 1
   processor_type rank = local_processor();
   std::cout << "(" << rank << ") "
-	    << "exec_send_list(size: " << send_list.size()
+	    << "bind_requests(send: " << plan.send_list_.size()
+	    << ", recv: " << plan.recv_list_.size()
 	    << ") -------------------------------------\n";
 #endif
-  typedef typename std::vector<Msg_record>::iterator sl_iterator;
 
+  if (plan.bindings_.size() == OVXX_PCA_BINDINGS)
   {
-    sl_iterator sl_cur = send_list.begin();
-    sl_iterator sl_end = send_list.end();
-    for (; sl_cur != sl_end; ++sl_cur)
-    {
-      Chain_builder builder;
-      processor_type proc = (*sl_cur).proc_;
-
-      rhs_dda_type* dda = rhs_dda_[(*sl_cur).subblock_];
-      dda->sync_in();
-      // FIXME: Does this have to be non-const ?
-      builder.stitch(dda->non_const_ptr(), (*sl_cur).chain_);
-      dda->sync_out();
-      
-      chain_type chain = builder.get_chain();
-      request_type   req;
-      comm_.send(proc, chain, req);
-      free_chain(chain);
-      req_list.push_back(req);
-    }
+    plan.release(plan.bindings_.back());
+    plan.bindings_.pop_back();
   }
-}
-
+  plan.bindings_.insert(plan.bindings_.begin(),
+			new Binding(send_base, recv_base));
+  Binding &b = plan.binding();
 
+  typedef typename std::vector<Msg_record>::iterator ml_iterator;
 
-// Execute the recv_list.
-
-template <dimension_type D, typename LHS, typename RHS>
-void
-Assignment<D, LHS, RHS, Chained_assign>::exec_recv_list()
-{
-#if OVXX_PCA_VERBOSE >= 1
-  processor_type rank = local_processor();
-  std::cout << "(" << rank << ") "
-	    << "exec_recv_list(size: " << recv_list.size()
-	    << ") -------------------------------------\n";
-#endif
+  // Post receives before sends, so incoming messages can be placed
+  // directly into the destination.
+  for (ml_iterator rl_cur = plan.recv_list_.begin();
+       rl_cur != plan.recv_list_.end();
+       ++rl_cur)
+  {
+    Chain_builder builder;
+    builder.stitch(recv_base, (*rl_cur).chain_);
+    chain_type chain = builder.get_chain();
+    request_type req;
+    comm_.recv_init((*rl_cur).proc_, chain, req);
+    b.chains_.push_back(chain);
+    b.requests_.push_back(req);
+  }
 
-  typedef typename std::vector<Msg_record>::iterator rl_iterator;
-  rl_iterator rl_cur = recv_list.begin();
-  rl_iterator rl_end = recv_list.end();
-    
-  for (; rl_cur != rl_end; ++rl_cur)
+  for (ml_iterator sl_cur = plan.send_list_.begin();
+       sl_cur != plan.send_list_.end();
+       ++sl_cur)
   {
     Chain_builder builder;
-    processor_type proc = (*rl_cur).proc_;
+    builder.stitch(send_base, (*sl_cur).chain_);
+    chain_type chain = builder.get_chain();
+    request_type req;
+    comm_.send_init((*sl_cur).proc_, chain, req);
+    b.chains_.push_back(chain);
+    b.requests_.push_back(req);
+  }
 
-    lhs_dda_type* dda = lhs_dda_[(*rl_cur).subblock_];
-    dda->sync_in();
-    builder.stitch(dda->ptr(), (*rl_cur).chain_);
-    dda->sync_out();
+  // Intra-node transfers: the sender notifies the receiver of the
+  // location (offset and strides) of its subblock, then waits for the
+  // receiver's acknowledgement.  If the subblock isn't in shared
+  // memory, the data is sent as a message instead.
+  length_type const notice_size = D + 1;
+  b.notices_.resize(notice_size * (plan.local_send_list_.size() +
+				   plan.local_recv_list_.size()));
+  stride_type *notice = b.notices_.size() ? &b.notices_[0] : 0;
+  for (ml_iterator sl_cur = plan.local_send_list_.begin();
+       sl_cur != plan.local_send_list_.end();
+       ++sl_cur, notice += notice_size)
+  {
+    notice[0] = chain_assign::shared_offset(send_base);
+    for (dimension_type d = 0; d != D; ++d)
+      notice[d + 1] = rhs_dda_[(*sl_cur).subblock_]->stride(d);
+    request_type req;
+    comm_.send_init((*sl_cur).proc_, notice, notice_size, notice_tag, req);
+    b.requests_.push_back(req);
+    if (notice[0] != -1)
+      comm_.recv_init((*sl_cur).proc_, static_cast<char*>(0), 0, ack_tag, req);
+    else
+    {
+      Chain_builder builder;
+      builder.stitch(send_base, (*sl_cur).chain_);
+      chain_type chain = builder.get_chain();
+      comm_.send_init((*sl_cur).proc_, chain, req);
+      b.chains_.push_back(chain);
+    }
+    b.requests_.push_back(req);
+  }
 
+  // The receiver's requests are started as the notices arrive.
+  for (ml_iterator rl_cur = plan.local_recv_list_.begin();
+       rl_cur != plan.local_recv_list_.end();
+       ++rl_cur, notice += notice_size)
+  {
+    request_type req;
+    comm_.recv_init((*rl_cur).proc_, notice, notice_size, notice_tag, req);
+    b.notice_requests_.push_back(req);
+    Chain_builder builder;
+    builder.stitch(recv_base, (*rl_cur).chain_);
     chain_type chain = builder.get_chain();
-    comm_.recv(proc, chain);
-    free_chain(chain);
+    comm_.recv_init((*rl_cur).proc_, chain, req);
+    b.chains_.push_back(chain);
+    b.local_requests_.push_back(req);
+    comm_.send_init((*rl_cur).proc_, static_cast<char*>(0), 0, ack_tag, req);
+    b.ack_requests_.push_back(req);
   }
+
 }
 
 
@@ -705,7 +1125,7 @@ Assignment<D, LHS, RHS, Chained_assign>::exec_copy_list()
 #if OVXX_PCA_VERBOSE >= 1
   processor_type rank = local_processor();
   std::cout << "(" << rank << ") "
-	    << "exec_copy_list(size: " << copy_list.size()
+	    << "exec_copy_list(size: " << plan_->copy_list_.size()
 	    << ") -------------------------------------\n";
 #endif
 
@@ -713,8 +1133,8 @@ Assignment<D, LHS, RHS, Chained_assign>::exec_copy_list()
   lhs_lview_type lhs_lview = ovxx::get_local_view(lhs_);
 
   typedef typename std::vector<Copy_record>::iterator cl_iterator;
-  for (cl_iterator cl_cur = copy_list.begin();
-       cl_cur != copy_list.end();
+  for (cl_iterator cl_cur = plan_->copy_list_.begin();
+       cl_cur != plan_->copy_list_.end();
        ++cl_cur)
   {
     view_assert_local(rhs_, (*cl_cur).rhs_sb_);
@@ -735,25 +1155,207 @@ Assignment<D, LHS, RHS, Chained_assign>::exec_copy_list()
 
 
 
-// Wait for the send_list instructions to be completed.
+// Process the notice of the i'th intra-node transfer: copy the data
+// directly from the sender's subblock and acknowledge, or receive it
+// as a message if the sender's subblock isn't in shared memory.
+
+template <dimension_type D, typename LHS, typename RHS>
+void
+Assignment<D, LHS, RHS, Chained_assign>::receive_notice(index_type i)
+{
+  Plan &plan = *plan_;
+  Binding &b = plan.binding();
+  stride_type const *notice =
+    &b.notices_[(D + 1) * (plan.local_send_list_.size() + i)];
+  plan.noticed_[i] = true;
+  if (notice[0] == -1)
+    comm_.start(b.local_requests_[i]);
+  else
+  {
+    copy_shared(i, notice, integral_constant<bool, shm_capable>());
+    comm_.start(b.ack_requests_[i]);
+  }
+}
+
+
+
+template <dimension_type D, typename LHS, typename RHS>
+void
+Assignment<D, LHS, RHS, Chained_assign>::copy_shared(
+  index_type i, stride_type const *notice, true_type)
+{
+  Plan &plan = *plan_;
+#if OVXX_PCA_VERBOSE >= 1
+  processor_type rank = local_processor();
+  std::cout << "(" << rank << ") "
+	    << "copy_shared(from: " << plan.local_recv_list_[i].proc_
+	    << ") -------------------------------------\n";
+#endif
+  // Make the sender's writes visible.
+  mpi::sync_shared_memory();
+
+  lhs_dda_type *dda = lhs_dda_[plan.local_recv_list_[i].subblock_];
+  stride_type lhs_stride[D];
+  for (dimension_type d = 0; d != D; ++d)
+    lhs_stride[d] = dda->stride(d);
+  rhs_value_type const *src =
+    reinterpret_cast<rhs_value_type const *>(plan.segments_[i] + notice[0]);
+
+  typedef typename std::vector<Shm_record>::iterator sl_iterator;
+  for (sl_iterator sl_cur = plan.shm_list_.begin();
+       sl_cur != plan.shm_list_.end();
+       ++sl_cur)
+    if ((*sl_cur).msg_ == i)
+      chain_assign::local_copy<lhs_order_t>(plan.binding().recv_base_, lhs_stride,
+					    (*sl_cur).lhs_dom_,
+					    src, notice + 1,
+					    (*sl_cur).rhs_dom_);
+}
+
+
+
+// Record the local subblocks' strides, which determine the layout
+// the message chains were built for.
+
+template <dimension_type D, typename LHS, typename RHS>
+void
+Assignment<D, LHS, RHS, Chained_assign>::local_strides(
+  stride_type *lhs_stride, stride_type *rhs_stride) const
+{
+  processor_type rank = local_processor();
+  index_type lhs_sb = lhs_am_.subblock(rank);
+  index_type rhs_sb = rhs_am_.subblock(rank);
+
+  for (dimension_type d = 0; d != D; ++d)
+  {
+    lhs_stride[d] = lhs_sb != no_subblock ? lhs_dda_[lhs_sb]->stride(d) : 0;
+    rhs_stride[d] = rhs_sb != no_subblock ? rhs_dda_[rhs_sb]->stride(d) : 0;
+  }
+}
+
+
+
+// Find a cached plan matching this assignment, and move it to
+// the front of the cache.
+
+template <dimension_type D, typename LHS, typename RHS>
+typename Assignment<D, LHS, RHS, Chained_assign>::plan_ptr
+Assignment<D, LHS, RHS, Chained_assign>::lookup_plan() const
+{
+  plan_cache_type *plans = thread_plans();
+  if (!plans) return plan_ptr();
+
+  Length<D> ext = extent<D>(lhs_.block());
+  stride_type lhs_stride[D];
+  stride_type rhs_stride[D];
+  local_strides(lhs_stride, rhs_stride);
+
+  typedef typename plan_cache_type::iterator iterator;
+  for (iterator i = plans->begin(); i != plans->end(); ++i)
+  {
+    Plan const &plan = **i;
+    if (!(plan.extent_ == ext) ||
+	!std::equal(lhs_stride, lhs_stride + D, plan.lhs_stride_) ||
+	!std::equal(rhs_stride, rhs_stride + D, plan.rhs_stride_) ||
+	!is_same_map<D>(plan.lhs_am_, lhs_am_) ||
+	!is_same_map<D>(plan.rhs_am_, rhs_am_))
+      continue;
+
+    plan_ptr found = *i;
+    plans->erase(i);
+    plans->insert(plans->begin(), found);
+    return found;
+  }
+  return plan_ptr();
+}
+
+
+
+// Return the calling thread's plan cache, or null if it has none
+// (or it has been released).
+
+template <dimension_type D, typename LHS, typename RHS>
+typename Assignment<D, LHS, RHS, Chained_assign>::plan_cache_type *
+Assignment<D, LHS, RHS, Chained_assign>::thread_plans()
+{
+  if (plans_ && plans_generation_ != generation_) plans_ = 0;
+  return plans_;
+}
+
+
+
+// Insert a new plan at the front of the cache, evicting the least
+// recently used one if the cache is full.
+
+template <dimension_type D, typename LHS, typename RHS>
+void
+Assignment<D, LHS, RHS, Chained_assign>::cache_plan(plan_ptr plan)
+{
+  if (OVXX_PCA_CACHE_SIZE == 0) return;
+
+  plan_cache_type *plans = thread_plans();
+  if (!plans)
+  {
+#if defined(OVXX_ENABLE_THREADING)
+    lock_guard<mutex> lock(caches_guard_);
+#endif
+    plans = plans_ = new plan_cache_type;
+    plans_generation_ = generation_;
+    caches_.push_back(plans);
+    // Plans hold MPI resources, so they need to be released
+    // before MPI is finalized.
+    mpi::at_finalize(&release_plans);
+    mpi::at_mpi_finalize(&release_all_plans);
+  }
+  if (plans->size() == OVXX_PCA_CACHE_SIZE)
+    plans->pop_back();
+  plans->insert(plans->begin(), plan);
+}
+
+
+
+// Release the calling thread's plan cache.
 
 template <dimension_type D, typename LHS, typename RHS>
 void
-Assignment<D, LHS, RHS, Chained_assign>::wait_send_list()
+Assignment<D, LHS, RHS, Chained_assign>::release_plans()
 {
-  typename std::vector<request_type>::iterator
-		cur = req_list.begin(),
-		end = req_list.end();
-  for(; cur != end; ++cur)
+  plan_cache_type *plans = thread_plans();
+  if (!plans) return;
   {
-    comm_.wait(*cur);
+#if defined(OVXX_ENABLE_THREADING)
+    lock_guard<mutex> lock(caches_guard_);
+#endif
+    caches_.erase(std::find(caches_.begin(), caches_.end(), plans));
   }
-  req_list.clear();
+  delete plans;
+  plans_ = 0;
+}
+
+
+
+// Release the plan caches of all threads.
+
+template <dimension_type D, typename LHS, typename RHS>
+void
+Assignment<D, LHS, RHS, Chained_assign>::release_all_plans()
+{
+#if defined(OVXX_ENABLE_THREADING)
+  lock_guard<mutex> lock(caches_guard_);
+#endif
+  for (typename std::vector<plan_cache_type *>::iterator i = caches_.begin();
+       i != caches_.end(); ++i)
+    delete *i;
+  caches_.clear();
+  ++generation_;
+  plans_ = 0;
 }
 
 } // namespace ovxx::parallel
 } // namespace ovxx
 
+#undef OVXX_PCA_BINDINGS
+#undef OVXX_PCA_CACHE_SIZE
 #undef OVXX_PCA_VERBOSE
 #undef OVXX_PCA_ROTATE
 
@@ -0,0 +1,299 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_parallel_corner_turn_hpp_
+#define ovxx_parallel_corner_turn_hpp_
+
+#include <ovxx/support.hpp>
+#include <ovxx/domain_utils.hpp>
+#include <ovxx/parallel/service.hpp>
+#include <vector>
+#include <algorithm>
+
+// Batches whose average message size (in bytes) is below this
+// threshold are exchanged with a single all-to-all collective,
+// larger ones with pairwise messages.
+#ifndef OVXX_CORNER_TURN_COLLECTIVE_MAX
+# define OVXX_CORNER_TURN_COLLECTIVE_MAX 16384
+#endif
+
+namespace ovxx
+{
+namespace parallel
+{
+
+/// Corner turn of a matrix from a row-wise block distribution (with
+/// row-major local storage) to a column-wise block distribution
+/// (with column-major local storage), such as used by distributed
+/// 2D FFTs.
+///
+/// The local rows are exchanged in batches, so the caller can
+/// overlap the transfer of one batch with computing the next:
+///
+///   for (index_type b = 0; b != ct.batches(); ++b)
+///   {
+///     <compute local rows ct.batch(b)>
+///     if (b) ct.finish(b - 1);
+///     ct.start(b);
+///   }
+///   ct.finish(ct.batches() - 1);
+///
+/// (At most one batch may be in flight at any time.)
+///
+/// If the average message is small, batches are packed and exchanged
+/// using an all-to-all collective. Otherwise, each batch is exchanged
+/// using pairwise messages (in rotated order, so processors don't all
+/// send to the same destination at once) that are set up once as
+/// persistent requests, and transfer directly between the two matrices.
+///
+/// Requirements:
+///   Both maps distribute the matrix over the same processors, in
+///   the same order, and the local processor holds a subblock.
+///   `src` and `dst` point to the (dense) local subblock data, and
+///   remain valid for the lifetime of the Corner_turn object.
+template <typename T>
+class Corner_turn : ovxx::detail::noncopyable
+{
+  typedef Communicator::request_type request_type;
+  typedef Communicator::chain_type chain_type;
+
+public:
+  template <typename RowMap, typename ColMap>
+  Corner_turn(RowMap const &row_map, T *src,
+	      ColMap const &col_map, T *dst,
+	      length_type batches)
+    : comm_(row_map.impl_comm()),
+      src_(src),
+      dst_(dst),
+      size_(row_map.num_subblocks(0)),
+      self_(row_map.subblock()),
+      proc_(size_),
+      row_(size_),
+      col_(size_),
+      batches_(batches),
+      requests_(batches),
+      counts_(4 * size_, 0)
+  {
+    OVXX_PRECONDITION(self_ != no_subblock);
+    OVXX_PRECONDITION(col_map.num_subblocks(1) == size_);
+    OVXX_PRECONDITION(batches_ > 0);
+
+    for (index_type p = 0; p != size_; ++p)
+    {
+      OVXX_PRECONDITION(row_map.impl_proc_from_rank(p) ==
+			col_map.impl_proc_from_rank(p));
+      proc_[p] = row_map.impl_proc_from_rank(p);
+      row_[p] = row_map.template impl_global_domain<2>(p, 0)[0];
+      col_[p] = col_map.template impl_global_domain<2>(p, 0)[1];
+    }
+    src_stride_ = row_map.template impl_subblock_domain<2>(self_)[1].size();
+    dst_stride_ = col_map.template impl_subblock_domain<2>(self_)[0].size();
+
+    // Average message size of a batch.
+    length_type bytes = sizeof(T) *
+      (dst_stride_ / size_ / batches_) * (src_stride_ / size_);
+    collective_ = size_ > 1 && bytes < OVXX_CORNER_TURN_COLLECTIVE_MAX;
+
+    if (collective_)
+    {
+      length_type send_size = 0, recv_size = 0;
+      for (index_type b = 0; b != batches_; ++b)
+      {
+	send_size = std::max(send_size, batch_size(b, self_) * src_stride_);
+	length_type size = 0;
+	for (index_type p = 0; p != size_; ++p)
+	  size += batch_size(b, p) * col_[self_].size();
+	recv_size = std::max(recv_size, size);
+      }
+      send_buffer_.resize(send_size);
+      recv_buffer_.resize(recv_size);
+    }
+    else
+      for (index_type b = 0; b != batches_; ++b)
+	init_requests(b);
+  }
+
+  ~Corner_turn()
+  {
+    for (index_type b = 0; b != requests_.size(); ++b)
+      for (index_type i = 0; i != requests_[b].size(); ++i)
+	comm_.free(requests_[b][i]);
+    for (index_type i = 0; i != chains_.size(); ++i)
+      free_chain(chains_[i]);
+  }
+
+  length_type batches() const { return batches_;}
+
+  /// Return the local rows making up batch `b`.
+  Domain<1> batch(index_type b) const
+  { return Domain<1>(batch_first(b, self_), 1, batch_size(b, self_));}
+
+  /// Return true if batches are exchanged using a collective.
+  bool collective() const { return collective_;}
+
+  /// Start the exchange of batch `b`. Batches need to be
+  /// started in order.
+  void start(index_type b)
+  {
+    copy_local(b);
+    if (collective_) start_collective(b);
+    else comm_.start(requests_[b]);
+  }
+
+  /// Wait for the exchange of batch `b` to complete.
+  void finish(index_type b)
+  {
+    if (collective_)
+    {
+      comm_.wait(collective_request_);
+      unpack(b);
+    }
+    else comm_.wait(requests_[b]);
+  }
+
+private:
+  index_type batch_first(index_type b, index_type p) const
+  { return b * row_[p].size() / batches_;}
+  length_type batch_size(index_type b, index_type p) const
+  { return batch_first(b + 1, p) - batch_first(b, p);}
+
+  /// Transfer the block of rows in batch `b` that stays local.
+  void copy_local(index_type b)
+  {
+    index_type first = batch_first(b, self_);
+    length_type size = batch_size(b, self_);
+    Domain<1> const &col = col_[self_];
+    T const *src = src_ + first * src_stride_ + col.first();
+    T *dst = dst_ + row_[self_].first() + first;
+    for (index_type c = 0; c != col.size(); ++c)
+      for (index_type r = 0; r != size; ++r)
+	dst[c * dst_stride_ + r] = src[r * src_stride_ + c];
+  }
+
+  /// Set up persistent requests for batch `b`, receiving directly
+  /// into the column-major destination.
+  void init_requests(index_type b)
+  {
+    for (index_type s = 1; s != size_; ++s)
+    {
+      index_type from = (self_ + size_ - s) % size_;
+      length_type size = batch_size(b, from);
+      if (size && col_[self_].size())
+      {
+	Chain_builder builder;
+	builder.add<T>(sizeof(T) * (row_[from].first() + batch_first(b, from)),
+		       1, size, dst_stride_, col_[self_].size());
+	add_request(builder, dst_, from, b, false);
+      }
+    }
+    length_type size = batch_size(b, self_);
+    for (index_type s = 1; s != size_; ++s)
+    {
+      index_type to = (self_ + s) % size_;
+      if (size && col_[to].size())
+      {
+	Chain_builder builder;
+	builder.add<T>(sizeof(T) * (batch_first(b, self_) * src_stride_ +
+				    col_[to].first()),
+		       src_stride_, size, 1, col_[to].size());
+	add_request(builder, src_, to, b, true);
+      }
+    }
+  }
+
+  void add_request(Chain_builder &builder, T *base, index_type p,
+		   index_type b, bool send)
+  {
+    chain_type relative = builder.get_chain();
+    Chain_builder stitched;
+    stitched.stitch(base, relative);
+    chain_type chain = stitched.get_chain();
+    free_chain(relative);
+    request_type req;
+    if (send) comm_.send_init(proc_[p], chain, req);
+    else      comm_.recv_init(proc_[p], chain, req);
+    chains_.push_back(chain);
+    requests_[b].push_back(req);
+  }
+
+  /// Pack batch `b` and start the collective exchange.
+  void start_collective(index_type b)
+  {
+    int *send_counts = &counts_[0];
+    int *send_displs = &counts_[size_];
+    int *recv_counts = &counts_[2 * size_];
+    int *recv_displs = &counts_[3 * size_];
+
+    index_type first = batch_first(b, self_);
+    length_type size = batch_size(b, self_);
+    index_type offset = 0;
+    for (index_type p = 0; p != size_; ++p)
+    {
+      length_type cols = p == self_ ? 0 : col_[p].size();
+      T const *src = src_ + first * src_stride_ + col_[p].first();
+      T *buffer = &send_buffer_[offset];
+      for (index_type r = 0; r != size; ++r)
+	for (index_type c = 0; c != cols; ++c)
+	  *buffer++ = src[r * src_stride_ + c];
+      send_counts[p] = size * cols;
+      send_displs[p] = offset;
+      offset += size * cols;
+    }
+    offset = 0;
+    for (index_type p = 0; p != size_; ++p)
+    {
+      recv_counts[p] = p == self_ ? 0 : batch_size(b, p) * col_[self_].size();
+      recv_displs[p] = offset;
+      offset += recv_counts[p];
+    }
+    comm_.alltoallv(send_buffer_.empty() ? 0 : &send_buffer_[0],
+		    send_counts, send_displs,
+		    recv_buffer_.empty() ? 0 : &recv_buffer_[0],
+		    recv_counts, recv_displs,
+		    collective_request_);
+  }
+
+  /// Scatter the data received for batch `b` into the destination.
+  void unpack(index_type b)
+  {
+    length_type cols = col_[self_].size();
+    for (index_type p = 0; p != size_; ++p)
+    {
+      if (p == self_) continue;
+      T const *buffer = &recv_buffer_[0] + counts_[3 * size_ + p];
+      T *dst = dst_ + row_[p].first() + batch_first(b, p);
+      length_type size = batch_size(b, p);
+      for (index_type r = 0; r != size; ++r)
+	for (index_type c = 0; c != cols; ++c)
+	  dst[c * dst_stride_ + r] = *buffer++;
+    }
+  }
+
+  Communicator comm_;
+  T *src_;
+  T *dst_;
+  length_type size_;
+  index_type self_;
+  std::vector<processor_type> proc_;
+  std::vector<Domain<1> > row_;  // global rows of each subblock
+  std::vector<Domain<1> > col_;  // global columns of each subblock
+  length_type src_stride_;       // row length of the source
+  length_type dst_stride_;       // column length of the destination
+  length_type batches_;
+  bool collective_;
+  std::vector<std::vector<request_type> > requests_;
+  std::vector<chain_type> chains_;
+  std::vector<T> send_buffer_;
+  std::vector<T> recv_buffer_;
+  std::vector<int> counts_;
+  request_type collective_request_;
+};
+
+} // namespace ovxx::parallel
+} // namespace ovxx
+
+#endif
@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_parallel_reductions_hpp_
+#define ovxx_parallel_reductions_hpp_
+
+// This header is included by <ovxx/reductions/reductions.hpp>
+// once reduce() is defined.
+
+#include <ovxx/parallel/service.hpp>
+#include <ovxx/parallel/map_traits.hpp>
+
+namespace ovxx
+{
+namespace parallel
+{
+
+/// Wrap a mean-based reduction so it returns the (unnormalized)
+/// sum. The partial sums of all processors are then combined,
+/// and normalized with the global size.
+template <template <typename> class R>
+struct partial_reduction
+{
+  template <typename T>
+  struct type : R<T>
+  {
+    static typename R<T>::accum_type
+    value(typename R<T>::accum_type state, length_type) { return state;}
+  };
+};
+
+template <template <typename> class R, typename V>
+typename R<typename V::value_type>::result_type
+local_reduce(V view, false_type) { return ovxx::reduce<R>(view);}
+
+template <template <typename> class R, typename V>
+typename R<typename V::value_type>::result_type
+local_reduce(V view, true_type)
+{ return ovxx::reduce<partial_reduction<R>::template type>(view);}
+
+/// Return true if the local processor contributes its subblock to
+/// a reduction over a view with the given map. (If a subblock is
+/// held by multiple processors, only the first one contributes.)
+template <typename M>
+inline bool
+contributes(M const &map)
+{
+  index_type sb = map.subblock();
+  return sb != no_subblock && *map.processor_begin(sb) == local_processor();
+}
+
+/// Return true if every processor in the communicator holds all
+/// the data, so no communication is required.
+template <typename M>
+inline bool
+is_replicated(M const &map)
+{
+  return map.num_subblocks() == 1 &&
+    map.num_processors() == map.impl_comm().size();
+}
+
+} // namespace ovxx::parallel
+
+namespace dispatcher
+{
+
+/// Reduce distributed views: each processor reduces its local
+/// subblock, then the partial results are combined across processors.
+template <template <typename> class R,
+	  typename T, typename B, typename O, dimension_type D>
+struct Evaluator<op::reduce<R>, be::parallel,
+  void(T&, B const&, O, integral_constant<dimension_type, D>)>
+{
+  typedef typename B::value_type value_type;
+  typedef typename B::map_type map_type;
+  // Expression blocks are only usable as const types.
+  typedef typename conditional<is_expr_block<B>::value, B const, B>::type
+    block_type;
+  typedef typename view_of<block_type>::const_type view_type;
+
+  static char const* name() { return "parallel";}
+
+  static bool const ct_valid =
+    parallel::is_global_only<map_type>::value &&
+    parallel::reduction_supported<R<value_type>::rtype, T>::value;
+
+  // Expressions combining differently-mapped views are
+  // evaluated element-wise.
+  static bool rt_valid(T&, B const &a, O, integral_constant<dimension_type, D>)
+  { return parallel::has_same_map<D>(a.map(), a);}
+
+  static void exec(T &r, B const &a, O, integral_constant<dimension_type, D>)
+  {
+    typedef integral_constant<bool, reduction::is_mean_based<R>::value> mean_based;
+    map_type const &map = a.map();
+    bool replicated = parallel::is_replicated(map);
+
+    T local = R<value_type>::initial();
+    if (replicated || parallel::contributes(map))
+    {
+      view_type view(const_cast<B&>(a));
+      local = parallel::local_reduce<R>(get_local_view(view), mean_based());
+    }
+    if (!replicated)
+      local = map.impl_comm().allreduce(R<value_type>::rtype, local);
+    r = R<value_type>::value(local, total_size(extent<D>(a)));
+  }
+};
+
+} // namespace ovxx::dispatcher
+} // namespace ovxx
+
+#endif
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_parallel_reductions_idx_hpp_
+#define ovxx_parallel_reductions_idx_hpp_
+
+// This header is included by <ovxx/reductions/reductions_idx.hpp>
+// once reduce_idx() is defined.
+
+#include <ovxx/parallel/reductions.hpp>
+
+namespace ovxx
+{
+namespace parallel
+{
+
+/// Map index reductions to the operation used to combine
+/// their (value, index) results across processors.
+template <template <typename> class R>
+struct idx_reduction { static bool const valid = false;};
+
+#define OVXX_IDX_REDUCTION(R, RT)					\
+template <> struct idx_reduction<R>				\
+{								\
+  static bool const valid = true;				\
+  static reduction_type const rtype = RT;			\
+};
+
+OVXX_IDX_REDUCTION(Max_value, reduce_max)
+OVXX_IDX_REDUCTION(Max_mag_value, reduce_max)
+OVXX_IDX_REDUCTION(Max_magsq_value, reduce_max)
+OVXX_IDX_REDUCTION(Min_value, reduce_min)
+OVXX_IDX_REDUCTION(Min_mag_value, reduce_min)
+OVXX_IDX_REDUCTION(Min_magsq_value, reduce_min)
+
+#undef OVXX_IDX_REDUCTION
+
+/// Return the position of `idx` when traversing a view of
+/// extent `len` in the order `O`.
+template <typename O, dimension_type D>
+index_type
+position(Index<D> const &idx, Length<D> const &len)
+{
+  dimension_type const order[3] = { O::impl_dim0, O::impl_dim1, O::impl_dim2};
+  index_type pos = 0;
+  for (dimension_type i = 0; i != 3; ++i)
+    if (order[i] < D) pos = pos * len[order[i]] + idx[order[i]];
+  return pos;
+}
+
+/// Return the index at position `pos` when traversing a view of
+/// extent `len` in the order `O`.
+template <typename O, dimension_type D>
+Index<D>
+index_from_position(index_type pos, Length<D> const &len)
+{
+  dimension_type const order[3] = { O::impl_dim0, O::impl_dim1, O::impl_dim2};
+  Index<D> idx;
+  for (dimension_type i = 3; i-- != 0;)
+    if (order[i] < D)
+    {
+      idx[order[i]] = pos % len[order[i]];
+      pos /= len[order[i]];
+    }
+  return idx;
+}
+
+} // namespace ovxx::parallel
+
+namespace dispatcher
+{
+
+/// Index reductions of distributed views: each processor reduces its
+/// local subblock, then the (value, global index) pairs are combined
+/// across processors. Ties go to the element encountered first when
+/// traversing the global view, as in the non-distributed case.
+template <template <typename> class R,
+	  typename T, typename B, dimension_type D, typename O>
+struct Evaluator<op::reduce_idx<R>, be::parallel,
+		 void(T&, B const&, Index<D>&, O)>
+{
+  typedef typename B::map_type map_type;
+  // Expression blocks are only usable as const types.
+  typedef typename conditional<is_expr_block<B>::value, B const, B>::type
+    block_type;
+  typedef typename view_of<block_type>::const_type view_type;
+
+  static char const* name() { return "parallel";}
+
+  static bool const ct_valid =
+    parallel::is_global_only<map_type>::value &&
+    parallel::idx_reduction<R>::valid;
+
+  static bool rt_valid(T&, B const &a, Index<D>&, O)
+  { return parallel::has_same_map<D>(a.map(), a);}
+
+  static void exec(T &r, B const &a, Index<D> &idx, O)
+  {
+    map_type const &map = a.map();
+    bool replicated = parallel::is_replicated(map);
+    Length<D> len = extent<D>(a);
+
+    T value = T();
+    index_type pos = mpi::Value_index<T>::npos;
+    if (replicated || parallel::contributes(map))
+    {
+      view_type view(const_cast<B&>(a));
+      typename view_of<typename distributed_local_block<block_type>::type>::const_type
+	local = get_local_view(view);
+      if (local.size())
+      {
+	index_type sb = map.subblock();
+	Index<D> local_idx;
+	value = ovxx::reduce_idx<R>(local, local_idx);
+	Index<D> global_idx;
+	for (dimension_type d = 0; d != D; ++d)
+	  global_idx[d] = map.impl_global_from_local_index(d, sb, local_idx[d]);
+	pos = parallel::position<O>(global_idx, len);
+      }
+    }
+    if (!replicated)
+      map.impl_comm().allreduce(parallel::idx_reduction<R>::rtype, value, pos);
+    r = value;
+    idx = parallel::index_from_position<O>(pos, len);
+  }
+};
+
+} // namespace ovxx::dispatcher
+} // namespace ovxx
+
+#endif
@@ -50,6 +50,10 @@ inline Communicator &default_communicator()
   return communicator;
 }
 
+// Without communication, reductions are always reproducible.
+inline void set_reproducible_reductions(bool) {}
+inline bool reproducible_reductions() { return true;}
+
 // template <reduction_type R, typename T>
 // struct reduction_supported { static bool const value = true;};
 
@@ -0,0 +1,356 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#include <ovxx/profile.hpp>
+#include <ovxx/c++11.hpp>
+#include <ovxx/c++11/chrono.hpp>
+#if defined(OVXX_ENABLE_THREADING)
+# include <ovxx/c++11/thread.hpp>
+#endif
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#if !_WIN32
+# include <unistd.h>
+#endif
+
+namespace ovxx
+{
+namespace profile
+{
+namespace detail
+{
+bool enabled = false;
+
+std::string type_name(char const *pretty_function)
+{
+  std::string name = pretty_function;
+  // GCC and Clang report "... name() [with T = <type>]" or
+  // "... name() [T = <type>]", respectively.
+  std::string::size_type begin = name.find("T = ");
+  std::string::size_type end = name.rfind(']');
+  if (begin == std::string::npos || end == std::string::npos || end < begin)
+    return "unknown";
+  name = name.substr(begin + 4, end - begin - 4);
+  char const *prefixes[] =
+  { "ovxx::dispatcher::op::", "ovxx::dispatcher::be::", "ovxx::", "vsip::"};
+  for (std::size_t p = 0; p != sizeof(prefixes)/sizeof(*prefixes); ++p)
+  {
+    std::string::size_type i;
+    std::size_t const length = std::strlen(prefixes[p]);
+    while ((i = name.find(prefixes[p])) != std::string::npos)
+      name.erase(i, length);
+  }
+  return name;
+}
+} // namespace ovxx::profile::detail
+
+namespace
+{
+/// Aggregated statistics for one (operation, backend) pair.
+struct summary
+{
+  summary() : calls(0), total(0), self(0), min(0), max(0), ops(0.), bytes(0.) {}
+  void add(event const &e)
+  {
+    if (!calls || e.duration < min) min = e.duration;
+    if (e.duration > max) max = e.duration;
+    ++calls;
+    total += e.duration;
+    self += e.self;
+    ops += e.ops;
+    bytes += e.bytes;
+  }
+  void merge(summary const &s)
+  {
+    if (!s.calls) return;
+    if (!calls || s.min < min) min = s.min;
+    if (s.max > max) max = s.max;
+    calls += s.calls;
+    total += s.total;
+    self += s.self;
+    ops += s.ops;
+    bytes += s.bytes;
+  }
+  length_type calls;
+  int64_type total, self, min, max;
+  double ops;
+  double bytes;
+};
+
+typedef std::pair<char const *, char const *> key_type;
+
+/// The events recorded by a single thread. Only the owning thread
+/// writes to it, so no synchronization is required until it is
+/// read during finalization.
+struct thread_buffer
+{
+  thread_buffer(unsigned i, std::size_t capacity)
+    : id(i), events(capacity), count(0) {}
+  unsigned id;
+  std::vector<event> events; // used as a ring buffer
+  uint64_type count;         // total number of events recorded
+  std::vector<summary> summaries; // indexed by slot
+  std::vector<int64_type> nested; // time spent in the nested events
+                                  // of each open event
+};
+
+std::vector<thread_buffer *> buffers;
+std::size_t capacity = 65536;
+int64_type start_time = 0;
+std::string trace_file;
+std::string summary_file;
+// The (operation, backend) pair of each summary slot. Slots are
+// cached by the operations, so they outlive finalization.
+std::vector<key_type> slots;
+#if defined(OVXX_ENABLE_THREADING)
+mutex buffers_guard;
+#endif
+thread_local thread_buffer *buffer = 0;
+// Incremented on every finalization, so stale thread-local
+// buffer pointers can be detected. Like detail::enabled, it only
+// changes while no other thread is running operations.
+unsigned generation = 0;
+thread_local unsigned buffer_generation = 0;
+
+thread_buffer *register_thread()
+{
+#if defined(OVXX_ENABLE_THREADING)
+  lock_guard<mutex> lock(buffers_guard);
+#endif
+  thread_buffer *b = new thread_buffer(buffers.size(), capacity);
+  buffers.push_back(b);
+  return b;
+}
+
+/// Substitute "%p" in `name` by the process id.
+std::string file_name(std::string name)
+{
+  std::string::size_type i = name.find("%p");
+  if (i != std::string::npos)
+  {
+    std::ostringstream pid;
+#if !_WIN32
+    pid << getpid();
+#endif
+    name.replace(i, 2, pid.str());
+  }
+  return name;
+}
+
+std::string quote(char const *s)
+{
+  std::string r = "\"";
+  for (; *s; ++s)
+  {
+    if (*s == '"' || *s == '\\') r += '\\';
+    r += *s;
+  }
+  return r + '"';
+}
+
+void write_trace(std::ostream &os)
+{
+  int pid = 0;
+#if !_WIN32
+  pid = getpid();
+#endif
+  os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+  bool first = true;
+  os << std::fixed << std::setprecision(3);
+  for (std::size_t b = 0; b != buffers.size(); ++b)
+  {
+    thread_buffer const &buf = *buffers[b];
+    std::size_t const size = buf.events.size();
+    uint64_type begin = buf.count > size ? buf.count - size : 0;
+    for (uint64_type i = begin; i != buf.count; ++i)
+    {
+      event const &e = buf.events[i % size];
+      os << (first ? "\n" : ",\n")
+	 << "{\"name\": " << quote(e.op)
+	 << ", \"cat\": " << quote(e.backend)
+	 << ", \"ph\": \"X\", \"pid\": " << pid
+	 << ", \"tid\": " << buf.id
+	 << ", \"ts\": " << (e.start - start_time) / 1000.
+	 << ", \"dur\": " << e.duration / 1000.
+	 << ", \"args\": {\"backend\": " << quote(e.backend)
+	 << ", \"size\": " << e.size
+	 << ", \"ops\": " << e.ops
+	 << ", \"bytes\": " << e.bytes << "}}";
+      first = false;
+    }
+  }
+  os << "\n]}" << std::endl;
+}
+
+bool by_self(std::pair<key_type, summary> const &a,
+	     std::pair<key_type, summary> const &b)
+{
+  return a.second.self > b.second.self;
+}
+
+void write_summary(std::ostream &os)
+{
+  std::vector<summary> all(slots.size());
+  uint64_type dropped = 0;
+  for (std::size_t b = 0; b != buffers.size(); ++b)
+  {
+    thread_buffer const &buf = *buffers[b];
+    for (std::size_t s = 0; s != buf.summaries.size(); ++s)
+      all[s].merge(buf.summaries[s]);
+    if (buf.count > buf.events.size())
+      dropped += buf.count - buf.events.size();
+  }
+  std::vector<std::pair<key_type, summary> > sorted;
+  for (std::size_t s = 0; s != all.size(); ++s)
+    if (all[s].calls) sorted.push_back(std::make_pair(slots[s], all[s]));
+  std::sort(sorted.begin(), sorted.end(), by_self);
+
+  // Nested operations are included in the total time of the enclosing
+  // one, so only the self times add up to the overall time.
+  double total = 0.;
+  for (std::size_t i = 0; i != sorted.size(); ++i)
+    total += sorted[i].second.self;
+
+  std::ios::fmtflags flags = os.flags();
+  os << "OpenVSIP profile: " << buffers.size() << " thread(s)";
+  if (dropped)
+    os << ", " << dropped << " event(s) not included in the trace";
+  os << "\n(self: excluding nested operations of the same thread)\n"
+     << std::setw(8) << "%self" << std::setw(12) << "self(ms)"
+     << std::setw(12) << "total(ms)"
+     << std::setw(10) << "calls" << std::setw(12) << "mean(us)"
+     << std::setw(12) << "min(us)" << std::setw(12) << "max(us)"
+     << std::setw(10) << "Mops/s" << std::setw(10) << "MB/s"
+     << "  backend / operation\n";
+  os << std::fixed;
+  for (std::size_t i = 0; i != sorted.size(); ++i)
+  {
+    summary const &s = sorted[i].second;
+    double seconds = s.total * 1e-9;
+    os << std::setprecision(2) << std::setw(8)
+       << (total > 0. ? 100. * s.self / total : 0.)
+       << std::setprecision(3) << std::setw(12) << s.self * 1e-6
+       << std::setw(12) << s.total * 1e-6
+       << std::setw(10) << s.calls
+       << std::setw(12) << s.total * 1e-3 / s.calls
+       << std::setw(12) << s.min * 1e-3
+       << std::setw(12) << s.max * 1e-3
+       << std::setprecision(1)
+       << std::setw(10) << (seconds > 0. ? s.ops * 1e-6 / seconds : 0.)
+       << std::setw(10) << (seconds > 0. ? s.bytes * 1e-6 / seconds : 0.)
+       << "  " << sorted[i].first.second << " / " << sorted[i].first.first
+       << '\n';
+  }
+  os.flush();
+  os.flags(flags);
+}
+
+} // namespace <unnamed>
+
+int64_type now()
+{
+#ifdef OVXX_TIMER_SYSTEM
+  using namespace cxx11::chrono;
+  return duration_cast<nanoseconds>(clock::now().time_since_epoch()).count();
+#else
+  return clock::now().time_since_epoch().count();
+#endif
+}
+
+namespace
+{
+thread_buffer *current_buffer()
+{
+  thread_buffer *b = buffer;
+  if (!b || buffer_generation != generation)
+  {
+    b = buffer = register_thread();
+    buffer_generation = generation;
+  }
+  return b;
+}
+} // namespace <unnamed>
+
+unsigned detail::register_slot(char const *op, char const *backend)
+{
+#if defined(OVXX_ENABLE_THREADING)
+  lock_guard<mutex> lock(buffers_guard);
+#endif
+  slots.push_back(key_type(op, backend));
+  return slots.size() - 1;
+}
+
+int64_type enter()
+{
+  current_buffer()->nested.push_back(0);
+  return now();
+}
+
+void record(event &e, unsigned slot)
+{
+  thread_buffer *b = current_buffer();
+  int64_type nested = 0;
+  if (!b->nested.empty())
+  {
+    nested = b->nested.back();
+    b->nested.pop_back();
+  }
+  e.self = e.duration - nested;
+  if (!b->nested.empty())
+    b->nested.back() += e.duration;
+  b->events[b->count++ % b->events.size()] = e;
+  if (slot >= b->summaries.size())
+    b->summaries.resize(slot + 1);
+  b->summaries[slot].add(e);
+}
+
+void initialize()
+{
+  char const *profile = std::getenv("OVXX_PROFILE");
+  if (!profile) return;
+  trace_file = profile;
+  char const *summary = std::getenv("OVXX_PROFILE_SUMMARY");
+  summary_file = summary ? summary : "";
+  if (char const *events = std::getenv("OVXX_PROFILE_EVENTS"))
+  {
+    long n = std::atol(events);
+    if (n > 0) capacity = n;
+  }
+  start_time = now();
+  detail::enabled = true;
+}
+
+void finalize()
+{
+  if (!detail::enabled) return;
+  detail::enabled = false;
+  if (!summary_file.empty())
+  {
+    std::ofstream os(file_name(summary_file).c_str());
+    write_summary(os);
+  }
+  else
+    write_summary(std::cerr);
+  if (!trace_file.empty())
+  {
+    std::ofstream os(file_name(trace_file).c_str());
+    write_trace(os);
+  }
+  for (std::size_t b = 0; b != buffers.size(); ++b)
+    delete buffers[b];
+  buffers.clear();
+  ++generation;
+}
+
+} // namespace ovxx::profile
+} // namespace ovxx
@@ -0,0 +1,309 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_profile_hpp_
+#define ovxx_profile_hpp_
+
+#include <ovxx/support.hpp>
+#include <ovxx/inttypes.hpp>
+#include <ovxx/detail/util.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#include <string>
+
+namespace ovxx
+{
+namespace expr
+{
+template <template <typename> class O, typename B, bool E> class Unary;
+template <template <typename, typename> class O,
+	  typename B1, typename B2, bool E> class Binary;
+template <template <typename, typename, typename> class O,
+	  typename B1, typename B2, typename B3, bool E> class Ternary;
+template <dimension_type D, typename T> class Scalar;
+} // namespace ovxx::expr
+
+/// A low-overhead tracing profiler for dispatched operations.
+///
+/// Profiling is disabled by default, and enabled at runtime by setting
+/// the OVXX_PROFILE environment variable before the library is
+/// initialized.  While enabled, every operation executed through the
+/// dispatcher is recorded with its backend, size, duration, and
+/// estimated operation and byte counts.  Events are stored in
+/// per-thread ring buffers (so recording requires no locking), whose
+/// size may be set with OVXX_PROFILE_EVENTS.
+///
+/// When the library is finalized, an aggregated summary is written to
+/// the file named by OVXX_PROFILE_SUMMARY (or to stderr), and if
+/// OVXX_PROFILE is not empty, the most recent events of each thread
+/// are written to the file it names in Chrome trace format (viewable
+/// with chrome://tracing or Perfetto).  A "%p" in either file name is
+/// replaced by the process id.
+namespace profile
+{
+namespace detail
+{
+/// Only set by initialize() and finalize(), which the library calls
+/// before it starts and after it stops its thread pool, so worker
+/// threads never see it change.
+extern bool enabled;
+
+/// Extract the type name from a __PRETTY_FUNCTION__ string.
+std::string type_name(char const *pretty_function);
+
+/// Allocate a summary slot for the given operation and backend.
+unsigned register_slot(char const *op, char const *backend);
+} // namespace ovxx::profile::detail
+
+/// Is profiling enabled ?
+inline bool enabled() { return detail::enabled;}
+
+struct event
+{
+  char const *op;
+  char const *backend;
+  length_type size;
+  int64_type start;    // ns
+  int64_type duration; // ns
+  int64_type self;     // ns, excluding nested events
+  double ops;
+  double bytes;
+};
+
+/// Return the current time, in nanoseconds.
+int64_type now();
+
+/// Open a new event in the calling thread, and return its start time.
+int64_type enter();
+
+/// Close the innermost open event of the calling thread, setting
+/// `e.self`, and record `e` in the thread's buffer and in summary
+/// slot `slot`.
+void record(event &e, unsigned slot);
+
+void initialize();
+void finalize();
+
+/// Return a readable name for T.
+template <typename T>
+char const *name()
+{
+  // Note: This works for incomplete types (such as operation tags), too.
+  static std::string const n = detail::type_name(__PRETTY_FUNCTION__);
+  return n.c_str();
+}
+
+/// Return the summary slot of operation O executed by backend B.
+template <typename O, typename B>
+unsigned slot()
+{
+  static unsigned const s = detail::register_slot(name<O>(), name<B>());
+  return s;
+}
+
+/// The size and estimated cost of an operation.
+struct cost
+{
+  cost() : size(0), ops(0.), bytes(0.) {}
+  length_type size;
+  double ops;
+  double bytes;
+};
+
+namespace detail
+{
+using ovxx::detail::yes_tag;
+using ovxx::detail::no_tag;
+
+template <typename T>
+no_tag is_block_helper(...);
+
+template <typename T>
+yes_tag is_block_helper(int, typename T::map_type * = 0);
+
+template <typename T>
+struct is_block
+{
+  static bool const value =
+    sizeof(is_block_helper<T>(0)) == sizeof(yes_tag);
+};
+} // namespace ovxx::profile::detail
+
+/// Accumulate the cost of an operation argument.
+/// Arguments that aren't blocks don't contribute.  Element-wise
+/// expression blocks count one operation per element and node,
+/// all others contribute the bytes they hold.
+template <typename A, bool = detail::is_block<A>::value>
+struct arg_cost
+{
+  static void add(A const &, cost &) {}
+};
+
+template <typename A>
+inline void add_cost(A const &a, cost &c) { arg_cost<A>::add(a, c);}
+
+template <typename B>
+struct arg_cost<B, true>
+{
+  static void add(B const &b, cost &c)
+  {
+    length_type size = b.size();
+    if (size > c.size) c.size = size;
+    c.bytes += static_cast<double>(size) * sizeof(typename B::value_type);
+  }
+};
+
+template <dimension_type D, typename T>
+struct arg_cost<expr::Scalar<D, T>, true>
+{
+  static void add(expr::Scalar<D, T> const &, cost &) {}
+};
+
+template <template <typename> class O, typename B>
+struct arg_cost<expr::Unary<O, B, true>, true>
+{
+  static void add(expr::Unary<O, B, true> const &b, cost &c)
+  {
+    c.ops += b.size();
+    add_cost(b.arg(), c);
+  }
+};
+
+template <template <typename, typename> class O, typename B1, typename B2>
+struct arg_cost<expr::Binary<O, B1, B2, true>, true>
+{
+  static void add(expr::Binary<O, B1, B2, true> const &b, cost &c)
+  {
+    c.ops += b.size();
+    add_cost(b.arg1(), c);
+    add_cost(b.arg2(), c);
+  }
+};
+
+template <template <typename, typename, typename> class O,
+	  typename B1, typename B2, typename B3>
+struct arg_cost<expr::Ternary<O, B1, B2, B3, true>, true>
+{
+  static void add(expr::Ternary<O, B1, B2, B3, true> const &b, cost &c)
+  {
+    c.ops += b.size();
+    add_cost(b.arg1(), c);
+    add_cost(b.arg2(), c);
+    add_cost(b.arg3(), c);
+  }
+};
+
+/// Record the execution of operation O by backend B for the
+/// lifetime of this object, if profiling is enabled.
+template <typename O, typename B>
+class scope : ovxx::detail::noncopyable
+{
+public:
+  template <typename A1>
+  scope(A1 const &a1) : active_(enabled())
+  {
+    if (!active_) return;
+    cost c;
+    add_cost(a1, c);
+    start(c);
+  }
+  template <typename A1, typename A2>
+  scope(A1 const &a1, A2 const &a2) : active_(enabled())
+  {
+    if (!active_) return;
+    cost c;
+    add_cost(a1, c); add_cost(a2, c);
+    start(c);
+  }
+  template <typename A1, typename A2, typename A3>
+  scope(A1 const &a1, A2 const &a2, A3 const &a3) : active_(enabled())
+  {
+    if (!active_) return;
+    cost c;
+    add_cost(a1, c); add_cost(a2, c); add_cost(a3, c);
+    start(c);
+  }
+  template <typename A1, typename A2, typename A3, typename A4>
+  scope(A1 const &a1, A2 const &a2, A3 const &a3, A4 const &a4)
+    : active_(enabled())
+  {
+    if (!active_) return;
+    cost c;
+    add_cost(a1, c); add_cost(a2, c); add_cost(a3, c); add_cost(a4, c);
+    start(c);
+  }
+  template <typename A1, typename A2, typename A3, typename A4, typename A5>
+  scope(A1 const &a1, A2 const &a2, A3 const &a3, A4 const &a4, A5 const &a5)
+    : active_(enabled())
+  {
+    if (!active_) return;
+    cost c;
+    add_cost(a1, c); add_cost(a2, c); add_cost(a3, c); add_cost(a4, c);
+    add_cost(a5, c);
+    start(c);
+  }
+  template <typename A1, typename A2, typename A3, typename A4, typename A5,
+	    typename A6>
+  scope(A1 const &a1, A2 const &a2, A3 const &a3, A4 const &a4, A5 const &a5,
+	A6 const &a6)
+    : active_(enabled())
+  {
+    if (!active_) return;
+    cost c;
+    add_cost(a1, c); add_cost(a2, c); add_cost(a3, c); add_cost(a4, c);
+    add_cost(a5, c); add_cost(a6, c);
+    start(c);
+  }
+  template <typename A1, typename A2, typename A3, typename A4, typename A5,
+	    typename A6, typename A7>
+  scope(A1 const &a1, A2 const &a2, A3 const &a3, A4 const &a4, A5 const &a5,
+	A6 const &a6, A7 const &a7)
+    : active_(enabled())
+  {
+    if (!active_) return;
+    cost c;
+    add_cost(a1, c); add_cost(a2, c); add_cost(a3, c); add_cost(a4, c);
+    add_cost(a5, c); add_cost(a6, c); add_cost(a7, c);
+    start(c);
+  }
+  template <typename A1, typename A2, typename A3, typename A4, typename A5,
+	    typename A6, typename A7, typename A8>
+  scope(A1 const &a1, A2 const &a2, A3 const &a3, A4 const &a4, A5 const &a5,
+	A6 const &a6, A7 const &a7, A8 const &a8)
+    : active_(enabled())
+  {
+    if (!active_) return;
+    cost c;
+    add_cost(a1, c); add_cost(a2, c); add_cost(a3, c); add_cost(a4, c);
+    add_cost(a5, c); add_cost(a6, c); add_cost(a7, c); add_cost(a8, c);
+    start(c);
+  }
+  ~scope()
+  {
+    if (!active_) return;
+    event_.duration = now() - event_.start;
+    record(event_, slot<O, B>());
+  }
+
+private:
+  void start(cost const &c)
+  {
+    event_.op = name<O>();
+    event_.backend = name<B>();
+    event_.size = c.size;
+    event_.ops = c.ops;
+    event_.bytes = c.bytes;
+    event_.start = enter();
+  }
+
+  bool active_;
+  event event_;
+};
+
+} // namespace ovxx::profile
+} // namespace ovxx
+
+#endif
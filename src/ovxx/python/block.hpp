@@ -11,6 +11,7 @@
 #include <boost/python.hpp>
 #include <boost/python/slice.hpp>
 #include <ovxx/python/config.hpp>
+#include <ovxx/python/gil.hpp>
 #include <numpy/arrayobject.h>
 #include <ovxx/support.hpp>
 #include <vsip/domain.hpp>
@@ -18,6 +19,7 @@
 #include <ovxx/storage.hpp>
 #include <ovxx/block_traits.hpp>
 #include <ovxx/view.hpp>
+#include <ovxx/domain_utils.hpp>
 #include <vsip/impl/local_map.hpp>
 #if OVXX_HAVE_OPENCL
 #include <ovxx/opencl/dda.hpp>
@@ -43,9 +45,11 @@ namespace python
 namespace bpl = boost::python;
 using boost::shared_ptr;
 
-// Send all traces from OVXX_TRACE to the Python logger
+// Send all traces from OVXX_TRACE to the Python logger.
+// Traces may be emitted while the GIL is released, so acquire it first.
 inline void trace(char const *format, ...)
 {
+  gil_acquire gil;
   bpl::object logging = bpl::import("logging");
   bpl::object info = logging.attr("info");
   va_list args;
@@ -56,7 +60,12 @@ inline void trace(char const *format, ...)
   info(msg);
 }
 
-inline void initialize() { import_array();}
+inline void initialize()
+{
+  // Make sure the GIL exists, so it can be released during computations.
+  PyEval_InitThreads();
+  import_array();
+}
 
 #define PYVSIP_THROW(TYPE, REASON)	 \
 {                                        \
@@ -136,11 +145,21 @@ public:
   sm_proxy(allocator *a, length_type s, bool f)
     : parent_(new storage_manager<T>(a, s, f))
   {}
+  // the user-storage constructor
+  sm_proxy(allocator *a, length_type s, T *ptr)
+    : parent_(new storage_manager<T>(a, s, ptr))
+  {}
   // the subblock constructor
   sm_proxy(smanager_ptr sm) : parent_(sm) {}
   // the real/imag component constructor
   sm_proxy(csmanager_ptr sm, bool r) : cparent_(sm), real_(r) {}
 
+  void admit(bool update)
+  {
+    if (parent_) parent_->admit(update);
+    else cparent_->admit(update);
+  }
+
   value_type get(index_type i) const
   {
     if (parent_) return parent_->get(i);
@@ -195,6 +214,16 @@ struct storage_traits<T, true>
   typedef sm_proxy<T> type;
 };
 
+// Delete a storage manager wrapping external memory, then
+// release the object owning that memory.
+template <typename S>
+struct external_deleter
+{
+  external_deleter(shared_ptr<void> o) : owner(o) {}
+  void operator()(S *s) { delete s; owner.reset();}
+  shared_ptr<void> owner;
+};
+
 template <dimension_type D, typename T, typename M = Local_map> class Block;
 
 // This block is modeled after stored_block, but without support for user-storage.
@@ -247,6 +276,34 @@ public:
       smanager_->put(i, value);
   }
 
+  /// Create a block referring to external memory, such as a buffer
+  /// exported by another Python object.  `strides` holds the distance
+  /// (in elements, possibly negative) between consecutive elements
+  /// in each dimension, and `owner` is released once the last block
+  /// referring to `data` is destroyed.
+  Block(Domain<dim> const &dom, stride_type const *strides, T *data,
+	shared_ptr<void> owner, map_type const &map = map_type())
+    : offset_(0),
+      layout_(external_domain(dom, strides)),
+      map_(map),
+      array_refcount_(0)
+  {
+    // The storage spans all elements, starting from the one
+    // at the lowest address.
+    length_type span = dom.size() ? 1 : 0;
+    for (dimension_type d = 0; d != dim && span; ++d)
+    {
+      stride_type extent = (dom[d].size() - 1) * strides[d];
+      if (extent < 0) offset_ -= extent;
+      span += extent < 0 ? -extent : extent;
+    }
+    smanager_.reset(new smanager_type(map.impl_allocator(), span,
+				      data - offset_),
+		    external_deleter<smanager_type>(owner));
+    smanager_->admit(false);
+    map_.impl_apply(dom);
+  }
+
   // constructor used internally to form a subblock of parent.
   // dom holds physical coordinates, i.e. strides express distance in elements,
   // not rows / columns.
@@ -370,6 +427,7 @@ public:
   {									\
     typename view_of<Block>::type self(*this);				\
     typename view_of<Block>::const_type other(const_cast<Block&>(o));	\
+    gil_release nogil;							\
     self OP other;							\
     return *this;							\
   }									\
@@ -379,6 +437,7 @@ public:
     typedef expr::Scalar<dim, value_type> S;				\
     S scalar(s);							\
     typename view_of<S>::const_type other(scalar);			\
+    gil_release nogil;							\
     self OP other;							\
     return *this;							\
   }
@@ -405,6 +464,21 @@ public:
   }
 
 private:
+  static Domain<dim> external_domain(Domain<dim> const &dom,
+				     stride_type const *strides)
+  {
+    // Only sizes and strides matter to the layout, but the domain
+    // needs to be valid.
+    Domain<1> d[dim];
+    for (dimension_type i = 0; i != dim; ++i)
+    {
+      length_type n = dom[i].size();
+      index_type first = strides[i] < 0 && n ? (n - 1) * -strides[i] : 0;
+      d[i] = Domain<1>(first, strides[i], n);
+    }
+    return construct_domain<dim>(d);
+  }
+
   length_type offset_;
   applied_layout_type layout_;
   shared_ptr<smanager_type> smanager_;
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_python_dlpack_hpp_
+#define ovxx_python_dlpack_hpp_
+
+#include <ovxx/support.hpp>
+#include <ovxx/c++11.hpp>
+#include <ovxx/inttypes.hpp>
+
+namespace ovxx
+{
+namespace python
+{
+/// The subset of the DLPack ABI (https://github.com/dmlc/dlpack) needed
+/// to exchange host memory with other array libraries.
+/// Tensors are passed as PyCapsules named "dltensor", which are renamed
+/// to "used_dltensor" once a consumer takes ownership.
+namespace dlpack
+{
+enum device_type { cpu = 1};
+enum type_code { int_ = 0, uint_ = 1, float_ = 2, complex_ = 5, bool_ = 6};
+
+struct Device
+{
+  int32_type device_type;
+  int32_type device_id;
+};
+
+struct DataType
+{
+  uint8_type code;
+  uint8_type bits;
+  uint16_type lanes;
+};
+
+struct Tensor
+{
+  void *data;
+  Device device;
+  int32_type ndim;
+  DataType dtype;
+  int64_type *shape;
+  int64_type *strides; // in elements; may be null for compact row-major data
+  uint64_type byte_offset;
+};
+
+struct ManagedTensor
+{
+  Tensor dl_tensor;
+  void *manager_ctx;
+  void (*deleter)(ManagedTensor *self);
+};
+
+template <typename T>
+struct type_info
+{
+  static uint8_type const code = is_integral<T>::value ?
+    (is_signed<T>::value ? int_ : uint_) : float_;
+  static uint8_type const bits = 8 * sizeof(T);
+};
+template <>
+struct type_info<bool>
+{
+  static uint8_type const code = bool_;
+  static uint8_type const bits = 8 * sizeof(bool);
+};
+template <typename T>
+struct type_info<complex<T> >
+{
+  static uint8_type const code = complex_;
+  static uint8_type const bits = 16 * sizeof(T);
+};
+
+template <typename T>
+inline bool is_compatible(DataType const &t)
+{
+  return t.code == type_info<T>::code && t.bits == type_info<T>::bits &&
+    t.lanes == 1;
+}
+
+} // namespace ovxx::python::dlpack
+} // namespace ovxx::python
+} // namespace ovxx
+
+#endif
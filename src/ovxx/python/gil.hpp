@@ -0,0 +1,56 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_python_gil_hpp_
+#define ovxx_python_gil_hpp_
+
+#include <Python.h>
+#include <ovxx/detail/noncopyable.hpp>
+
+namespace ovxx
+{
+namespace python
+{
+
+/// Release the global interpreter lock for the lifetime of this
+/// object, so other Python threads may run while we compute.
+/// The Python C API must not be used (and Python objects must not
+/// be created or destroyed) while the lock is released.
+///
+/// Bindings release the lock around the evaluation of FFTs,
+/// convolutions, filters, matrix products, solvers, as well as
+/// element-wise functions, reductions and block assignments.  Thus
+/// distinct objects may be used concurrently from different threads.
+/// A single object (such as an fft) or a block being written to must
+/// not be used from more than one thread at a time, however, and
+/// objects are still created with the lock held.
+class gil_release : ovxx::detail::noncopyable
+{
+public:
+  gil_release() : state_(PyEval_SaveThread()) {}
+  ~gil_release() { PyEval_RestoreThread(state_);}
+
+private:
+  PyThreadState *state_;
+};
+
+/// Acquire the global interpreter lock for the lifetime of this
+/// object, regardless of whether the current thread holds it.
+class gil_acquire : ovxx::detail::noncopyable
+{
+public:
+  gil_acquire() : state_(PyGILState_Ensure()) {}
+  ~gil_acquire() { PyGILState_Release(state_);}
+
+private:
+  PyGILState_STATE state_;
+};
+
+} // namespace ovxx::python
+} // namespace ovxx
+
+#endif
@@ -368,4 +368,8 @@ struct Evaluator<op::reduce<R>, be::generic,
 } // namespace ovxx::dispatcher
 } // namespace ovxx
 
+#ifdef OVXX_PARALLEL
+# include <ovxx/parallel/reductions.hpp>
+#endif
+
 #endif
@@ -364,4 +364,8 @@ reduce_idx(V view, Index<V::dim> &idx)
 
 } // namespace ovxx
 	     
+#ifdef OVXX_PARALLEL
+# include <ovxx/parallel/reductions_idx.hpp>
+#endif
+
 #endif
@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_signal_channelizer_hpp_
+#define ovxx_signal_channelizer_hpp_
+
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/dense.hpp>
+#include <vsip/dda.hpp>
+#include <vsip/impl/signal/fft.hpp>
+#include <ovxx/aligned_array.hpp>
+#include <ovxx/adjust_layout.hpp>
+#include <ovxx/complex_traits.hpp>
+#include <ovxx/thread_pool.hpp>
+#include <ovxx/signal/detail/history.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#include <algorithm>
+
+namespace ovxx
+{
+namespace signal
+{
+namespace detail
+{
+/// Compute the polyphase branch outputs of a range of frames.
+template <typename T, typename K>
+struct channelizer_branches
+{
+  channelizer_branches(K const *b, T const *i, T *o, length_type c,
+		       length_type t, length_type d, index_type p)
+    : bank(b), in(i), out(o), channels(c), taps(t), decimation(d), phase(p) {}
+
+  void operator()(Domain<1> const &frames) const
+  {
+    for (index_type f = frames.first(); f != frames.first() + frames.size(); ++f)
+    {
+      // The frame's window is x[0] ... x[taps * channels - 1], the newest
+      // sample, at absolute time n, being last.
+      T const *x = in + f * decimation;
+      T *v = out + f * channels;
+      std::fill(v, v + channels, T(0));
+      // v[channels - 1 - r] accumulates branch r, i.e. the products
+      // h[r + q * channels] x[n - r - q * channels].
+      for (index_type p = 0; p != taps; ++p)
+      {
+	K const *h = bank + (taps - 1 - p) * channels;
+	T const *s = x + p * channels;
+	for (index_type j = 0; j != channels; ++j)
+	  v[j] += h[j] * s[j];
+      }
+      // Branch r, at absolute time n, feeds DFT input (n - r) mod channels.
+      index_type n = (phase + f * decimation) % channels;
+      std::rotate(v, v + (channels - 1 - n), v + channels);
+    }
+  }
+
+  K const *bank;
+  T const *in;
+  T *out;
+  length_type channels;
+  length_type taps;
+  length_type decimation;
+  index_type phase;
+};
+} // namespace ovxx::signal::detail
+
+/// Polyphase FFT channelizer.
+///
+/// Splits a complex signal into `channels` equally spaced frequency
+/// channels, centered at `2 pi k / channels`, each shifted to baseband,
+/// lowpass-filtered by the prototype `kernel`, and decimated by
+/// `decimation`.  Channel k's output m is thus
+///
+///   y_k[m] = sum_l kernel[l] x[mD - l] exp(-2 pi j k (mD - l) / channels)
+///
+/// With `decimation == channels` the channelizer is critically sampled;
+/// with a smaller decimation it is oversampled, and adjacent channels
+/// overlap.  Rather than filtering each channel separately, the input is
+/// run through a bank of `channels` polyphase branches of the prototype,
+/// and the branch outputs of all frames are transformed at once by a
+/// batched `Fftm`, using whatever FFT backend is configured.  The branch
+/// filtering of separate frames is spread across the library thread pool.
+///
+/// The input is processed in chunks of `input_size` samples, a multiple
+/// of the decimation, each producing a channels x time matrix of
+/// `input_size / decimation` frames.  The filter state is saved between
+/// chunks.
+template <typename T>
+class Channelizer : ovxx::detail::noncopyable
+{
+  typedef typename scalar_of<T>::type kernel_type;
+  typedef Dense<2, T, col2_type> frames_block_type;
+  typedef vsip::Fftm<T, T, col, fft_fwd, by_reference> fftm_type;
+
+public:
+  template <typename Block>
+  Channelizer(const_Vector<kernel_type, Block> kernel,
+	      length_type channels,
+	      length_type decimation,
+	      length_type input_size)
+    VSIP_THROW((std::bad_alloc))
+    : channels_(channels),
+      decimation_(decimation),
+      input_size_(input_size),
+      kernel_size_(kernel.size()),
+      taps_((kernel.size() + channels - 1) / channels),
+      bank_(channels_ * taps_),
+      history_((taps_ - 1) * channels_ + channels_ - 1, 1, input_size_),
+      branches_(channels_, input_size_ / decimation_),
+      fftm_(Domain<2>(channels_, input_size_ / decimation_), 1.)
+  {
+    OVXX_PRECONDITION(channels_ > 0);
+    OVXX_PRECONDITION(decimation_ > 0 && decimation_ <= channels_);
+    OVXX_PRECONDITION(input_size_ > 0 && input_size_ % decimation_ == 0);
+    OVXX_PRECONDITION(kernel_size_ > 0);
+    // Branch r holds the coefficients r, r + channels, r + 2 channels, ...,
+    // padded with zeros. Block p of the bank holds the coefficients
+    // p * channels ... (p + 1) * channels - 1, reversed.
+    for (index_type p = 0; p != taps_; ++p)
+      for (index_type r = 0; r != channels_; ++r)
+      {
+	index_type k = p * channels_ + r;
+	bank_[p * channels_ + channels_ - 1 - r] =
+	  k < kernel_size_ ? kernel.get(k) : kernel_type(0);
+      }
+    reset();
+  }
+
+  length_type channels() const VSIP_NOTHROW { return channels_;}
+  length_type decimation() const VSIP_NOTHROW { return decimation_;}
+  length_type kernel_size() const VSIP_NOTHROW { return kernel_size_;}
+  length_type input_size() const VSIP_NOTHROW { return input_size_;}
+  /// The number of frames (output samples per channel) per chunk.
+  length_type output_size() const VSIP_NOTHROW { return input_size_ / decimation_;}
+
+  /// Channelize the next chunk of input. `out` is a channels x
+  /// output_size() matrix.
+  template <typename Block0, typename Block1>
+  Matrix<T, Block1>
+  operator()(const_Vector<T, Block0> in, Matrix<T, Block1> out) VSIP_NOTHROW
+  {
+    OVXX_PRECONDITION(in.size() == input_size_);
+    OVXX_PRECONDITION(out.size(0) == channels_ && out.size(1) == output_size());
+
+    length_type const saved = history_.size();
+    T const *buffer = history_.load(in);
+    {
+      // Frame f's window ends at buffer[saved + f * D], and spans
+      // taps * channels samples.
+      dda::Data<frames_block_type, dda::out> data(branches_.block());
+      detail::channelizer_branches<T, kernel_type>
+	branches(bank_.get(), buffer + saved + 1 - taps_ * channels_, data.ptr(),
+		 channels_, taps_, decimation_, phase_);
+      thread_pool::parallel_for(Domain<1>(output_size()), branches);
+    }
+    fftm_(branches_, out);
+
+    history_.save(0, input_size_);
+    phase_ = (phase_ + input_size_) % channels_;
+    return out;
+  }
+
+  /// Clear the state, to start channelizing a new signal.
+  void reset() VSIP_NOTHROW
+  {
+    history_.reset();
+    phase_ = 0;
+  }
+
+private:
+  length_type channels_;
+  length_type decimation_;
+  length_type input_size_;
+  length_type kernel_size_;
+  length_type taps_;
+  aligned_array<kernel_type> bank_;
+  detail::history<T> history_;
+  Matrix<T, frames_block_type> branches_;
+  fftm_type fftm_;
+  /// The absolute position of the next input sample, modulo channels.
+  index_type phase_;
+};
+
+} // namespace ovxx::signal
+} // namespace ovxx
+
+#endif
@@ -0,0 +1,235 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_signal_ddc_hpp_
+#define ovxx_signal_ddc_hpp_
+
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/dda.hpp>
+#include <ovxx/aligned_array.hpp>
+#include <ovxx/adjust_layout.hpp>
+#include <ovxx/complex_traits.hpp>
+#include <ovxx/signal/detail/history.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace ovxx
+{
+namespace signal
+{
+/// Digital down-converter: mixing, lowpass filtering, and decimation.
+///
+/// Each channel computes what
+///
+///   modulate(in, frequency, phase, mixed);
+///   Fir<...> fir(kernel, size, decimation);
+///   fir(mixed, out);
+///
+/// would, without forming the full-rate mixed signal: since
+///
+///   sum_l h[l] x[n - l] exp(j((n - l) nu + phi))
+///     = exp(j(n nu + phi)) sum_l h[l] exp(-j l nu) x[n - l],
+///
+/// the input is filtered with the kernel shifted to the channel's
+/// frequency, and only the decimated outputs are mixed, by a numerically
+/// controlled oscillator advancing by `decimation * frequency` per
+/// output.  Frequencies are given in radians per sample, as for
+/// modulate(); a negative frequency thus shifts the band around
+/// `-frequency` down to baseband.
+///
+/// A multi-channel converter tunes several frequencies from the same
+/// input, sharing the saved input samples.
+///
+/// The filter state and the oscillator phase are saved between calls,
+/// so a signal may be processed in chunks of any length.  Each call
+/// produces the outputs that are available so far; output_size() tells
+/// how many.
+template <typename T>
+class Ddc : ovxx::detail::noncopyable
+{
+public:
+  typedef typename scalar_of<T>::type scalar_type;
+  typedef complex<scalar_type> result_type;
+
+  /// Create a single-channel converter.
+  template <typename Block>
+  Ddc(const_Vector<scalar_type, Block> kernel,
+      scalar_type frequency,
+      length_type decimation,
+      scalar_type phase = scalar_type(0))
+    VSIP_THROW((std::bad_alloc))
+    : decimation_(decimation),
+      channels_(1),
+      kernel_size_(checked_size(kernel.size())),
+      bank_(kernel_size_),
+      frequency_(1),
+      phase_(1),
+      oscillator_(1),
+      history_(kernel_size_ - 1)
+  {
+    frequency_[0] = frequency;
+    phase_[0] = phase;
+    init(kernel);
+  }
+
+  /// Create a converter with one channel per element of `frequencies`.
+  template <typename Block0, typename Block1>
+  Ddc(const_Vector<scalar_type, Block0> kernel,
+      const_Vector<scalar_type, Block1> frequencies,
+      length_type decimation)
+    VSIP_THROW((std::bad_alloc))
+    : decimation_(decimation),
+      channels_(frequencies.size()),
+      kernel_size_(checked_size(kernel.size())),
+      bank_(channels_ * kernel_size_),
+      frequency_(channels_),
+      phase_(channels_),
+      oscillator_(channels_),
+      history_(kernel_size_ - 1)
+  {
+    for (index_type c = 0; c != channels_; ++c)
+    {
+      frequency_[c] = frequencies.get(c);
+      phase_[c] = scalar_type(0);
+    }
+    init(kernel);
+  }
+
+  length_type decimation() const VSIP_NOTHROW { return decimation_;}
+  length_type kernel_size() const VSIP_NOTHROW { return kernel_size_;}
+  length_type channels() const VSIP_NOTHROW { return channels_;}
+
+  /// Return the number of outputs (per channel) the next call
+  /// produces for `in_size` input samples.
+  length_type output_size(length_type in_size) const VSIP_NOTHROW
+  {
+    return position_ < in_size ? (in_size - position_ + decimation_ - 1) / decimation_ : 0;
+  }
+
+  /// Down-convert the next chunk with a single-channel converter.
+  /// The outputs are written to the beginning of `out`. Returns their number.
+  template <typename Block0, typename Block1>
+  length_type
+  operator()(const_Vector<T, Block0> in, Vector<result_type, Block1> out)
+  {
+    OVXX_PRECONDITION(channels_ == 1);
+    length_type const outputs = output_size(in.size());
+    OVXX_PRECONDITION(out.size() >= outputs);
+
+    typedef typename get_block_layout<Block1>::type LP;
+    typedef typename adjust_layout_storage_format<array, LP>::type use_LP;
+    T const *buffer = history_.load(in);
+    // Only a prefix of `out` may be written.
+    dda::Data<Block1, dda::inout, use_LP> data_out(out.block());
+    filter(0, buffer, in.size(), data_out.ptr(), data_out.stride(0));
+    advance(in.size());
+    return outputs;
+  }
+
+  /// Down-convert the next chunk to each channel, given as the rows
+  /// of `out`. The outputs are written to the beginning of the rows.
+  /// Returns their number (per channel).
+  template <typename Block0, typename Block1>
+  length_type
+  operator()(const_Vector<T, Block0> in, Matrix<result_type, Block1> out)
+  {
+    OVXX_PRECONDITION(out.size(0) == channels_);
+    length_type const outputs = output_size(in.size());
+    OVXX_PRECONDITION(out.size(1) >= outputs);
+
+    typedef typename get_block_layout<Block1>::type LP;
+    typedef typename adjust_layout_storage_format<array, LP>::type use_LP;
+    T const *buffer = history_.load(in);
+    dda::Data<Block1, dda::inout, use_LP> data_out(out.block());
+    for (index_type c = 0; c != channels_; ++c)
+      filter(c, buffer, in.size(),
+	     data_out.ptr() + c * data_out.stride(0), data_out.stride(1));
+    advance(in.size());
+    return outputs;
+  }
+
+  /// Clear the state, to start down-converting a new signal.
+  void reset() VSIP_NOTHROW
+  {
+    history_.reset();
+    for (index_type c = 0; c != channels_; ++c)
+      oscillator_[c] = std::polar(1., double(phase_[c]));
+    position_ = 0;
+  }
+
+private:
+  // Check the kernel size before the members are sized with it.
+  static length_type checked_size(length_type kernel_size)
+  {
+    OVXX_PRECONDITION(kernel_size > 0);
+    return kernel_size;
+  }
+
+  template <typename Block>
+  void init(const_Vector<scalar_type, Block> kernel)
+  {
+    OVXX_PRECONDITION(decimation_ > 0);
+    OVXX_PRECONDITION(channels_ > 0);
+    // Channel c's kernel, h[l] exp(-j l nu), in reverse order.
+    for (index_type c = 0; c != channels_; ++c)
+      for (index_type l = 0; l != kernel_size_; ++l)
+	bank_[c * kernel_size_ + kernel_size_ - 1 - l] =
+	  result_type(double(kernel.get(l)) * std::polar(1., -double(l) * frequency_[c]));
+    reset();
+  }
+
+  /// Compute channel `c`'s outputs for the `length` samples staged
+  /// in `buffer`.
+  void filter(index_type c, T const *buffer, length_type length,
+	      result_type *out, stride_type out_stride)
+  {
+    result_type const *h = bank_.get() + c * kernel_size_;
+    complex<double> oscillator = oscillator_[c];
+    complex<double> const step = std::polar(1., double(decimation_) * frequency_[c]);
+    for (index_type i = position_; i < length; i += decimation_, out += out_stride)
+    {
+      // Output i's window ends at buffer[i + kernel_size_ - 1].
+      T const *x = buffer + i;
+      result_type sum = result_type(0);
+      for (index_type l = 0; l != kernel_size_; ++l)
+	sum += h[l] * x[l];
+      *out = sum * result_type(oscillator);
+      oscillator *= step;
+      // Keep the oscillator on the unit circle.
+      oscillator *= (3. - std::norm(oscillator)) / 2.;
+    }
+    oscillator_[c] = oscillator;
+  }
+
+  /// Move the position past `length` input samples, and keep
+  /// the last kernel_size - 1 of them.
+  void advance(length_type length)
+  {
+    history_.save(0, length);
+    if (position_ < length)
+      position_ += output_size(length) * decimation_;
+    position_ -= length;
+  }
+
+  length_type decimation_;
+  length_type channels_;
+  length_type kernel_size_;
+  aligned_array<result_type> bank_;
+  aligned_array<scalar_type> frequency_;
+  aligned_array<scalar_type> phase_;
+  aligned_array<complex<double> > oscillator_;
+  detail::history<T> history_;
+  length_type position_;
+};
+
+} // namespace ovxx::signal
+} // namespace ovxx
+
+#endif
@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_signal_detail_history_hpp_
+#define ovxx_signal_detail_history_hpp_
+
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/dda.hpp>
+#include <ovxx/aligned_array.hpp>
+#include <ovxx/adjust_layout.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#include <algorithm>
+
+namespace ovxx
+{
+namespace signal
+{
+namespace detail
+{
+/// The input staging of stream filters, which need the last few
+/// samples of the previous chunk along with the current one.
+///
+/// Each channel's last `size` samples are saved between chunks.
+/// load() lays out the saved samples of a channel and the next chunk
+/// contiguously, so filters may be evaluated without special-casing
+/// chunk boundaries, and save() keeps the last samples for the next
+/// chunk.  The staging buffer is shared by all channels, so channels
+/// are to be processed one at a time.
+template <typename T>
+class history : ovxx::detail::noncopyable
+{
+public:
+  /// Save `size` samples of each of `channels` channels. The buffer is
+  /// allocated for chunks of `capacity` samples, and grown on demand.
+  history(length_type size, length_type channels = 1, length_type capacity = 0)
+    : size_(size),
+      saved_(channels * size_),
+      buffer_(size_ + capacity)
+  {
+    reset();
+  }
+
+  /// The number of samples saved per channel.
+  length_type size() const { return size_;}
+
+  /// Stage `length` samples at `in`, `stride` apart, after the saved
+  /// samples of channel `c`. Returns the start of the staged samples.
+  T *load(index_type c, T const *in, stride_type stride, length_type length)
+  {
+    if (buffer_.size() < size_ + length)
+    {
+      aligned_array<T> buffer(size_ + length);
+      buffer_ = buffer;
+    }
+    T *buffer = buffer_.get();
+    T const *saved = saved_.get() + c * size_;
+    std::copy(saved, saved + size_, buffer);
+    for (index_type i = 0; i != length; ++i)
+      buffer[size_ + i] = in[i * stride];
+    return buffer;
+  }
+
+  /// Stage `in` after the saved samples of channel `c`.
+  template <typename Block>
+  T *load(const_Vector<T, Block> in, index_type c = 0)
+  {
+    typedef typename get_block_layout<Block>::type LP;
+    typedef typename adjust_layout_storage_format<array, LP>::type use_LP;
+    dda::Data<Block, dda::in, use_LP> data(in.block());
+    return load(c, data.ptr(), data.stride(0), in.size());
+  }
+
+  /// Save the last size() samples of the `length` samples staged
+  /// for channel `c`.
+  void save(index_type c, length_type length)
+  {
+    T const *buffer = buffer_.get() + length;
+    std::copy(buffer, buffer + size_, saved_.get() + c * size_);
+  }
+
+  /// Clear the saved samples, to start a new stream.
+  void reset()
+  {
+    std::fill(saved_.get(), saved_.get() + saved_.size(), T(0));
+  }
+
+private:
+  length_type size_;
+  aligned_array<T> saved_;
+  aligned_array<T> buffer_;
+};
+
+} // namespace ovxx::signal::detail
+} // namespace ovxx::signal
+} // namespace ovxx
+
+#endif
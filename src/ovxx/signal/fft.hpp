@@ -78,6 +78,12 @@ namespace fft
 /// else ................................... estimate
 enum fftw_planning { estimate=1, measure=12, patient=32};
 
+// Defined in <ovxx/signal/fft/distributed.hpp>.
+template <dimension_type D, typename I, typename O, int E, unsigned N>
+class distributed;
+template <typename I, typename O, int A>
+struct fftm_redistribution;
+
 template <dimension_type D, typename I, typename O, int A, int E>
 class Interface
 {
@@ -166,6 +172,36 @@ public:
     std::auto_ptr<backend_type>(Domain<D> const &, typename base::scalar_type), L>
     dispatcher_type;
 
+private:
+  typedef fft::distributed<D, I, O, exponent, N> distributed_type;
+
+  /// Distributed views are handled by distributed_type, if supported.
+  template <typename BlockT>
+  struct is_distributed
+  {
+    static bool const value = distributed_type::supported &&
+      parallel::is_global_map<typename BlockT::map_type>::value;
+  };
+
+  /// The result of a distributed FFT is computed eagerly, into a view
+  /// with the input's map.
+  template <typename ViewT,
+	    bool = is_distributed<typename ViewT::block_type>::value>
+  struct result
+  {
+#ifdef VSIP_IMPL_REF_IMPL
+    typedef typename fft::result<O, typename ViewT::block_type>::view_type type;
+#else
+    typedef typename fft::Result_rbo<D, I, O, ViewT, workspace, S>::view_type type;
+#endif
+  };
+  template <typename ViewT>
+  struct result<ViewT, true>
+  {
+    typedef typename fft::result<O, typename ViewT::block_type>::view_type type;
+  };
+
+public:
   Fft(Domain<D> const& dom, typename base::scalar_type scale)
     VSIP_THROW((std::bad_alloc))
     : base(dom, scale, false, S, by_value),
@@ -173,13 +209,22 @@ public:
       workspace_(backend_.get(), this->input_size(), this->output_size(), scale)
   {}
 
-#ifdef VSIP_IMPL_REF_IMPL
   /// Returns the Fast Fourier Transform of :literal:`in`.
   template <typename ViewT>
-  typename fft::result<O, typename ViewT::block_type>::view_type
+  typename result<ViewT>::type
   operator()(ViewT in) VSIP_THROW((std::bad_alloc))
   {
     OVXX_PRECONDITION(extent(in) == extent(this->input_size()));
+    return apply(in, integral_constant<bool,
+		 is_distributed<typename ViewT::block_type>::value>());
+  }
+
+private:
+#ifdef VSIP_IMPL_REF_IMPL
+  template <typename ViewT>
+  typename result<ViewT>::type
+  apply(ViewT in, false_type)
+  {
     typedef fft::result<O, typename ViewT::block_type> traits;
     typename traits::view_type out(traits::create(this->output_size(),
                                                  in.block().map()));
@@ -187,12 +232,10 @@ public:
     return out;
   }
 #else
-  /// Returns the Fast Fourier Transform of :literal:`in`.
   template <typename ViewT>
-  typename fft::Result_rbo<D, I, O, ViewT, workspace, S>::view_type
-  operator()(ViewT in) VSIP_THROW((std::bad_alloc))
+  typename result<ViewT>::type
+  apply(ViewT in, false_type)
   {
-    OVXX_PRECONDITION(extent(in) == extent(this->input_size()));
     typedef fft::Result_rbo<D, I, O, ViewT, workspace, S> traits;
     typedef typename traits::functor_type functor_type;
     typedef typename traits::block_type   block_type;
@@ -204,9 +247,24 @@ public:
     return view_type(block);
   }
 #endif
-private:
+  template <typename ViewT>
+  typename result<ViewT>::type
+  apply(ViewT in, true_type)
+  {
+    typedef fft::result<O, typename ViewT::block_type> traits;
+    typename traits::view_type out(traits::create(this->output_size(),
+                                                 in.block().map()));
+    fft::detail::buffer_guard guard(distributed_lock_);
+    if (!distributed_.get())
+      distributed_.reset(new distributed_type(this->input_size(), this->scale()));
+    (*distributed_)(in.block(), out.block());
+    return out;
+  }
+
   std::auto_ptr<backend_type> backend_;
   workspace workspace_;
+  std::auto_ptr<distributed_type> distributed_;
+  fft::detail::buffer_lock distributed_lock_;
 };
 
 template <dimension_type D,
@@ -251,7 +309,8 @@ public:
     OVXX_CT_ASSERT((View0<I,Block0>::dim == View1<O,Block1>::dim));
     OVXX_PRECONDITION(extent(in) == extent(this->input_size()));
     OVXX_PRECONDITION(extent(out) == extent(this->output_size()));
-    workspace_.out_of_place(*this->backend_, in.block(), out.block());
+    out_of_place(in.block(), out.block(),
+		 integral_constant<bool, is_distributed<Block0, Block1>::value>());
     return out;
   }
 
@@ -262,13 +321,56 @@ public:
   {
     OVXX_PRECONDITION(extent(inout) == extent(this->input_size()));
     OVXX_PRECONDITION(extent(inout) == extent(this->output_size()));
-    workspace_.in_place(*this->backend_, inout.block());
+    in_place(inout.block(),
+	     integral_constant<bool, is_distributed<BlockT, BlockT>::value>());
     return inout;
   }
 
 private:
+  typedef fft::distributed<D, I, O, exponent, N> distributed_type;
+
+  /// Distributed views are handled by distributed_type, if supported.
+  template <typename Block0, typename Block1>
+  struct is_distributed
+  {
+    static bool const value = distributed_type::supported &&
+      parallel::is_global_map<typename Block0::map_type>::value &&
+      parallel::is_global_map<typename Block1::map_type>::value;
+  };
+
+  template <typename Block0, typename Block1>
+  void out_of_place(Block0 const &in, Block1 &out, false_type)
+  { workspace_.out_of_place(*this->backend_, in, out);}
+  template <typename Block0, typename Block1>
+  void out_of_place(Block0 const &in, Block1 &out, true_type)
+  {
+    fft::detail::buffer_guard guard(distributed_lock_);
+    distributed()(in, out);
+  }
+  template <typename BlockT>
+  void in_place(BlockT &inout, false_type)
+  { workspace_.in_place(*this->backend_, inout);}
+  template <typename BlockT>
+  void in_place(BlockT &inout, true_type)
+  {
+    fft::detail::buffer_guard guard(distributed_lock_);
+    distributed()(inout, inout);
+  }
+
+  // The distributed FFT is set up on first use with distributed views.
+  // Its temporaries are shared by all calls, so the caller needs to hold
+  // distributed_lock_ while setting it up and using it.
+  distributed_type &distributed()
+  {
+    if (!distributed_.get())
+      distributed_.reset(new distributed_type(this->input_size(), this->scale()));
+    return *distributed_;
+  }
+
   std::auto_ptr<backend_type> backend_;
   workspace workspace_;
+  std::auto_ptr<distributed_type> distributed_;
+  fft::detail::buffer_lock distributed_lock_;
 };
 
 template <typename I,                       //< Input type
@@ -401,16 +503,16 @@ public:
   {
     OVXX_PRECONDITION(extent(in)  == extent(this->input_size()));
     OVXX_PRECONDITION(extent(out) == extent(this->output_size()));
-    if (parallel::is_global_map<typename Block0::map_type>::value ||
-	parallel::is_global_map<typename Block1::map_type>::value)
+    if ((parallel::is_global_map<typename Block0::map_type>::value ||
+	 parallel::is_global_map<typename Block1::map_type>::value) &&
+	(in.block().map().num_subblocks(axis) != 1 ||
+	 out.block().map().num_subblocks(axis) != 1 ||
+	 global_domain(in) != global_domain(out)))
     {
-      if (in.block().map().num_subblocks(axis) != 1 ||
-	  out.block().map().num_subblocks(axis) != 1)
-	OVXX_DO_THROW(unimplemented(
-	  "Fftm requires dimension along FFT to not be distributed"));
-      if (global_domain(in) != global_domain(out))
-	OVXX_DO_THROW(unimplemented(
-	  "Fftm requires input and output to have same mapping"));
+      redistribute(in, out, integral_constant<bool,
+		   parallel::is_global_map<typename Block0::map_type>::value &&
+		   parallel::is_global_map<typename Block1::map_type>::value>());
+      return out;
     }
     workspace_.out_of_place(*this->backend_, in.local().block(), out.local().block());
     return out;
@@ -424,18 +526,63 @@ public:
     OVXX_PRECONDITION(extent(inout) == extent(this->input_size()));
     if (parallel::is_global_map<typename BlockT::map_type>::value &&
 	inout.block().map().num_subblocks(axis) != 1)
-      OVXX_DO_THROW(unimplemented(
-	"Fftm requires dimension along FFT to not be distributed"));
+    {
+      redistribute(inout, integral_constant<bool,
+		   parallel::is_global_map<typename BlockT::map_type>::value>());
+      return inout;
+    }
     workspace_.in_place(*this->backend_, inout.local().block());
     return inout;
   }
 
 private:
+  typedef fft::fftm_redistribution<I, O, A> redistribution_type;
+
+  /// Turn the input into a distribution that keeps FFTs local,
+  /// and the result back into the output's distribution.
+  template <typename Block0, typename Block1>
+  void redistribute(const_Matrix<I,Block0> in, Matrix<O,Block1> out, true_type)
+  {
+    redistribution_type &r = redistribution();
+    r.input = in;
+    workspace_.out_of_place(*this->backend_,
+			    r.input.local().block(), r.output.local().block());
+    out = r.output;
+  }
+  template <typename Block0, typename Block1>
+  void redistribute(const_Matrix<I,Block0>, Matrix<O,Block1>, false_type)
+  {
+    OVXX_DO_THROW(unimplemented(
+      "Fftm requires input and output to have same mapping"));
+  }
+  template <typename BlockT>
+  void redistribute(Matrix<O,BlockT> inout, true_type)
+  {
+    redistribution_type &r = redistribution();
+    r.input = inout;
+    workspace_.in_place(*this->backend_, r.input.local().block());
+    inout = r.input;
+  }
+  template <typename BlockT>
+  void redistribute(Matrix<O,BlockT>, false_type) {}
+
+  // The temporaries are allocated on first use with views that need them.
+  redistribution_type &redistribution()
+  {
+    if (!redistribution_.get())
+      redistribution_.reset(new redistribution_type(this->input_size(),
+						    this->output_size()));
+    return *redistribution_;
+  }
+
   std::auto_ptr<backend_type> backend_;
   workspace workspace_;
+  std::auto_ptr<redistribution_type> redistribution_;
 };
 
 } // namespace ovxx::signal
 } // namespace ovxx
 
+#include <ovxx/signal/fft/distributed.hpp>
+
 #endif
@@ -61,6 +61,7 @@ public:
   virtual ~fft_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<1> &rtl_in, Rt_layout<1> &rtl_out)
   {
     // By default use unit_stride, tuple<0, 1, 2>, interleaved_complex
@@ -100,6 +101,7 @@ public:
   virtual ~fft_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<1> &rtl_in, Rt_layout<1> &rtl_out)
   {
     // By default use unit_stride, tuple<0, 1, 2>, interleaved_complex
@@ -140,6 +142,7 @@ public:
   virtual ~fft_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<1> &rtl_inout)
   {
     // By default use unit_stride, tuple<0, 1, 2>, interleaved_complex
@@ -215,6 +218,7 @@ public:
   virtual ~fft_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<2> &rtl_in, Rt_layout<2> &rtl_out)
   {
     // By default use unit_stride, tuple<0, 1, 2>, interleaved_complex
@@ -259,6 +263,7 @@ public:
   virtual ~fft_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<2> &rtl_in, Rt_layout<2> &rtl_out)
   {
     // By default use unit_stride, tuple<0, 1, 2>, interleaved_complex
@@ -303,6 +308,7 @@ public:
   virtual ~fft_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<2> &rtl_inout)
   {
     // By default use unit_stride, tuple<0, 1, 2>, interleaved_complex
@@ -386,6 +392,7 @@ public:
   virtual ~fft_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<3> &rtl_in, Rt_layout<3> &rtl_out)
   {
     // By default use unit_stride, tuple<0, 1, 2>, interleaved_complex
@@ -442,6 +449,7 @@ public:
   virtual ~fft_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<3> &rtl_in, Rt_layout<3> &rtl_out)
   {
     // By default use unit_stride, tuple<0, 1, 2>, interleaved_complex
@@ -498,6 +506,7 @@ public:
   virtual ~fft_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<3> &rtl_inout)
   {
     // By default use unit_stride, tuple<0, 1, 2>, interleaved_complex
@@ -609,6 +618,7 @@ public:
   virtual ~fftm_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<2> &rtl_in, Rt_layout<2> &rtl_out)
   {
     // By default use unit_stride,
@@ -657,6 +667,7 @@ public:
   virtual ~fftm_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<2> &rtl_in, Rt_layout<2> &rtl_out)
   {
     // By default use unit_stride,
@@ -705,6 +716,7 @@ public:
   virtual ~fftm_backend() {}
   virtual bool supports_scale() { return false;}
   virtual bool supports_cuda_memory() { return false;}
+  virtual bool supports_concurrency() { return false;}
   virtual void query_layout(Rt_layout<2> &rtl_inout)
   {
     // By default use unit_stride,
@@ -53,6 +53,7 @@ class dft<1, complex<T>, complex<T>, S>
 
 public:
   virtual char const* name() { return "dft<1,complex,complex>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<1> &) {}
   virtual void query_layout(Rt_layout<1> &rtl_in, Rt_layout<1> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
@@ -132,6 +133,7 @@ class dft<1, T, complex<T>, 0> : public fft_backend<1, T, complex<T>, 0>
 
 public:
   virtual char const* name() { return "dft<1,real,complex>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<1> &rtl_in, Rt_layout<1> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
   virtual void out_of_place(rtype *in, stride_type in_s,
@@ -176,6 +178,7 @@ class dft<1, complex<T>, T, 0> : public fft_backend<1, complex<T>, T, 0>
 
 public:
   virtual char const* name() { return "dft<1,complex,real>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<1> &rtl_in, Rt_layout<1> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
   virtual void out_of_place(ctype *in, stride_type in_s,
@@ -227,6 +230,7 @@ class dft<2, complex<T>, complex<T>, S>
 
 public:
   virtual char const* name() { return "dft<2,complex,complex>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &) {}
   virtual void query_layout(Rt_layout<2> &rtl_in, Rt_layout<2> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
@@ -307,6 +311,7 @@ class dft<2, T, complex<T>, S> : public fft_backend<2, T, complex<T>, S>
 
 public:
   virtual char const* name() { return "dft<2,real,complex>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &rtl_in, Rt_layout<2> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
   virtual void out_of_place(rtype *in,
@@ -390,6 +395,7 @@ class dft<2, complex<T>, T, S> : public  fft_backend<2, complex<T>, T, S>
 
 public:
   virtual char const* name() { return "dft<2,complex,real>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &rtl_in, Rt_layout<2> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
   virtual void out_of_place(ctype *in,
@@ -486,6 +492,7 @@ class dft<3, complex<T>, complex<T>, S>
 
 public:
   virtual char const* name() { return "dft<3,complex,complex>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<3> &) {}
   virtual void query_layout(Rt_layout<3> &rtl_in, Rt_layout<3> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
@@ -589,6 +596,7 @@ class dft<3, T, complex<T>, S> : public fft_backend<3, T, complex<T>, S>
 
 public:
   virtual char const* name() { return "dft<3,real,complex>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<3> &rtl_in, Rt_layout<3> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
   virtual void out_of_place(rtype *in,
@@ -714,6 +722,7 @@ class dft<3, complex<T>, T, S> : public fft_backend<3, complex<T>, T, S>
 
 public:
   virtual char const* name() { return "dft<3,complex,real>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<3> &rtl_in, Rt_layout<3> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
   virtual void out_of_place(ctype *in,
@@ -891,6 +900,7 @@ class dftm<T, complex<T>, A, fft_fwd>
 
 public:
   virtual char const* name() { return "dftm<real,complex>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &rtl_in, Rt_layout<2> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
   virtual void out_of_place(rtype *in,
@@ -938,6 +948,7 @@ class dftm<complex<T>, T, A, fft_inv>
 
 public:
   virtual char const* name() { return "dftm<complex,real>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &rtl_in, Rt_layout<2> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
   virtual void out_of_place(ctype *in,
@@ -1001,6 +1012,7 @@ class dftm<complex<T>, complex<T>, A, D>
 
 public:
   virtual char const* name() { return "dftm<complex,complex>";}
+  virtual bool supports_concurrency() { return true;}
   virtual void query_layout(Rt_layout<2> &) {}
   virtual void query_layout(Rt_layout<2> &rtl_in, Rt_layout<2> &rtl_out)
   { rtl_in.storage_format = rtl_out.storage_format;}
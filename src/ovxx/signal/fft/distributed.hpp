@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_signal_fft_distributed_hpp_
+#define ovxx_signal_fft_distributed_hpp_
+
+// This header is included by <ovxx/signal/fft.hpp> once Fftm is defined.
+
+#include <vsip/map.hpp>
+#include <vsip/dense.hpp>
+#include <vsip/matrix.hpp>
+#include <ovxx/strided.hpp>
+#include <ovxx/c++11/shared_ptr.hpp>
+#ifdef OVXX_PARALLEL
+# include <ovxx/parallel/corner_turn.hpp>
+#endif
+#include <algorithm>
+
+namespace ovxx
+{
+namespace signal
+{
+namespace fft
+{
+
+/// Distributed (multi-dimensional) FFT, used by Fft when applied
+/// to distributed views. Only the specializations below are
+/// supported; for all others, Fft operates on the global views.
+template <dimension_type D, typename I, typename O, int E, unsigned N>
+class distributed
+{
+public:
+  static bool const supported = false;
+
+  distributed(Domain<D> const &, typename scalar_of<I>::type) {}
+
+  template <typename Block0, typename Block1>
+  void operator()(Block0 const &, Block1 &) {}
+};
+
+#ifdef OVXX_PARALLEL
+/// Distributed 2D complex FFT.
+///
+/// The input is turned into a row-wise distribution (unless it is
+/// already), where each processor computes the FFTs of its rows in
+/// batches. Each batch is sent off to the column-wise distribution
+/// while the next batch is being computed. Once all batches have
+/// arrived, each processor computes the FFTs of its columns, and the
+/// result is turned into the output's distribution (unless it
+/// already is).
+template <typename T, int E, unsigned N>
+class distributed<2, complex<T>, complex<T>, E, N> : ovxx::detail::noncopyable
+{
+  typedef complex<T> C;
+  static int const dir = E == -1 ? fft_fwd : fft_inv;
+
+  typedef Map<Block_dist, Block_dist> map_type;
+  typedef Layout<2, row2_type, dense, array> row_layout_type;
+  typedef Layout<2, col2_type, dense, array> col_layout_type;
+  typedef parallel::distributed_block<Strided<2, C, row_layout_type>, map_type>
+    row_block_type;
+  typedef parallel::distributed_block<Strided<2, C, col_layout_type>, map_type>
+    col_block_type;
+  typedef Matrix<C, row_block_type> row_matrix_type;
+  typedef Matrix<C, col_block_type> col_matrix_type;
+
+  typedef Fftm<C, C,
+	       typename dispatcher::List<
+		 dispatcher::op::fftm<C, C, row, dir, by_reference, N> >::type,
+	       row, dir, by_reference, N> row_fftm_type;
+  typedef Fftm<C, C,
+	       typename dispatcher::List<
+		 dispatcher::op::fftm<C, C, col, dir, by_reference, N> >::type,
+	       col, dir, by_reference, N> col_fftm_type;
+
+public:
+  static bool const supported = true;
+
+  distributed(Domain<2> const &dom, T scale)
+    : rows_(dom[0].size(), dom[1].size(),
+	    map_type(Block_dist(num_processors()), Block_dist(1))),
+      cols_(dom[0].size(), dom[1].size(),
+	    map_type(Block_dist(1), Block_dist(num_processors()))),
+      turn_(rows_.block().map(), rows_.local().block().ptr(),
+	    cols_.block().map(), cols_.local().block().ptr(),
+	    batches(dom))
+  {
+    row_fftm_.resize(turn_.batches());
+    for (index_type b = 0; b != turn_.batches(); ++b)
+    {
+      length_type size = turn_.batch(b).size();
+      if (!size) continue;
+      else if (b && turn_.batch(b - 1).size() == size)
+	row_fftm_[b] = row_fftm_[b - 1];
+      else
+	row_fftm_[b].reset(new row_fftm_type(Domain<2>(size, dom[1].size()), 1));
+    }
+    length_type size = cols_.local().size(1);
+    if (size)
+      col_fftm_.reset(new col_fftm_type(Domain<2>(dom[0].size(), size), scale));
+  }
+
+  template <typename Block0, typename Block1>
+  void operator()(Block0 const &in, Block1 &out)
+  {
+    typename view_of<Block0>::const_type input(const_cast<Block0&>(in));
+    typename view_of<Block1>::type output(out);
+
+    bool direct_in = parallel::has_same_map<2>(rows_.block().map(), in);
+    bool direct_out = parallel::has_same_map<2>(cols_.block().map(), out);
+
+    if (!direct_in) rows_ = input;
+
+    typename row_matrix_type::local_type rows = rows_.local();
+    Domain<1> all(rows.size(1));
+    for (index_type b = 0; b != turn_.batches(); ++b)
+    {
+      Domain<2> dom(turn_.batch(b), all);
+      if (row_fftm_[b].get())
+      {
+	if (direct_in) (*row_fftm_[b])(input.local()(dom), rows(dom));
+	else (*row_fftm_[b])(rows(dom));
+      }
+      if (b) turn_.finish(b - 1);
+      turn_.start(b);
+    }
+    turn_.finish(turn_.batches() - 1);
+
+    if (col_fftm_.get())
+    {
+      if (direct_out) (*col_fftm_)(cols_.local(), output.local());
+      else (*col_fftm_)(cols_.local());
+    }
+    if (!direct_out) output = cols_;
+  }
+
+private:
+  /// Split the local rows into a few batches to overlap communication
+  /// with computation, as long as there is enough data to be worth it.
+  static length_type batches(Domain<2> const &dom)
+  {
+    length_type rows = dom[0].size() / num_processors();
+    if (rows * dom[1].size() * sizeof(C) < 65536) return 1;
+    return std::max<length_type>(1, std::min<length_type>(4, rows));
+  }
+
+  row_matrix_type rows_;
+  col_matrix_type cols_;
+  parallel::Corner_turn<C> turn_;
+  std::vector<shared_ptr<row_fftm_type> > row_fftm_;
+  shared_ptr<col_fftm_type> col_fftm_;
+};
+#endif
+
+/// Temporaries used by Fftm to turn distributed views into
+/// a distribution that keeps each FFT local to a processor.
+template <typename I, typename O, int A>
+struct fftm_redistribution
+{
+  typedef Map<Block_dist, Block_dist> map_type;
+  typedef typename conditional<A == row, row2_type, col2_type>::type order_type;
+  typedef Matrix<I, Dense<2, I, order_type, map_type> > input_type;
+  typedef Matrix<O, Dense<2, O, order_type, map_type> > output_type;
+
+  fftm_redistribution(Domain<2> const &in, Domain<2> const &out)
+    : input(in[0].size(), in[1].size(), map()),
+      output(out[0].size(), out[1].size(), map())
+  {}
+
+  static map_type map()
+  {
+    length_type np = num_processors();
+    return A == row ? map_type(np, 1) : map_type(1, np);
+  }
+
+  input_type input;
+  output_type output;
+};
+
+} // namespace ovxx::signal::fft
+} // namespace ovxx::signal
+} // namespace ovxx
+
+#endif
@@ -16,6 +16,10 @@
 #include <ovxx/adjust_layout.hpp>
 #include <ovxx/equal.hpp>
 #include <ovxx/dda.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#if defined(OVXX_ENABLE_THREADING)
+# include <ovxx/c++11/thread.hpp>
+#endif
 
 namespace ovxx
 {
@@ -27,11 +31,78 @@ namespace fft
 /// This provides the temporary data as well as the
 /// conversion logic from blocks to arrays as expected
 /// by fft backends.
+///
+/// A workspace (and thus an Fft or Fftm object) may be used from
+/// multiple threads concurrently: the backend's plan is shared, while
+/// its buffers are used by one call at a time.  Concurrent calls
+/// allocate temporary buffers if the backend supports concurrency,
+/// or otherwise wait for the call using the backend to complete.
 template <dimension_type D, typename I, typename O>
 class workspace;
 
 namespace detail
 {
+/// Guards the buffers of a backend. Copies get their own lock.
+class buffer_lock
+{
+public:
+  buffer_lock() {}
+  buffer_lock(buffer_lock const &) {}
+  buffer_lock &operator=(buffer_lock const &) { return *this;}
+
+#if defined(OVXX_ENABLE_THREADING)
+  bool try_lock() { return mutex_.try_lock();}
+  void lock() { mutex_.lock();}
+  void unlock() { mutex_.unlock();}
+private:
+  mutex mutex_;
+#else
+  bool try_lock() { return true;}
+  void lock() {}
+  void unlock() {}
+#endif
+};
+
+/// Holds a buffer_lock for the duration of a scope.
+class buffer_guard : ovxx::detail::noncopyable
+{
+public:
+  buffer_guard(buffer_lock &lock) : lock_(lock) { lock_.lock();}
+  ~buffer_guard() { lock_.unlock();}
+
+private:
+  buffer_lock &lock_;
+};
+
+/// Provide the buffers used by a single backend call.
+template <typename BE>
+class scratch : ovxx::detail::noncopyable
+{
+public:
+  scratch(BE &backend, buffer_lock &lock)
+    : backend_(backend), lock_(lock), owner_(lock.try_lock())
+  {
+    if (!owner_ && !backend_.supports_concurrency())
+    {
+      lock_.lock();
+      owner_ = true;
+    }
+  }
+  ~scratch() { if (owner_) lock_.unlock();}
+
+  /// The backend's buffers, or null pointers if temporary buffers
+  /// need to be allocated.
+  typename BE::input_value_type *input()
+  { return owner_ ? backend_.input_buffer() : 0;}
+  typename BE::output_value_type *output()
+  { return owner_ ? backend_.output_buffer() : 0;}
+
+private:
+  BE &backend_;
+  buffer_lock &lock_;
+  bool owner_;
+};
+
 template <typename I, typename O>
 struct fft_size
 {
@@ -415,8 +486,9 @@ public:
     backend.query_layout(rtl_in, rtl_out);
     bool force_copy = backend.requires_copy(rtl_in);
     {
-      dda::Rt_data<B1, dda::in> in_data(in, force_copy, rtl_in, backend.input_buffer());
-      dda::Rt_data<B2, dda::out> out_data(out, rtl_out, backend.output_buffer());
+      detail::scratch<BE> buffers(backend, lock_);
+      dda::Rt_data<B1, dda::in> in_data(in, force_copy, rtl_in, buffers.input());
+      dda::Rt_data<B2, dda::out> out_data(out, rtl_out, buffers.output());
       detail::out_of_place(backend, rtl_in.storage_format, in_data, rtl_out.storage_format, out_data);
     }
     if (!backend.supports_scale() && scale_ != scalar_type(1.))
@@ -432,7 +504,8 @@ public:
     Rt_layout<1> rtl_inout = block_layout<1>(inout); 
     backend.query_layout(rtl_inout);
     {
-      dda::Rt_data<B, dda::inout> data(inout, rtl_inout, backend.input_buffer());
+      detail::scratch<BE> buffers(backend, lock_);
+      dda::Rt_data<B, dda::inout> data(inout, rtl_inout, buffers.input());
       detail::in_place(backend, rtl_inout.storage_format, data);
     }
     if (!backend.supports_scale() && scale_ != scalar_type(1.))
@@ -444,6 +517,7 @@ public:
 
 private:
   scalar_type scale_;
+  detail::buffer_lock lock_;
 };
 
 template <typename I, typename O>
@@ -467,8 +541,9 @@ public:
     backend.query_layout(rtl_in, rtl_out);
     bool force_copy = backend.requires_copy(rtl_in);
     {
-      dda::Rt_data<B1, dda::in> in_data(in, force_copy, rtl_in, backend.input_buffer());
-      dda::Rt_data<B2, dda::out> out_data(out, rtl_out, backend.output_buffer());
+      detail::scratch<BE> buffers(backend, lock_);
+      dda::Rt_data<B1, dda::in> in_data(in, force_copy, rtl_in, buffers.input());
+      dda::Rt_data<B2, dda::out> out_data(out, rtl_out, buffers.output());
       detail::out_of_place(backend, rtl_in.storage_format, in_data, rtl_out.storage_format, out_data);
     }
     if (!backend.supports_scale() && scale_ != scalar_type(1.))
@@ -484,7 +559,8 @@ public:
     Rt_layout<2> rtl_inout = block_layout<2>(inout); 
     backend.query_layout(rtl_inout);
     {
-      dda::Rt_data<B, dda::inout> inout_data(inout, rtl_inout, backend.input_buffer());
+      detail::scratch<BE> buffers(backend, lock_);
+      dda::Rt_data<B, dda::inout> inout_data(inout, rtl_inout, buffers.input());
       detail::in_place(backend, rtl_inout.storage_format, inout_data);
     }
     if (!backend.supports_scale() && scale_ != scalar_type(1.))
@@ -496,6 +572,7 @@ public:
 
 private:
   scalar_type scale_;
+  detail::buffer_lock lock_;
 };
 
 template <typename I, typename O>
@@ -519,8 +596,9 @@ public:
     backend.query_layout(rtl_in, rtl_out);
     bool force_copy = backend.requires_copy(rtl_in);
     {
-      dda::Rt_data<B1, dda::in> in_data(in, force_copy, rtl_in, backend.input_buffer());
-      dda::Rt_data<B2, dda::out> out_data(out, rtl_out, backend.output_buffer());
+      detail::scratch<BE> buffers(backend, lock_);
+      dda::Rt_data<B1, dda::in> in_data(in, force_copy, rtl_in, buffers.input());
+      dda::Rt_data<B2, dda::out> out_data(out, rtl_out, buffers.output());
       detail::out_of_place(backend, rtl_in.storage_format, in_data, rtl_out.storage_format, out_data);
     }
     if (!backend.supports_scale() && scale_ != scalar_type(1.))
@@ -536,7 +614,8 @@ public:
     Rt_layout<3> rtl_inout = block_layout<3>(inout); 
     backend.query_layout(rtl_inout);
     {
-      dda::Rt_data<B, dda::inout> inout_data(inout, rtl_inout, backend.input_buffer());
+      detail::scratch<BE> buffers(backend, lock_);
+      dda::Rt_data<B, dda::inout> inout_data(inout, rtl_inout, buffers.input());
       detail::in_place(backend, rtl_inout.storage_format, inout_data);
     }
     if (!backend.supports_scale() && scale_ != scalar_type(1.))
@@ -548,6 +627,7 @@ public:
 
 private:
   scalar_type scale_;
+  detail::buffer_lock lock_;
 };
 
 } // namespace ovxx::signal::fft
@@ -54,6 +54,19 @@ public:
 
   virtual length_type apply(T const *in, stride_type in_stride, length_type in_length,
                             T *out, stride_type out_stride, length_type out_length) = 0;
+  /// Filter a chunk of `in_length` samples of an input stream,
+  /// continuing where the previous chunk left off, and write the
+  /// resulting outputs to `out`. Return the number of outputs.
+  virtual length_type stream(T const *, stride_type, length_type,
+                             T *, stride_type, length_type)
+  {
+    OVXX_DO_THROW(unimplemented("Fir_backend::stream unimplemented"));
+    return 0;
+  }
+  /// Return the number of outputs the next chunk of `in_length`
+  /// samples will produce.
+  virtual length_type stream_output_size(length_type in_length) const VSIP_NOTHROW
+  { return (in_length + decimation_ - 1) / decimation_;}
   virtual void reset() VSIP_NOTHROW = 0;
   virtual char const* name() { return "fir-backend-base";}
   virtual bool supports_cuda_memory() { return false;}
@@ -76,7 +89,9 @@ public:
       skip_(0),
       kernel_(this->kernel_size()),
       state_(this->kernel_size(), T(0)),
-      state_saved_(0)
+      state_saved_(0),
+      history_(this->order_, T(0)),
+      phase_(0)
   {
     OVXX_PRECONDITION(k > (S == nonsym));
     // unpack the kernel
@@ -93,7 +108,9 @@ public:
       skip_(fir.skip_),
       kernel_(fir.kernel_),
       state_(fir.state_.get(Domain<1>(fir.state_.size()))),
-      state_saved_(fir.state_saved_)
+      state_saved_(fir.state_saved_),
+      history_(fir.history_.get(Domain<1>(fir.history_.size()))),
+      phase_(fir.phase_)
   {}
   virtual Fir *clone() { return new Fir(*this);}
 
@@ -159,10 +176,83 @@ public:
     return oix;
   }
 
+  // Output n of the stream is computed at input position n * decimation,
+  // from the preceding M samples (kept in history_ across chunks) and
+  // the current one. phase_ is the position of the next output
+  // relative to the start of the next chunk.
+  length_type stream(T const *in, stride_type in_stride, length_type in_length,
+                     T *out, stride_type out_stride, length_type out_length)
+  {
+    typedef expr::Subset<Dense<1, T> > block_type;
+    typedef Vector<T, block_type> view_type;
+
+    length_type const outputs = stream_output_size(in_length);
+    OVXX_PRECONDITION(out_length >= outputs);
+    if (!in_length) return 0;
+
+    length_type in_extent = abs(in_stride) * (in_length - 1) + 1;
+    T *nc_in = const_cast<T*>(in);
+    Dense<1, T> in_block(in_extent, in_stride > 0 ? nc_in : nc_in - in_extent + 1);
+    block_type sub_in_block(Domain<1>(in_stride > 0 ? 0 : in_extent - 1,
+                                      in_stride, in_length), in_block);
+    view_type input(sub_in_block);
+
+    length_type out_extent = abs(out_stride) * (out_length - 1) + 1;
+    Dense<1, T> out_block(out_extent, out_stride > 0 ? out : out - out_extent + 1);
+    block_type sub_out_block(Domain<1>(out_stride > 0 ? 0 : out_extent - 1,
+                                       out_stride, out_length), out_block);
+    view_type output(sub_out_block);
+
+    length_type const dec = this->decimation();
+    length_type const m = this->order_;
+    length_type p = phase_;
+    length_type oix = 0;
+
+    in_block.admit(true);
+    out_block.admit(false);
+
+    // Outputs that depend on samples of previous chunks...
+    for (; p < m && p < in_length; ++oix, p += dec)
+    {
+      T sum = dot(this->kernel_(Domain<1>(m - p, 1, p + 1)),
+                  input(Domain<1>(p + 1)));
+      sum += dot(this->kernel_(Domain<1>(m - p)),
+                 history_(Domain<1>(p, 1, m - p)));
+      output.put(oix, sum);
+    }
+    // ...and those that only depend on samples of this one.
+    for (; p < in_length; ++oix, p += dec)
+      output.put(oix, dot(this->kernel_, input(Domain<1>(p - m, 1, m + 1))));
+    phase_ = p - in_length;
+
+    // Keep the last M samples.
+    if (in_length >= m)
+      history_ = input(Domain<1>(in_length - m, 1, m));
+    else
+    {
+      for (index_type i = 0; i != m - in_length; ++i)
+        history_.put(i, history_.get(i + in_length));
+      history_(Domain<1>(m - in_length, 1, in_length)) = input;
+    }
+
+    in_block.release(false);
+    out_block.release(true);
+
+    return oix;
+  }
+
+  length_type stream_output_size(length_type in_length) const VSIP_NOTHROW
+  {
+    length_type const dec = this->decimation();
+    return phase_ < in_length ? (in_length - phase_ + dec - 1) / dec : 0;
+  }
+
   virtual void reset() VSIP_NOTHROW
   {
     state_saved_ = skip_ = 0;
     state_ = T(0);
+    history_ = T(0);
+    phase_ = 0;
   }
 
 private:
@@ -170,6 +260,8 @@ private:
   Vector<T, block_type> kernel_; 
   Vector<T, block_type> state_;
   length_type state_saved_;
+  Vector<T, block_type> history_;
+  length_type phase_;
 };
 
 } // namespace ovxx::signal
@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_signal_resampler_hpp_
+#define ovxx_signal_resampler_hpp_
+
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/dda.hpp>
+#include <ovxx/aligned_array.hpp>
+#include <ovxx/adjust_layout.hpp>
+#include <ovxx/signal/detail/history.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#include <algorithm>
+
+namespace ovxx
+{
+namespace signal
+{
+/// Rational sample-rate conversion by a factor L/M.
+///
+/// Conceptually, the input is upsampled by L (inserting L-1 zeros
+/// after each sample), filtered with `kernel`, and downsampled by M.
+/// The resampler instead splits the kernel into a bank of L polyphase
+/// subfilters and evaluates only the outputs that are kept, directly
+/// from the input samples, so no full-rate intermediate signal is
+/// formed.  For unit gain, the kernel's coefficients should add up to L.
+///
+/// The filter state is saved between calls, so a signal may be
+/// processed in chunks of any length.  Each call produces the outputs
+/// that are available so far; output_size() tells how many.
+///
+/// A resampler may process multiple channels at once, given as the
+/// rows of a matrix; each channel has its own state.
+template <typename T>
+class Resampler : ovxx::detail::noncopyable
+{
+public:
+  template <typename Block>
+  Resampler(const_Vector<T, Block> kernel,
+	    length_type interpolation,
+	    length_type decimation,
+	    length_type channels = 1)
+    VSIP_THROW((std::bad_alloc))
+    : interpolation_(interpolation),
+      decimation_(decimation),
+      channels_(channels),
+      kernel_size_(kernel.size()),
+      phase_length_(phase_length(kernel.size(), interpolation)),
+      bank_(interpolation_ * phase_length_),
+      history_(phase_length_ - 1, channels_),
+      position_(0)
+  {
+    OVXX_PRECONDITION(decimation_ > 0);
+    OVXX_PRECONDITION(channels_ > 0);
+    // Subfilter p holds the coefficients p, p + L, p + 2L, ...,
+    // in reverse order, padded with zeros.
+    for (index_type p = 0; p != interpolation_; ++p)
+      for (index_type j = 0; j != phase_length_; ++j)
+      {
+	index_type k = p + j * interpolation_;
+	bank_[p * phase_length_ + phase_length_ - 1 - j] =
+	  k < kernel_size_ ? kernel.get(k) : T(0);
+      }
+    reset();
+  }
+
+  length_type interpolation() const VSIP_NOTHROW { return interpolation_;}
+  length_type decimation() const VSIP_NOTHROW { return decimation_;}
+  length_type kernel_size() const VSIP_NOTHROW { return kernel_size_;}
+  length_type channels() const VSIP_NOTHROW { return channels_;}
+
+  /// Return the number of outputs (per channel) the next call
+  /// produces for `in_size` input samples (per channel).
+  length_type output_size(length_type in_size) const VSIP_NOTHROW
+  {
+    length_type const end = in_size * interpolation_;
+    return position_ < end ? (end - position_ + decimation_ - 1) / decimation_ : 0;
+  }
+
+  /// Resample the next chunk of a single-channel signal. The outputs
+  /// are written to the beginning of `out`. Returns their number.
+  template <typename Block0, typename Block1>
+  length_type
+  operator()(const_Vector<T, Block0> in, Vector<T, Block1> out)
+  {
+    OVXX_PRECONDITION(channels_ == 1);
+    length_type const outputs = output_size(in.size());
+    OVXX_PRECONDITION(out.size() >= outputs);
+
+    typedef typename get_block_layout<Block0>::type LP0;
+    typedef typename get_block_layout<Block1>::type LP1;
+    typedef typename adjust_layout_storage_format<array, LP0>::type use_LP0;
+    typedef typename adjust_layout_storage_format<array, LP1>::type use_LP1;
+    dda::Data<Block0, dda::in, use_LP0> data_in(in.block());
+    // Only a prefix of `out` may be written.
+    dda::Data<Block1, dda::inout, use_LP1> data_out(out.block());
+
+    filter(0, data_in.ptr(), data_in.stride(0), in.size(),
+	   data_out.ptr(), data_out.stride(0));
+    advance(in.size());
+    return outputs;
+  }
+
+  /// Resample the next chunk of each channel (row) of `in`. The outputs
+  /// are written to the beginning of the rows of `out`. Returns their
+  /// number (per channel).
+  template <typename Block0, typename Block1>
+  length_type
+  operator()(const_Matrix<T, Block0> in, Matrix<T, Block1> out)
+  {
+    OVXX_PRECONDITION(in.size(0) == channels_ && out.size(0) == channels_);
+    length_type const outputs = output_size(in.size(1));
+    OVXX_PRECONDITION(out.size(1) >= outputs);
+
+    typedef typename get_block_layout<Block0>::type LP0;
+    typedef typename get_block_layout<Block1>::type LP1;
+    typedef typename adjust_layout_storage_format<array, LP0>::type use_LP0;
+    typedef typename adjust_layout_storage_format<array, LP1>::type use_LP1;
+    dda::Data<Block0, dda::in, use_LP0> data_in(in.block());
+    dda::Data<Block1, dda::inout, use_LP1> data_out(out.block());
+
+    for (index_type c = 0; c != channels_; ++c)
+      filter(c, data_in.ptr() + c * data_in.stride(0), data_in.stride(1), in.size(1),
+	     data_out.ptr() + c * data_out.stride(0), data_out.stride(1));
+    advance(in.size(1));
+    return outputs;
+  }
+
+  /// Clear the state, to start resampling a new signal.
+  void reset() VSIP_NOTHROW
+  {
+    history_.reset();
+    position_ = 0;
+  }
+
+private:
+  // Check the arguments before the members are sized with the result.
+  static length_type phase_length(length_type kernel_size, length_type interpolation)
+  {
+    OVXX_PRECONDITION(interpolation > 0);
+    OVXX_PRECONDITION(kernel_size > 0);
+    return (kernel_size + interpolation - 1) / interpolation;
+  }
+
+  /// Filter `length` samples of channel `c`.
+  void filter(index_type c, T const *in, stride_type in_stride, length_type length,
+	      T *out, stride_type out_stride)
+  {
+    length_type const taps = phase_length_;
+    T const *buffer = history_.load(c, in, in_stride, length);
+
+    // Output n is at position position_ + n * M of the upsampled input,
+    // that is, at input sample u / L, using subfilter u % L.
+    length_type const end = length * interpolation_;
+    for (length_type u = position_; u < end; u += decimation_, out += out_stride)
+    {
+      T const *h = bank_.get() + (u % interpolation_) * taps;
+      T const *x = buffer + u / interpolation_;
+      T sum = T(0);
+      for (index_type j = 0; j != taps; ++j)
+	sum += h[j] * x[j];
+      *out = sum;
+    }
+    // Keep the last taps - 1 samples.
+    history_.save(c, length);
+  }
+
+  /// Move the position past `length` input samples.
+  void advance(length_type length)
+  {
+    length_type const end = length * interpolation_;
+    if (position_ < end)
+      position_ += output_size(length) * decimation_;
+    position_ -= end;
+  }
+
+  length_type interpolation_;
+  length_type decimation_;
+  length_type channels_;
+  length_type kernel_size_;
+  length_type phase_length_;
+  aligned_array<T> bank_;
+  detail::history<T> history_;
+  length_type position_;
+};
+
+} // namespace ovxx::signal
+} // namespace ovxx
+
+#endif
@@ -0,0 +1,258 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_signal_stft_hpp_
+#define ovxx_signal_stft_hpp_
+
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/dda.hpp>
+#include <vsip/impl/signal/fft.hpp>
+#include <ovxx/aligned_array.hpp>
+#include <ovxx/adjust_layout.hpp>
+#include <ovxx/complex_traits.hpp>
+#include <ovxx/signal/detail/history.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#include <algorithm>
+
+namespace ovxx
+{
+namespace signal
+{
+/// Short-time Fourier transform.
+///
+/// The input is cut into overlapping frames of `window.size()` samples,
+/// `hop` samples apart.  Each frame is multiplied by `window`, padded
+/// with zeros to `nfft` samples, and transformed, yielding one row of a
+/// time x frequency matrix (a spectrogram).  For real input, only the
+/// `nfft / 2 + 1` non-negative frequencies are returned.
+///
+/// Frames are staged directly from the input, the window being applied
+/// while staging, and all frames of a call are transformed at once by a
+/// batched `Fftm`, so no separate frame extraction or windowing pass is
+/// needed.
+///
+/// The input is processed in chunks of `input_size` samples, a multiple
+/// of `hop`, each producing `input_size / hop` frames.  Frame m ends
+/// with input sample `(m + 1) * hop - 1`; samples preceding the signal
+/// are taken to be zero.  The samples needed by later frames are saved
+/// between calls.
+template <typename T>
+class Stft : ovxx::detail::noncopyable
+{
+  typedef typename scalar_of<T>::type scalar_type;
+  typedef vsip::Fftm<T, complex<scalar_type>, row, fft_fwd, by_reference> fftm_type;
+
+public:
+  typedef complex<scalar_type> result_type;
+
+  template <typename Block>
+  Stft(const_Vector<scalar_type, Block> window,
+       length_type hop,
+       length_type nfft,
+       length_type input_size)
+    VSIP_THROW((std::bad_alloc))
+    : frame_length_(window.size()),
+      hop_(hop),
+      nfft_(nfft),
+      input_size_(input_size),
+      window_(frame_length_),
+      history_(frame_length_ - hop_, 1, input_size_),
+      frames_(input_size_ / hop_, nfft_, T(0)),
+      fftm_(Domain<2>(input_size_ / hop_, nfft_), scalar_type(1))
+  {
+    OVXX_PRECONDITION(hop_ > 0 && hop_ <= frame_length_);
+    OVXX_PRECONDITION(nfft_ >= frame_length_);
+    OVXX_PRECONDITION(input_size_ > 0 && input_size_ % hop_ == 0);
+    for (index_type i = 0; i != frame_length_; ++i)
+      window_[i] = window.get(i);
+    reset();
+  }
+
+  length_type frame_length() const VSIP_NOTHROW { return frame_length_;}
+  length_type hop() const VSIP_NOTHROW { return hop_;}
+  length_type nfft() const VSIP_NOTHROW { return nfft_;}
+  length_type input_size() const VSIP_NOTHROW { return input_size_;}
+  /// The number of frames per chunk.
+  length_type frames() const VSIP_NOTHROW { return input_size_ / hop_;}
+  /// The number of frequencies per frame.
+  length_type bins() const VSIP_NOTHROW
+  { return is_complex<T>::value ? nfft_ : nfft_ / 2 + 1;}
+
+  /// Transform the next chunk of input. `out` is a frames() x bins() matrix.
+  template <typename Block0, typename Block1>
+  Matrix<result_type, Block1>
+  operator()(const_Vector<T, Block0> in, Matrix<result_type, Block1> out) VSIP_NOTHROW
+  {
+    OVXX_PRECONDITION(in.size() == input_size_);
+    OVXX_PRECONDITION(out.size(0) == frames() && out.size(1) == bins());
+
+    T const *buffer = history_.load(in);
+    {
+      // Stage the windowed frames. Frame f starts at buffer[f * hop];
+      // the zero padding beyond frame_length is left untouched.
+      dda::Data<typename frames_type::block_type, dda::inout> data(frames_.block());
+      scalar_type const *w = window_.get();
+      for (index_type f = 0; f != frames(); ++f)
+      {
+	T const *x = buffer + f * hop_;
+	T *frame = data.ptr() + f * data.stride(0);
+	for (index_type i = 0; i != frame_length_; ++i)
+	  frame[i] = w[i] * x[i];
+      }
+    }
+    fftm_(frames_, out);
+
+    history_.save(0, input_size_);
+    return out;
+  }
+
+  /// Clear the state, to start transforming a new signal.
+  void reset() VSIP_NOTHROW { history_.reset();}
+
+private:
+  typedef Matrix<T> frames_type;
+
+  length_type frame_length_;
+  length_type hop_;
+  length_type nfft_;
+  length_type input_size_;
+  aligned_array<scalar_type> window_;
+  detail::history<T> history_;
+  frames_type frames_;
+  fftm_type fftm_;
+};
+
+/// Inverse short-time Fourier transform.
+///
+/// Reverses Stft by weighted overlap-add: each frame is transformed
+/// back, multiplied by the window again, and added to the output at the
+/// frame's position; the sum is then divided by the sum of the squared
+/// window values overlapping at each position.  Given the spectrogram
+/// of an Stft with the same parameters, this reconstructs the signal,
+/// delayed by `window.size() - hop` samples.  The windows of successive
+/// frames need to cover every position.
+///
+/// The input is processed in chunks of `output_size / hop` frames, each
+/// producing `output_size` samples.  The overlapping tails of the frames
+/// are saved between calls.
+template <typename T>
+class Istft : ovxx::detail::noncopyable
+{
+  typedef typename scalar_of<T>::type scalar_type;
+  typedef vsip::Fftm<complex<scalar_type>, T, row, fft_inv, by_reference> fftm_type;
+
+public:
+  typedef complex<scalar_type> input_type;
+
+  template <typename Block>
+  Istft(const_Vector<scalar_type, Block> window,
+	length_type hop,
+	length_type nfft,
+	length_type output_size)
+    VSIP_THROW((std::bad_alloc))
+    : frame_length_(window.size()),
+      hop_(hop),
+      nfft_(nfft),
+      output_size_(output_size),
+      window_(frame_length_),
+      norm_(hop_),
+      accumulator_(output_size_ + frame_length_ - hop_),
+      frames_(output_size_ / hop_, nfft_),
+      fftm_(Domain<2>(output_size_ / hop_, nfft_), scalar_type(1) / nfft_)
+  {
+    OVXX_PRECONDITION(hop_ > 0 && hop_ <= frame_length_);
+    OVXX_PRECONDITION(nfft_ >= frame_length_);
+    OVXX_PRECONDITION(output_size_ > 0 && output_size_ % hop_ == 0);
+    for (index_type i = 0; i != frame_length_; ++i)
+      window_[i] = window.get(i);
+    // Position i of a chunk is overlapped by the frame positions
+    // congruent to i modulo hop.
+    for (index_type p = 0; p != hop_; ++p)
+    {
+      scalar_type sum = scalar_type(0);
+      for (index_type i = p; i < frame_length_; i += hop_)
+	sum += window_[i] * window_[i];
+      OVXX_PRECONDITION(sum > scalar_type(0));
+      norm_[p] = scalar_type(1) / sum;
+    }
+    reset();
+  }
+
+  length_type frame_length() const VSIP_NOTHROW { return frame_length_;}
+  length_type hop() const VSIP_NOTHROW { return hop_;}
+  length_type nfft() const VSIP_NOTHROW { return nfft_;}
+  length_type output_size() const VSIP_NOTHROW { return output_size_;}
+  /// The number of frames per chunk.
+  length_type frames() const VSIP_NOTHROW { return output_size_ / hop_;}
+  /// The number of frequencies per frame.
+  length_type bins() const VSIP_NOTHROW
+  { return is_complex<T>::value ? nfft_ : nfft_ / 2 + 1;}
+
+  /// Transform the next chunk of frames() x bins() spectra.
+  template <typename Block0, typename Block1>
+  Vector<T, Block1>
+  operator()(const_Matrix<input_type, Block0> in, Vector<T, Block1> out) VSIP_NOTHROW
+  {
+    OVXX_PRECONDITION(in.size(0) == frames() && in.size(1) == bins());
+    OVXX_PRECONDITION(out.size() == output_size_);
+
+    fftm_(in, frames_);
+    T *acc = accumulator_.get();
+    {
+      // Frame f starts at acc[f * hop].
+      dda::Data<typename frames_type::block_type, dda::in> data(frames_.block());
+      scalar_type const *w = window_.get();
+      for (index_type f = 0; f != frames(); ++f)
+      {
+	T const *frame = data.ptr() + f * data.stride(0);
+	T *a = acc + f * hop_;
+	for (index_type i = 0; i != frame_length_; ++i)
+	  a[i] += w[i] * frame[i];
+      }
+    }
+    {
+      typedef typename get_block_layout<Block1>::type LP;
+      typedef typename adjust_layout_storage_format<array, LP>::type use_LP;
+      dda::Data<Block1, dda::out, use_LP> data(out.block());
+      T *ptr = data.ptr();
+      stride_type stride = data.stride(0);
+      for (index_type i = 0; i != output_size_; ++i)
+	ptr[i * stride] = acc[i] * norm_[i % hop_];
+    }
+    // Keep the tails of the last frames.
+    length_type const tail = frame_length_ - hop_;
+    std::copy(acc + output_size_, acc + output_size_ + tail, acc);
+    std::fill(acc + tail, acc + tail + output_size_, T(0));
+    return out;
+  }
+
+  /// Clear the state, to start transforming a new signal.
+  void reset() VSIP_NOTHROW
+  {
+    std::fill(accumulator_.get(), accumulator_.get() + accumulator_.size(), T(0));
+  }
+
+private:
+  typedef Matrix<T> frames_type;
+
+  length_type frame_length_;
+  length_type hop_;
+  length_type nfft_;
+  length_type output_size_;
+  aligned_array<scalar_type> window_;
+  aligned_array<scalar_type> norm_;
+  aligned_array<T> accumulator_;
+  frames_type frames_;
+  fftm_type fftm_;
+};
+
+} // namespace ovxx::signal
+} // namespace ovxx
+
+#endif
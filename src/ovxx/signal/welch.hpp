@@ -0,0 +1,253 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_signal_welch_hpp_
+#define ovxx_signal_welch_hpp_
+
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/dda.hpp>
+#include <ovxx/signal/stft.hpp>
+#include <ovxx/aligned_array.hpp>
+#include <ovxx/complex_traits.hpp>
+#include <ovxx/thread_pool.hpp>
+#include <ovxx/c++11/shared_ptr.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace ovxx
+{
+namespace signal
+{
+namespace detail
+{
+/// Add the cross products of a range of frequencies of the segment
+/// spectra to the running sums, for all channel pairs.
+template <typename C>
+struct welch_accumulate
+{
+  welch_accumulate(C const *s, stride_type c, stride_type r, length_type f,
+		   index_type first, length_type n, C *o, length_type b)
+    : spectra(s), channel_stride(c), row_stride(r), frames(f),
+      first_frame(first), channels(n), sums(o), bins(b) {}
+
+  void operator()(Domain<1> const &dom) const
+  {
+    for (index_type k = dom.first(); k != dom.first() + dom.size(); ++k)
+      for (index_type f = first_frame; f != frames; ++f)
+      {
+	C const *x = spectra + f * row_stride + k;
+	C *sum = sums + k;
+	for (index_type i = 0; i != channels; ++i)
+	{
+	  C xi = conj(x[i * channel_stride]);
+	  for (index_type j = i; j != channels; ++j, sum += bins)
+	    *sum += xi * x[j * channel_stride];
+	}
+      }
+  }
+
+  C const *spectra;
+  stride_type channel_stride;
+  stride_type row_stride;
+  length_type frames;
+  index_type first_frame;
+  length_type channels;
+  C *sums;
+  length_type bins;
+};
+} // namespace ovxx::signal::detail
+
+/// Welch spectral density estimation.
+///
+/// The input is cut into overlapping segments of `window.size()`
+/// samples, `hop` samples apart, each of which is windowed and
+/// transformed (see Stft).  The estimates average the segments' cross
+/// products
+///
+///   S_ij[k] = mean(conj(X_i[k]) X_j[k]) / sum(window^2)
+///
+/// over all segments seen so far, for every pair of channels i <= j.
+/// Only the running sums are kept, not the segment spectra, so signals
+/// may be of any duration, and estimates may be read at any time.  The
+/// pair products of each segment are computed from a single transform
+/// per channel, and the frequencies are spread across the library
+/// thread pool.
+///
+/// The estimates are two-sided densities at a unit sample rate.  For
+/// real input only the `nfft / 2 + 1` non-negative frequencies are
+/// returned; a one-sided density doubles all but the first and (for
+/// even `nfft`) the last of them.
+///
+/// The input is processed in chunks of `input_size` samples per channel,
+/// a multiple of `hop`.  Segments may span chunks; only segments
+/// entirely within the signal are used.
+template <typename T>
+class Welch : ovxx::detail::noncopyable
+{
+  typedef typename scalar_of<T>::type scalar_type;
+  typedef Stft<T> stft_type;
+
+public:
+  typedef complex<scalar_type> csd_type;
+
+  template <typename Block>
+  Welch(const_Vector<scalar_type, Block> window,
+	length_type hop,
+	length_type nfft,
+	length_type input_size,
+	length_type channels = 1)
+    VSIP_THROW((std::bad_alloc))
+    : channels_(channels),
+      frames_(input_size / hop),
+      bins_(is_complex<T>::value ? nfft : nfft / 2 + 1),
+      stft_(channels_),
+      spectra_(channels_ * frames_, bins_),
+      sums_(channels_ * (channels_ + 1) / 2 * bins_)
+  {
+    OVXX_PRECONDITION(channels_ > 0);
+    scalar_type energy = scalar_type(0);
+    for (index_type i = 0; i != window.size(); ++i)
+      energy += window.get(i) * window.get(i);
+    OVXX_PRECONDITION(energy > scalar_type(0));
+    energy_ = energy;
+    // Segment m ends with sample (m + 1) * hop - 1, so the first ones
+    // include samples preceding the signal.
+    partial_ = (window.size() + hop - 1) / hop - 1;
+    for (index_type c = 0; c != channels_; ++c)
+      stft_[c].reset(new stft_type(window, hop, nfft, input_size));
+    reset();
+  }
+
+  length_type channels() const VSIP_NOTHROW { return channels_;}
+  length_type input_size() const VSIP_NOTHROW { return stft_[0]->input_size();}
+  /// The number of frequencies per estimate.
+  length_type bins() const VSIP_NOTHROW { return bins_;}
+  /// The number of segments averaged so far.
+  length_type segments() const VSIP_NOTHROW { return segments_;}
+
+  /// Add the next chunk of a single-channel signal.
+  template <typename Block>
+  void operator()(const_Vector<T, Block> in) VSIP_NOTHROW
+  {
+    OVXX_PRECONDITION(channels_ == 1);
+    (*stft_[0])(in, spectra_);
+    accumulate();
+  }
+
+  /// Add the next chunk of each channel (row) of `in`.
+  template <typename Block>
+  void operator()(const_Matrix<T, Block> in) VSIP_NOTHROW
+  {
+    OVXX_PRECONDITION(in.size(0) == channels_);
+    for (index_type c = 0; c != channels_; ++c)
+    {
+      Domain<2> dom(Domain<1>(c * frames_, 1, frames_), Domain<1>(bins_));
+      (*stft_[c])(in.row(c), spectra_(dom));
+    }
+    accumulate();
+  }
+
+  /// Return the power spectral density of `channel` in `out`.
+  template <typename Block>
+  Vector<scalar_type, Block>
+  psd(Vector<scalar_type, Block> out, index_type channel = 0) const VSIP_NOTHROW
+  {
+    OVXX_PRECONDITION(segments_ > 0 && out.size() == bins_);
+    csd_type const *sum = sums_.get() + pair(channel, channel) * bins_;
+    scalar_type const scale = scalar_type(1) / (segments_ * energy_);
+    for (index_type k = 0; k != bins_; ++k)
+      out.put(k, sum[k].real() * scale);
+    return out;
+  }
+
+  /// Return the cross spectral density of channels `i` and `j`,
+  /// mean(conj(X_i) X_j), in `out`.
+  template <typename Block>
+  Vector<csd_type, Block>
+  csd(Vector<csd_type, Block> out, index_type i, index_type j) const VSIP_NOTHROW
+  {
+    OVXX_PRECONDITION(segments_ > 0 && out.size() == bins_);
+    csd_type const *sum = sums_.get() + pair(i, j) * bins_;
+    scalar_type const scale = scalar_type(1) / (segments_ * energy_);
+    for (index_type k = 0; k != bins_; ++k)
+      out.put(k, (i <= j ? sum[k] : conj(sum[k])) * scale);
+    return out;
+  }
+
+  /// Return the magnitude-squared coherence of channels `i` and `j`,
+  /// |S_ij|^2 / (S_ii S_jj), in `out`.
+  template <typename Block>
+  Vector<scalar_type, Block>
+  coherence(Vector<scalar_type, Block> out, index_type i, index_type j) const VSIP_NOTHROW
+  {
+    OVXX_PRECONDITION(segments_ > 0 && out.size() == bins_);
+    csd_type const *sij = sums_.get() + pair(i, j) * bins_;
+    csd_type const *sii = sums_.get() + pair(i, i) * bins_;
+    csd_type const *sjj = sums_.get() + pair(j, j) * bins_;
+    for (index_type k = 0; k != bins_; ++k)
+    {
+      scalar_type power = sii[k].real() * sjj[k].real();
+      out.put(k, power > scalar_type(0) ? norm(sij[k]) / power : scalar_type(0));
+    }
+    return out;
+  }
+
+  /// Clear the estimates and the state, to start over with a new signal.
+  void reset() VSIP_NOTHROW
+  {
+    for (index_type c = 0; c != channels_; ++c)
+      stft_[c]->reset();
+    std::fill(sums_.get(), sums_.get() + sums_.size(), csd_type(0));
+    segments_ = 0;
+    skip_ = partial_;
+  }
+
+private:
+  /// The index of the running sums of channels `i` and `j`.
+  index_type pair(index_type i, index_type j) const
+  {
+    OVXX_PRECONDITION(i < channels_ && j < channels_);
+    if (i > j) std::swap(i, j);
+    return i * (2 * channels_ - i + 1) / 2 + (j - i);
+  }
+
+  void accumulate()
+  {
+    index_type first = std::min(skip_, frames_);
+    skip_ -= first;
+    if (first == frames_) return;
+    dda::Data<typename spectra_type::block_type, dda::in> data(spectra_.block());
+    detail::welch_accumulate<csd_type>
+      sums(data.ptr(), frames_ * data.stride(0), data.stride(0), frames_, first,
+	   channels_, sums_.get(), bins_);
+    thread_pool::parallel_for(Domain<1>(bins_), sums);
+    segments_ += frames_ - first;
+  }
+
+  typedef Matrix<csd_type> spectra_type;
+
+  length_type channels_;
+  length_type frames_;
+  length_type bins_;
+  scalar_type energy_;
+  length_type partial_;
+  std::vector<shared_ptr<stft_type> > stft_;
+  /// The spectra of the current chunk, one block of frames per channel.
+  spectra_type spectra_;
+  /// The running sums, bins per channel pair.
+  aligned_array<csd_type> sums_;
+  length_type segments_;
+  length_type skip_;
+};
+
+} // namespace ovxx::signal
+} // namespace ovxx
+
+#endif
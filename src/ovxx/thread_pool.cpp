@@ -0,0 +1,418 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#include <ovxx/thread_pool.hpp>
+#include <ovxx/allocator.hpp>
+#if defined(OVXX_ENABLE_THREADING)
+# include <ovxx/c++11/thread.hpp>
+# include <deque>
+# if defined(__linux__)
+#  include <sched.h>
+# endif
+#endif
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#if !_WIN32
+# include <unistd.h>
+#endif
+
+namespace ovxx
+{
+namespace thread_pool
+{
+namespace
+{
+unsigned nesting_limit = 1;
+thread_local unsigned nesting = 0;
+thread_local unsigned worker = 0;
+
+/// Run `t` and report its completion to `group`.
+void execute(task *t, task_group *group)
+{
+  char const *error = 0;
+  std::string message;
+  try { t->run();}
+  catch (std::exception const &x) { message = x.what(); error = message.c_str();}
+  catch (...) { error = "unknown exception";}
+  delete t;
+  group->finished(error);
+}
+
+#if defined(OVXX_ENABLE_THREADING)
+
+/// The number of processors this process may run on, which may be
+/// fewer than are online if it is confined to a subset (e.g. by taskset
+/// or a container's cpuset).
+unsigned available_processors()
+{
+#if defined(__linux__)
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (!sched_getaffinity(0, sizeof(allowed), &allowed))
+  {
+    int n = CPU_COUNT(&allowed);
+    if (n > 0) return n;
+  }
+#endif
+#if defined(_SC_NPROCESSORS_ONLN)
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n > 0) return n;
+#endif
+  return 1;
+}
+
+/// Pin the calling thread to the processor assigned to thread `index`
+/// (0 being the initializing thread) out of `size`.
+void set_affinity(config const &c, unsigned index, unsigned size)
+{
+#if defined(__linux__)
+  if (c.affinity == no_affinity) return;
+  std::vector<int> cpus;
+  if (c.affinity == explicit_affinity)
+    cpus = c.cpus;
+  else
+  {
+    // The processors this process may run on.
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed)) return;
+    for (int i = 0; i != CPU_SETSIZE; ++i)
+      if (CPU_ISSET(i, &allowed)) cpus.push_back(i);
+  }
+  if (cpus.empty()) return;
+  unsigned slot = index;
+  if (c.affinity == scatter_affinity && size < cpus.size())
+    slot = index * cpus.size() / size;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpus[slot % cpus.size()], &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+class pool;
+pool *instance = 0;
+
+struct entry
+{
+  task *t;
+  task_group *group;
+};
+
+struct queue
+{
+  mutex guard;
+  std::deque<entry> entries;
+};
+
+class pool : ovxx::detail::noncopyable
+{
+  struct runner
+  {
+    runner(pool *p, unsigned i) : self(p), index(i) {}
+    void operator()() { self->work(index);}
+    pool *self;
+    unsigned index;
+  };
+
+public:
+  pool(config const &c, unsigned size)
+    : config_(c), queued_(0), done_(false)
+  {
+    // Queue 0 is shared by all threads that aren't workers.
+    for (unsigned i = 0; i != size; ++i)
+      queues_.push_back(new queue);
+    set_affinity(config_, 0, size);
+    for (unsigned i = 1; i != size; ++i)
+      workers_.push_back(new thread(runner(this, i)));
+  }
+  ~pool()
+  {
+    {
+      lock_guard<mutex> lock(sleep_guard_);
+      done_ = true;
+    }
+    wakeup_.notify_all();
+    for (unsigned i = 0; i != workers_.size(); ++i)
+    {
+      workers_[i]->join();
+      delete workers_[i];
+    }
+    for (unsigned i = 0; i != queues_.size(); ++i)
+      delete queues_[i];
+  }
+
+  unsigned size() const { return queues_.size();}
+
+  void push(entry const &e)
+  {
+    queue &q = *queues_[worker];
+    {
+      lock_guard<mutex> lock(q.guard);
+      q.entries.push_back(e);
+    }
+    {
+      lock_guard<mutex> lock(sleep_guard_);
+      ++queued_;
+    }
+    wakeup_.notify_one();
+    progress_.notify_all();
+  }
+
+  /// The worker thread's main loop.
+  void work(unsigned index)
+  {
+    worker = index;
+    set_affinity(config_, index, size());
+    // Tasks may allocate blocks.
+    int argc = 0;
+    char **argv = 0;
+    allocator::initialize(argc, argv);
+    while (true)
+    {
+      if (try_run()) continue;
+      unique_lock<mutex> lock(sleep_guard_);
+      while (!queued_ && !done_) wakeup_.wait(lock);
+      if (done_ && !queued_) break;
+    }
+    allocator::finalize();
+  }
+
+  /// Execute a pending task, if there is any.
+  bool try_run()
+  {
+    entry e;
+    if (!pop(e)) return false;
+    {
+      lock_guard<mutex> lock(sleep_guard_);
+      --queued_;
+    }
+    execute(e.t, e.group);
+    {
+      lock_guard<mutex> lock(sleep_guard_);
+      progress_.notify_all();
+    }
+    return true;
+  }
+
+  /// Block until a task is pending, or `done(arg)` holds.
+  void sleep(bool (*done)(void *), void *arg)
+  {
+    unique_lock<mutex> lock(sleep_guard_);
+    while (!queued_ && !done(arg)) progress_.wait(lock);
+  }
+
+private:
+  bool pop(entry &e)
+  {
+    unsigned const self = worker;
+    // Workers take their own most recent task first...
+    if (self)
+    {
+      queue &q = *queues_[self];
+      lock_guard<mutex> lock(q.guard);
+      if (!q.entries.empty())
+      {
+	e = q.entries.back();
+	q.entries.pop_back();
+	return true;
+      }
+    }
+    // ...and otherwise the oldest task of any other queue, starting
+    // with the shared one.
+    for (unsigned i = 0; i != queues_.size(); ++i)
+    {
+      if (i == self && i) continue;
+      queue &q = *queues_[i];
+      lock_guard<mutex> lock(q.guard);
+      if (!q.entries.empty())
+      {
+	e = q.entries.front();
+	q.entries.pop_front();
+	return true;
+      }
+    }
+    return false;
+  }
+
+  config config_;
+  std::vector<queue *> queues_;
+  std::vector<thread *> workers_;
+  mutex sleep_guard_;
+  /// Signals pending tasks to idle workers.
+  condition_variable wakeup_;
+  /// Signals pending and completed tasks to threads in run_until().
+  condition_variable progress_;
+  length_type queued_;
+  bool done_;
+};
+
+#endif
+} // namespace <unnamed>
+
+config config::from_environment()
+{
+  config c;
+  if (char const *n = std::getenv("OVXX_NUM_THREADS"))
+    c.num_threads = std::max(std::atoi(n), 0);
+  if (char const *a = std::getenv("OVXX_AFFINITY"))
+  {
+    if (!std::strcmp(a, "compact")) c.affinity = compact_affinity;
+    else if (!std::strcmp(a, "scatter")) c.affinity = scatter_affinity;
+    else if (*a && std::strcmp(a, "none"))
+    {
+      c.affinity = explicit_affinity;
+      for (char const *p = a; *p;)
+      {
+	char *end;
+	long cpu = std::strtol(p, &end, 10);
+	if (end == p)
+	  OVXX_DO_THROW(std::runtime_error(std::string("Invalid OVXX_AFFINITY value ") + a));
+	c.cpus.push_back(cpu);
+	p = *end == ',' ? end + 1 : end;
+      }
+    }
+  }
+  if (char const *n = std::getenv("OVXX_NESTED_PARALLELISM"))
+    c.nesting = std::max(std::atoi(n), 0);
+  return c;
+}
+
+struct task_group::impl
+{
+  impl() : pending(0) {}
+  static bool done(void *self)
+  {
+    impl *i = static_cast<impl *>(self);
+#if defined(OVXX_ENABLE_THREADING)
+    lock_guard<mutex> lock(i->guard);
+#endif
+    return !i->pending;
+  }
+#if defined(OVXX_ENABLE_THREADING)
+  mutex guard;
+#endif
+  length_type pending;
+  std::string error;
+};
+
+task_group::task_group() : impl_(new impl) {}
+
+task_group::~task_group()
+{
+  try { wait();}
+  catch (...) {}
+  delete impl_;
+}
+
+void task_group::run(task *t)
+{
+#if defined(OVXX_ENABLE_THREADING)
+  if (instance)
+  {
+    {
+      lock_guard<mutex> lock(impl_->guard);
+      ++impl_->pending;
+    }
+    entry e = { t, this};
+    instance->push(e);
+    return;
+  }
+#endif
+  // No pool: execute immediately.
+  ++impl_->pending;
+  execute(t, this);
+}
+
+void task_group::finished(char const *error)
+{
+#if defined(OVXX_ENABLE_THREADING)
+  lock_guard<mutex> lock(impl_->guard);
+#endif
+  --impl_->pending;
+  if (error && impl_->error.empty()) impl_->error = error;
+}
+
+void task_group::wait()
+{
+  run_until(&impl::done, impl_);
+  if (!impl_->error.empty())
+  {
+    std::string error;
+    std::swap(error, impl_->error);
+    OVXX_DO_THROW(std::runtime_error(error));
+  }
+}
+
+void initialize(config const &c)
+{
+  finalize();
+  nesting_limit = c.nesting;
+#if defined(OVXX_ENABLE_THREADING)
+  unsigned n = c.num_threads;
+  if (!n)
+    n = c.affinity == explicit_affinity && !c.cpus.empty() ?
+      c.cpus.size() : available_processors();
+  instance = new pool(c, n);
+#endif
+}
+
+void initialize() { initialize(config::from_environment());}
+
+void finalize()
+{
+#if defined(OVXX_ENABLE_THREADING)
+  delete instance;
+  instance = 0;
+#endif
+}
+
+unsigned size()
+{
+#if defined(OVXX_ENABLE_THREADING)
+  if (instance) return instance->size();
+#endif
+  return 1;
+}
+
+unsigned worker_index() { return worker;}
+
+bool run_pending()
+{
+#if defined(OVXX_ENABLE_THREADING)
+  if (instance) return instance->try_run();
+#endif
+  return false;
+}
+
+void run_until(bool (*done)(void *), void *arg)
+{
+#if defined(OVXX_ENABLE_THREADING)
+  while (!done(arg))
+  {
+    if (!instance) this_thread::yield();
+    else if (!instance->try_run()) instance->sleep(done, arg);
+  }
+#else
+  // Tasks are run as they are submitted, so there is nothing to wait for.
+  while (!done(arg));
+#endif
+}
+
+unsigned nesting_level() { return nesting;}
+
+bool parallel() { return size() > 1 && nesting < nesting_limit;}
+
+namespace detail
+{
+nesting_scope::nesting_scope() { ++nesting;}
+nesting_scope::~nesting_scope() { --nesting;}
+} // namespace ovxx::thread_pool::detail
+
+} // namespace ovxx::thread_pool
+} // namespace ovxx
@@ -0,0 +1,219 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.BSD file.
+
+#ifndef ovxx_thread_pool_hpp_
+#define ovxx_thread_pool_hpp_
+
+#include <ovxx/support.hpp>
+#include <ovxx/c++11.hpp>
+#include <ovxx/detail/noncopyable.hpp>
+#include <vsip/domain.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ovxx
+{
+/// A work-stealing thread pool, owned by the library.
+///
+/// The pool is started when the library is initialized, and stopped
+/// when it is finalized.  Each worker thread owns a task queue;
+/// tasks submitted by a worker are pushed onto its own queue (and
+/// popped in LIFO order), while tasks submitted by other threads are
+/// pushed onto a shared queue.  Idle workers steal from the other
+/// queues, or sleep if there is no work.  A thread waiting for a
+/// task group executes pending tasks in the meantime, so tasks may
+/// themselves spawn and wait for tasks.
+///
+/// The pool is configured through environment variables:
+///
+///   OVXX_NUM_THREADS: the number of threads executing tasks,
+///     including the one waiting for them (default: the number of
+///     online processors).
+///   OVXX_AFFINITY: "none" (the default), "compact" (pin threads to
+///     consecutive processors), "scatter" (spread them evenly over
+///     the available processors), or a comma-separated list of
+///     processor ids.  The initializing thread is pinned to the first
+///     processor, workers to the following ones.
+///   OVXX_NESTED_PARALLELISM: the number of nested parallel_for levels
+///     that are executed in parallel (default: 1).  Deeper levels are
+///     executed serially by the calling task.
+///
+/// Without threading support (OVXX_ENABLE_THREADING), tasks are
+/// executed immediately by the submitting thread.
+namespace thread_pool
+{
+enum affinity_type
+{
+  no_affinity,
+  compact_affinity,
+  scatter_affinity,
+  explicit_affinity
+};
+
+struct config
+{
+  config() : num_threads(0), affinity(no_affinity), nesting(1) {}
+  /// Read the configuration from the environment.
+  static config from_environment();
+
+  unsigned num_threads;    // 0: the number of online processors
+  affinity_type affinity;
+  std::vector<int> cpus;   // for explicit_affinity
+  unsigned nesting;
+};
+
+/// A unit of work.
+class task : ovxx::detail::noncopyable
+{
+public:
+  virtual ~task() {}
+  virtual void run() = 0;
+};
+
+namespace detail
+{
+template <typename F>
+class function_task : public task
+{
+public:
+  function_task(F const &f) : f_(f) {}
+  virtual void run() { f_();}
+private:
+  F f_;
+};
+} // namespace ovxx::thread_pool::detail
+
+/// A set of tasks that may be waited for together.
+class task_group : ovxx::detail::noncopyable
+{
+public:
+  task_group();
+  /// Wait for all pending tasks, ignoring errors.
+  ~task_group();
+
+  /// Schedule `t` for execution. The group takes ownership of `t`.
+  void run(task *t);
+  template <typename T>
+  void run(T *t) { run(static_cast<task *>(t));}
+  /// Schedule a copy of the function object `f` for execution.
+  template <typename F>
+  void run(F const &f) { run(new detail::function_task<F>(f));}
+  /// Wait for all tasks scheduled so far to complete, executing
+  /// pending tasks while waiting.  If any task terminated with an
+  /// exception, throw a std::runtime_error reporting it.
+  void wait();
+
+  // Implementation details.
+  void finished(char const *error);
+
+private:
+  struct impl;
+  impl *impl_;
+};
+
+/// Start the pool with the given configuration.
+void initialize(config const &);
+/// Start the pool, configured from the environment.
+void initialize();
+/// Stop the pool. Pending tasks are completed first.
+void finalize();
+
+/// Return the number of threads executing tasks (including the caller).
+unsigned size();
+/// Return the index of the calling worker (starting at 1),
+/// or 0 if it isn't a pool worker.
+unsigned worker_index();
+/// Execute one pending task, if there is any, and report whether
+/// a task was executed.
+bool run_pending();
+/// Execute pending tasks until `done(arg)` returns true, blocking
+/// while there is nothing to execute. `done` is evaluated again
+/// whenever a task is scheduled or completes.
+void run_until(bool (*done)(void *), void *arg);
+
+/// Return the parallel_for nesting level of the calling thread.
+unsigned nesting_level();
+/// Should a parallel_for at the current nesting level be run in parallel ?
+bool parallel();
+
+namespace detail
+{
+/// Increment the nesting level for the lifetime of this object.
+class nesting_scope : ovxx::detail::noncopyable
+{
+public:
+  nesting_scope();
+  ~nesting_scope();
+};
+
+// Sub-domain `i` of `n` chunks of dimension 0 of `dom`.
+inline Domain<1> chunk(Domain<1> const &dom, length_type n, index_type i)
+{
+  length_type begin = dom.length() * i / n;
+  length_type end = dom.length() * (i + 1) / n;
+  return Domain<1>(dom.first() + begin * dom.stride(), dom.stride(), end - begin);
+}
+inline Domain<2> chunk(Domain<2> const &dom, length_type n, index_type i)
+{ return Domain<2>(chunk(dom[0], n, i), dom[1]);}
+inline Domain<3> chunk(Domain<3> const &dom, length_type n, index_type i)
+{ return Domain<3>(chunk(dom[0], n, i), dom[1], dom[2]);}
+
+template <dimension_type D, typename F>
+class for_task : public task
+{
+public:
+  for_task(Domain<D> const &dom, F const &f) : dom_(dom), f_(f) {}
+  virtual void run()
+  {
+    nesting_scope scope;
+    f_(dom_);
+  }
+private:
+  Domain<D> dom_;
+  F const &f_;
+};
+
+inline length_type outer_length(Domain<1> const &dom) { return dom.length();}
+template <dimension_type D>
+inline length_type outer_length(Domain<D> const &dom) { return dom[0].length();}
+} // namespace ovxx::thread_pool::detail
+
+/// Apply `f` to sub-domains partitioning `dom`, in parallel.
+///
+/// `dom` is split along its first dimension into chunks of at least
+/// `grain` indices (by default, into a few chunks per thread).  `f`
+/// must be callable as `f(Domain<D> const &)`, and may be called
+/// concurrently from multiple threads.  Returns once all chunks have
+/// been processed.
+template <dimension_type D, typename F>
+void parallel_for(Domain<D> const &dom, F const &f, length_type grain = 0)
+{
+  length_type const length = detail::outer_length(dom);
+  length_type chunks = 4 * size();
+  if (grain) chunks = std::min(chunks, length / grain);
+  chunks = std::min(chunks, length);
+  if (chunks < 2 || !parallel())
+  {
+    f(dom);
+    return;
+  }
+  task_group group;
+  // Run the first chunk in the calling thread.
+  for (index_type i = 1; i != chunks; ++i)
+    group.run(new detail::for_task<D, F>(detail::chunk(dom, chunks, i), f));
+  {
+    detail::nesting_scope scope;
+    f(detail::chunk(dom, chunks, 0));
+  }
+  group.wait();
+}
+
+} // namespace ovxx::thread_pool
+} // namespace ovxx
+
+#endif
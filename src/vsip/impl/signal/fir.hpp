@@ -142,6 +142,49 @@ public:
     }
   }
 
+  /// Filter the next chunk of an input stream.
+  ///
+  /// Unlike operator(), this accepts chunks of any length (independent
+  /// of input_size()), and writes the decimated outputs that are
+  /// available so far to the beginning of `out`, which must be large
+  /// enough to hold impl_stream_output_size(in.size()) values.  The
+  /// filter state, including the decimation phase, is carried over
+  /// from one chunk to the next, so filtering a signal in chunks
+  /// produces the same outputs as filtering it at once.  Returns the
+  /// number of outputs.  Calls to reset() start a new stream.
+  ///
+  /// The streaming state is kept apart from the state operator()
+  /// saves, and mixing the two modes on one object (without a reset()
+  /// in between) is undefined.  Throws `unimplemented` if the selected
+  /// backend doesn't support streaming.
+  template <typename Block0, typename Block1>
+  length_type
+  impl_stream(const_Vector<T, Block0> in, Vector<T, Block1> out)
+  {
+    using vsip::get_block_layout;
+    using ovxx::adjust_layout_storage_format;
+
+    OVXX_CT_ASSERT(continuous_filter == state_save);
+    OVXX_PRECONDITION(out.size() >= impl_stream_output_size(in.size()));
+
+    typedef typename get_block_layout<Block0>::type LP0;
+    typedef typename get_block_layout<Block1>::type LP1;
+    typedef typename adjust_layout_storage_format<array, LP0>::type use_LP0;
+    typedef typename adjust_layout_storage_format<array, LP1>::type use_LP1;
+
+    dda::Data<Block0, dda::in, use_LP0> data_in(in.block());
+    // Only a prefix of `out` may be written.
+    dda::Data<Block1, dda::inout, use_LP1> data_out(out.block());
+
+    return backend_->stream(data_in.ptr(), data_in.stride(0), data_in.size(0),
+                            data_out.ptr(), data_out.stride(0), data_out.size(0));
+  }
+
+  /// Return the number of outputs impl_stream() produces for the
+  /// next chunk of `in_size` samples.
+  length_type impl_stream_output_size(length_type in_size) const VSIP_NOTHROW
+  { return backend_->stream_output_size(in_size);}
+
   void reset() VSIP_NOTHROW { backend_->reset();}
 
   float impl_performance(char const *what) const VSIP_NOTHROW
@@ -16,6 +16,7 @@
 #include <vsip/impl/replicated_map.hpp>
 #include <ovxx/parallel/scalar_map.hpp>
 #include <ovxx/parallel/map_utils.hpp>
+#include <ovxx/parallel/assign_async.hpp>
 #ifdef OVXX_PARALLEL
 # include <ovxx/parallel/util.hpp>
 #endif
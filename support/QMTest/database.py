@@ -301,6 +301,8 @@ class Database(CompilationTestDatabase):
                 self.excluded_subdirs.append('opencl')
             if self.flags.get('have_cuda') != '1':
                 self.excluded_subdirs.append('cuda')
+            if self.flags.get('have_hdf5') != '1':
+                self.excluded_subdirs.append('hdf5')
             if self.flags.get('enable_cvsip_bindings') != 'yes':
                 self.excluded_subdirs.append('cvsip')
             if self.flags.get('enable_python_bindings') not in ('1', 'yes'):
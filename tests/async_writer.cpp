@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Writing frames from a dedicated thread.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <ovxx/io/async_writer.hpp>
+#include <test.hpp>
+#include <stdexcept>
+#include <vector>
+
+using namespace ovxx;
+
+// A sink recording the first value of each frame. It may be held
+// closed, to keep the writer thread busy, and it may fail on a given
+// frame.
+class sink
+{
+public:
+  sink() : open_(true), fail_(-1), attempts_(0) {}
+
+  void append(const_Vector<float> frame)
+  {
+    unique_lock<mutex> lock(mutex_);
+    while (!open_) cond_.wait(lock);
+    index_type attempt = attempts_++;
+    if (static_cast<stride_type>(attempt) == fail_)
+      throw std::runtime_error("disk full");
+    frames_.push_back(frame.get(0));
+  }
+
+  void close() { lock_guard<mutex> lock(mutex_); open_ = false;}
+  void open()
+  {
+    lock_guard<mutex> lock(mutex_);
+    open_ = true;
+    cond_.notify_all();
+  }
+  void fail(stride_type attempt) { lock_guard<mutex> lock(mutex_); fail_ = attempt;}
+  length_type attempts() const { lock_guard<mutex> lock(mutex_); return attempts_;}
+  std::vector<float> frames() const { lock_guard<mutex> lock(mutex_); return frames_;}
+
+private:
+  mutable mutex mutex_;
+  condition_variable cond_;
+  bool open_;
+  stride_type fail_;
+  length_type attempts_;
+  std::vector<float> frames_;
+};
+
+typedef io::async_writer<float> writer_type;
+
+// Frames reach the sink in the order they were queued, whether copied
+// by write() or produced in place.
+void
+test_order()
+{
+  sink s;
+  writer_type writer(s, 4, 2);
+  for (index_type i = 0; i != 20; ++i)
+    if (i % 2)
+      writer.write(Vector<float>(4, float(i)));
+    else
+    {
+      writer_type::view_type frame = writer.acquire();
+      frame = float(i);
+      writer.commit();
+    }
+  writer.flush();
+  test_assert(writer.pending() == 0);
+  std::vector<float> frames = s.frames();
+  test_assert(frames.size() == 20);
+  for (index_type i = 0; i != frames.size(); ++i)
+    test_assert(frames[i] == float(i));
+}
+
+// Once all buffers are taken, try_write() drops frames instead of
+// waiting, and counts them.
+void
+test_overrun()
+{
+  sink s;
+  s.close();
+  writer_type writer(s, 4, 3);
+  for (index_type i = 0; i != 3; ++i)
+    test_assert(writer.try_write(Vector<float>(4, float(i))));
+  test_assert(!writer.try_write(Vector<float>(4, 3.f)));
+  test_assert(!writer.try_write(Vector<float>(4, 4.f)));
+  test_assert(writer.overruns() == 2);
+  // The writer thread holds on to the first frame while it's written.
+  test_assert(writer.pending() == 3);
+  s.open();
+  writer.flush();
+  test_assert(writer.try_write(Vector<float>(4, 5.f)));
+  writer.flush();
+  std::vector<float> frames = s.frames();
+  test_assert(frames.size() == 4);
+  test_assert(frames[0] == 0.f && frames[2] == 2.f && frames[3] == 5.f);
+  test_assert(writer.overruns() == 2);
+}
+
+// A sink failure is reported once, by the next call, and the frames
+// queued after the failing one are still written.
+void
+test_error()
+{
+  sink s;
+  s.close();
+  s.fail(2);
+  writer_type writer(s, 4, 5);
+  for (index_type i = 0; i != 5; ++i)
+    writer.write(Vector<float>(4, float(i)));
+  s.open();
+  bool reported = false;
+  try { writer.flush();}
+  catch (std::runtime_error const &e)
+  {
+    reported = std::string(e.what()) == "disk full";
+  }
+  test_assert(reported);
+  writer.flush();
+  std::vector<float> frames = s.frames();
+  test_assert(frames.size() == 4);
+  test_assert(frames[1] == 1.f && frames[2] == 3.f);
+
+  // write() reports a failure too.
+  s.fail(5);
+  writer.write(Vector<float>(4, 5.f));
+  while (writer.pending()) this_thread::yield();
+  reported = false;
+  try { writer.write(Vector<float>(4, 6.f));}
+  catch (std::runtime_error const &) { reported = true;}
+  test_assert(reported);
+}
+
+// Destroying the writer writes the pending frames, and doesn't throw
+// even if the sink fails meanwhile.
+void
+test_destroy()
+{
+  sink s;
+  s.close();
+  s.fail(0);
+  {
+    writer_type writer(s, 4, 3);
+    for (index_type i = 0; i != 3; ++i)
+      writer.write(Vector<float>(4, float(i)));
+    s.open();
+  }
+  test_assert(s.attempts() == 3);
+  std::vector<float> frames = s.frames();
+  test_assert(frames.size() == 2);
+  test_assert(frames[0] == 1.f && frames[1] == 2.f);
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  test_order();
+  test_overrun();
+  test_error();
+  test_destroy();
+}
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Polyphase FFT channelizer.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/signal.hpp>
+#include <ovxx/signal/channelizer.hpp>
+#include <test.hpp>
+#include <cmath>
+
+using namespace ovxx;
+using ovxx::signal::Channelizer;
+
+// A tone at 2 pi s / channels lands in channel s mod channels only;
+// negative frequencies wrap around to the upper channels. With a
+// kernel of `periods * channels` ones, the other channels sum whole
+// periods of their beat frequency, and cancel, once the filter is
+// filled.
+template <typename T>
+void
+test_tone(length_type channels, length_type decimation, length_type chunk,
+	  int s, length_type periods)
+{
+  typedef typename scalar_of<T>::type S;
+  length_type const chunks = 6, taps = periods * channels;
+  index_type const k0 = (s % int(channels) + channels) % channels;
+  Channelizer<T> channelizer(Vector<S>(taps, S(1)), channels, decimation, chunk);
+  length_type const frames = channelizer.output_size();
+  Matrix<T> out(channels, frames);
+  Vector<T> x(chunk);
+  for (index_type c = 0; c != chunks; ++c)
+  {
+    for (index_type i = 0; i != chunk; ++i)
+    {
+      double phi = 2 * M_PI * s * double((c * chunk + i) % channels) / channels;
+      x.put(i, T(std::cos(phi), std::sin(phi)));
+    }
+    channelizer(x, out);
+    for (index_type f = 0; f != frames; ++f)
+    {
+      index_type n = c * chunk + f * decimation;
+      if (n + 1 < taps) continue;
+      for (index_type k = 0; k != channels; ++k)
+	test_assert(equal(out.get(k, f), T(k == k0 ? S(taps) : S(0))));
+    }
+  }
+}
+
+// Frame f of the whole signal is the same whether the signal is cut
+// into many chunks of a single frame, or processed at once. With a
+// decimation that doesn't divide the number of channels, the DFT
+// rotation of each frame depends on the position carried over.
+template <typename T>
+void
+test_chunking(length_type channels, length_type decimation, length_type k)
+{
+  typedef typename scalar_of<T>::type S;
+  length_type const frames = 2 * k + 5, size = frames * decimation;
+  Vector<S> h(k);
+  for (index_type i = 0; i != k; ++i) h.put(i, S(1) + S(i % 4) / S(2));
+  Vector<T> x(size);
+  for (index_type i = 0; i != size; ++i)
+    x.put(i, T(S((i * 3) % 8), S(i % 3) - S(1)));
+
+  Channelizer<T> whole(h, channels, decimation, size);
+  Matrix<T> expected(channels, frames);
+  whole(x, expected);
+
+  Channelizer<T> framewise(h, channels, decimation, decimation);
+  test_assert(framewise.output_size() == 1);
+  Matrix<T> out(channels, 1);
+  for (index_type f = 0; f != frames; ++f)
+  {
+    framewise(x(Domain<1>(f * decimation, 1, decimation)), out);
+    test_assert(equal(out.col(0), expected.col(f)));
+  }
+}
+
+// Compare an oversampled channelizer to mixing each channel to
+// baseband, filtering, and decimating.
+template <typename T>
+void
+test_mixing(length_type channels, length_type decimation, length_type chunk)
+{
+  typedef typename scalar_of<T>::type S;
+  length_type const k = 3 * channels - 1, size = 4 * chunk;
+  Vector<S> h(k);
+  for (index_type i = 0; i != k; ++i) h.put(i, S(k - i) / S(k));
+  Vector<T> x(size);
+  for (index_type i = 0; i != size; ++i)
+    x.put(i, T(S(i % 5) - S(2), S((i * 7) % 4)));
+
+  Channelizer<T> channelizer(h, channels, decimation, chunk);
+  length_type const frames = channelizer.output_size();
+  Matrix<T> out(channels, 4 * frames);
+  for (index_type c = 0; c != 4; ++c)
+    channelizer(x(Domain<1>(c * chunk, 1, chunk)),
+		out(Domain<2>(Domain<1>(channels), Domain<1>(c * frames, 1, frames))));
+
+  Vector<T> kernel(k);
+  kernel = h;
+  Vector<T> mixed(size), expected(out.size(1));
+  for (index_type ch = 0; ch != channels; ++ch)
+  {
+    for (index_type n = 0; n != size; ++n)
+    {
+      double phi = -2 * M_PI * double(ch * n % channels) / channels;
+      mixed.put(n, x.get(n) * T(std::cos(phi), std::sin(phi)));
+    }
+    Fir<T> fir(kernel, size, decimation);
+    fir(mixed, expected);
+    test_assert(equal(out.row(ch), expected));
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  test_tone<complex<double> >(8, 4, 12, 3, 1);
+  test_tone<complex<double> >(8, 8, 24, -1, 2);
+  test_tone<complex<float> >(6, 3, 9, -4, 1);
+  test_chunking<complex<double> >(8, 3, 20);
+  test_chunking<complex<float> >(5, 5, 12);
+  test_mixing<complex<double> >(8, 3, 9);
+  test_mixing<complex<float> >(4, 4, 16);
+}
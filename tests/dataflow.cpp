@@ -0,0 +1,202 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Asynchronous execution of processing chains.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/signal.hpp>
+#include <ovxx/dataflow.hpp>
+#include <ovxx/thread_pool.hpp>
+#include <test.hpp>
+#include <stdexcept>
+#include <vector>
+
+using namespace ovxx;
+namespace df = ovxx::dataflow;
+
+typedef complex<float> T;
+
+// Generate frame `frame`.
+struct ingest
+{
+  ingest(Matrix<T> m, index_type f) : data(m), frame(f) {}
+  void operator()()
+  {
+    for (index_type r = 0; r != data.size(0); ++r)
+      for (index_type c = 0; c != data.size(1); ++c)
+	data.put(r, c, T(frame + r + c, 1.f));
+  }
+  Matrix<T> data;
+  index_type frame;
+};
+
+// Apply a frequency-domain filter.
+struct compress
+{
+  compress(Matrix<T> d, Matrix<T> f) : data(d), filter(f) {}
+  void operator()() { data = data * filter;}
+  Matrix<T> data;
+  Matrix<T> filter;
+};
+
+// Transpose a frame.
+struct corner_turn
+{
+  corner_turn(Matrix<T> o, Matrix<T> i) : out(o), in(i) {}
+  void operator()() { out = in.transpose();}
+  Matrix<T> out;
+  Matrix<T> in;
+};
+
+// Reduce a frame to a single value.
+struct collect
+{
+  collect(Matrix<T> d, std::vector<T> &r, index_type f)
+    : data(d), results(r), frame(f) {}
+  void operator()() { results[frame] = sumval(data);}
+  Matrix<T> data;
+  std::vector<T> &results;
+  index_type frame;
+};
+
+// Pipeline a chain of stages over successive frames, using `depth`
+// sets of buffers.
+void
+test_pipeline(length_type depth, length_type max_pending)
+{
+  length_type const rows = 8, cols = 16, frames = 20;
+  typedef Fftm<T, T, row, fft_fwd, by_reference> fwd_type;
+  typedef Fftm<T, T, row, fft_inv, by_reference> inv_type;
+  fwd_type fwd(Domain<2>(rows, cols), 1.f);
+  inv_type inv(Domain<2>(rows, cols), 1.f / cols);
+  Matrix<T> filter(rows, cols, T(2.f));
+
+  std::vector<Matrix<T> > input, freq, output, turned;
+  for (index_type b = 0; b != depth; ++b)
+  {
+    input.push_back(Matrix<T>(rows, cols));
+    freq.push_back(Matrix<T>(rows, cols));
+    output.push_back(Matrix<T>(rows, cols));
+    turned.push_back(Matrix<T>(cols, rows));
+  }
+  std::vector<T> results(frames);
+
+  df::graph g(max_pending);
+  for (index_type f = 0; f != frames; ++f)
+  {
+    index_type b = f % depth;
+    g.submit(ingest(input[b], f), df::access().writes(input[b]));
+    g.call(fwd, input[b], freq[b]);
+    g.submit(compress(freq[b], filter),
+	     df::access().reads(filter).writes(freq[b]));
+    g.call(inv, freq[b], output[b]);
+    g.submit(corner_turn(turned[b], output[b]),
+	     df::access().reads(output[b]).writes(turned[b]));
+    g.submit(collect(turned[b], results, f), df::access().reads(turned[b]));
+  }
+  g.wait();
+  test_assert(g.pending() == 0);
+
+  for (index_type f = 0; f != frames; ++f)
+  {
+    T expected;
+    for (index_type r = 0; r != rows; ++r)
+      for (index_type c = 0; c != cols; ++c)
+	expected += 2.f * T(f + r + c, 1.f);
+    test_assert(equal(results[f], expected));
+  }
+}
+
+struct append
+{
+  append(std::vector<int> &l, int v) : log(l), value(v) {}
+  void operator()() { log.push_back(value);}
+  std::vector<int> &log;
+  int value;
+};
+
+struct store
+{
+  store(Vector<float> v, float x) : view(v), value(x) {}
+  void operator()() { view = value;}
+  Vector<float> view;
+  float value;
+};
+
+struct failure
+{
+  void operator()() { throw std::runtime_error("stage failure");}
+};
+
+void
+test_ordering()
+{
+  // Stages modifying the same object run in submission order.
+  std::vector<int> log;
+  df::graph g;
+  for (int i = 0; i != 50; ++i)
+    g.submit(append(log, i), df::access().exclusive(log));
+  g.wait();
+  test_assert(log.size() == 50);
+  for (int i = 0; i != 50; ++i)
+    test_assert(log[i] == i);
+
+  // Read after write, write after read, and aliasing views.
+  Vector<float> a(100, 0.f);
+  Vector<float> b(100, 0.f);
+  Vector<float> alias = a;
+  for (int i = 1; i != 10; ++i)
+  {
+    g.submit(store(alias, i), df::access().writes(alias));
+    g.assign(b, a);
+  }
+  g.wait();
+  test_assert(b.get(99) == 9.f);
+}
+
+void
+test_failure()
+{
+  Vector<float> a(10, 0.f);
+  Vector<float> b(10, 0.f);
+  Vector<float> c(10, 0.f);
+  df::graph g;
+  g.submit(failure(), df::access().writes(a));
+  // Depends on the failed stage, and thus is skipped.
+  g.submit(store(a, 1.f), df::access().writes(a));
+  // Independent.
+  g.submit(store(b, 2.f), df::access().writes(b));
+  bool caught = false;
+  try { g.wait();}
+  catch (std::runtime_error const &) { caught = true;}
+  test_assert(caught);
+  test_assert(a.get(0) == 0.f);
+  test_assert(b.get(0) == 2.f);
+
+  // The graph remains usable.
+  g.assign(c, b);
+  g.wait();
+  test_assert(c.get(0) == 2.f);
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  thread_pool::config c;
+  c.num_threads = 4;
+  thread_pool::initialize(c);
+
+  test_pipeline(1, 0);
+  test_pipeline(3, 0);
+  test_pipeline(3, 8);
+  test_ordering();
+  test_failure();
+}
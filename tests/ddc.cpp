@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Fused digital down-conversion.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/signal.hpp>
+#include <ovxx/signal/ddc.hpp>
+#include <test.hpp>
+#include <cmath>
+
+using namespace ovxx;
+using ovxx::signal::Ddc;
+
+typedef complex<double> C;
+
+// Down-convert a constant through a unit kernel for a long time: the
+// output is the oscillator itself, which must stay on the unit circle
+// and in phase with exp(j(n nu + phi)) despite the accumulated products.
+void
+test_drift(double nu, double phi, length_type decimation)
+{
+  length_type const chunk = 999, chunks = 200;
+  Ddc<double> ddc(Vector<double>(1, 1.), nu, decimation, phi);
+  Vector<double> ones(chunk, 1.);
+  Vector<C> out(chunk);
+  index_type n = 0;
+  for (index_type c = 0; c != chunks; ++c)
+  {
+    length_type o = ddc(ones, out);
+    for (index_type i = 0; i != o; ++i, n += decimation)
+    {
+      test_assert(std::abs(std::abs(out.get(i)) - 1.) < 1e-12);
+      test_assert(std::abs(out.get(i) - std::polar(1., n * nu + phi)) < 1e-9);
+    }
+  }
+  test_assert(n == decimation * ((chunk * chunks + decimation - 1) / decimation));
+}
+
+// Feed one sample at a time: output m is due at input m D, and mixes
+// the filtered window ending there.
+template <typename T>
+void
+test_phase(length_type k, length_type decimation, double nu, double phi)
+{
+  length_type const size = 5 * decimation + k;
+  Vector<double> h(k);
+  for (index_type l = 0; l != k; ++l) h.put(l, 1. / (l + 1));
+  Vector<T> x(size);
+  for (index_type i = 0; i != size; ++i) x.put(i, T(double(i % 6) - 2.5));
+
+  Ddc<T> ddc(h, nu, decimation, phi);
+  Vector<C> out(1);
+  index_type m = 0;
+  for (index_type i = 0; i != size; ++i)
+  {
+    length_type due = i % decimation ? 0 : 1;
+    test_assert(ddc.output_size(1) == due);
+    test_assert(ddc(x(Domain<1>(i, 1, 1)), out) == due);
+    if (!due) continue;
+    C expected = 0.;
+    for (index_type l = 0; l != k && l <= i; ++l)
+      expected += h.get(l) * C(x.get(i - l)) * std::polar(1., (i - l) * nu + phi);
+    test_assert(equal(out.get(0), expected));
+    ++m;
+  }
+  test_assert(m == (size + decimation - 1) / decimation);
+}
+
+// Tuning a real signal to +nu and -nu yields conjugate outputs, and
+// tuning to 0 is plain decimating filtering. Also compare a channel
+// to a single-channel converter, after a reset.
+void
+test_channels(length_type k, length_type decimation, double nu)
+{
+  length_type const size = 26 * decimation, chunk = 13;
+  Vector<double> h(k);
+  for (index_type l = 0; l != k; ++l) h.put(l, double(l % 3) - 0.5);
+  Vector<double> x(size);
+  for (index_type i = 0; i != size; ++i) x.put(i, std::sin(0.3 * i) + (i % 4));
+  Vector<double> tune(3);
+  tune.put(0, nu);
+  tune.put(1, -nu);
+  tune.put(2, 0.);
+
+  Ddc<double> ddc(h, tune, decimation);
+  length_type const outputs = (size + decimation - 1) / decimation;
+  Matrix<C> out(3, outputs);
+  length_type produced = 0;
+  for (index_type pos = 0; pos != size; pos += chunk)
+    produced += ddc(x(Domain<1>(pos, 1, chunk)),
+		    out(Domain<2>(Domain<1>(3), Domain<1>(produced, 1, outputs - produced))));
+  test_assert(produced == outputs);
+
+  Fir<double> fir(h, size, decimation);
+  Vector<double> baseband(outputs);
+  fir(x, baseband);
+  for (index_type m = 0; m != outputs; ++m)
+  {
+    test_assert(equal(out.get(1, m), conj(out.get(0, m))));
+    test_assert(equal(out.get(2, m), C(baseband.get(m))));
+  }
+
+  Ddc<double> single(h, -nu, decimation);
+  Vector<C> restarted(outputs);
+  single(x(Domain<1>(chunk)), restarted);
+  single.reset();
+  test_assert(single(x, restarted) == outputs);
+  test_assert(equal(restarted, out.row(1)));
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  test_drift(0.7311, 0.4, 1);
+  test_drift(-2.9, 0., 7);
+  test_phase<double>(7, 3, 0.9, 0.2);
+  test_phase<C>(4, 4, -1.3, 0.);
+  test_phase<C>(5, 1, 2.2, -0.6);
+  test_channels(12, 4, 0.6);
+  test_channels(5, 3, -1.7);
+}
@@ -8,7 +8,10 @@
 
 #include <ovxx/dispatch.hpp>
 #include <ovxx/dispatcher/diagnostics.hpp>
+#include <ovxx/dispatcher/tuning.hpp>
 #include "test.hpp"
+#include <fstream>
+#include <cstdio>
 
 template <typename T> void test_dispatch();
 
@@ -253,10 +256,147 @@ test_dispatch()
                                  double>::value));
 }
 
+///////////////////////// O5 tests /////////////////////////////////////
+// Test cost-based dispatch
+struct O5;
+
+// A minimal block type, providing a problem size.
+struct Size_block
+{
+  typedef void map_type;
+  typedef float value_type;
+  Size_block(vsip::length_type s) : size_(s) {}
+  vsip::length_type size() const { return size_;}
+  vsip::length_type size_;
+};
+
+namespace ovxx
+{
+namespace dispatcher
+{
+template <>
+struct List<O5>
+{
+  typedef make_type_list<A, B, C>::type type;
+};
+
+template <>
+struct Signature<O5>
+{
+  typedef char(type)(Size_block const &);
+};
+
+template <>
+struct Evaluator<O5, A>
+{
+  static bool const ct_valid = true;
+  static bool rt_valid(Size_block const &b) { return b.size() != 13;}
+  static char exec(Size_block const &) { return 'A';}
+};
+
+template <>
+struct Evaluator<O5, B>
+{
+  static bool const ct_valid = true;
+  static bool rt_valid(Size_block const &b) { return b.size() != 42;}
+  static char exec(Size_block const &) { return 'B';}
+};
+
+template <>
+struct Evaluator<O5, C>
+{
+  static bool const ct_valid = true;
+  static bool rt_valid(Size_block const &) { return true;}
+  static char exec(Size_block const &) { return 'C';}
+};
+// The same backends, with the unmeasured one (C) first.
+struct O5_fallback_first;
+
+template <>
+struct List<O5_fallback_first>
+{
+  typedef make_type_list<C, A, B>::type type;
+};
+
+template <>
+struct Signature<O5_fallback_first>
+{
+  typedef char(type)(Size_block const &);
+};
+
+template <typename X>
+struct Evaluator<O5_fallback_first, X> : Evaluator<O5, X> {};
+} // namespace ovxx::dispatcher
+} // namespace ovxx
+
+char
+dispatch_o5(vsip::length_type size)
+{
+  return ovxx::dispatch<O5, char, Size_block const &>(Size_block(size));
+}
+
+char
+dispatch_o5_fallback_first(vsip::length_type size)
+{
+  using ovxx::dispatcher::O5_fallback_first;
+  return ovxx::dispatch<O5_fallback_first, char, Size_block const &>(Size_block(size));
+}
+
+template <>
+void
+test_dispatch<O5>()
+{
+  namespace tuning = ovxx::dispatcher::tuning;
+  char const *op = ovxx::profile::name<O5>();
+
+  // Without tuning data, the first valid backend wins.
+  test_assert(!tuning::enabled());
+  test_assert(dispatch_o5(1000) == 'A');
+
+  // A has a low overhead, B a high overhead but a better throughput.
+  tuning::add(op, "A", 1, 1e-6);
+  tuning::add(op, "A", 1000, 1e-3);
+  tuning::add(op, "B", 1, 1e-5);
+  tuning::add(op, "B", 1000, 1e-4);
+  test_assert(tuning::enabled());
+  test_assert(dispatch_o5(10) == 'A');
+  test_assert(dispatch_o5(1000) == 'B');
+  test_assert(dispatch_o5(100000) == 'B');
+  // Only valid backends are considered...
+  test_assert(dispatch_o5(13) == 'B');
+  // ...and unmeasured ones (C) only if no measured one is valid.
+  test_assert(dispatch_o5(42) == 'A');
+
+  // An unmeasured backend earlier in the list doesn't block measured ones.
+  char const *op_ff = ovxx::profile::name<ovxx::dispatcher::O5_fallback_first>();
+  test_assert(dispatch_o5_fallback_first(1000) == 'C');
+  tuning::add(op_ff, "B", 1, 1e-5);
+  tuning::add(op_ff, "B", 1000, 1e-4);
+  test_assert(dispatch_o5_fallback_first(1000) == 'B');
+  test_assert(dispatch_o5_fallback_first(13) == 'B');
+  test_assert(dispatch_o5_fallback_first(42) == 'C');
+
+  // Round-trip the table through a file.
+  char const *filename = "dispatch-tuning.txt";
+  {
+    std::ofstream ofs(filename);
+    tuning::save(ofs);
+  }
+  tuning::clear();
+  test_assert(!tuning::enabled());
+  test_assert(dispatch_o5(1000) == 'A');
+  tuning::load(filename);
+  test_assert(tuning::enabled());
+  test_assert(dispatch_o5(1000) == 'B');
+  tuning::clear();
+  std::remove(filename);
+}
+
 int main(int, char **)
 {
   test_dispatch<O1>();
   test_dispatch<O2>();
   test_dispatch<O3>();
   test_dispatch<O4>();
+  test_dispatch<O5>();
 }
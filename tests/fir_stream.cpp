@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Streaming FIR filtering of variable-length chunks.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/signal.hpp>
+#include <test.hpp>
+
+using namespace ovxx;
+
+// y[n] = sum_l h[l] x[n d - l], with x[i] = 0 for i < 0.
+template <typename T>
+T
+direct(Vector<T> h, Vector<T> x, length_type d, index_type n)
+{
+  T sum = T(0);
+  for (index_type l = 0; l != h.size() && l <= n * d; ++l)
+    sum += h.get(l) * x.get(n * d - l);
+  return sum;
+}
+
+// Feed one sample at a time: an output is due exactly at the inputs
+// whose position is a multiple of the decimation, however the samples
+// are spread across calls.
+template <typename T>
+void
+test_phase(length_type k, length_type d)
+{
+  length_type const size = 4 * k + d + 1;
+  Vector<T> h(k), x(size);
+  for (index_type l = 0; l != k; ++l) h.put(l, T(k - l));
+  for (index_type i = 0; i != size; ++i) x.put(i, T(i % 4) - T(i % 3));
+
+  Fir<T, nonsym, state_save> fir(h, k, d);
+  Vector<T> out(1);
+  index_type n = 0;
+  for (index_type i = 0; i != size; ++i)
+  {
+    length_type due = i % d == 0 ? 1 : 0;
+    test_assert(fir.impl_stream_output_size(1) == due);
+    test_assert(fir.impl_stream(x(Domain<1>(i, 1, 1)), out) == due);
+    if (due) test_assert(equal(out.get(0), direct(h, x, d, n++)));
+    // Empty chunks neither produce outputs nor disturb the phase.
+    test_assert(fir.impl_stream(x(Domain<1>(i, 1, 0)), out) == 0);
+  }
+  test_assert(n == (size + d - 1) / d);
+}
+
+// Chunks shorter than the filter order need samples from several
+// earlier chunks. Compare to the block filter, for symmetric kernels.
+template <typename T, symmetry_type S>
+void
+test_short_chunks(length_type k, length_type d, length_type chunk)
+{
+  length_type const size = 10 * chunk;
+  Vector<T> h(k), x(size);
+  for (index_type l = 0; l != k; ++l) h.put(l, T(1) / T(l + 2));
+  for (index_type i = 0; i != size; ++i) x.put(i, T((i * 5) % 9) - T(4));
+
+  Fir<T, S, state_save> block(h, size, d);
+  test_assert(block.kernel_size() > chunk);
+  Vector<T> expected(block.output_size());
+  block(x, expected);
+
+  Fir<T, S, state_save> fir(h, size, d);
+  Vector<T> output(expected.size());
+  Vector<T> chunk_out(chunk);
+  length_type produced = 0;
+  for (index_type pos = 0; pos != size; pos += chunk)
+  {
+    length_type o = fir.impl_stream(x(Domain<1>(pos, 1, chunk)), chunk_out);
+    for (index_type i = 0; i != o; ++i)
+      output.put(produced + i, chunk_out.get(i));
+    produced += o;
+  }
+  test_assert(produced == expected.size());
+  test_assert(equal(output, expected));
+}
+
+// Strided input and output views, and a reset in the middle of a
+// decimation period.
+template <typename T>
+void
+test_strided_reset(length_type k, length_type d)
+{
+  length_type const size = 60;
+  Vector<T> h(k, T(1));
+  Matrix<T> m(size, 3, T(0));
+  for (index_type i = 0; i != size; ++i) m.put(i, 1, T(i) - T(size / 2));
+  Vector<T> x(size);
+  x = m.col(1);
+
+  Fir<T, nonsym, state_save> fir(h, size, d);
+  Matrix<T> out(size, 2, T(-1));
+  length_type const first = d + 1;
+  length_type o = fir.impl_stream(m.col(1)(Domain<1>(first)), out.col(0));
+  test_assert(o == 2);
+  for (index_type n = 0; n != o; ++n)
+    test_assert(equal(out.get(n, 0), direct(h, x, d, n)));
+  // Only the outputs produced were written.
+  test_assert(equal(out.get(o, 0), T(-1)));
+
+  // Without the reset, the next output would be due at sample 2 d.
+  fir.reset();
+  test_assert(fir.impl_stream_output_size(size) == (size + d - 1) / d);
+  o = fir.impl_stream(m.col(1), out.col(1));
+  for (index_type n = 0; n != o; ++n)
+    test_assert(equal(out.get(n, 1), direct(h, x, d, n)));
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  test_phase<float>(5, 1);
+  test_phase<float>(6, 4);
+  test_phase<complex<double> >(4, 3);
+  test_short_chunks<float, nonsym>(13, 2, 3);
+  test_short_chunks<float, sym_even_len_even>(7, 3, 5);
+  test_short_chunks<double, sym_even_len_odd>(6, 2, 1);
+  test_strided_reset<float>(4, 3);
+  test_strided_reset<complex<float> >(7, 2);
+}
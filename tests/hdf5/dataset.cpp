@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Chunked, extensible HDF5 datasets: appending frames, and reading
+// and writing hyperslabs.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/tensor.hpp>
+#include <ovxx/io/hdf5.hpp>
+#include <test.hpp>
+#include <cstdio>
+
+using namespace ovxx;
+
+length_type const samples = 12;
+
+// The value of sample `s` of frame `f`.
+float value(index_type f, index_type s) { return float(100 * f + s);}
+
+Vector<float> make_frame(index_type f)
+{
+  Vector<float> frame(samples);
+  for (index_type s = 0; s != samples; ++s) frame.put(s, value(f, s));
+  return frame;
+}
+
+void
+test_append(char const *name)
+{
+  hdf5::file file(name, 'w');
+  hdf5::dataset ds = file.create_dataset<float>
+    ("frames", Length<2>(0, samples), Length<2>(2, samples));
+  test_assert(ds.query_dimensionality() == 2);
+  test_assert(ds.query_extent<2>()[0].size() == 0);
+
+  // A single frame...
+  ds.append(make_frame(0));
+  test_assert(ds.query_extent<2>()[0].size() == 1);
+  // ...and a block of them.
+  Matrix<float> block(3, samples);
+  for (index_type f = 0; f != 3; ++f) block.row(f) = make_frame(f + 1);
+  ds.append(block);
+  ds.append(make_frame(4));
+  Domain<2> extent = ds.query_extent<2>();
+  test_assert(extent[0].size() == 5 && extent[1].size() == samples);
+
+  // Frames of the wrong size, or views of the wrong dimensionality,
+  // are refused, and leave the dataset unchanged.
+  bool refused = false;
+  try { ds.append(Vector<float>(samples + 1, 0.f));}
+  catch (hdf5::exception const &) { refused = true;}
+  test_assert(refused);
+  refused = false;
+  try { ds.append(Matrix<float>(2, samples - 1, 0.f));}
+  catch (hdf5::exception const &) { refused = true;}
+  test_assert(refused);
+  refused = false;
+  try { ds.append(Tensor<float>(1, 1, samples, 0.f));}
+  catch (hdf5::exception const &) { refused = true;}
+  test_assert(refused);
+  test_assert(ds.query_extent<2>()[0].size() == 5);
+
+  // Overwrite part of frame 2.
+  Vector<float> patch(4);
+  for (index_type s = 0; s != 4; ++s) patch.put(s, -value(2, 2 * s + 1));
+  ds.write(patch, Domain<2>(Domain<1>(2, 1, 1), Domain<1>(1, 2, 4)));
+
+  // A fixed-size dataset can't grow.
+  hdf5::dataset fixed = file.create_dataset<float>
+    ("fixed", Length<2>(1, samples), Length<2>(1, samples), false);
+  refused = false;
+  try { fixed.append(make_frame(0));}
+  catch (hdf5::exception const &) { refused = true;}
+  test_assert(refused);
+}
+
+float expected(index_type f, index_type s)
+{
+  bool patched = f == 2 && s % 2 && s < 9;
+  return patched ? -value(f, s) : value(f, s);
+}
+
+void
+test_read(char const *name)
+{
+  hdf5::file file(name, 'r');
+  // Reopen with a cache big enough for all chunks.
+  hdf5::dataset ds = file.open_dataset
+    ("frames", hdf5::chunk_cache(6 * samples * sizeof(float), 101, 1.));
+  test_assert(ds.has_value_type<float>());
+  Domain<2> extent = ds.query_extent<2>();
+  test_assert(extent[0].size() == 5 && extent[1].size() == samples);
+
+  // A single frame, into a vector.
+  Vector<float> frame(samples);
+  for (index_type f = 0; f != 5; ++f)
+  {
+    ds.read(frame, Domain<2>(Domain<1>(f, 1, 1), samples));
+    for (index_type s = 0; s != samples; ++s)
+      test_assert(frame.get(s) == expected(f, s));
+  }
+  // Every third sample of the odd frames, into a vector...
+  Vector<float> column(2 * samples / 3);
+  ds.read(column, Domain<2>(Domain<1>(1, 2, 2), Domain<1>(0, 3, samples / 3)));
+  for (index_type i = 0; i != column.size(); ++i)
+    test_assert(column.get(i) == expected(1 + 2 * (i / 4), 3 * (i % 4)));
+  // ...and into a matrix, and a strided subview of one.
+  Matrix<float> m(2, samples / 3);
+  ds.read(m, Domain<2>(Domain<1>(1, 2, 2), Domain<1>(0, 3, samples / 3)));
+  Matrix<float> big(4, samples, 0.f);
+  ds.read(big(Domain<2>(Domain<1>(0, 2, 2), Domain<1>(1, 3, samples / 3))),
+	  Domain<2>(Domain<1>(1, 2, 2), Domain<1>(0, 3, samples / 3)));
+  for (index_type r = 0; r != 2; ++r)
+    for (index_type c = 0; c != samples / 3; ++c)
+    {
+      test_assert(m.get(r, c) == expected(1 + 2 * r, 3 * c));
+      test_assert(big.get(2 * r, 1 + 3 * c) == expected(1 + 2 * r, 3 * c));
+      test_assert(big.get(2 * r + 1, 3 * c) == 0.f);
+    }
+  // The hyperslab needs to hold as many elements as the view.
+  bool refused = false;
+  try { ds.read(frame, Domain<2>(2, samples));}
+  catch (hdf5::exception const &) { refused = true;}
+  test_assert(refused);
+  // Reading beyond the extent fails.
+  refused = false;
+  try { ds.read(frame, Domain<2>(Domain<1>(5, 1, 1), samples));}
+  catch (hdf5::exception const &) { refused = true;}
+  test_assert(refused);
+
+  // Copies share the dataset, which stays open until the last
+  // of them is gone.
+  {
+    hdf5::dataset copy = ds;
+    copy = file.open_dataset("frames");
+    copy = ds;
+  }
+  ds.read(frame, Domain<2>(Domain<1>(4, 1, 1), samples));
+  test_assert(frame.get(3) == value(4, 3));
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+  // The errors provoked by the tests needn't be reported on stderr.
+  H5Eset_auto(H5E_DEFAULT, 0, 0);
+
+  char const *name = "hdf5-test.h5";
+  test_append(name);
+  test_read(name);
+  std::remove(name);
+}
@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Conversion of raw integer sample data, in both byte orders, to
+// real and (interleaved and split) complex views.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <ovxx/strided.hpp>
+#include <ovxx/io/ingest.hpp>
+#include <test.hpp>
+#include <vector>
+
+using namespace ovxx;
+
+template <typename I>
+I
+sample(index_type i)
+{
+  // Cover the full range, including negative values.
+  return static_cast<I>((i * 7919 + 13) * (sizeof(I) == 2 ? 1 : 65537));
+}
+
+// Produce raw data of the given byte order.
+template <typename I>
+std::vector<I>
+raw_data(length_type size, bool big_endian)
+{
+  std::vector<I> data(size);
+  for (index_type i = 0; i != size; ++i)
+  {
+    data[i] = sample<I>(i);
+    byteswap(data[i], big_endian != is_big_endian);
+  }
+  return data;
+}
+
+template <typename I>
+void
+test_real(length_type size, bool big_endian)
+{
+  float const scale = 1.f / 4096;
+  std::vector<I> data = raw_data<I>(size + 1, big_endian);
+  Vector<float> out(size, -1.f);
+  io::ingest(&data[0], out, scale, big_endian);
+  for (index_type i = 0; i != size; ++i)
+    test_assert(out.get(i) == scale * sample<I>(i));
+}
+
+template <typename I, storage_format_type S>
+void
+test_complex(length_type size, bool big_endian)
+{
+  typedef Layout<1, row1_type, dense, S> layout_type;
+  typedef Strided<1, complex<float>, layout_type> block_type;
+
+  float const scale = 0.5f;
+  std::vector<I> data = raw_data<I>(2 * size + 1, big_endian);
+  Vector<complex<float>, block_type> out(size, complex<float>(-1.f));
+  io::ingest(&data[0], out, scale, big_endian);
+  for (index_type i = 0; i != size; ++i)
+    test_assert(out.get(i) == complex<float>(scale * sample<I>(2*i),
+					     scale * sample<I>(2*i + 1)));
+}
+
+// Non-unit-stride targets go through a temporary.
+template <typename I>
+void
+test_subview(length_type size, bool big_endian)
+{
+  std::vector<I> data = raw_data<I>(2 * size, big_endian);
+  Vector<complex<float> > out(2 * size, complex<float>());
+  io::ingest(&data[0], out(Domain<1>(1, 2, size)), 1.f, big_endian);
+  for (index_type i = 0; i != size; ++i)
+  {
+    test_assert(out.get(2*i) == complex<float>());
+    test_assert(out.get(2*i + 1) == complex<float>(sample<I>(2*i),
+						   sample<I>(2*i + 1)));
+  }
+}
+
+template <typename I>
+void
+test_type()
+{
+  length_type const sizes[] = { 0, 1, 3, 4, 7, 8, 9, 17, 1000};
+  for (index_type i = 0; i != sizeof(sizes) / sizeof(*sizes); ++i)
+    for (int big_endian = 0; big_endian != 2; ++big_endian)
+    {
+      test_real<I>(sizes[i], big_endian);
+      test_complex<I, array>(sizes[i], big_endian);
+      test_complex<I, interleaved_complex>(sizes[i], big_endian);
+      test_complex<I, split_complex>(sizes[i], big_endian);
+      test_subview<I>(sizes[i], big_endian);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  test_type<int8_type>();
+  test_type<int16_type>();
+  test_type<int32_type>();
+}
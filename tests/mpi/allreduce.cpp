@@ -59,7 +59,7 @@ allreduce_test(mpi::Communicator &comm, T init)
 
   // Compute expected result
   std::vector<T> generated_values;
-  for (int p = 0; p < comm.size(); ++p)
+  for (index_type p = 0; p < comm.size(); ++p)
     generated_values.push_back(gen(p));
   T expected_result = std::accumulate(generated_values.begin(),
 				      generated_values.end(),
@@ -71,6 +71,57 @@ allreduce_test(mpi::Communicator &comm, T init)
   comm.barrier();
 }
 
+// Reduce (value, position) pairs: values repeat across processors,
+// so the lowest position among the extremal values has to win.
+// Processors with npos positions don't contribute.
+void
+allreduce_idx_test(mpi::Communicator &comm, reduction_type R)
+{
+  index_type const npos = mpi::Value_index<float>::npos;
+  float expected_value = 0.f;
+  index_type expected_pos = npos;
+  for (index_type p = 0; p < comm.size(); ++p)
+  {
+    float v = p % 2;
+    index_type i = p % 3 ? 100 - p : npos;
+    if (i == npos) continue;
+    if (expected_pos == npos ||
+	(R == reduce_max ? v > expected_value : v < expected_value) ||
+	(v == expected_value && i < expected_pos))
+    {
+      expected_value = v;
+      expected_pos = i;
+    }
+  }
+  float value = comm.rank() % 2;
+  index_type pos = comm.rank() % 3 ? 100 - comm.rank() : npos;
+  comm.allreduce(R, value, pos);
+  test_assert(pos == expected_pos);
+  if (pos != npos) test_assert(value == expected_value);
+  comm.barrier();
+}
+
+// Reproducible reductions yield the same result as the tree
+// evaluated sequentially, independent of the MPI implementation.
+template <typename T>
+void
+reproducible_test(mpi::Communicator &comm)
+{
+  mpi::set_reproducible_reductions(true);
+  T value = T(1) / T(3 + comm.rank());
+  T result = comm.allreduce(reduce_sum, value);
+  // Evaluate the same binomial tree locally.
+  int size = comm.size();
+  std::vector<T> values(size);
+  for (int p = 0; p < size; ++p) values[p] = T(1) / T(3 + p);
+  for (int mask = 1; mask < size; mask <<= 1)
+    for (int p = 0; p + mask < size; p += 2 * mask)
+      values[p] = values[p] + values[p + mask];
+  test_assert(result == values[0]);
+  mpi::set_reproducible_reductions(false);
+  comm.barrier();
+}
+
 int main(int argc, char* argv[])
 {
   library lib(argc, argv);
@@ -79,4 +130,10 @@ int main(int argc, char* argv[])
   allreduce_test<int, reduce_sum>(comm, 0);
   allreduce_test<float, reduce_max>(comm, 2);
   allreduce_test<double, reduce_min>(comm, 1);
+  allreduce_test<complex<float>, reduce_sum>(comm, 0);
+  allreduce_test<complex<double>, reduce_sum>(comm, 0);
+  allreduce_idx_test(comm, reduce_max);
+  allreduce_idx_test(comm, reduce_min);
+  reproducible_test<float>(comm);
+  reproducible_test<double>(comm);
 }
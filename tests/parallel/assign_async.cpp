@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/map.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/parallel.hpp>
+#include <test.hpp>
+#include "util.hpp"
+
+using namespace ovxx;
+using ovxx::parallel::Async_assignment;
+
+template <typename T, typename B>
+void
+fill(Matrix<T, B> m, index_type iter)
+{
+  typename Matrix<T, B>::local_type l = m.local();
+  for (index_type r = 0; r < l.size(0); ++r)
+    for (index_type c = 0; c < l.size(1); ++c)
+    {
+      index_type gr = global_from_local_index(m, 0, r);
+      index_type gc = global_from_local_index(m, 1, c);
+      l.put(r, c, T(iter * 1000 + gr * m.size(1) + gc));
+    }
+}
+
+template <typename T, typename B>
+void
+check(Matrix<T, B> m, index_type iter)
+{
+  typename Matrix<T, B>::local_type l = m.local();
+  for (index_type r = 0; r < l.size(0); ++r)
+    for (index_type c = 0; c < l.size(1); ++c)
+    {
+      index_type gr = global_from_local_index(m, 0, r);
+      index_type gc = global_from_local_index(m, 1, c);
+      test_assert(equal(l.get(r, c), T(iter * 1000 + gr * m.size(1) + gc)));
+    }
+}
+
+// Double-buffered corner-turn: while one corner-turn is in flight,
+// the next frame is produced, and a second one is started.
+template <typename T>
+void
+corner_turn(length_type rows, length_type cols, length_type loop)
+{
+  typedef Map<Block_dist, Block_dist>      map_type;
+  typedef Dense<2, T, row2_type, map_type> block_type;
+  typedef Matrix<T, block_type>            view_type;
+
+  processor_type np = num_processors();
+  map_type row_map(np, 1);
+  map_type col_map(1, np);
+
+  view_type A1(rows, cols, row_map);
+  view_type A2(rows, cols, row_map);
+  view_type B1(rows, cols, col_map);
+  view_type B2(rows, cols, col_map);
+
+  Async_assignment<view_type, view_type> ct1(B1, A1);
+  Async_assignment<view_type, view_type> ct2(B2, A2);
+
+  fill(A1, 0);
+  ct1.start();
+  for (index_type i = 1; i < loop; ++i)
+  {
+    if (i % 2)
+    {
+      fill(A2, i);
+      ct2.start();
+      ct1.test();
+      ct1.finish();
+      check(B1, i - 1);
+    }
+    else
+    {
+      fill(A1, i);
+      ct1.start();
+      ct2.finish();
+      check(B2, i - 1);
+    }
+  }
+  if (loop % 2) { ct1.finish(); check(B1, loop - 1);}
+  else          { ct2.finish(); check(B2, loop - 1);}
+
+  // Same maps, no communication.
+  fill(A1, 0);
+  view_type C(rows, cols, row_map);
+  Async_assignment<view_type, view_type> copy(C, A1);
+  copy.start();
+  test_assert(copy.test());
+  copy.finish();
+  check(C, 0);
+}
+
+// Block-distributed vectors use a different assignment algorithm.
+template <typename T>
+void
+vector_redistribute(length_type size)
+{
+  typedef Map<Block_dist> map_type;
+  typedef Dense<1, T, row1_type, map_type> block_type;
+  typedef Vector<T, block_type> view_type;
+
+  processor_type np = num_processors();
+  map_type src_map(np);
+  map_type dst_map(std::max<length_type>(np / 2, 1));
+
+  view_type src(size, T(), src_map);
+  view_type dst(size, T(), dst_map);
+  typename view_type::local_type l = src.local();
+  for (index_type i = 0; i < l.size(); ++i)
+    l.put(i, T(global_from_local_index(src, 0, i)));
+
+  Async_assignment<view_type, view_type> assign(dst, src);
+  assign.start();
+  assign.finish();
+
+  typename view_type::local_type d = dst.local();
+  for (index_type i = 0; i < d.size(); ++i)
+    test_assert(equal(d.get(i), T(global_from_local_index(dst, 0, i))));
+}
+
+int
+main(int argc, char** argv)
+{
+  vsipl vpp(argc, argv);
+
+  corner_turn<float>(32, 64, 6);
+  corner_turn<complex<float> >(15, 9, 5);
+  vector_redistribute<float>(37);
+  vector_redistribute<complex<float> >(16);
+
+  return 0;
+}
@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Repeated parallel assignments reuse cached plans (and their
+// persistent requests). Make sure these stay correct when data
+// changes between assignments, when different blocks share the same
+// maps, and when the same maps are applied to different extents.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/map.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/parallel.hpp>
+#include <test.hpp>
+#include "util.hpp"
+#include <vector>
+
+using namespace ovxx;
+
+template <typename T, typename B>
+void
+fill(Matrix<T, B> m, index_type iter)
+{
+  typename Matrix<T, B>::local_type l = m.local();
+  for (index_type r = 0; r < l.size(0); ++r)
+    for (index_type c = 0; c < l.size(1); ++c)
+    {
+      index_type gr = global_from_local_index(m, 0, r);
+      index_type gc = global_from_local_index(m, 1, c);
+      l.put(r, c, T(iter * 1000 + gr * m.size(1) + gc));
+    }
+}
+
+template <typename T, typename B>
+void
+check(Matrix<T, B> m, index_type iter)
+{
+  typename Matrix<T, B>::local_type l = m.local();
+  for (index_type r = 0; r < l.size(0); ++r)
+    for (index_type c = 0; c < l.size(1); ++c)
+    {
+      index_type gr = global_from_local_index(m, 0, r);
+      index_type gc = global_from_local_index(m, 1, c);
+      test_assert(equal(l.get(r, c), T(iter * 1000 + gr * m.size(1) + gc)));
+    }
+}
+
+template <typename T>
+void
+repeated_corner_turn(length_type rows, length_type cols, length_type loop)
+{
+  typedef Map<Block_dist, Block_dist>      map_type;
+  typedef Dense<2, T, row2_type, map_type> block_type;
+
+  processor_type np = num_processors();
+  map_type row_map(np, 1);
+  map_type col_map(1, np);
+
+  Matrix<T, block_type> A(rows, cols, row_map);
+  Matrix<T, block_type> B1(rows, cols, col_map);
+  Matrix<T, block_type> B2(rows, cols, col_map);
+
+  for (index_type i = 0; i < loop; ++i)
+  {
+    fill(A, i);
+    // Alternate between two destinations with the same map, so the
+    // cached plan has to be rebound to different subblocks.
+    if (i % 2) { B1 = A; check(B1, i);}
+    else       { B2 = A; check(B2, i);}
+  }
+
+  // Cycle through more destinations than a plan keeps request sets
+  // for, so the least recently used ones get released and recreated.
+  std::vector<Matrix<T, block_type> > dst;
+  for (index_type i = 0; i != 6; ++i)
+    dst.push_back(Matrix<T, block_type>(rows, cols, col_map));
+  for (index_type i = 0; i < 3 * dst.size(); ++i)
+  {
+    fill(A, i);
+    dst[i % dst.size()] = A;
+    check(dst[i % dst.size()], i);
+  }
+
+  // Same maps, different extents: this must not pick up the plan above.
+  Matrix<T, block_type> C(rows + 3, cols + 1, row_map);
+  Matrix<T, block_type> D(rows + 3, cols + 1, col_map);
+  for (index_type i = 0; i < loop; ++i)
+  {
+    fill(C, i);
+    D = C;
+    check(D, i);
+    fill(A, i);
+    B1 = A;
+    check(B1, i);
+  }
+}
+
+template <typename T>
+void
+repeated_cyclic(length_type size, length_type loop)
+{
+  typedef Map<Block_dist>  block_map_type;
+  typedef Map<Cyclic_dist> cyclic_map_type;
+  typedef Dense<1, T, row1_type, block_map_type> block_block_type;
+  typedef Dense<1, T, row1_type, cyclic_map_type> cyclic_block_type;
+
+  processor_type np = num_processors();
+  block_map_type block_map(np);
+  cyclic_map_type cyclic_map(Cyclic_dist(np, 2));
+
+  Vector<T, block_block_type> src(size, block_map);
+  Vector<T, cyclic_block_type> dst(size, cyclic_map);
+  Vector<T, block_block_type> back(size, block_map);
+
+  for (index_type i = 0; i < loop; ++i)
+  {
+    typename Vector<T, block_block_type>::local_type l = src.local();
+    for (index_type j = 0; j < l.size(); ++j)
+      l.put(j, T(i + global_from_local_index(src, 0, j)));
+    dst = src;
+    back = dst;
+    typename Vector<T, block_block_type>::local_type b = back.local();
+    for (index_type j = 0; j < b.size(); ++j)
+      test_assert(equal(b.get(j), T(i + global_from_local_index(back, 0, j))));
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  vsipl vpp(argc, argv);
+
+  repeated_corner_turn<float>(32, 64, 5);
+  repeated_corner_turn<complex<float> >(16, 7, 4);
+  repeated_cyclic<float>(53, 4);
+  repeated_cyclic<complex<float> >(20, 3);
+
+  return 0;
+}
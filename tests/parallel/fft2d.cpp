@@ -0,0 +1,198 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Distributed 2D FFTs (with built-in corner turn), and Fftm on views
+// distributed along the FFT axis. Results are checked against FFTs
+// of the non-distributed data.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/signal.hpp>
+#include <vsip/math.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/map.hpp>
+#include <test.hpp>
+#include "util.hpp"
+
+using namespace ovxx;
+
+typedef Map<Block_dist, Block_dist> map_type;
+
+template <typename T>
+T
+value(index_type r, index_type c)
+{
+  return T(std::cos(0.1 * r + 0.3 * c), (r * 7 + c * 3) % 11 - 5.);
+}
+
+template <typename T>
+void
+setup(Matrix<T> m)
+{
+  for (index_type r = 0; r < m.size(0); ++r)
+    for (index_type c = 0; c < m.size(1); ++c)
+      m.put(r, c, value<T>(r, c));
+}
+
+template <typename T, typename B>
+void
+setup(Matrix<T, B> m)
+{
+  typename Matrix<T, B>::local_type l = m.local();
+  for (index_type r = 0; r < l.size(0); ++r)
+    for (index_type c = 0; c < l.size(1); ++c)
+      l.put(r, c, value<T>(global_from_local_index(m, 0, r),
+			   global_from_local_index(m, 1, c)));
+}
+
+// Check the local part of `m` against the global reference.
+template <typename T, typename B>
+void
+check(Matrix<T, B> m, Matrix<T> ref)
+{
+  if (subblock(m) != no_subblock)
+    test_assert(test::diff(m.local(), ref(global_domain(m))) < -100);
+}
+
+// Return a 2D processor grid map.
+map_type
+grid_map()
+{
+  length_type np = num_processors();
+  length_type n0 = np % 2 ? 1 : 2;
+  return map_type(n0, np / n0);
+}
+
+template <typename T>
+void
+test_fft2d(length_type rows, length_type cols,
+	   map_type const &in_map, map_type const &out_map)
+{
+  typedef typename scalar_of<T>::type scalar_type;
+  typedef Dense<2, T, row2_type, map_type> block_type;
+  typedef Fft<const_Matrix, T, T, fft_fwd, by_reference> fwd_type;
+  typedef Fft<const_Matrix, T, T, fft_inv, by_reference> inv_type;
+
+  Domain<2> dom(rows, cols);
+  fwd_type fwd(dom, 1.);
+  inv_type inv(dom, scalar_type(1.) / (rows * cols));
+
+  Matrix<T> data(rows, cols);
+  Matrix<T> ref(rows, cols);
+  setup(data);
+  fwd(data, ref);
+
+  Matrix<T, block_type> in(rows, cols, in_map);
+  Matrix<T, block_type> out(rows, cols, out_map);
+  Matrix<T, block_type> back(rows, cols, in_map);
+  setup(in);
+
+  // Repeat, to exercise the reuse of the corner turn.
+  for (index_type i = 0; i != 2; ++i)
+  {
+    out = T();
+    fwd(in, out);
+    check(out, ref);
+  }
+  inv(out, back);
+  check(back, data);
+
+  // In-place
+  fwd(back);
+  check(back, ref);
+}
+
+template <typename T>
+void
+test_fft2d_by_value(length_type rows, length_type cols, map_type const &map)
+{
+  typedef Dense<2, T, row2_type, map_type> block_type;
+  typedef Fft<const_Matrix, T, T, fft_fwd, by_value> fwd_type;
+
+  Domain<2> dom(rows, cols);
+  fwd_type fwd(dom, 1.);
+
+  Matrix<T> data(rows, cols);
+  setup(data);
+  Matrix<T> ref = fwd(data);
+
+  Matrix<T, block_type> in(rows, cols, map);
+  setup(in);
+  // The result has the input's map...
+  check(fwd(in), ref);
+  // ...and may be assigned to views with other maps.
+  Matrix<T, block_type> out(rows, cols, grid_map());
+  out = fwd(in);
+  check(out, ref);
+}
+
+template <typename T>
+void
+test_fftm(length_type rows, length_type cols)
+{
+  typedef Dense<2, T, row2_type, map_type> block_type;
+  typedef Fftm<T, T, row, fft_fwd, by_reference> row_fftm_type;
+  typedef Fftm<T, T, col, fft_fwd, by_reference> col_fftm_type;
+
+  length_type np = num_processors();
+  Domain<2> dom(rows, cols);
+  row_fftm_type row_fftm(dom, 1.);
+  col_fftm_type col_fftm(dom, 1.);
+
+  Matrix<T> data(rows, cols);
+  Matrix<T> row_ref(rows, cols);
+  Matrix<T> col_ref(rows, cols);
+  setup(data);
+  row_fftm(data, row_ref);
+  col_fftm(data, col_ref);
+
+  // Distributed along the FFT axis.
+  Matrix<T, block_type> in(rows, cols, map_type(1, np));
+  Matrix<T, block_type> out(rows, cols, map_type(1, np));
+  setup(in);
+  row_fftm(in, out);
+  check(out, row_ref);
+  row_fftm(in);
+  check(in, row_ref);
+
+  // Input and output with different mappings.
+  Matrix<T, block_type> in2(rows, cols, map_type(1, np));
+  Matrix<T, block_type> out2(rows, cols, map_type(np, 1));
+  setup(in2);
+  col_fftm(in2, out2);
+  check(out2, col_ref);
+}
+
+int
+main(int argc, char** argv)
+{
+  vsipl vpp(argc, argv);
+
+  length_type np = num_processors();
+  map_type row_map(np, 1);
+  map_type col_map(1, np);
+
+  // Input in row-, output in column-distribution: no extra corner turns.
+  test_fft2d<complex<float> >(16, 32, row_map, col_map);
+  // Uneven distributions.
+  test_fft2d<complex<float> >(18, 21, row_map, col_map);
+  // Large enough to be pipelined (collective exchange)...
+  test_fft2d<complex<float> >(256, 128, row_map, col_map);
+  // ...and to use pairwise exchange.
+  test_fft2d<complex<double> >(512, 256, row_map, col_map);
+  // Other distributions.
+  test_fft2d<complex<float> >(24, 16, grid_map(), grid_map());
+  test_fft2d<complex<double> >(16, 20, col_map, row_map);
+
+  test_fft2d_by_value<complex<float> >(16, 32, row_map);
+  test_fft2d_by_value<complex<double> >(18, 21, grid_map());
+
+  test_fftm<complex<float> >(12, 16);
+  test_fftm<complex<double> >(9, 14);
+
+  return 0;
+}
@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Reductions of distributed views, for all value types and
+// (index-)reductions, compared against the non-distributed results.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/math.hpp>
+#include <vsip/map.hpp>
+#include <vsip/parallel.hpp>
+#include <test.hpp>
+#include <storage.hpp>
+
+using namespace ovxx;
+
+template <typename T>
+T
+value(index_type i)
+{
+  return T((i * 7) % 13) - T(4);
+}
+
+template <>
+bool
+value<bool>(index_type i)
+{
+  return (i * 7) % 13 != 3;
+}
+
+template <>
+complex<float>
+value<complex<float> >(index_type i)
+{
+  return complex<float>(value<float>(i), value<float>(i + 5) / 3.f);
+}
+
+template <>
+complex<double>
+value<complex<double> >(index_type i)
+{
+  return complex<double>(value<double>(i), value<double>(i + 5) / 3.);
+}
+
+template <typename V>
+void
+setup(V view)
+{
+  for (index_type i = 0; i != view.size(); ++i)
+    put_nth(view, i, value<typename V::value_type>(i));
+}
+
+template <typename T, typename M, dimension_type D>
+void
+test_sum(Domain<D> const &dom, M const &map)
+{
+  typedef typename Default_order<D>::type order_type;
+  typedef typename view_of<Dense<D, T, order_type> >::type ref_type;
+  typedef typename view_of<Dense<D, T, order_type, M> >::type view_type;
+
+  ref_type ref = test::create_view<ref_type>(dom);
+  view_type view = test::create_view<view_type>(dom, map);
+  setup(ref);
+  setup(view);
+
+  test_assert(equal(sumval(view), sumval(ref)));
+  test_assert(equal(sumsqval(view), sumsqval(ref)));
+  test_assert(equal(meanval(view), meanval(ref)));
+  test_assert(equal(meansqval(view), meansqval(ref)));
+  test_assert(equal(sumval(view + view), sumval(ref + ref)));
+}
+
+template <typename T, typename M, dimension_type D>
+void
+test_bool(Domain<D> const &dom, M const &map)
+{
+  typedef typename Default_order<D>::type order_type;
+  typedef typename view_of<Dense<D, T, order_type> >::type ref_type;
+  typedef typename view_of<Dense<D, T, order_type, M> >::type view_type;
+
+  ref_type ref = test::create_view<ref_type>(dom);
+  view_type view = test::create_view<view_type>(dom, map);
+  setup(ref);
+  setup(view);
+
+  test_assert(alltrue(view) == alltrue(ref));
+  test_assert(anytrue(view) == anytrue(ref));
+  test_assert(sumval(view) == sumval(ref));
+  ref = T(1);
+  view = T(1);
+  test_assert(alltrue(view) == alltrue(ref));
+  ref = T();
+  view = T();
+  test_assert(anytrue(view) == anytrue(ref));
+}
+
+template <typename T, typename M, dimension_type D>
+void
+test_idx(Domain<D> const &dom, M const &map)
+{
+  typedef typename Default_order<D>::type order_type;
+  typedef typename view_of<Dense<D, T, order_type> >::type ref_type;
+  typedef typename view_of<Dense<D, T, order_type, M> >::type view_type;
+
+  ref_type ref = test::create_view<ref_type>(dom);
+  view_type view = test::create_view<view_type>(dom, map);
+  // The values repeat, so ties need to be resolved consistently.
+  setup(ref);
+  setup(view);
+
+  Index<D> ref_idx, idx;
+  test_assert(equal(maxval(view, idx), maxval(ref, ref_idx)));
+  test_assert(idx == ref_idx);
+  test_assert(equal(minval(view, idx), minval(ref, ref_idx)));
+  test_assert(idx == ref_idx);
+  test_assert(equal(maxmgval(view, idx), maxmgval(ref, ref_idx)));
+  test_assert(idx == ref_idx);
+  test_assert(equal(minmgval(view, idx), minmgval(ref, ref_idx)));
+  test_assert(idx == ref_idx);
+  test_assert(equal(maxval(view - T(1), idx), maxval(ref - T(1), ref_idx)));
+  test_assert(idx == ref_idx);
+}
+
+template <typename T, typename M, dimension_type D>
+void
+test_cidx(Domain<D> const &dom, M const &map)
+{
+  typedef typename Default_order<D>::type order_type;
+  typedef typename view_of<Dense<D, T, order_type> >::type ref_type;
+  typedef typename view_of<Dense<D, T, order_type, M> >::type view_type;
+
+  ref_type ref = test::create_view<ref_type>(dom);
+  view_type view = test::create_view<view_type>(dom, map);
+  setup(ref);
+  setup(view);
+
+  Index<D> ref_idx, idx;
+  test_assert(equal(maxmgsqval(view, idx), maxmgsqval(ref, ref_idx)));
+  test_assert(idx == ref_idx);
+  test_assert(equal(minmgsqval(view, idx), minmgsqval(ref, ref_idx)));
+  test_assert(idx == ref_idx);
+  test_assert(equal(maxmgval(view, idx), maxmgval(ref, ref_idx)));
+  test_assert(idx == ref_idx);
+}
+
+// With reproducible reductions, the result must not depend on the
+// MPI implementation's choice of algorithm, and be identical from
+// call to call.
+template <typename T>
+void
+test_reproducible(length_type size)
+{
+  typedef Dense<1, T, row1_type, Map<> > block_type;
+  Vector<T, block_type> view(size, Map<>(num_processors()));
+  for (index_type i = 0; i != size; ++i)
+    view.put(i, T(1) / T(i + 1));
+
+  parallel::set_reproducible_reductions(true);
+  T sum = sumval(view);
+  for (index_type i = 0; i != 4; ++i)
+    test_assert(sumval(view) == sum);
+  parallel::set_reproducible_reductions(false);
+  test_assert(equal(sumval(view), sum));
+}
+
+template <typename M, dimension_type D>
+void
+test_all(Domain<D> const &dom, M const &map)
+{
+  test_sum<int>(dom, map);
+  test_sum<float>(dom, map);
+  test_sum<double>(dom, map);
+  test_sum<complex<float> >(dom, map);
+  test_sum<complex<double> >(dom, map);
+  test_bool<bool>(dom, map);
+  test_bool<int>(dom, map);
+  test_idx<int>(dom, map);
+  test_idx<float>(dom, map);
+  test_idx<double>(dom, map);
+  test_cidx<complex<float> >(dom, map);
+  test_cidx<complex<double> >(dom, map);
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  length_type np = num_processors();
+  length_type n0 = np % 2 ? 1 : 2;
+
+  test_all(Domain<1>(21), Map<>(np));
+  test_all(Domain<1>(16), Map<Block_dist>(Block_dist(np)));
+  test_all(Domain<1>(23), Map<Cyclic_dist>(Cyclic_dist(np, 2)));
+  test_all(Domain<1>(11), Replicated_map<1>());
+  test_all(Domain<2>(7, 9), Map<>(np, 1));
+  test_all(Domain<2>(7, 9), Map<>(1, np));
+  test_all(Domain<2>(8, 6), Map<>(n0, np / n0));
+  test_all(Domain<3>(3, 5, 4), Map<>(1, np, 1));
+
+  test_reproducible<float>(1000);
+  test_reproducible<double>(1000);
+  test_reproducible<complex<float> >(500);
+}
@@ -0,0 +1,205 @@
+//
+// Copyright (c) 2013 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Parallel assignments between processors on the same node copy
+// directly out of shared memory. Make sure this works for various
+// distributions, with repeated assignments, and falls back to
+// messages for subblocks that aren't in shared memory.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/map.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/tensor.hpp>
+#include <vsip/parallel.hpp>
+#include <vsip/dda.hpp>
+#include <ovxx/mpi/shared_memory.hpp>
+#include <test.hpp>
+#include <cstdlib>
+
+using namespace ovxx;
+
+template <typename T>
+T
+value(index_type iter, index_type i)
+{
+  return T(iter * 1000 + i);
+}
+
+inline index_type
+linear_index(Index<1> const &i, Length<1> const &) { return i[0];}
+
+inline index_type
+linear_index(Index<2> const &i, Length<2> const &l) { return i[0] * l[1] + i[1];}
+
+inline index_type
+linear_index(Index<3> const &i, Length<3> const &l)
+{ return (i[0] * l[1] + i[1]) * l[2] + i[2];}
+
+// Fill (or check) the local part of `view` with values derived from
+// the global linear index of each element.
+template <typename V>
+void
+fill(V view, index_type iter)
+{
+  typedef typename V::value_type T;
+  dimension_type const D = V::dim;
+  Length<D> len = extent(view);
+  typename V::local_type l = view.local();
+  for (index_type p = 0; p < num_patches(view); ++p)
+  {
+    Domain<D> l_dom = local_domain(view, p);
+    Domain<D> g_dom = global_domain(view, p);
+    Length<D> ext = extent(l_dom);
+    Index<D> idx;
+    for (index_type i = 0; i != l_dom.size(); ++i, next(ext, idx))
+      put(l.block(), domain_nth(l_dom, idx),
+	  value<T>(iter, linear_index(domain_nth(g_dom, idx), len)));
+  }
+}
+
+template <typename V>
+void
+check(V view, index_type iter)
+{
+  typedef typename V::value_type T;
+  dimension_type const D = V::dim;
+  Length<D> len = extent(view);
+  typename V::local_type l = view.local();
+  for (index_type p = 0; p < num_patches(view); ++p)
+  {
+    Domain<D> l_dom = local_domain(view, p);
+    Domain<D> g_dom = global_domain(view, p);
+    Length<D> ext = extent(l_dom);
+    Index<D> idx;
+    for (index_type i = 0; i != l_dom.size(); ++i, next(ext, idx))
+      test_assert(equal(get(l.block(), domain_nth(l_dom, idx)),
+			value<T>(iter, linear_index(domain_nth(g_dom, idx), len))));
+  }
+}
+
+// Make sure the subblocks are actually allocated in shared memory.
+template <typename V>
+void
+check_shared(V view)
+{
+#if MPI_VERSION >= 3
+  typename V::local_type l = view.local();
+  if (l.size())
+  {
+    vsip::dda::Data<typename V::local_type::block_type, vsip::dda::in> data(l.block());
+    test_assert(mpi::shared_offset(data.ptr()) != -1);
+  }
+#endif
+}
+
+template <typename T, typename S, typename D>
+void
+assign(S src, D dst, length_type loop)
+{
+  for (index_type i = 0; i != loop; ++i)
+  {
+    fill(src, i);
+    dst = src;
+    check(dst, i);
+  }
+}
+
+template <typename T>
+void
+corner_turn(length_type rows, length_type cols, length_type loop)
+{
+  typedef Map<Block_dist, Block_dist>      map_type;
+  typedef Dense<2, T, row2_type, map_type> block_type;
+  typedef Matrix<T, block_type>            view_type;
+
+  processor_type np = num_processors();
+  view_type A(rows, cols, map_type(np, 1));
+  view_type B(rows, cols, map_type(1, np));
+  check_shared(A);
+  check_shared(B);
+  assign<T>(A, B, loop);
+  assign<T>(B, A, loop);
+}
+
+template <typename T>
+void
+cyclic_assign(length_type size, length_type loop)
+{
+  typedef Map<Block_dist>  block_map_type;
+  typedef Map<Cyclic_dist> cyclic_map_type;
+
+  processor_type np = num_processors();
+  Vector<T, Dense<1, T, row1_type, block_map_type> > A(size, block_map_type(np));
+  Vector<T, Dense<1, T, row1_type, cyclic_map_type> >
+    B(size, cyclic_map_type(Cyclic_dist(np, 3)));
+  assign<T>(A, B, loop);
+  assign<T>(B, A, loop);
+}
+
+template <typename T>
+void
+tensor(length_type loop)
+{
+  typedef Map<Block_dist, Block_dist, Block_dist> map_type;
+  typedef Dense<3, T, tuple<0, 1, 2>, map_type>   src_block_type;
+  typedef Dense<3, T, tuple<2, 1, 0>, map_type>   dst_block_type;
+
+  processor_type np = num_processors();
+  Tensor<T, src_block_type> A(4, 5, 7, map_type(np, 1, 1));
+  Tensor<T, dst_block_type> B(4, 5, 7, map_type(1, 1, np));
+  assign<T>(A, B, loop);
+}
+
+// The source uses user storage, so it isn't in shared memory.
+template <typename T>
+void
+user_data(length_type rows, length_type cols, length_type loop)
+{
+  typedef Map<Block_dist, Block_dist>      map_type;
+  typedef Dense<2, T, row2_type, map_type> block_type;
+  typedef Matrix<T, block_type>            view_type;
+
+  processor_type np = num_processors();
+  map_type row_map(np, 1);
+  block_type block(Domain<2>(rows, cols), static_cast<T*>(0), row_map);
+  view_type A(block);
+  view_type B(rows, cols, map_type(1, np));
+
+  Domain<2> dom = subblock_domain(A);
+  T *data = new T[dom.size()];
+  block.rebind(data);
+  block.admit(false);
+  assign<T>(A, B, loop);
+  block.release(false);
+  delete[] data;
+}
+
+int
+main(int argc, char** argv)
+{
+  // Enable shared memory, unless the size was given explicitly.
+  setenv("OVXX_SHARED_MEMORY", "16", 0);
+  Vector<float> *survivor = 0;
+  {
+    vsipl library(argc, argv);
+
+    corner_turn<float>(32, 64, 3);
+    corner_turn<complex<float> >(15, 7, 3);
+    corner_turn<int>(5, 64, 2);
+    cyclic_assign<double>(101, 3);
+    tensor<float>(2);
+    user_data<float>(16, 24, 3);
+
+    survivor = new Vector<float>(64, 1.f);
+    check_shared(*survivor);
+  }
+  // A view outliving the library may still be released.
+  delete survivor;
+  return 0;
+}
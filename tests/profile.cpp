@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Profiling of dispatched operations, enabled through the environment.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/math.hpp>
+#include <ovxx/profile.hpp>
+#include <test.hpp>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstdio>
+
+using namespace ovxx;
+
+struct outer_op;
+struct inner_op;
+struct backend;
+
+std::string
+read(char const *filename)
+{
+  std::ifstream ifs(filename);
+  std::ostringstream oss;
+  oss << ifs.rdbuf();
+  return oss.str();
+}
+
+int
+main(int argc, char **argv)
+{
+  char const *trace = "profile-trace.json";
+  char const *summary = "profile-summary.txt";
+  setenv("OVXX_PROFILE", trace, 1);
+  setenv("OVXX_PROFILE_SUMMARY", summary, 1);
+  setenv("OVXX_PROFILE_EVENTS", "4", 1);
+  {
+    vsipl library(argc, argv);
+    test_assert(profile::enabled());
+
+    length_type const size = 1024;
+    Vector<float> a(size, 1.f);
+    Vector<float> b(size, 2.f);
+    Vector<float> c(size);
+    for (int i = 0; i != 8; ++i)
+      c = a * b;
+    test_assert(c.get(0) == 2.f);
+    // A nested operation.
+    {
+      profile::scope<outer_op, backend> o(a.block());
+      profile::scope<inner_op, backend> i(b.block());
+      c = a + b;
+    }
+  }
+  test_assert(!profile::enabled());
+
+  std::string t = read(trace);
+  test_assert(t.find("\"traceEvents\"") != std::string::npos);
+  test_assert(t.find("\"ph\": \"X\"") != std::string::npos);
+  test_assert(t.find("\"size\": 1024") != std::string::npos);
+  // One operation per element, and three blocks of floats accessed.
+  test_assert(t.find("\"ops\": 1024.000") != std::string::npos);
+  test_assert(t.find("\"bytes\": 12288.000") != std::string::npos);
+  // Only the most recent events are kept.
+  std::string::size_type count = 0;
+  for (std::string::size_type i = t.find("\"name\"");
+       i != std::string::npos;
+       i = t.find("\"name\"", i + 1))
+    ++count;
+  test_assert(count == 4);
+
+  std::string s = read(summary);
+  test_assert(s.find("OpenVSIP profile") != std::string::npos);
+  test_assert(s.find("event(s) not included") != std::string::npos);
+  test_assert(s.find("assign") != std::string::npos);
+  test_assert(s.find("backend / outer_op") != std::string::npos);
+  // Self times don't count nested operations twice.
+  std::istringstream lines(s);
+  std::string line;
+  double percent = 0.;
+  while (std::getline(lines, line))
+    if (line.find(" / ") != std::string::npos)
+    {
+      double p;
+      if (std::istringstream(line) >> p) percent += p;
+    }
+  test_assert(percent > 99. && percent < 101.);
+
+  std::remove(trace);
+  std::remove(summary);
+}
@@ -0,0 +1,50 @@
+#
+# Copyright (c) 2014 Stefan Seefeld
+# All rights reserved.
+#
+# This file is part of OpenVSIP. It is made available under the
+# license contained in the accompanying LICENSE.BSD file.
+
+import numpy as np
+from numpy import array
+from vsip import vector, matrix
+
+# Wrap a buffer without copying: changes are visible on both sides.
+a = np.arange(8, dtype=float)
+v = vector(buffer=a)
+v[2] = 42.
+assert a[2] == 42.
+a[3] = -1.
+assert v[3] == -1.
+
+# Strided and reversed buffers keep their layout.
+v = vector(buffer=a[::2])
+assert v.length() == 4
+v[1] = 7.
+assert a[2] == 7.
+v = vector(buffer=a[::-1])
+assert v[0] == a[7]
+
+# A transposed buffer becomes a column-major matrix.
+c = (np.arange(12) + 1j*np.arange(12)).reshape(3, 4)
+m = matrix(buffer=c.T)
+assert m.rows() == 4 and m.cols() == 3
+m[1, 2] = 0
+assert c[2, 1] == 0
+
+# Blocks export their storage through the buffer protocol.
+v = vector(float, 4, 1.)
+b = memoryview(v.block)
+assert b.shape == (4,)
+
+if hasattr(np, 'from_dlpack'):
+    # Export via DLPack...
+    v = vector(array=np.arange(4, dtype=np.float32))
+    n = np.from_dlpack(v)
+    v[0] = 10.
+    assert n[0] == 10.
+    # ...and import.
+    a = np.arange(6, dtype=float).reshape(2, 3)
+    m = matrix(dlpack=a)
+    a[1, 1] = 5.
+    assert m[1, 1] == 5.
@@ -0,0 +1,46 @@
+#
+# Copyright (c) 2014 Stefan Seefeld
+# All rights reserved.
+#
+# This file is part of OpenVSIP. It is made available under the
+# license contained in the accompanying LICENSE.BSD file.
+
+import numpy as np
+from numpy import array
+from vsip import vector, matrix
+from vsip.expr import lazy, evaluate
+from vsip.math import elementwise as elm
+
+a1 = np.arange(1, 1001, dtype=float)
+a2 = np.arange(1001, 1, -1, dtype=float)
+a3 = np.ones(1000, dtype=float)
+v1 = vector(array=a1)
+v2 = vector(array=a2)
+v3 = vector(array=a3)
+
+# Force an expression
+r = evaluate(lazy(v1)*v2 + v3)
+assert np.allclose(array(r), a1*a2 + a3)
+
+# Assign an expression, with scalars and functions
+r = vector(float, 1000)
+r[:] = 2.*elm.sqrt(lazy(v1)*v1 + v2*v2) - v3/4
+assert np.allclose(array(r), 2.*np.sqrt(a1*a1 + a2*a2) - a3/4)
+
+# Assign to a subvector
+r[::2] = lazy(v1[::2]) - v2[1::2]
+assert np.allclose(array(r)[::2], a1[::2] - a2[1::2])
+
+# The target may be an operand
+v = vector(array=a1)
+v += lazy(v2)*v3
+assert np.allclose(array(v), a1 + a2*a3)
+
+# Complex matrices
+c1 = (np.arange(12) + 1j*np.arange(12)).reshape(3, 4)
+c2 = (np.arange(12) - 1j).reshape(3, 4)
+m1 = matrix(array=c1)
+m2 = matrix(array=c2)
+m = matrix(complex, 3, 4)
+m[:,:] = elm.exp(-lazy(m1)) * m2 + 1j
+assert np.allclose(array(m), np.exp(-c1)*c2 + 1j)
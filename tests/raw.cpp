@@ -0,0 +1,168 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Byte swapping, and reading raw files of either byte order.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <ovxx/byteswap.hpp>
+#include <ovxx/io/raw.hpp>
+#include <test.hpp>
+#include <cstdio>
+#include <vector>
+
+using namespace ovxx;
+
+void
+test_byteswap()
+{
+  uint16_type s = 0x0102;
+  byteswap<true>(s);
+  test_assert(s == 0x0201);
+  uint32_type i = 0x01020304;
+  byteswap<true>(i);
+  test_assert(i == 0x04030201);
+  uint64_type l = 0x0102030405060708ULL;
+  byteswap<false>(l);
+  test_assert(l == 0x0102030405060708ULL);
+  byteswap<true>(l);
+  test_assert(l == 0x0807060504030201ULL);
+
+  // Complex values swap their parts separately.
+  complex<float> c(1.5f, -2.25f);
+  complex<float> swapped = c;
+  byteswap<true>(swapped);
+  uint32_type re, im;
+  std::memcpy(&re, &c, 4);
+  std::memcpy(&im, reinterpret_cast<char *>(&c) + 4, 4);
+  byteswap<true>(re);
+  byteswap<true>(im);
+  test_assert(std::memcmp(&re, &swapped, 4) == 0);
+  test_assert(std::memcmp(&im, reinterpret_cast<char *>(&swapped) + 4, 4) == 0);
+  // Swapping arrays twice restores the original.
+  std::vector<double> d(5);
+  for (index_type k = 0; k != d.size(); ++k) d[k] = k * 0.75 - 1.;
+  byteswap_n(&d[0], d.size());
+  test_assert(d[3] != 1.25);
+  byteswap_n(&d[0], d.size());
+  for (index_type k = 0; k != d.size(); ++k) test_assert(d[k] == k * 0.75 - 1.);
+}
+
+// Append `v` to `file` as a record written on a machine of the other
+// byte order.
+template <template <typename, typename> class V, typename T, typename B>
+void
+append_foreign(std::FILE *file, V<T, B> v)
+{
+  typedef Layout<V<T, B>::dim, tuple<0,1,2>, dense, array> layout_type;
+  vsip::dda::Data<B, vsip::dda::in, layout_type> data(v.block());
+  serialization::Descriptor info;
+  std::memset(&info, 0, sizeof(info));
+  serialization::describe_data(data, info);
+  raw::detail::byteswap(info);
+  std::fwrite(&info, sizeof(info), 1, file);
+  long offset = std::ftell(file);
+  std::vector<char> padding(raw::detail::align(offset) - offset, 0);
+  if (padding.size()) std::fwrite(&padding[0], 1, padding.size(), file);
+  std::vector<T> values(data.ptr(), data.ptr() + v.size());
+  byteswap_n(&values[0], values.size());
+  std::fwrite(&values[0], sizeof(T), values.size(), file);
+}
+
+void
+test_foreign(char const *name)
+{
+  typedef complex<double> C;
+  Vector<float> v(10);
+  for (index_type i = 0; i != v.size(); ++i) v.put(i, i * 1.5f - 3.f);
+  Matrix<C> m(3, 4);
+  for (index_type r = 0; r != 3; ++r)
+    for (index_type c = 0; c != 4; ++c)
+      m.put(r, c, C(r + 0.5, -double(c)));
+  {
+    std::FILE *file = std::fopen(name, "wb");
+    test_assert(file);
+    raw::detail::header h = raw::detail::make_header();
+    byteswap<true>(h.byte_order);
+    byteswap<true>(h.version);
+    std::fwrite(&h, sizeof(h), 1, file);
+    append_foreign(file, v);
+    append_foreign(file, m);
+    std::fclose(file);
+  }
+
+  raw::reader file(name);
+  test_assert(file.swapped());
+  test_assert(file.size() == 2);
+  // Descriptors are presented in native byte order.
+  test_assert(file.descriptor(0).size[0] == 10);
+  test_assert(file.descriptor(1).size[0] == 3 && file.descriptor(1).size[1] == 4);
+
+  const_Vector<float> fv = file.vector<float>(0);
+  test_assert(equal(fv, v));
+  const_Matrix<C> fm = file.matrix<C>(1);
+  test_assert(equal(fm, m));
+  // Data are swapped once, when first requested; asking again doesn't
+  // swap them back, neither for the new views nor the earlier ones.
+  test_assert(equal(file.vector<float>(0), v));
+  test_assert(equal(file.matrix<C>(1), m));
+  test_assert(equal(fv, v));
+  test_assert(equal(fm, m));
+
+  // Requests that don't match a record's type or dimension are refused.
+  bool refused = false;
+  try { file.vector<double>(0);}
+  catch (raw::exception const &) { refused = true;}
+  test_assert(refused);
+  refused = false;
+  try { file.matrix<float>(0);}
+  catch (raw::exception const &) { refused = true;}
+  test_assert(refused);
+  refused = false;
+  try { file.vector<C>(1);}
+  catch (raw::exception const &) { refused = true;}
+  test_assert(refused);
+  // The mismatched request didn't swap the data.
+  test_assert(equal(file.vector<float>(0), v));
+}
+
+void
+test_native(char const *name)
+{
+  Matrix<int> m(5, 2);
+  for (index_type r = 0; r != 5; ++r)
+    for (index_type c = 0; c != 2; ++c)
+      m.put(r, c, int(r * 100 + c) - 250);
+  {
+    raw::writer file(name);
+    file.append(m);
+    file.append(m.col(1));
+  }
+  raw::reader file(name);
+  test_assert(!file.swapped());
+  test_assert(file.size() == 2);
+  test_assert(equal(file.matrix<int>(0), m));
+  test_assert(equal(file.vector<int>(1), m.col(1)));
+  bool refused = false;
+  try { file.vector<unsigned int>(1);}
+  catch (raw::exception const &) { refused = true;}
+  test_assert(refused);
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  test_byteswap();
+  char const *name = "raw-test.raw";
+  test_foreign(name);
+  test_native(name);
+  std::remove(name);
+}
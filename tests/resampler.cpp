@@ -0,0 +1,147 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Polyphase rational resampling.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/dense.hpp>
+#include <vsip/signal.hpp>
+#include <ovxx/signal/resampler.hpp>
+#include <test.hpp>
+
+using namespace ovxx;
+using ovxx::signal::Resampler;
+
+// With a kernel of L ones, interpolation by L repeats each sample L
+// times. Feed single samples, so each output's subfilter is chosen
+// from the phase carried over between calls.
+template <typename T>
+void
+test_hold(length_type l)
+{
+  length_type const size = 23;
+  Resampler<T> resampler(Vector<T>(l, T(1)), l, 1);
+  Vector<T> out(l);
+  for (index_type i = 0; i != size; ++i)
+  {
+    T x = T(3 * i + 1);
+    test_assert(resampler.output_size(1) == l);
+    test_assert(resampler(Vector<T>(1, x), out) == l);
+    for (index_type j = 0; j != l; ++j)
+      test_assert(equal(out.get(j), x));
+  }
+}
+
+// Decimation by M with a unit kernel picks every M-th sample. With
+// chunks shorter than M, most calls produce nothing, and the position
+// of the next output spans several calls.
+template <typename T>
+void
+test_pick(length_type m, length_type chunk)
+{
+  length_type const size = 7 * m + 3;
+  Vector<T> x(size);
+  for (index_type i = 0; i != size; ++i) x.put(i, T(i) * T(i % 5));
+
+  Resampler<T> resampler(Vector<T>(1, T(1)), 1, m);
+  Vector<T> out(chunk);
+  index_type next = 0;
+  for (index_type pos = 0; pos < size; pos += chunk)
+  {
+    length_type n = std::min(chunk, size - pos);
+    length_type o = resampler(x(Domain<1>(pos, 1, n)), out);
+    for (index_type j = 0; j != o; ++j, next += m)
+    {
+      test_assert(next >= pos && next < pos + n);
+      test_assert(equal(out.get(j), x.get(next)));
+    }
+  }
+  test_assert(next == m * ((size + m - 1) / m));
+}
+
+// A general ratio, compared to upsampling, filtering, and downsampling
+// the whole signal, resampled in two uneven halves.
+template <typename T>
+void
+test_ratio(length_type k, length_type l, length_type m)
+{
+  length_type const size = 90;
+  Vector<T> h(k), x(size);
+  for (index_type i = 0; i != k; ++i) h.put(i, T(k - i) / T(k));
+  for (index_type i = 0; i != size; ++i) x.put(i, T((i * 11) % 17) - T(8));
+
+  Vector<T> upsampled(size * l, T(0));
+  upsampled(Domain<1>(0, l, size)) = x;
+  Fir<T> fir(h, size * l);
+  Vector<T> filtered(size * l);
+  fir(upsampled, filtered);
+  length_type const outputs = (size * l + m - 1) / m;
+
+  Resampler<T> resampler(h, l, m);
+  test_assert(resampler.output_size(size) == outputs);
+  Vector<T> out(outputs);
+  length_type const split = size / 3 + 1;
+  length_type o = resampler(x(Domain<1>(split)), out);
+  length_type rest = resampler(x(Domain<1>(split, 1, size - split)),
+			       out(Domain<1>(o, 1, outputs - o)));
+  test_assert(o + rest == outputs);
+  for (index_type n = 0; n != outputs; ++n)
+    test_assert(equal(out.get(n), filtered.get(n * m)));
+}
+
+// The channels of a column-major matrix are strided. Each has its own
+// state, and resamples like a single-channel resampler would.
+template <typename T>
+void
+test_channels(length_type channels, length_type l, length_type m)
+{
+  typedef Dense<2, T, col2_type> block_type;
+  length_type const size = 41, k = 3 * l + 1;
+  Vector<T> h(k);
+  for (index_type i = 0; i != k; ++i) h.put(i, T(i % 3) + T(1));
+  Matrix<T, block_type> x(channels, size);
+  for (index_type c = 0; c != channels; ++c)
+    for (index_type i = 0; i != size; ++i)
+      x.put(c, i, T(c + 1) * (T(i % 7) - T(c)));
+
+  Resampler<T> resampler(h, l, m, channels);
+  length_type const outputs = resampler.output_size(size);
+  Matrix<T, block_type> out(channels, outputs);
+  length_type const split = 5;
+  length_type o = resampler(x(Domain<2>(channels, split)), out);
+  resampler(x(Domain<2>(Domain<1>(channels), Domain<1>(split, 1, size - split))),
+	    out(Domain<2>(Domain<1>(channels), Domain<1>(o, 1, outputs - o))));
+
+  for (index_type c = 0; c != channels; ++c)
+  {
+    Resampler<T> single(h, l, m);
+    Vector<T> expected(outputs);
+    test_assert(single(x.row(c), expected) == outputs);
+    test_assert(equal(out.row(c), expected));
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  test_hold<float>(1);
+  test_hold<float>(4);
+  test_hold<complex<double> >(3);
+  test_pick<float>(5, 2);
+  test_pick<double>(3, 1);
+  test_pick<complex<float> >(4, 7);
+  test_ratio<float>(24, 5, 3);
+  test_ratio<double>(33, 7, 4);
+  test_ratio<complex<float> >(16, 2, 3);
+  test_channels<float>(3, 5, 3);
+  test_channels<complex<double> >(2, 2, 5);
+}
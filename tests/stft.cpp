@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Short-time Fourier transform and its inverse.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/signal.hpp>
+#include <ovxx/signal/stft.hpp>
+#include <test.hpp>
+#include <cmath>
+
+using namespace ovxx;
+using ovxx::signal::Stft;
+using ovxx::signal::Istft;
+
+// An impulse at the start of the signal appears in the first
+// window.size() / hop frames, which only partially overlap the signal,
+// at offset window.size() - (m + 1) hop of frame m. It is weighted by
+// the window there, and the transform turns the offset into a linear
+// phase. All later frames are zero.
+template <typename T>
+void
+test_impulse(length_type length, length_type hop, length_type nfft, length_type chunk)
+{
+  typedef typename scalar_of<T>::type S;
+  typedef complex<S> C;
+  Vector<S> window(length);
+  for (index_type i = 0; i != length; ++i) window.put(i, S(i + 1));
+
+  Stft<T> stft(window, hop, nfft, chunk);
+  Matrix<C> spectra(stft.frames(), stft.bins());
+  Vector<T> x(chunk, T(0));
+  x.put(0, T(1));
+  length_type const chunks = (length + chunk - 1) / chunk + 1;
+  for (index_type c = 0; c != chunks; ++c)
+  {
+    stft(x, spectra);
+    x.put(0, T(0));
+    for (index_type f = 0; f != stft.frames(); ++f)
+    {
+      index_type m = c * stft.frames() + f;
+      for (index_type k = 0; k != stft.bins(); ++k)
+      {
+	C expected(0);
+	if ((m + 1) * hop <= length)
+	{
+	  index_type offset = length - (m + 1) * hop;
+	  expected = std::polar(S(window.get(offset)),
+				S(-2 * M_PI * double(k * offset % nfft) / nfft));
+	}
+	test_assert(equal(spectra.get(m - c * stft.frames(), k), expected));
+      }
+    }
+  }
+}
+
+// A constant signal with a rectangular window: bin 0 counts the frame
+// samples within the signal, and with twice as many bins as samples,
+// the other even bins vanish once the frames are full.
+template <typename T>
+void
+test_padding(length_type length, length_type hop)
+{
+  typedef typename scalar_of<T>::type S;
+  typedef complex<S> C;
+  length_type const nfft = 2 * length, chunk = 2 * hop;
+  Stft<T> stft(Vector<S>(length, S(1)), hop, nfft, chunk);
+  Matrix<C> spectra(stft.frames(), stft.bins());
+  Vector<T> ones(chunk, T(1));
+  for (index_type m = 0; m < length / hop + 3; m += stft.frames())
+  {
+    stft(ones, spectra);
+    for (index_type f = 0; f != stft.frames(); ++f)
+    {
+      length_type inside = std::min((m + f + 1) * hop, length);
+      test_assert(equal(spectra.get(f, 0), C(S(inside))));
+      if (inside == length)
+	for (index_type k = 2; k < stft.bins(); k += 2)
+	  test_assert(equal(spectra.get(f, k), C(0)));
+    }
+  }
+}
+
+// Overlap-add of the transformed frames reconstructs the signal,
+// delayed by window.size() - hop samples, also without overlap, with
+// an odd transform size, and across resets of both transforms.
+template <typename T>
+void
+test_roundtrip(length_type length, length_type hop, length_type nfft, length_type chunk)
+{
+  typedef typename scalar_of<T>::type S;
+  typedef complex<S> C;
+  length_type const chunks = 5, size = chunks * chunk, delay = length - hop;
+  Vector<S> window(length);
+  for (index_type i = 0; i != length; ++i)
+    window.put(i, S(0.5) - S(0.4) * S(std::cos(2 * M_PI * (i + 0.5) / length)));
+  Vector<T> x(size);
+  unsigned state = 12345;
+  for (index_type i = 0; i != size; ++i)
+  {
+    state = state * 1103515245 + 12345;
+    x.put(i, T(S(int(state >> 16) % 201 - 100) / S(10)));
+  }
+
+  Stft<T> stft(window, hop, nfft, chunk);
+  Istft<T> istft(window, hop, nfft, chunk);
+  Matrix<C> spectra(stft.frames(), stft.bins());
+  Vector<T> y(size);
+  for (int pass = 0; pass != 2; ++pass)
+  {
+    for (index_type c = 0; c != chunks; ++c)
+    {
+      stft(x(Domain<1>(c * chunk, 1, chunk)), spectra);
+      istft(spectra, y(Domain<1>(c * chunk, 1, chunk)));
+    }
+    for (index_type i = 0; i != size; ++i)
+      test_assert(equal(y.get(i), i < delay ? T(0) : x.get(i - delay)));
+    stft.reset();
+    istft.reset();
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  test_impulse<double>(16, 4, 16, 8);
+  test_impulse<complex<float> >(12, 3, 16, 3);
+  test_impulse<float>(10, 10, 13, 20);
+  test_padding<double>(12, 4);
+  test_padding<complex<double> >(9, 3);
+  test_roundtrip<float>(16, 8, 16, 32);
+  test_roundtrip<double>(8, 8, 8, 16);
+  test_roundtrip<complex<double> >(12, 3, 15, 6);
+  test_roundtrip<double>(10, 5, 11, 5);
+}
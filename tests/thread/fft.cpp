@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Concurrent use of a single Fft / Fftm object.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/signal.hpp>
+#include <ovxx/thread_pool.hpp>
+#include <test.hpp>
+
+using namespace ovxx;
+
+typedef complex<float> C;
+
+template <typename T1, typename T2>
+bool
+matrix_equal(Matrix<T1> a, Matrix<T2> b)
+{
+  for (index_type r = 0; r != a.size(0); ++r)
+    for (index_type c = 0; c != a.size(1); ++c)
+      if (!equal(a.get(r, c), b.get(r, c))) return false;
+  return true;
+}
+
+// Transform rows `dom` of `in` into `out`, using a shared Fft.
+template <typename F, typename T1, typename T2>
+struct by_row
+{
+  by_row(F &f, Matrix<T1> i, Matrix<T2> o) : fft(f), in(i), out(o) {}
+  void operator()(Domain<1> const &dom) const
+  {
+    Matrix<T1> i = in;
+    Matrix<T2> o = out;
+    for (index_type r = dom.first(); r != dom.first() + dom.size(); ++r)
+      fft(i.row(r), o.row(r));
+  }
+  F &fft;
+  Matrix<T1> in;
+  Matrix<T2> out;
+};
+
+// Transform columns `dom` of `in` into rows of `out`.
+// Strided input requires the workspace to copy it.
+template <typename F>
+struct by_column
+{
+  by_column(F &f, Matrix<C> i, Matrix<C> o) : fft(f), in(i), out(o) {}
+  void operator()(Domain<1> const &dom) const
+  {
+    Matrix<C> i = in;
+    Matrix<C> o = out;
+    for (index_type r = dom.first(); r != dom.first() + dom.size(); ++r)
+      fft(i.col(r), o.row(r));
+  }
+  F &fft;
+  Matrix<C> in;
+  Matrix<C> out;
+};
+
+// Transform blocks of `rows` rows, using a shared Fftm.
+template <typename F>
+struct by_block
+{
+  by_block(F &f, Matrix<C> i, Matrix<C> o, length_type r)
+    : fftm(f), in(i), out(o), rows(r) {}
+  void operator()(Domain<1> const &dom) const
+  {
+    Matrix<C> i = in;
+    Matrix<C> o = out;
+    for (index_type b = dom.first(); b != dom.first() + dom.size(); ++b)
+    {
+      Domain<2> block(Domain<1>(b * rows, 1, rows), Domain<1>(in.size(1)));
+      fftm(i(block), o(block));
+    }
+  }
+  F &fftm;
+  Matrix<C> in;
+  Matrix<C> out;
+  length_type rows;
+};
+
+void
+test_fft(length_type rows, length_type cols)
+{
+  typedef Fft<const_Vector, C, C, fft_fwd, by_reference> fft_type;
+  fft_type fft(Domain<1>(cols), 1.f);
+
+  Matrix<C> in(rows, cols);
+  for (index_type r = 0; r != rows; ++r)
+    for (index_type c = 0; c != cols; ++c)
+      in.put(r, c, C(r + c, r * c % 7));
+  Matrix<C> expected(rows, cols);
+  for (index_type r = 0; r != rows; ++r)
+    fft(in.row(r), expected.row(r));
+
+  Matrix<C> out(rows, cols, C(0.f));
+  thread_pool::parallel_for(Domain<1>(rows),
+			    by_row<fft_type, C, C>(fft, in, out), 1);
+  test_assert(matrix_equal(out, expected));
+
+  Matrix<C> in_t(cols, rows);
+  in_t = in.transpose();
+  out = C(0.f);
+  thread_pool::parallel_for(Domain<1>(rows),
+			    by_column<fft_type>(fft, in_t, out), 1);
+  test_assert(matrix_equal(out, expected));
+}
+
+void
+test_real_fft(length_type rows, length_type cols)
+{
+  typedef Fft<const_Vector, float, C, 0, by_reference> fft_type;
+  fft_type fft(Domain<1>(cols), 1.f);
+
+  Matrix<float> in(rows, cols);
+  for (index_type r = 0; r != rows; ++r)
+    for (index_type c = 0; c != cols; ++c)
+      in.put(r, c, float(r + c * c % 5));
+  Matrix<C> expected(rows, cols / 2 + 1);
+  for (index_type r = 0; r != rows; ++r)
+    fft(in.row(r), expected.row(r));
+
+  Matrix<C> out(rows, cols / 2 + 1, C(0.f));
+  thread_pool::parallel_for(Domain<1>(rows),
+			    by_row<fft_type, float, C>(fft, in, out), 1);
+  test_assert(matrix_equal(out, expected));
+}
+
+void
+test_fftm(length_type blocks, length_type rows, length_type cols)
+{
+  typedef Fftm<C, C, row, fft_fwd, by_reference> fftm_type;
+  fftm_type fftm(Domain<2>(rows, cols), 1.f);
+
+  Matrix<C> in(blocks * rows, cols);
+  for (index_type r = 0; r != in.size(0); ++r)
+    for (index_type c = 0; c != cols; ++c)
+      in.put(r, c, C(r * c % 11, r));
+  Matrix<C> expected(blocks * rows, cols);
+  for (index_type b = 0; b != blocks; ++b)
+  {
+    Domain<2> block(Domain<1>(b * rows, 1, rows), Domain<1>(cols));
+    fftm(in(block), expected(block));
+  }
+
+  Matrix<C> out(blocks * rows, cols, C(0.f));
+  thread_pool::parallel_for(Domain<1>(blocks),
+			    by_block<fftm_type>(fftm, in, out, rows), 1);
+  test_assert(matrix_equal(out, expected));
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  thread_pool::config c;
+  c.num_threads = 4;
+  thread_pool::initialize(c);
+
+  test_fft(64, 32);
+  test_fft(16, 256);
+  test_real_fft(64, 32);
+  test_fftm(32, 4, 64);
+}
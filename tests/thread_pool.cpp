@@ -0,0 +1,165 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// The library thread pool: task groups and parallel_for.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <ovxx/thread_pool.hpp>
+#include <test.hpp>
+#include <stdexcept>
+#include <vector>
+#if defined(__linux__)
+# include <sched.h>
+#endif
+
+using namespace ovxx;
+namespace tp = ovxx::thread_pool;
+
+// Record the chunks of a 1D parallel_for, checking that each index
+// is visited exactly once.
+struct fill_1d
+{
+  fill_1d(std::vector<int> &v) : visits(v) {}
+  void operator()(Domain<1> const &dom) const
+  {
+    for (index_type i = 0; i != dom.size(); ++i)
+      ++visits[dom.impl_nth(i)];
+  }
+  std::vector<int> &visits;
+};
+
+// Assign to a view through a 2D parallel_for.
+struct fill_2d
+{
+  fill_2d(Matrix<float> m) : matrix(m) {}
+  void operator()(Domain<2> const &dom) const
+  {
+    // Subviews of a shared view may be created concurrently.
+    Matrix<float> m = matrix;
+    m(dom) = m(dom) + 1.f;
+  }
+  Matrix<float> matrix;
+};
+
+// A parallel_for nested within another.
+struct nested
+{
+  nested(std::vector<int> &v, length_type c) : visits(v), columns(c) {}
+  void operator()(Domain<1> const &rows) const
+  {
+    for (index_type r = 0; r != rows.size(); ++r)
+    {
+      std::vector<int> inner(columns, 0);
+      tp::parallel_for(Domain<1>(columns), fill_1d(inner));
+      for (index_type c = 0; c != columns; ++c)
+	visits[rows.impl_nth(r)] += inner[c];
+    }
+  }
+  std::vector<int> &visits;
+  length_type columns;
+};
+
+struct accumulate
+{
+  accumulate(std::vector<int> &v, index_type i) : values(v), index(i) {}
+  void operator()() const { values[index] += index;}
+  std::vector<int> &values;
+  index_type index;
+};
+
+struct failure
+{
+  void operator()() const { throw std::runtime_error("task failure");}
+};
+
+void
+test_task_group()
+{
+  std::vector<int> values(100, 0);
+  tp::task_group group;
+  for (index_type i = 0; i != values.size(); ++i)
+    group.run(accumulate(values, i));
+  group.wait();
+  for (index_type i = 0; i != values.size(); ++i)
+    test_assert(values[i] == static_cast<int>(i));
+
+  group.run(failure());
+  bool caught = false;
+  try { group.wait();}
+  catch (std::runtime_error const &e) { caught = true;}
+  test_assert(caught);
+}
+
+void
+test_parallel_for()
+{
+  std::vector<int> visits(1000, 0);
+  tp::parallel_for(Domain<1>(1000), fill_1d(visits));
+  for (index_type i = 0; i != visits.size(); ++i)
+    test_assert(visits[i] == 1);
+
+  // A strided domain, and a grain size.
+  std::vector<int> strided(1000, 0);
+  tp::parallel_for(Domain<1>(1, 3, 333), fill_1d(strided), 10);
+  for (index_type i = 0; i != strided.size(); ++i)
+    test_assert(strided[i] == (i % 3 == 1 && i < 1000 ? 1 : 0));
+
+  Matrix<float> m(64, 32, 1.f);
+  tp::parallel_for(Domain<2>(64, 32), fill_2d(m));
+  for (index_type r = 0; r != 64; ++r)
+    for (index_type c = 0; c != 32; ++c)
+      test_assert(m.get(r, c) == 2.f);
+
+  std::vector<int> rows(50, 0);
+  tp::parallel_for(Domain<1>(50), nested(rows, 20));
+  for (index_type i = 0; i != rows.size(); ++i)
+    test_assert(rows[i] == 20);
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  tp::config c;
+  c.num_threads = 4;
+  tp::initialize(c);
+#if OVXX_ENABLE_THREADING
+  test_assert(tp::size() == 4);
+#else
+  test_assert(tp::size() == 1);
+#endif
+  test_assert(tp::nesting_level() == 0);
+  test_task_group();
+  test_parallel_for();
+
+  // Allow two levels of parallelism.
+  c.nesting = 2;
+  tp::initialize(c);
+  test_parallel_for();
+
+  // A single thread.
+  c.num_threads = 1;
+  tp::initialize(c);
+  test_assert(!tp::parallel());
+  test_task_group();
+  test_parallel_for();
+
+  // By default, one thread per processor the process may run on.
+  c.num_threads = 0;
+  tp::initialize(c);
+#if OVXX_ENABLE_THREADING && defined(__linux__)
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (!sched_getaffinity(0, sizeof(allowed), &allowed))
+    test_assert(tp::size() == static_cast<unsigned>(CPU_COUNT(&allowed)));
+#endif
+  test_task_group();
+}
@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2014 Stefan Seefeld
+// All rights reserved.
+//
+// This file is part of OpenVSIP. It is made available under the
+// license contained in the accompanying LICENSE.GPL file.
+
+// Welch spectral density estimation.
+
+#include <vsip/initfin.hpp>
+#include <vsip/support.hpp>
+#include <vsip/vector.hpp>
+#include <vsip/matrix.hpp>
+#include <vsip/signal.hpp>
+#include <ovxx/signal/welch.hpp>
+#include <test.hpp>
+#include <cmath>
+
+using namespace ovxx;
+using ovxx::signal::Welch;
+
+typedef complex<double> C;
+
+// Segments reaching before the start of the signal are skipped, even
+// when they span several chunks, so the count only starts growing
+// once window.size() samples have been seen.
+void
+test_partial(length_type length, length_type hop, length_type chunk)
+{
+  Welch<double> welch(Vector<double>(length, 1.), hop, length, chunk);
+  Vector<double> x(chunk);
+  length_type seen = 0;
+  for (index_type c = 0; c != 3 * length / chunk + 2; ++c)
+  {
+    for (index_type i = 0; i != chunk; ++i) x.put(i, double((seen + i) % 5));
+    welch(x);
+    seen += chunk;
+    test_assert(welch.segments() == (seen < length ? 0 : (seen - length) / hop + 1));
+  }
+  // After a reset, partial segments are skipped again.
+  welch.reset();
+  test_assert(welch.segments() == 0);
+  welch(x);
+  test_assert(welch.segments() == (chunk < length ? 0 : (chunk - length) / hop + 1));
+}
+
+// With a rectangular window of nfft samples, a tone at bin k0 has all
+// its power, |a|^2 nfft, in that bin. A second channel scaled by b
+// has cross density conj(a) a b nfft there, and is fully coherent.
+void
+test_tone(length_type nfft, length_type hop, index_type k0, C a, C b)
+{
+  length_type const chunk = 2 * hop, size = 4 * nfft;
+  Welch<C> welch(Vector<double>(nfft, 1.), hop, nfft, chunk, 2);
+  Matrix<C> x(2, chunk);
+  for (index_type pos = 0; pos != size; pos += chunk)
+  {
+    for (index_type i = 0; i != chunk; ++i)
+    {
+      C tone = a * std::polar(1., 2 * M_PI * double(k0 * (pos + i) % nfft) / nfft);
+      x.put(0, i, tone);
+      x.put(1, i, b * tone);
+    }
+    welch(x);
+  }
+  Vector<double> psd(nfft), coherence(nfft);
+  Vector<C> csd(nfft), reverse(nfft);
+  welch.psd(psd, 0);
+  welch.csd(csd, 0, 1);
+  welch.csd(reverse, 1, 0);
+  welch.coherence(coherence, 1, 0);
+  for (index_type k = 0; k != nfft; ++k)
+  {
+    bool tone = k == k0;
+    test_assert(equal(psd.get(k), tone ? norm(a) * nfft : 0.));
+    test_assert(equal(csd.get(k), tone ? norm(a) * b * double(nfft) : C(0.)));
+    test_assert(equal(reverse.get(k), conj(csd.get(k))));
+    if (tone) test_assert(equal(coherence.get(k), 1.));
+  }
+  welch.psd(psd, 1);
+  test_assert(equal(psd.get(k0), norm(a * b) * nfft));
+}
+
+// By Parseval's theorem, with a rectangular window the full two-sided
+// density sums to the mean segment energy. For real input, the bins
+// above nfft / 2 mirror those returned.
+void
+test_energy(length_type nfft, length_type hop)
+{
+  length_type const size = 6 * nfft;
+  Vector<double> x(size);
+  for (index_type i = 0; i != size; ++i)
+    x.put(i, std::sin(0.37 * i) + double((i * 3) % 7) / 7.);
+  Welch<double> welch(Vector<double>(nfft, 1.), hop, nfft, size);
+  welch(x);
+  test_assert(welch.bins() == nfft / 2 + 1);
+
+  double energy = 0.;
+  length_type segments = 0;
+  for (index_type start = hop * ((nfft + hop - 1) / hop) - nfft;
+       start + nfft <= size; start += hop, ++segments)
+    for (index_type i = 0; i != nfft; ++i)
+      energy += x.get(start + i) * x.get(start + i);
+  test_assert(welch.segments() == segments);
+
+  Vector<double> psd(welch.bins());
+  welch.psd(psd);
+  double sum = psd.get(0);
+  for (index_type k = 1; k != welch.bins(); ++k)
+    sum += (2 * k == nfft ? 1. : 2.) * psd.get(k);
+  test_assert(equal(sum, energy / segments));
+}
+
+int
+main(int argc, char **argv)
+{
+  vsipl library(argc, argv);
+
+  test_partial(16, 4, 4);
+  test_partial(12, 3, 9);
+  test_partial(8, 8, 16);
+  test_tone(16, 8, 3, C(1.5, -0.5), C(2., -1.));
+  test_tone(12, 4, 11, C(0., 2.), C(-0.5, 0.));
+  test_energy(16, 4);
+  test_energy(15, 5);
+}